@@ -182,8 +182,8 @@ main (int argc, char *argv[])
     {
         tmcPepL->m_devTer = devicesTer.Get(0);
         tmcPepR->m_devTer = devicesTer.Get(1);
-        DynamicCast<PointToPointNetDevice>(tmcPepL->m_devTer)->m_transmitCompleteCb = MakeCallback (&TmcApp::sentToBond, tmcPepL);
-        DynamicCast<PointToPointNetDevice>(tmcPepR->m_devTer)->m_transmitCompleteCb = MakeCallback (&TmcApp::sentToBond, tmcPepR);
+        tmcPepL->m_devTer->SetReadyCallback (MakeCallback (&TmcApp::sentToBond, tmcPepL));
+        tmcPepR->m_devTer->SetReadyCallback (MakeCallback (&TmcApp::sentToBond, tmcPepR));
         DynamicCast<PointToPointNetDevice>(tmcPepL->m_devTer)->SetReceiveCallback(MakeCallback (&TmcApp::recvFromBond, tmcPepL));
         DynamicCast<PointToPointNetDevice>(tmcPepR->m_devTer)->SetReceiveCallback(MakeCallback (&TmcApp::recvFromBond, tmcPepR));
     }
@@ -192,8 +192,8 @@ main (int argc, char *argv[])
     {
         tmcPepL->m_devSat = devicesSat.Get(0);
         tmcPepR->m_devSat = devicesSat.Get(1);
-        DynamicCast<PointToPointNetDevice>(tmcPepL->m_devSat)->m_transmitCompleteCb = MakeCallback (&TmcApp::sentToBond, tmcPepL);
-        DynamicCast<PointToPointNetDevice>(tmcPepR->m_devSat)->m_transmitCompleteCb = MakeCallback (&TmcApp::sentToBond, tmcPepR);
+        tmcPepL->m_devSat->SetReadyCallback (MakeCallback (&TmcApp::sentToBond, tmcPepL));
+        tmcPepR->m_devSat->SetReadyCallback (MakeCallback (&TmcApp::sentToBond, tmcPepR));
         DynamicCast<PointToPointNetDevice>(tmcPepL->m_devSat)->SetReceiveCallback(MakeCallback (&TmcApp::recvFromBond, tmcPepL));
         DynamicCast<PointToPointNetDevice>(tmcPepR->m_devSat)->SetReceiveCallback(MakeCallback (&TmcApp::recvFromBond, tmcPepR));
     }
@@ -37,6 +37,7 @@
 #include "seq-ts-header.h"
 #include <cstdlib>
 #include <cstdio>
+#include <vector>
 #include "ns3/tranGia.h"
 
 namespace ns3 {
@@ -190,10 +191,14 @@ TranGiaClient::StartApplication (void)
   } while (nrMainObjects < 1);
   m_ofStat << nrMainObjects << ",";
 
+  // draw all object sizes of a kind in one batch
+  std::vector<double> sizes(nrMainObjects);
+  m_sizeMainObjectsWeibull->GetValues(sizes.data(), nrMainObjects);
+
   uint32_t totalSize = 0;
   for(uint32_t i = 0; i < nrMainObjects; i++)
   {
-      uint32_t value = m_sizeMainObjectsWeibull->GetInteger();
+      uint32_t value = static_cast<uint32_t>(sizes[i]);
       objectSizes.push_back(value);
       m_ofStat << value << ":"; // mainObjectSizes
       totalSize += value;
@@ -204,10 +209,13 @@ TranGiaClient::StartApplication (void)
   uint32_t nrEmbObjects = m_nrEmbObjectsExp->GetInteger ();
   m_ofStat << nrEmbObjects << ",";
 
+  sizes.resize(nrEmbObjects);
+  m_sizeEmbObjectsLognormal->GetValues(sizes.data(), nrEmbObjects);
+
   totalSize = 0;
   for(uint32_t i = 0; i < nrEmbObjects; i++)
   {
-      uint32_t value = m_sizeEmbObjectsLognormal->GetInteger();
+      uint32_t value = static_cast<uint32_t>(sizes[i]);
       objectSizes.push_back(value);
       m_ofStat << value << ":"; //embObjectsSizes
       totalSize += value;
@@ -35,6 +35,7 @@
 #include "rng-seed-manager.h"
 #include "unused.h"
 #include <cmath>
+#include <algorithm>
 #include <iostream>
 
 /**
@@ -47,6 +48,42 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("RandomVariableStream");
 
+namespace {
+
+/**
+ * \ingroup randomvariable
+ * Move the values of \p v which satisfy \p bound to the front,
+ * preserving their order.
+ *
+ * This is the batched equivalent of the rejection loops used by the
+ * bounded distributions: a value is accepted if \p bound is zero or
+ * the value does not exceed it.
+ *
+ * \param [in,out] v The candidate values.
+ * \param [in] n The number of candidate values.
+ * \param [in] bound The upper bound, or zero for no bound.
+ * \return The number of accepted values.
+ */
+std::size_t
+AcceptBounded (double *v, std::size_t n, double bound)
+{
+  if (bound == 0)
+    {
+      return n;
+    }
+  std::size_t accepted = 0;
+  for (std::size_t i = 0; i < n; ++i)
+    {
+      if (v[i] <= bound)
+        {
+          v[accepted++] = v[i];
+        }
+    }
+  return accepted;
+}
+
+} // unnamed namespace
+
 NS_OBJECT_ENSURE_REGISTERED (RandomVariableStream);
 
 TypeId 
@@ -138,6 +175,30 @@ RandomVariableStream::Peek(void) const
   return m_rng;
 }
 
+void
+RandomVariableStream::GetU01Values (double *u, std::size_t n) const
+{
+  NS_LOG_FUNCTION (this << u << n);
+  m_rng->RandU01 (u, n);
+  if (m_isAntithetic)
+    {
+      for (std::size_t i = 0; i < n; ++i)
+        {
+          u[i] = (1 - u[i]);
+        }
+    }
+}
+
+void
+RandomVariableStream::GetValues (double *out, std::size_t n)
+{
+  NS_LOG_FUNCTION (this << out << n);
+  for (std::size_t i = 0; i < n; ++i)
+    {
+      out[i] = GetValue ();
+    }
+}
+
 NS_OBJECT_ENSURE_REGISTERED(UniformRandomVariable);
 
 TypeId 
@@ -208,6 +269,23 @@ UniformRandomVariable::GetInteger (void)
   NS_LOG_FUNCTION (this);
   return (uint32_t)GetValue (m_min, m_max + 1);
 }
+void
+UniformRandomVariable::GetValues (double *out, std::size_t n)
+{
+  NS_LOG_FUNCTION (this << out << n);
+  Peek ()->RandU01 (out, n);
+  for (std::size_t i = 0; i < n; ++i)
+    {
+      out[i] = m_min + out[i] * (m_max - m_min);
+    }
+  if (IsAntithetic ())
+    {
+      for (std::size_t i = 0; i < n; ++i)
+        {
+          out[i] = m_min + (m_max - out[i]);
+        }
+    }
+}
 
 NS_OBJECT_ENSURE_REGISTERED(ConstantRandomVariable);
 
@@ -445,6 +523,25 @@ ExponentialRandomVariable::GetInteger (void)
   NS_LOG_FUNCTION (this);
   return (uint32_t)GetValue (m_mean, m_bound);
 }
+void
+ExponentialRandomVariable::GetValues (double *out, std::size_t n)
+{
+  NS_LOG_FUNCTION (this << out << n);
+  // Every value consumes at least one uniform, so drawing as many
+  // uniforms as values are still missing never runs ahead of GetValue().
+  std::size_t filled = 0;
+  while (filled < n)
+    {
+      double *v = out + filled;
+      std::size_t k = n - filled;
+      GetU01Values (v, k);
+      for (std::size_t i = 0; i < k; ++i)
+        {
+          v[i] = -m_mean*std::log (v[i]);
+        }
+      filled += AcceptBounded (v, k, m_bound);
+    }
+}
 
 NS_OBJECT_ENSURE_REGISTERED(ParetoRandomVariable);
 
@@ -564,6 +661,23 @@ ParetoRandomVariable::GetInteger (void)
   NS_LOG_FUNCTION (this);
   return (uint32_t)GetValue (m_scale, m_shape, m_bound);
 }
+void
+ParetoRandomVariable::GetValues (double *out, std::size_t n)
+{
+  NS_LOG_FUNCTION (this << out << n);
+  std::size_t filled = 0;
+  while (filled < n)
+    {
+      double *v = out + filled;
+      std::size_t k = n - filled;
+      GetU01Values (v, k);
+      for (std::size_t i = 0; i < k; ++i)
+        {
+          v[i] = (m_scale * ( 1.0 / std::pow (v[i], 1.0 / m_shape)));
+        }
+      filled += AcceptBounded (v, k, m_bound);
+    }
+}
 
 NS_OBJECT_ENSURE_REGISTERED(WeibullRandomVariable);
 
@@ -658,6 +772,24 @@ WeibullRandomVariable::GetInteger (void)
   NS_LOG_FUNCTION (this);
   return (uint32_t)GetValue (m_scale, m_shape, m_bound);
 }
+void
+WeibullRandomVariable::GetValues (double *out, std::size_t n)
+{
+  NS_LOG_FUNCTION (this << out << n);
+  double exponent = 1.0 / m_shape;
+  std::size_t filled = 0;
+  while (filled < n)
+    {
+      double *v = out + filled;
+      std::size_t k = n - filled;
+      GetU01Values (v, k);
+      for (std::size_t i = 0; i < k; ++i)
+        {
+          v[i] = m_scale * std::pow ( -std::log (v[i]), exponent);
+        }
+      filled += AcceptBounded (v, k, m_bound);
+    }
+}
 
 NS_OBJECT_ENSURE_REGISTERED(NormalRandomVariable);
 
@@ -898,6 +1030,40 @@ LogNormalRandomVariable::GetInteger (void)
   NS_LOG_FUNCTION (this);
   return (uint32_t)GetValue (m_mu, m_sigma);
 }
+void
+LogNormalRandomVariable::GetValues (double *out, std::size_t n)
+{
+  NS_LOG_FUNCTION (this << out << n);
+  // Each value needs at least one pair of uniforms; drawing two uniforms
+  // per missing value therefore never runs ahead of GetValue().
+  static const std::size_t BLOCK = 64;
+  double u[2 * BLOCK];
+  std::size_t filled = 0;
+  while (filled < n)
+    {
+      std::size_t k = std::min (n - filled, BLOCK);
+      GetU01Values (u, 2 * k);
+      std::size_t start = filled;
+      for (std::size_t i = 0; i < k; ++i)
+        {
+          /* choose x,y in uniform square (-1,-1) to (+1,+1) */
+          double v1 = -1 + 2 * u[2 * i];
+          double v2 = -1 + 2 * u[2 * i + 1];
+
+          /* see if it is in the unit circle */
+          double r2 = v1 * v1 + v2 * v2;
+          if (r2 > 1.0 || r2 == 0)
+            {
+              continue;
+            }
+          out[filled++] = v1 * std::sqrt (-2.0 * std::log (r2) / r2);
+        }
+      for (std::size_t i = start; i < filled; ++i)
+        {
+          out[i] = std::exp (m_sigma * out[i] + m_mu);
+        }
+    }
+}
 
 NS_OBJECT_ENSURE_REGISTERED(GammaRandomVariable);
 
@@ -29,6 +29,7 @@
 #include "type-id.h"
 #include "object.h"
 #include "attribute-helper.h"
+#include <cstddef>
 #include <stdint.h>
 
 /**
@@ -149,6 +150,20 @@ public:
    */
   virtual uint32_t GetInteger (void) = 0;
 
+  /**
+   * \brief Get the next \p n random values drawn from the distribution.
+   *
+   * The values written to \p out are identical, in order, to those
+   * returned by \p n successive calls to GetValue(), and the stream is
+   * left in the same state.  The default implementation simply calls
+   * GetValue() in a loop; distributions computed by an inverse transform
+   * override it to draw their uniforms from the RngStream in blocks.
+   *
+   * \param [out] out The array to fill, of at least \p n elements.
+   * \param [in] n The number of values to draw.
+   */
+  virtual void GetValues (double *out, std::size_t n);
+
 protected:
   /**
    * \brief Get the pointer to the underlying RngStream.
@@ -156,6 +171,17 @@ protected:
    */
   RngStream *Peek(void) const;
 
+  /**
+   * \brief Get the next \p n uniforms from the underlying RngStream.
+   *
+   * If this stream is antithetic each value \c u is replaced by
+   * \c 1-u, as done by the scalar GetValue() implementations.
+   *
+   * \param [out] u The array to fill, of at least \p n elements.
+   * \param [in] n The number of uniforms to draw.
+   */
+  void GetU01Values (double *u, std::size_t n) const;
+
 private:
   /**
    * Copy constructor.  These objects are not copyable.
@@ -294,6 +320,7 @@ public:
    * \note The upper limit is included in the output range.
    */
   virtual uint32_t GetInteger (void);
+  virtual void GetValues (double *out, std::size_t n);
   
 private:
   /** The lower bound on values that can be returned by this RNG stream. */
@@ -586,6 +613,7 @@ public:
   // Inherited from RandomVariableStream
   virtual double GetValue (void);
   virtual uint32_t GetInteger (void);
+  virtual void GetValues (double *out, std::size_t n);
 
 private:
   /** The mean value of the unbounded exponential distribution. */
@@ -791,6 +819,7 @@ public:
    * which now involves the distance \f$u\f$ is from 1 in the denominator.
    */
   virtual uint32_t GetInteger (void);
+  virtual void GetValues (double *out, std::size_t n);
 
 private:
   /** The mean parameter for the Pareto distribution returned by this RNG stream. */
@@ -1000,6 +1029,7 @@ public:
    * which now involves the log of the distance \f$u\f$ is from 1.
    */
   virtual uint32_t GetInteger (void);
+  virtual void GetValues (double *out, std::size_t n);
 
 private:
   /** The scale parameter for the Weibull distribution returned by this RNG stream. */
@@ -1463,6 +1493,7 @@ public:
    * which now involves the distances \f$u1\f$ and \f$u2\f$ are from 1.
    */
   virtual uint32_t GetInteger (void);
+  virtual void GetValues (double *out, std::size_t n);
 
 private:
   /** The mu value for the log-normal distribution returned by this RNG stream. */
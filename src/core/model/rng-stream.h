@@ -20,6 +20,7 @@
 #ifndef RNGSTREAM_H
 #define RNGSTREAM_H
 #include <string>
+#include <cstddef>
 #include <stdint.h>
 
 /**
@@ -70,6 +71,17 @@ public:
    * \returns The next random.
    */
   double RandU01 (void);
+  /**
+   * Generate the next \p n random numbers for this stream.
+   *
+   * The sequence written to \p u is bit-identical to the one obtained
+   * by \p n successive calls to RandU01(void), but the state is kept
+   * in registers for the whole block.
+   *
+   * \param [out] u The array to fill, of at least \p n elements.
+   * \param [in] n The number of randoms to generate.
+   */
+  void RandU01 (double *u, std::size_t n);
 
 private:
   /**
@@ -129,6 +129,12 @@ public:
    * \returns The scheduled EventId.
    */
   virtual EventId Schedule (const Time &delay) = 0;
+  /**
+   * Make an event invoking the callback with the current arguments.
+   *
+   * \returns The event, to be scheduled by the caller.
+   */
+  virtual EventImpl * MakeEvent (void) = 0;
   /** Invoke the expire function. */
   virtual void Invoke (void) = 0;
 };
@@ -274,6 +280,10 @@ MakeTimerImpl (IntToType<0>, FN fn)
     {
       return Simulator::Schedule (delay, m_fn);
     }
+    virtual EventImpl * MakeEvent (void)
+    {
+      return ns3::MakeEvent (m_fn);
+    }
     virtual void Invoke (void)
     {
       m_fn ();
@@ -309,6 +319,10 @@ MakeTimerImpl (IntToType<1>, FN fn)
     {
       return Simulator::Schedule (delay, m_fn, m_a1);
     }
+    virtual EventImpl * MakeEvent (void)
+    {
+      return ns3::MakeEvent (m_fn, m_a1);
+    }
     virtual void Invoke (void)
     {
       m_fn (m_a1);
@@ -349,6 +363,10 @@ MakeTimerImpl (IntToType<2>, FN fn)
     {
       return Simulator::Schedule (delay, m_fn, m_a1, m_a2);
     }
+    virtual EventImpl * MakeEvent (void)
+    {
+      return ns3::MakeEvent (m_fn, m_a1, m_a2);
+    }
     virtual void Invoke (void)
     {
       m_fn (m_a1, m_a2);
@@ -394,6 +412,10 @@ MakeTimerImpl (IntToType<3>, FN fn)
     {
       return Simulator::Schedule (delay, m_fn, m_a1, m_a2, m_a3);
     }
+    virtual EventImpl * MakeEvent (void)
+    {
+      return ns3::MakeEvent (m_fn, m_a1, m_a2, m_a3);
+    }
     virtual void Invoke (void)
     {
       m_fn (m_a1, m_a2, m_a3);
@@ -444,6 +466,10 @@ MakeTimerImpl (IntToType<4>, FN fn)
     {
       return Simulator::Schedule (delay, m_fn, m_a1, m_a2, m_a3, m_a4);
     }
+    virtual EventImpl * MakeEvent (void)
+    {
+      return ns3::MakeEvent (m_fn, m_a1, m_a2, m_a3, m_a4);
+    }
     virtual void Invoke (void)
     {
       m_fn (m_a1, m_a2, m_a3, m_a4);
@@ -499,6 +525,10 @@ MakeTimerImpl (IntToType<5>, FN fn)
     {
       return Simulator::Schedule (delay, m_fn, m_a1, m_a2, m_a3, m_a4, m_a5);
     }
+    virtual EventImpl * MakeEvent (void)
+    {
+      return ns3::MakeEvent (m_fn, m_a1, m_a2, m_a3, m_a4, m_a5);
+    }
     virtual void Invoke (void)
     {
       m_fn (m_a1, m_a2, m_a3, m_a4, m_a5);
@@ -559,6 +589,10 @@ MakeTimerImpl (IntToType<6>, FN fn)
     {
       return Simulator::Schedule (delay, m_fn, m_a1, m_a2, m_a3, m_a4, m_a5, m_a6);
     }
+    virtual EventImpl * MakeEvent (void)
+    {
+      return ns3::MakeEvent (m_fn, m_a1, m_a2, m_a3, m_a4, m_a5, m_a6);
+    }
     virtual void Invoke (void)
     {
       m_fn (m_a1, m_a2, m_a3, m_a4, m_a5, m_a6);
@@ -649,6 +683,10 @@ MakeTimerImpl (IntToType<0>, MEM_PTR memPtr, OBJ_PTR objPtr)
     {
       return Simulator::Schedule (delay, m_memPtr, m_objPtr);
     }
+    virtual EventImpl * MakeEvent (void)
+    {
+      return ns3::MakeEvent (m_memPtr, m_objPtr);
+    }
     virtual void Invoke (void)
     {
       (TimerImplMemberTraits<OBJ_PTR>::GetReference (m_objPtr).*m_memPtr)();
@@ -686,6 +724,10 @@ MakeTimerImpl (IntToType<1>, MEM_PTR memPtr, OBJ_PTR objPtr)
     {
       return Simulator::Schedule (delay, m_memPtr, m_objPtr, m_a1);
     }
+    virtual EventImpl * MakeEvent (void)
+    {
+      return ns3::MakeEvent (m_memPtr, m_objPtr, m_a1);
+    }
     virtual void Invoke (void)
     {
       (TimerImplMemberTraits<OBJ_PTR>::GetReference (m_objPtr).*m_memPtr)(m_a1);
@@ -728,6 +770,10 @@ MakeTimerImpl (IntToType<2>, MEM_PTR memPtr, OBJ_PTR objPtr)
     {
       return Simulator::Schedule (delay, m_memPtr, m_objPtr, m_a1, m_a2);
     }
+    virtual EventImpl * MakeEvent (void)
+    {
+      return ns3::MakeEvent (m_memPtr, m_objPtr, m_a1, m_a2);
+    }
     virtual void Invoke (void)
     {
       (TimerImplMemberTraits<OBJ_PTR>::GetReference (m_objPtr).*m_memPtr)(m_a1, m_a2);
@@ -775,6 +821,10 @@ MakeTimerImpl (IntToType<3>, MEM_PTR memPtr, OBJ_PTR objPtr)
     {
       return Simulator::Schedule (delay, m_memPtr, m_objPtr, m_a1, m_a2, m_a3);
     }
+    virtual EventImpl * MakeEvent (void)
+    {
+      return ns3::MakeEvent (m_memPtr, m_objPtr, m_a1, m_a2, m_a3);
+    }
     virtual void Invoke (void)
     {
       (TimerImplMemberTraits<OBJ_PTR>::GetReference (m_objPtr).*m_memPtr)(m_a1, m_a2, m_a3);
@@ -827,6 +877,10 @@ MakeTimerImpl (IntToType<4>, MEM_PTR memPtr, OBJ_PTR objPtr)
     {
       return Simulator::Schedule (delay, m_memPtr, m_objPtr, m_a1, m_a2, m_a3, m_a4);
     }
+    virtual EventImpl * MakeEvent (void)
+    {
+      return ns3::MakeEvent (m_memPtr, m_objPtr, m_a1, m_a2, m_a3, m_a4);
+    }
     virtual void Invoke (void)
     {
       (TimerImplMemberTraits<OBJ_PTR>::GetReference (m_objPtr).*m_memPtr)(m_a1, m_a2, m_a3, m_a4);
@@ -884,6 +938,10 @@ MakeTimerImpl (IntToType<5>, MEM_PTR memPtr, OBJ_PTR objPtr)
     {
       return Simulator::Schedule (delay, m_memPtr, m_objPtr, m_a1, m_a2, m_a3, m_a4, m_a5);
     }
+    virtual EventImpl * MakeEvent (void)
+    {
+      return ns3::MakeEvent (m_memPtr, m_objPtr, m_a1, m_a2, m_a3, m_a4, m_a5);
+    }
     virtual void Invoke (void)
     {
       (TimerImplMemberTraits<OBJ_PTR>::GetReference (m_objPtr).*m_memPtr)(m_a1, m_a2, m_a3, m_a4, m_a5);
@@ -946,6 +1004,10 @@ MakeTimerImpl (IntToType<6>, MEM_PTR memPtr, OBJ_PTR objPtr)
     {
       return Simulator::Schedule (delay, m_memPtr, m_objPtr, m_a1, m_a2, m_a3, m_a4, m_a5, m_a6);
     }
+    virtual EventImpl * MakeEvent (void)
+    {
+      return ns3::MakeEvent (m_memPtr, m_objPtr, m_a1, m_a2, m_a3, m_a4, m_a5, m_a6);
+    }
     virtual void Invoke (void)
     {
       (TimerImplMemberTraits<OBJ_PTR>::GetReference (m_objPtr).*m_memPtr)(m_a1, m_a2, m_a3, m_a4, m_a5, m_a6);
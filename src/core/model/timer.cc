@@ -18,6 +18,7 @@
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
 #include "timer.h"
+#include "timing-wheel.h"
 #include "simulator.h"
 #include "simulation-singleton.h"
 #include "log.h"
@@ -55,18 +56,18 @@ Timer::~Timer ()
   NS_LOG_FUNCTION (this);
   if (m_flags & CHECK_ON_DESTROY)
     {
-      if (m_event.IsRunning ())
+      if (IsEventRunning ())
         {
           NS_FATAL_ERROR ("Event is still running while destroying.");
         }
     }
   else if (m_flags & CANCEL_ON_DESTROY)
     {
-      m_event.Cancel ();
+      Cancel ();
     }
   else if (m_flags & REMOVE_ON_DESTROY)
     {
-      Simulator::Remove (m_event);
+      Remove ();
     }
   delete m_impl;
 }
@@ -83,6 +84,20 @@ Timer::GetDelay (void) const
   NS_LOG_FUNCTION (this);
   return m_delay;
 }
+void
+Timer::SetTimingWheel (bool enable)
+{
+  NS_LOG_FUNCTION (this << enable);
+  NS_ASSERT_MSG (!IsEventRunning (), "Cannot move a running timer to or from the timing wheel");
+  if (enable)
+    {
+      m_flags |= TIMER_WHEEL;
+    }
+  else
+    {
+      m_flags &= ~TIMER_WHEEL;
+    }
+}
 Time
 Timer::GetDelayLeft (void) const
 {
@@ -90,6 +105,10 @@ Timer::GetDelayLeft (void) const
   switch (GetState ())
     {
     case Timer::RUNNING:
+      if (m_wheelEvent != 0)
+        {
+          return m_wheelEvent->GetTs () - Simulator::Now ();
+        }
       return Simulator::GetDelayLeft (m_event);
       break;
     case Timer::EXPIRED:
@@ -109,25 +128,44 @@ void
 Timer::Cancel (void)
 {
   NS_LOG_FUNCTION (this);
+  if (m_wheelEvent != 0)
+    {
+      m_wheelEvent->Cancel ();
+      return;
+    }
   Simulator::Cancel (m_event);
 }
 void
 Timer::Remove (void)
 {
   NS_LOG_FUNCTION (this);
+  if (m_wheelEvent != 0)
+    {
+      m_wheelEvent->Cancel ();
+      return;
+    }
   Simulator::Remove (m_event);
 }
 bool
 Timer::IsExpired (void) const
 {
   NS_LOG_FUNCTION (this);
-  return !IsSuspended () && m_event.IsExpired ();
+  return !IsSuspended () && !IsEventRunning ();
 }
 bool
 Timer::IsRunning (void) const
 {
   NS_LOG_FUNCTION (this);
-  return !IsSuspended () && m_event.IsRunning ();
+  return !IsSuspended () && IsEventRunning ();
+}
+bool
+Timer::IsEventRunning (void) const
+{
+  if (m_wheelEvent != 0)
+    {
+      return m_wheelEvent->IsRunning ();
+    }
+  return m_event.IsRunning ();
 }
 bool
 Timer::IsSuspended (void) const
@@ -166,11 +204,27 @@ Timer::Schedule (Time delay)
 {
   NS_LOG_FUNCTION (this << delay);
   NS_ASSERT (m_impl != 0);
-  if (m_event.IsRunning ())
+  if (IsEventRunning ())
     {
       NS_FATAL_ERROR ("Event is still running while re-scheduling.");
     }
-  m_event = m_impl->Schedule (delay);
+  DoSchedule (delay);
+}
+
+void
+Timer::DoSchedule (const Time &delay)
+{
+  NS_LOG_FUNCTION (this << delay);
+  if (m_flags & TIMER_WHEEL)
+    {
+      m_event = EventId ();
+      m_wheelEvent = TimingWheel::Schedule (delay, Ptr<EventImpl> (m_impl->MakeEvent (), false));
+    }
+  else
+    {
+      m_wheelEvent = 0;
+      m_event = m_impl->Schedule (delay);
+    }
 }
 
 void
@@ -178,8 +232,8 @@ Timer::Suspend (void)
 {
   NS_LOG_FUNCTION (this);
   NS_ASSERT (IsRunning ());
-  m_delayLeft = Simulator::GetDelayLeft (m_event);
-  Simulator::Remove (m_event);
+  m_delayLeft = GetDelayLeft ();
+  Remove ();
   m_flags |= TIMER_SUSPENDED;
 }
 
@@ -188,7 +242,7 @@ Timer::Resume (void)
 {
   NS_LOG_FUNCTION (this);
   NS_ASSERT (m_flags & TIMER_SUSPENDED);
-  m_event = m_impl->Schedule (m_delayLeft);
+  DoSchedule (m_delayLeft);
   m_flags &= ~TIMER_SUSPENDED;
 }
 
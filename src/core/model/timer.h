@@ -24,6 +24,7 @@
 #include "nstime.h"
 #include "event-id.h"
 #include "int-to-type.h"
+#include "timing-wheel.h"
 
 /**
  * \file
@@ -68,6 +69,10 @@ class TimerImpl;
  * management policies. These policies are specified at construction time
  * and cannot be changed after.
  *
+ * Timers which are mostly cancelled or rescheduled before they expire,
+ * such as protocol timeouts, can be held by the TimingWheel instead of
+ * the simulator event list (see SetTimingWheel).
+ *
  * \see Watchdog for a simpler interface for a watchdog timer.
  */
 class Timer
@@ -201,6 +206,15 @@ public:
    * \returns The currently-configured delay for the next Schedule.
    */
   Time GetDelay (void) const;
+  /**
+   * \param [in] enable whether the timer is held by the TimingWheel
+   *
+   * The next calls to Schedule will schedule the timer in the TimingWheel,
+   * which only schedules it in the simulator event list once the granule of
+   * its expiration time starts. The timer still expires at the exact
+   * expiration time. Calling this method on a running timer is an error.
+   */
+  void SetTimingWheel (bool enable);
   /**
    * \returns The amount of time left until this timer expires.
    *
@@ -214,7 +228,9 @@ public:
   void Cancel (void);
   /**
    * Remove from the simulation event-list the currently-running event
-   * if there is one. Do nothing otherwise.
+   * if there is one. Do nothing otherwise. A timer held by the
+   * TimingWheel is removed from the wheel, or cancelled if it has
+   * already been scheduled in the simulation event-list.
    */
   void Remove (void);
   /**
@@ -266,9 +282,22 @@ private:
   /** Internal bit marking the suspended state. */
   enum InternalSuspended
   {
-    TIMER_SUSPENDED = (1 << 7)  /** Timer suspended. */
+    TIMER_SUSPENDED = (1 << 7),  /** Timer suspended. */
+    TIMER_WHEEL = (1 << 8)       /** Timer held by the TimingWheel. */
   };
 
+  /**
+   * Schedule the event of the timer, in the TimingWheel or in the
+   * simulation event-list.
+   * \param [in] delay the delay to use
+   */
+  void DoSchedule (const Time &delay);
+  /**
+   * \returns \c true if the event of the timer is running, regardless
+   * of the suspended state
+   */
+  bool IsEventRunning (void) const;
+
   /**
    * Bitfield for Timer State, DestroyPolicy and InternalSuspended.
    *
@@ -283,6 +312,8 @@ private:
   Time m_delay;
   /** The future event scheduled to expire the timer. */
   EventId m_event;
+  /** The event held by the TimingWheel, if the timer uses it. */
+  Ptr<TimingWheelEvent> m_wheelEvent;
   /**
    * The timer implementation, which contains the bound callback
    * function and arguments.
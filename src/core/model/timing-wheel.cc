@@ -0,0 +1,388 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "timing-wheel.h"
+#include "simulator.h"
+#include "log.h"
+#include <algorithm>
+
+/**
+ * \file
+ * \ingroup timer
+ * ns3::TimingWheel and ns3::TimingWheelEvent implementations.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TimingWheel");
+
+NS_OBJECT_ENSURE_REGISTERED (TimingWheel);
+
+/**
+ * \ingroup timer
+ * The timing wheel of the current simulation.
+ */
+static Ptr<TimingWheel> g_wheel;
+
+TimingWheelEvent::TimingWheelEvent (const Time &ts, const Ptr<EventImpl> &event)
+  : m_ts (ts),
+    m_event (event),
+    m_context (Simulator::GetContext ()),
+    m_seq (0),
+    m_wheel (0),
+    m_slot (0),
+    m_pos (0)
+{
+}
+
+TimingWheelEvent::~TimingWheelEvent ()
+{
+}
+
+Time
+TimingWheelEvent::GetTs (void) const
+{
+  return m_ts;
+}
+
+bool
+TimingWheelEvent::IsRunning (void)
+{
+  return m_event != 0;
+}
+
+bool
+TimingWheelEvent::IsExpired (void)
+{
+  return m_event == 0;
+}
+
+void
+TimingWheelEvent::Cancel (void)
+{
+  Ptr<TimingWheelEvent> self = this;
+  if (m_wheel != 0)
+    {
+      m_wheel->Unlink (this);
+    }
+  else if (m_event != 0)
+    {
+      EventImpl::Cancel ();
+    }
+  m_event = 0;
+}
+
+void
+TimingWheelEvent::Notify (void)
+{
+  Ptr<EventImpl> event = m_event;
+  m_event = 0;
+  if (event != 0)
+    {
+      event->Invoke ();
+    }
+}
+
+
+TypeId
+TimingWheel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TimingWheel")
+    .SetParent<Object> ()
+    .SetGroupName ("Core")
+    .AddConstructor<TimingWheel> ()
+    .AddAttribute ("Granularity",
+                   "The duration of the granules of the timing wheel. Events less "
+                   "than a granule away are scheduled in the simulator event list.",
+                   TimeValue (MilliSeconds (1)),
+                   MakeTimeAccessor (&TimingWheel::m_granularity),
+                   MakeTimeChecker (TimeStep (1)))
+  ;
+  return tid;
+}
+
+TimingWheel::TimingWheel ()
+  : m_granuleSteps (1),
+    m_current (0),
+    m_seq (0),
+    m_nEvents (0),
+    m_slots (OVERFLOW_SLOT + 1),
+    m_expireGranule (0)
+{
+  NS_LOG_FUNCTION (this);
+  std::fill (m_nLevelEvents, m_nLevelEvents + N_LEVELS + 1, 0);
+}
+
+TimingWheel::~TimingWheel ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+TimingWheel::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (uint32_t i = 0; i < m_slots.size (); i++)
+    {
+      for (uint32_t j = 0; j < m_slots[i].size (); j++)
+        {
+          m_slots[i][j]->m_wheel = 0;
+          m_slots[i][j]->m_event = 0;
+        }
+      m_slots[i].clear ();
+    }
+  m_nEvents = 0;
+  std::fill (m_nLevelEvents, m_nLevelEvents + N_LEVELS + 1, 0);
+  if (m_expireEvent != 0)
+    {
+      m_expireEvent->Cancel ();
+      m_expireEvent = 0;
+    }
+  Object::DoDispose ();
+}
+
+Ptr<TimingWheel>
+TimingWheel::GetWheel (void)
+{
+  if (g_wheel == 0)
+    {
+      g_wheel = CreateObject<TimingWheel> ();
+      g_wheel->m_granuleSteps = g_wheel->m_granularity.GetTimeStep ();
+      Simulator::ScheduleDestroy (&TimingWheel::DestroyWheel);
+    }
+  return g_wheel;
+}
+
+void
+TimingWheel::DestroyWheel (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  if (g_wheel != 0)
+    {
+      g_wheel->Dispose ();
+      g_wheel = 0;
+    }
+}
+
+Ptr<TimingWheelEvent>
+TimingWheel::Schedule (const Time &delay, const Ptr<EventImpl> &event)
+{
+  NS_LOG_FUNCTION (delay << event);
+  NS_ASSERT_MSG (!delay.IsStrictlyNegative (), "TimingWheel::Schedule(): Negative delay");
+  Ptr<TimingWheelEvent> ev = Create<TimingWheelEvent> (Simulator::Now () + delay, event);
+  GetWheel ()->Insert (ev);
+  return ev;
+}
+
+uint32_t
+TimingWheel::GetNEvents (void)
+{
+  return (g_wheel != 0 ? g_wheel->m_nEvents : 0);
+}
+
+uint64_t
+TimingWheel::GetGranule (const Time &t) const
+{
+  return t.GetTimeStep () / m_granuleSteps;
+}
+
+void
+TimingWheel::Insert (Ptr<TimingWheelEvent> event)
+{
+  NS_LOG_FUNCTION (this << event);
+
+  // No slot can start before the pending expiration, hence the current
+  // granule can be moved to the granule of the current time
+  m_current = GetGranule (Simulator::Now ());
+  event->m_seq = m_seq++;
+
+  uint64_t granule = Place (event);
+  if (granule == m_current)
+    {
+      Promote (event);
+    }
+  else
+    {
+      ScheduleExpire (granule);
+    }
+}
+
+uint64_t
+TimingWheel::Place (Ptr<TimingWheelEvent> event)
+{
+  NS_LOG_FUNCTION (this << event);
+
+  uint64_t granule = GetGranule (event->m_ts);
+  if (granule <= m_current)
+    {
+      return m_current;
+    }
+
+  uint32_t level = 0;
+  while (level < N_LEVELS
+         && (granule >> (SLOT_BITS * (level + 1))) != (m_current >> (SLOT_BITS * (level + 1))))
+    {
+      level++;
+    }
+
+  uint64_t start;
+  if (level < N_LEVELS)
+    {
+      uint32_t shift = SLOT_BITS * level;
+      event->m_slot = level * N_SLOTS + ((granule >> shift) & (N_SLOTS - 1));
+      start = (granule >> shift) << shift;
+    }
+  else
+    {
+      uint32_t shift = SLOT_BITS * N_LEVELS;
+      event->m_slot = OVERFLOW_SLOT;
+      start = ((m_current >> shift) + 1) << shift;
+    }
+
+  event->m_wheel = this;
+  event->m_pos = m_slots[event->m_slot].size ();
+  m_slots[event->m_slot].push_back (event);
+  m_nLevelEvents[level]++;
+  m_nEvents++;
+  return start;
+}
+
+void
+TimingWheel::Unlink (TimingWheelEvent *event)
+{
+  NS_LOG_FUNCTION (this << event);
+  NS_ASSERT (event->m_wheel == this);
+
+  std::vector<Ptr<TimingWheelEvent> > &slot = m_slots[event->m_slot];
+  NS_ASSERT (event->m_pos < slot.size () && PeekPointer (slot[event->m_pos]) == event);
+  if (event->m_pos != slot.size () - 1)
+    {
+      slot[event->m_pos] = slot.back ();
+      slot[event->m_pos]->m_pos = event->m_pos;
+    }
+  event->m_wheel = 0;
+  m_nLevelEvents[event->m_slot / N_SLOTS]--;
+  m_nEvents--;
+  slot.pop_back ();
+}
+
+void
+TimingWheel::Promote (Ptr<TimingWheelEvent> event)
+{
+  NS_LOG_FUNCTION (this << event);
+  event->m_wheel = 0;
+  Simulator::ScheduleWithContext (event->m_context, event->m_ts - Simulator::Now (),
+                                  GetPointer (event));
+}
+
+void
+TimingWheel::Expire (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  m_expireEvent = 0;
+  m_current = GetGranule (Simulator::Now ());
+
+  // Move the events of the slots starting at the current granule to the
+  // lower levels, from the top-most level, and collect the due events
+  std::vector<Ptr<TimingWheelEvent> > due;
+  for (uint32_t level = N_LEVELS + 1; level-- > 0; )
+    {
+      uint32_t shift = SLOT_BITS * level;
+      if (m_nLevelEvents[level] == 0 || (m_current & ((uint64_t (1) << shift) - 1)) != 0)
+        {
+          continue;
+        }
+      uint32_t index = (level == N_LEVELS ? OVERFLOW_SLOT
+                        : level * N_SLOTS + ((m_current >> shift) & (N_SLOTS - 1)));
+      std::vector<Ptr<TimingWheelEvent> > events;
+      events.swap (m_slots[index]);
+      m_nLevelEvents[level] -= events.size ();
+      m_nEvents -= events.size ();
+      for (std::vector<Ptr<TimingWheelEvent> >::iterator it = events.begin (); it != events.end (); it++)
+        {
+          (*it)->m_wheel = 0;
+          if (Place (*it) == m_current)
+            {
+              due.push_back (*it);
+            }
+        }
+    }
+
+  // Promote the due events in the order the simulator would have run them
+  std::sort (due.begin (), due.end (),
+             [] (const Ptr<TimingWheelEvent> &a, const Ptr<TimingWheelEvent> &b)
+             {
+               return a->m_ts < b->m_ts || (a->m_ts == b->m_ts && a->m_seq < b->m_seq);
+             });
+  for (std::vector<Ptr<TimingWheelEvent> >::iterator it = due.begin (); it != due.end (); it++)
+    {
+      Promote (*it);
+    }
+
+  if (m_nEvents > 0)
+    {
+      ScheduleExpire (GetNextGranule ());
+    }
+}
+
+uint64_t
+TimingWheel::GetNextGranule (void) const
+{
+  NS_LOG_FUNCTION (this);
+
+  for (uint32_t level = 0; level < N_LEVELS; level++)
+    {
+      if (m_nLevelEvents[level] == 0)
+        {
+          continue;
+        }
+      uint32_t shift = SLOT_BITS * level;
+      for (uint32_t i = ((m_current >> shift) & (N_SLOTS - 1)) + 1; i < N_SLOTS; i++)
+        {
+          if (!m_slots[level * N_SLOTS + i].empty ())
+            {
+              return (((m_current >> (shift + SLOT_BITS)) << SLOT_BITS) + i) << shift;
+            }
+        }
+      NS_ASSERT_MSG (false, "No slot found for the events of level " << level);
+    }
+  NS_ASSERT (m_nLevelEvents[N_LEVELS] > 0);
+  uint32_t shift = SLOT_BITS * N_LEVELS;
+  return ((m_current >> shift) + 1) << shift;
+}
+
+void
+TimingWheel::ScheduleExpire (uint64_t granule)
+{
+  NS_LOG_FUNCTION (this << granule);
+
+  if (m_expireEvent != 0)
+    {
+      if (m_expireGranule <= granule)
+        {
+          return;
+        }
+      m_expireEvent->Cancel ();
+    }
+  m_expireGranule = granule;
+  m_expireEvent = Ptr<EventImpl> (MakeEvent (&TimingWheel::Expire, this), false);
+  Simulator::ScheduleWithContext (Simulator::NO_CONTEXT,
+                                  TimeStep (granule * m_granuleSteps) - Simulator::Now (),
+                                  GetPointer (m_expireEvent));
+}
+
+} // namespace ns3
@@ -0,0 +1,222 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TIMING_WHEEL_H
+#define TIMING_WHEEL_H
+
+#include "object.h"
+#include "nstime.h"
+#include "event-impl.h"
+#include "ptr.h"
+#include <vector>
+
+/**
+ * \file
+ * \ingroup timer
+ * ns3::TimingWheel and ns3::TimingWheelEvent declarations.
+ */
+
+namespace ns3 {
+
+class TimingWheel;
+
+/**
+ * \ingroup timer
+ * \brief An event held by the TimingWheel
+ *
+ * The event stays in the timing wheel until the granule of its expiration
+ * time starts, then it is scheduled in the simulator event list to expire
+ * at its exact expiration time. Cancelling an event still held by the wheel
+ * just unlinks it from the wheel, hence the simulator never sees the events
+ * which are cancelled long before they expire.
+ */
+class TimingWheelEvent : public EventImpl
+{
+public:
+  /**
+   * \param [in] ts the expiration time
+   * \param [in] event the event to invoke at expiration
+   */
+  TimingWheelEvent (const Time &ts, const Ptr<EventImpl> &event);
+  virtual ~TimingWheelEvent ();
+
+  /**
+   * \returns the expiration time of the event
+   */
+  Time GetTs (void) const;
+  /**
+   * \returns \c true if the event has neither expired nor been cancelled
+   */
+  bool IsRunning (void);
+  /**
+   * \returns \c true if the event has expired or has been cancelled
+   */
+  bool IsExpired (void);
+  /**
+   * Cancel the event. If the event is still held by the timing wheel, it
+   * is removed from the wheel. Otherwise, it is cancelled in the simulator
+   * event list, as by Simulator::Cancel.
+   */
+  void Cancel (void);
+
+protected:
+  virtual void Notify (void);
+
+private:
+  friend class TimingWheel;
+
+  Time m_ts;                //!< the expiration time
+  Ptr<EventImpl> m_event;   //!< the event to invoke, null once expired or cancelled
+  uint32_t m_context;       //!< the context the event was scheduled from
+  uint64_t m_seq;           //!< the insertion sequence number, to order ties
+  TimingWheel *m_wheel;     //!< the wheel holding the event, if any
+  uint32_t m_slot;          //!< the slot of the wheel holding the event
+  uint32_t m_pos;           //!< the position of the event in its slot
+};
+
+/**
+ * \ingroup timer
+ * \brief A hierarchical timing wheel holding coarse timers out of the
+ * simulator event list
+ *
+ * Protocol timers (retransmission, delayed ACK, cache timeouts, ...) are
+ * mostly cancelled or rescheduled before they expire. When such timers
+ * are scheduled as simulator events, each cancellation leaves an event in
+ * the event list until its expiration time, and the event list is then
+ * dominated by cancelled events.
+ *
+ * The timing wheel divides the time in granules (see the Granularity
+ * attribute) and holds the events in four levels of 64 slots, the slots of
+ * a level spanning 64 times as many granules as the slots of the level
+ * below, plus an overflow slot for the events beyond the span of the top
+ * level. Scheduling and cancelling an event take a constant time. A single
+ * simulator event is scheduled at the start of the next non-empty slot:
+ * when it expires, the events of the top-most due slot are moved to lower
+ * levels and the events whose granule has started are promoted to the
+ * simulator event list, where they expire at their exact expiration time
+ * and in the context they were scheduled from.
+ *
+ * Events less than a granule away are promoted as soon as they are
+ * scheduled. A promoted event expires after the events scheduled for the
+ * same time before its promotion.
+ *
+ * A wheel is created for each simulation the first time an event is
+ * scheduled and destroyed by Simulator::Destroy. Timer objects use it
+ * when Timer::SetTimingWheel has been called.
+ */
+class TimingWheel : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  TimingWheel ();
+  virtual ~TimingWheel ();
+
+  /**
+   * Schedule an event in the timing wheel of the current simulation.
+   *
+   * \param [in] delay the delay before the event expires
+   * \param [in] event the event to invoke at expiration
+   * \returns the event held by the timing wheel
+   */
+  static Ptr<TimingWheelEvent> Schedule (const Time &delay, const Ptr<EventImpl> &event);
+
+  /**
+   * \returns the number of events held by the timing wheel of the current
+   * simulation, not including the events promoted to the simulator
+   */
+  static uint32_t GetNEvents (void);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  friend class TimingWheelEvent;
+
+  /**
+   * \returns the timing wheel of the current simulation, creating it if needed
+   */
+  static Ptr<TimingWheel> GetWheel (void);
+  /**
+   * Destroy the timing wheel of the current simulation.
+   */
+  static void DestroyWheel (void);
+
+  /**
+   * Insert an event in the wheel.
+   * \param [in] event the event
+   */
+  void Insert (Ptr<TimingWheelEvent> event);
+  /**
+   * Place an event in the slot matching its expiration granule, relative
+   * to the current granule, unless the event is due.
+   * \param [in] event the event
+   * \returns the granule at which the slot of the event starts, or the
+   * current granule if the event is due
+   */
+  uint64_t Place (Ptr<TimingWheelEvent> event);
+  /**
+   * Remove an event from its slot.
+   * \param [in] event the event
+   */
+  void Unlink (TimingWheelEvent *event);
+  /**
+   * Schedule a due event in the simulator event list.
+   * \param [in] event the event
+   */
+  void Promote (Ptr<TimingWheelEvent> event);
+  /**
+   * Process the slots starting at the current granule.
+   */
+  void Expire (void);
+  /**
+   * \returns the granule at which the next non-empty slot starts
+   */
+  uint64_t GetNextGranule (void) const;
+  /**
+   * Make sure the wheel expires at the given granule, or earlier.
+   * \param [in] granule the granule
+   */
+  void ScheduleExpire (uint64_t granule);
+  /**
+   * \param [in] t a time
+   * \returns the granule of the given time
+   */
+  uint64_t GetGranule (const Time &t) const;
+
+  static const uint32_t SLOT_BITS = 6;                  //!< log2 of the number of slots per level
+  static const uint32_t N_SLOTS = 1 << SLOT_BITS;       //!< number of slots per level
+  static const uint32_t N_LEVELS = 4;                   //!< number of levels
+  static const uint32_t OVERFLOW_SLOT = N_LEVELS * N_SLOTS;  //!< index of the overflow slot
+
+  Time m_granularity;                //!< the duration of a granule
+  int64_t m_granuleSteps;            //!< the duration of a granule, in time steps
+  uint64_t m_current;                //!< the current granule
+  uint64_t m_seq;                    //!< next insertion sequence number
+  uint32_t m_nEvents;                //!< number of events held by the wheel
+  uint32_t m_nLevelEvents[N_LEVELS + 1];  //!< number of events held by each level, and in overflow
+  std::vector<std::vector<Ptr<TimingWheelEvent> > > m_slots;  //!< the slots of all the levels
+  Ptr<EventImpl> m_expireEvent;      //!< the pending expiration of the wheel
+  uint64_t m_expireGranule;          //!< the granule of the pending expiration
+};
+
+} // namespace ns3
+
+#endif /* TIMING_WHEEL_H */
@@ -0,0 +1,178 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/boolean.h"
+#include "ns3/double.h"
+#include "ns3/object-factory.h"
+#include "ns3/random-variable-stream.h"
+#include <vector>
+
+/**
+ * \file
+ * \ingroup core-tests
+ * \ingroup randomvariable
+ * \ingroup randomvariable-tests
+ * Test that the batched RandomVariableStream::GetValues() matches GetValue().
+ */
+
+namespace ns3 {
+
+  namespace tests {
+
+
+/**
+ * \ingroup randomvariable-tests
+ * Test case comparing GetValues() against repeated GetValue() calls.
+ *
+ * Two streams of the same type are created with the same stream number;
+ * one is sampled with GetValue(), the other with GetValues() in blocks of
+ * varying size.  The sequences must be bit-identical, including after the
+ * blocks, which checks that GetValues() leaves the RngStream in the same
+ * state.
+ */
+class RandomVariableStreamValuesTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor.
+   * \param [in] typeId The name of the RandomVariableStream subclass.
+   * \param [in] stream The stream number shared by both streams.
+   * \param [in] antithetic Whether both streams generate antithetic values.
+   */
+  RandomVariableStreamValuesTestCase (std::string typeId, int64_t stream, bool antithetic);
+  /** Destructor. */
+  virtual ~RandomVariableStreamValuesTestCase ();
+
+  /**
+   * Set an attribute on both streams.
+   * \param [in] name The attribute name.
+   * \param [in] value The attribute value.
+   * \returns This test case.
+   */
+  RandomVariableStreamValuesTestCase * Set (std::string name, double value);
+
+private:
+  virtual void DoRun (void);
+
+  /** The factory for both streams. */
+  ObjectFactory m_factory;
+  /** The stream number shared by both streams. */
+  int64_t m_stream;
+};
+
+RandomVariableStreamValuesTestCase::RandomVariableStreamValuesTestCase (std::string typeId,
+                                                                        int64_t stream,
+                                                                        bool antithetic)
+  : TestCase (typeId + (antithetic ? " antithetic" : "") + " GetValues()"),
+    m_stream (stream)
+{
+  m_factory.SetTypeId (typeId);
+  m_factory.Set ("Antithetic", BooleanValue (antithetic));
+}
+
+RandomVariableStreamValuesTestCase::~RandomVariableStreamValuesTestCase ()
+{
+}
+
+RandomVariableStreamValuesTestCase *
+RandomVariableStreamValuesTestCase::Set (std::string name, double value)
+{
+  m_factory.Set (name, DoubleValue (value));
+  return this;
+}
+
+void
+RandomVariableStreamValuesTestCase::DoRun (void)
+{
+  static const std::size_t blocks[] = { 1, 7, 0, 64, 65, 1000, 3 };
+
+  Ptr<RandomVariableStream> scalar = m_factory.Create<RandomVariableStream> ();
+  Ptr<RandomVariableStream> batched = m_factory.Create<RandomVariableStream> ();
+  scalar->SetStream (m_stream);
+  batched->SetStream (m_stream);
+
+  for (std::size_t b = 0; b < sizeof (blocks) / sizeof (blocks[0]); ++b)
+    {
+      std::vector<double> values (blocks[b] + 1);
+      batched->GetValues (&values[0], blocks[b]);
+      for (std::size_t i = 0; i < blocks[b]; ++i)
+        {
+          NS_TEST_ASSERT_MSG_EQ (values[i], scalar->GetValue (),
+                                 "GetValues() differs from GetValue() at index "
+                                 << i << " of block " << b);
+        }
+    }
+  NS_TEST_ASSERT_MSG_EQ (batched->GetValue (), scalar->GetValue (),
+                         "GetValues() left the stream in a different state");
+}
+
+/**
+ * \ingroup randomvariable-tests
+ * Test suite for the batched RandomVariableStream::GetValues() API.
+ */
+class RandomVariableStreamValuesTestSuite : public TestSuite
+{
+public:
+  /** Constructor. */
+  RandomVariableStreamValuesTestSuite ();
+
+private:
+  /**
+   * Add a test case comparing two streams.
+   * \param [in] typeId The name of the RandomVariableStream subclass.
+   * \param [in] stream The stream number shared by both streams.
+   * \param [in] antithetic Whether both streams generate antithetic values.
+   * \returns The test case, for further attribute configuration.
+   */
+  RandomVariableStreamValuesTestCase * Add (std::string typeId, int64_t stream, bool antithetic);
+};
+
+RandomVariableStreamValuesTestCase *
+RandomVariableStreamValuesTestSuite::Add (std::string typeId, int64_t stream, bool antithetic)
+{
+  RandomVariableStreamValuesTestCase *tc = new RandomVariableStreamValuesTestCase (typeId, stream, antithetic);
+  AddTestCase (tc, TestCase::QUICK);
+  return tc;
+}
+
+RandomVariableStreamValuesTestSuite::RandomVariableStreamValuesTestSuite ()
+  : TestSuite ("random-variable-stream-values", UNIT)
+{
+  Add ("ns3::UniformRandomVariable", 1, false)->Set ("Min", -2.0)->Set ("Max", 5.0);
+  Add ("ns3::UniformRandomVariable", 2, true)->Set ("Min", -2.0)->Set ("Max", 5.0);
+  Add ("ns3::ExponentialRandomVariable", 3, false);
+  Add ("ns3::ExponentialRandomVariable", 4, true)->Set ("Bound", 1.5);
+  Add ("ns3::ParetoRandomVariable", 5, false)->Set ("Bound", 3.0);
+  Add ("ns3::WeibullRandomVariable", 6, false)->Set ("Shape", 0.814944)->Set ("Bound", 2.0);
+  Add ("ns3::WeibullRandomVariable", 7, true);
+  Add ("ns3::LogNormalRandomVariable", 8, false);
+  Add ("ns3::LogNormalRandomVariable", 9, true);
+  // Uses the default GetValues() implementation.
+  Add ("ns3::NormalRandomVariable", 10, false);
+}
+
+/**
+ * \ingroup randomvariable-tests
+ * RandomVariableStreamValuesTestSuite instance variable.
+ */
+static RandomVariableStreamValuesTestSuite g_randomVariableStreamValuesTestSuite;
+
+
+  }  // namespace tests
+
+}  // namespace ns3
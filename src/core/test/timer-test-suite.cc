@@ -18,9 +18,11 @@
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
 #include "ns3/timer.h"
+#include "ns3/timing-wheel.h"
 #include "ns3/test.h"
 #include "ns3/simulator.h"
 #include "ns3/nstime.h"
+#include <vector>
 
 namespace {
 void bari (int)
@@ -208,6 +210,105 @@ TimerTemplateTestCase::DoTeardown (void)
   Simulator::Destroy ();
 }
 
+class TimerWheelTestCase : public TestCase
+{
+public:
+  TimerWheelTestCase ();
+  virtual void DoRun (void);
+  void Expire (uint32_t i);
+  void Rearm (void);
+  void RearmExpire (void);
+
+  std::vector<Time> m_expired;
+  Timer m_rearmTimer;
+  uint32_t m_nRearmExpired;
+};
+
+TimerWheelTestCase::TimerWheelTestCase ()
+  : TestCase ("Check the timers held by the timing wheel"),
+    m_rearmTimer (Timer::CANCEL_ON_DESTROY),
+    m_nRearmExpired (0)
+{
+}
+
+void
+TimerWheelTestCase::Expire (uint32_t i)
+{
+  m_expired[i] = Simulator::Now ();
+}
+
+void
+TimerWheelTestCase::Rearm (void)
+{
+  m_rearmTimer.Cancel ();
+  m_rearmTimer.Schedule (MilliSeconds (200));
+}
+
+void
+TimerWheelTestCase::RearmExpire (void)
+{
+  m_nRearmExpired++;
+  NS_TEST_EXPECT_MSG_EQ (Simulator::Now (), MilliSeconds (1199), "unexpected expiration time");
+  NS_TEST_EXPECT_MSG_EQ (m_rearmTimer.IsExpired (), true, "the timer must be expired while expiring");
+}
+
+void
+TimerWheelTestCase::DoRun (void)
+{
+  Timer timer = Timer (Timer::CANCEL_ON_DESTROY);
+
+  timer.SetTimingWheel (true);
+  timer.SetFunction (&bari);
+  timer.SetArguments (1);
+  timer.Schedule (Seconds (10.0));
+  NS_TEST_ASSERT_MSG_EQ (timer.GetState (), Timer::RUNNING, "");
+  NS_TEST_ASSERT_MSG_EQ (timer.GetDelayLeft (), Seconds (10.0), "");
+  NS_TEST_ASSERT_MSG_EQ (TimingWheel::GetNEvents (), 1, "the timer must be held by the wheel");
+  timer.Suspend ();
+  NS_TEST_ASSERT_MSG_EQ (timer.GetState (), Timer::SUSPENDED, "");
+  NS_TEST_ASSERT_MSG_EQ (TimingWheel::GetNEvents (), 0, "the timer must have left the wheel");
+  timer.Resume ();
+  NS_TEST_ASSERT_MSG_EQ (timer.GetState (), Timer::RUNNING, "");
+  NS_TEST_ASSERT_MSG_EQ (timer.GetDelayLeft (), Seconds (10.0), "");
+  timer.Cancel ();
+  NS_TEST_ASSERT_MSG_EQ (timer.GetState (), Timer::EXPIRED, "");
+  NS_TEST_ASSERT_MSG_EQ (TimingWheel::GetNEvents (), 0, "the timer must have left the wheel");
+
+  // timers expire at their exact time, from all the levels of the wheel
+  Time delays[] = { Seconds (0), MicroSeconds (300), MilliSeconds (1), MicroSeconds (63999),
+                    MilliSeconds (64), MicroSeconds (65500), Seconds (4.1), Seconds (300.5),
+                    Hours (5), Hours (10) + NanoSeconds (7) };
+  const uint32_t n = sizeof (delays) / sizeof (delays[0]);
+  Timer timers[n];
+  m_expired.assign (n, Seconds (-1));
+  for (uint32_t i = 0; i < n; i++)
+    {
+      timers[i].SetTimingWheel (true);
+      timers[i].SetFunction (&TimerWheelTestCase::Expire, this);
+      timers[i].SetArguments (i);
+      timers[i].Schedule (delays[i]);
+    }
+
+  // a timer rearmed every millisecond only expires once
+  m_rearmTimer.SetTimingWheel (true);
+  m_rearmTimer.SetFunction (&TimerWheelTestCase::RearmExpire, this);
+  for (uint32_t i = 0; i < 1000; i++)
+    {
+      Simulator::Schedule (MilliSeconds (i), &TimerWheelTestCase::Rearm, this);
+    }
+
+  Simulator::Run ();
+
+  for (uint32_t i = 0; i < n; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_expired[i], delays[i], "timer " << i << " expired at the wrong time");
+    }
+  NS_TEST_EXPECT_MSG_EQ (m_nRearmExpired, 1, "the rearmed timer must expire once");
+  NS_TEST_EXPECT_MSG_EQ (TimingWheel::GetNEvents (), 0, "the wheel must be empty");
+
+  Simulator::Destroy ();
+}
+
 static class TimerTestSuite : public TestSuite
 {
 public:
@@ -216,5 +317,6 @@ public:
   {
     AddTestCase (new TimerStateTestCase (), TestCase::QUICK);
     AddTestCase (new TimerTemplateTestCase (), TestCase::QUICK);
+    AddTestCase (new TimerWheelTestCase (), TestCase::QUICK);
   }
 } g_timerTestSuite;
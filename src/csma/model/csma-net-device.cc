@@ -220,6 +220,7 @@ CsmaNetDevice::DoDispose ()
   m_node = 0;
   m_queue = 0;
   m_queueInterface = 0;
+  m_readyCallback = MakeNullCallback<void, Ptr<NetDevice> > ();
   NetDevice::DoDispose ();
 }
 
@@ -597,6 +598,10 @@ CsmaNetDevice::TransmitAbort (void)
   //
   if (m_queue->IsEmpty ())
     {
+      if (!m_readyCallback.IsNull ())
+        {
+          m_readyCallback (this);
+        }
       return;
     }
   else
@@ -666,6 +671,10 @@ CsmaNetDevice::TransmitReadyEvent (void)
   //
   if (m_queue->IsEmpty ())
     {
+      if (!m_readyCallback.IsNull ())
+        {
+          m_readyCallback (this);
+        }
       return;
     }
   else
@@ -1084,6 +1093,31 @@ CsmaNetDevice::SupportsSendFrom () const
   return true;
 }
 
+bool
+CsmaNetDevice::SupportsReadyCallback (void) const
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  return true;
+}
+
+void
+CsmaNetDevice::SetReadyCallback (NetDevice::ReadyCallback cb)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  m_readyCallback = cb;
+}
+
+uint32_t
+CsmaNetDevice::GetTxBudget (void) const
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  if (m_txMachineState == READY && m_queue->IsEmpty () && IsLinkUp ())
+    {
+      return GetMtu ();
+    }
+  return 0;
+}
+
 int64_t
 CsmaNetDevice::AssignStreams (int64_t stream)
 {
@@ -328,6 +328,22 @@ public:
   virtual void SetPromiscReceiveCallback (PromiscReceiveCallback cb);
   virtual bool SupportsSendFrom (void) const;
 
+  /**
+   * \return true: the device notifies when it is ready to send.
+   */
+  virtual bool SupportsReadyCallback (void) const;
+
+  /**
+   * \param cb callback to invoke whenever the transmitter becomes idle, after
+   *        the interframe gap, with no packet waiting in the queue.
+   */
+  virtual void SetReadyCallback (NetDevice::ReadyCallback cb);
+
+  /**
+   * \return the MTU if the transmitter is idle and the queue empty, zero otherwise.
+   */
+  virtual uint32_t GetTxBudget (void) const;
+
  /**
   * Assign a fixed random variable stream number to the random variables
   * used by this model.  Return the number of streams (possibly zero) that
@@ -707,6 +723,11 @@ private:
    */
   NetDevice::PromiscReceiveCallback m_promiscRxCallback;
 
+  /**
+   * The callback used to notify higher layers that the device is ready to send.
+   */
+  NetDevice::ReadyCallback m_readyCallback;
+
   /**
    * The interface index (really net evice index) that has been assigned to 
    * this network device.
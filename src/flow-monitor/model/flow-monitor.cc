@@ -22,6 +22,7 @@
 #include "ns3/simulator.h"
 #include "ns3/log.h"
 #include "ns3/double.h"
+#include "ns3/uinteger.h"
 #include <fstream>
 #include <sstream>
 
@@ -45,6 +46,25 @@ FlowMonitor::GetTypeId (void)
                    TimeValue (Seconds (10.0)),
                    MakeTimeAccessor (&FlowMonitor::m_maxPerHopDelay),
                    MakeTimeChecker ())
+    .AddAttribute ("PacketSampling", ("Track only one packet in PacketSampling of each flow.  "
+                                      "All the packets are counted, but the delay, jitter, "
+                                      "forwarding and loss statistics are estimated from the "
+                                      "tracked packets, scaled by PacketSampling.  The probes "
+                                      "only count the tracked packets, except for the drops."),
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&FlowMonitor::m_packetSampling),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("ExportInterval", ("The interval between the exports of the flow statistics, "
+                                       "once enabled by EnableExport."),
+                   TimeValue (Seconds (1.0)),
+                   MakeTimeAccessor (&FlowMonitor::m_exportInterval),
+                   MakeTimeChecker ())
+    .AddAttribute ("FlowIdleTimeout", ("The time after which a flow without activity is exported "
+                                       "one last time and removed from the statistics, "
+                                       "once the export is enabled.  Zero disables the eviction."),
+                   TimeValue (Seconds (0.0)),
+                   MakeTimeAccessor (&FlowMonitor::m_flowIdleTimeout),
+                   MakeTimeChecker ())
     .AddAttribute ("StartTime", ("The time when the monitoring starts."),
                    TimeValue (Seconds (0.0)),
                    MakeTimeAccessor (&FlowMonitor::Start),
@@ -80,7 +100,8 @@ FlowMonitor::GetInstanceTypeId (void) const
 }
 
 FlowMonitor::FlowMonitor ()
-  : m_enabled (false)
+  : m_packetSampling (1),
+    m_enabled (false)
 {
   // m_histogramBinWidth=DEFAULT_BIN_WIDTH;
 }
@@ -99,6 +120,8 @@ FlowMonitor::DoDispose (void)
       m_flowProbes[i]->Dispose ();
       m_flowProbes[i] = 0;
     }
+  m_exportEvent.Cancel ();
+  m_exportStream = 0;
   Object::DoDispose ();
 }
 
@@ -140,14 +163,29 @@ FlowMonitor::ReportFirstTx (Ptr<FlowProbe> probe, uint32_t flowId, uint32_t pack
       return;
     }
   Time now = Simulator::Now ();
-  TrackedPacket &tracked = m_trackedPackets[std::make_pair (flowId, packetId)];
-  tracked.firstSeenTime = now;
-  tracked.lastSeenTime = tracked.firstSeenTime;
-  tracked.timesForwarded = 0;
-  NS_LOG_DEBUG ("ReportFirstTx: adding tracked packet (flowId=" << flowId << ", packetId=" << packetId
-                                                                << ").");
+  if (IsTracked (packetId))
+    {
+      TrackedPacketKey key (flowId, packetId);
+      std::pair<TrackedPacketMap::iterator, bool> insert
+        = m_trackedPackets.insert (std::make_pair (key, TrackedPacket ()));
+      TrackedPacket &tracked = insert.first->second;
+      if (insert.second)
+        {
+          tracked.lastSeenNode = m_lastSeenPackets.insert (m_lastSeenPackets.end (), key);
+          m_packetsInFlight[flowId]++;
+        }
+      else
+        {
+          m_lastSeenPackets.splice (m_lastSeenPackets.end (), m_lastSeenPackets, tracked.lastSeenNode);
+        }
+      tracked.firstSeenTime = now;
+      tracked.lastSeenTime = tracked.firstSeenTime;
+      tracked.timesForwarded = 0;
+      NS_LOG_DEBUG ("ReportFirstTx: adding tracked packet (flowId=" << flowId << ", packetId=" << packetId
+                                                                    << ").");
 
-  probe->AddPacketStats (flowId, packetSize, Seconds (0));
+      probe->AddPacketStats (flowId, packetSize, Seconds (0));
+    }
 
   FlowStats &stats = GetStatsForFlow (flowId);
   stats.txBytes += packetSize;
@@ -167,8 +205,11 @@ FlowMonitor::ReportForwarding (Ptr<FlowProbe> probe, uint32_t flowId, uint32_t p
     {
       return;
     }
-  std::pair<FlowId, FlowPacketId> key (flowId, packetId);
-  TrackedPacketMap::iterator tracked = m_trackedPackets.find (key);
+  if (!IsTracked (packetId))
+    {
+      return;
+    }
+  TrackedPacketMap::iterator tracked = m_trackedPackets.find (TrackedPacketKey (flowId, packetId));
   if (tracked == m_trackedPackets.end ())
     {
       NS_LOG_WARN ("Received packet forward report (flowId=" << flowId << ", packetId=" << packetId
@@ -178,6 +219,7 @@ FlowMonitor::ReportForwarding (Ptr<FlowProbe> probe, uint32_t flowId, uint32_t p
 
   tracked->second.timesForwarded++;
   tracked->second.lastSeenTime = Simulator::Now ();
+  m_lastSeenPackets.splice (m_lastSeenPackets.end (), m_lastSeenPackets, tracked->second.lastSeenNode);
 
   Time delay = (Simulator::Now () - tracked->second.firstSeenTime);
   probe->AddPacketStats (flowId, packetSize, delay);
@@ -191,36 +233,51 @@ FlowMonitor::ReportLastRx (Ptr<FlowProbe> probe, uint32_t flowId, uint32_t packe
     {
       return;
     }
-  TrackedPacketMap::iterator tracked = m_trackedPackets.find (std::make_pair (flowId, packetId));
-  if (tracked == m_trackedPackets.end ())
+  TrackedPacketMap::iterator tracked = m_trackedPackets.end ();
+  if (IsTracked (packetId))
     {
-      NS_LOG_WARN ("Received packet last-tx report (flowId=" << flowId << ", packetId=" << packetId
-                                                             << ") but not known to be transmitted.");
-      return;
+      tracked = m_trackedPackets.find (TrackedPacketKey (flowId, packetId));
+      if (tracked == m_trackedPackets.end ())
+        {
+          NS_LOG_WARN ("Received packet last-tx report (flowId=" << flowId << ", packetId=" << packetId
+                                                                 << ") but not known to be transmitted.");
+          return;
+        }
     }
 
   Time now = Simulator::Now ();
-  Time delay = (now - tracked->second.firstSeenTime);
-  probe->AddPacketStats (flowId, packetSize, delay);
-
   FlowStats &stats = GetStatsForFlow (flowId);
-  stats.delaySum += delay;
-  stats.delayHistogram.AddValue (delay.GetSeconds ());
-  if (stats.rxPackets > 0 )
+  if (tracked != m_trackedPackets.end ())
     {
-      Time jitter = stats.lastDelay - delay;
-      if (jitter > Seconds (0))
-        {
-          stats.jitterSum += jitter;
-          stats.jitterHistogram.AddValue (jitter.GetSeconds ());
-        }
-      else 
+      Time delay = (now - tracked->second.firstSeenTime);
+      probe->AddPacketStats (flowId, packetSize, delay);
+
+      // the jitter is measured between consecutive tracked packets
+      bool hasLastDelay = (stats.delayHistogram.GetNBins () > 0);
+      stats.delaySum += delay * static_cast<int64_t> (m_packetSampling);
+      stats.delayHistogram.AddValue (delay.GetSeconds ());
+      if (hasLastDelay)
         {
-          stats.jitterSum -= jitter;
-          stats.jitterHistogram.AddValue (-jitter.GetSeconds ());
+          Time jitter = stats.lastDelay - delay;
+          if (jitter > Seconds (0))
+            {
+              stats.jitterSum += jitter * static_cast<int64_t> (m_packetSampling);
+              stats.jitterHistogram.AddValue (jitter.GetSeconds ());
+            }
+          else
+            {
+              stats.jitterSum -= jitter * static_cast<int64_t> (m_packetSampling);
+              stats.jitterHistogram.AddValue (-jitter.GetSeconds ());
+            }
         }
+      stats.lastDelay = delay;
+      stats.timesForwarded += tracked->second.timesForwarded * m_packetSampling;
+
+      NS_LOG_DEBUG ("ReportLastTx: removing tracked packet (flowId="
+                    << flowId << ", packetId=" << packetId << ").");
+
+      UntrackPacket (tracked); // we don't need to track this packet anymore
     }
-  stats.lastDelay = delay;
 
   stats.rxBytes += packetSize;
   stats.packetSizeHistogram.AddValue ((double) packetSize);
@@ -239,12 +296,6 @@ FlowMonitor::ReportLastRx (Ptr<FlowProbe> probe, uint32_t flowId, uint32_t packe
         }
     }
   stats.timeLastRxPacket = now;
-  stats.timesForwarded += tracked->second.timesForwarded;
-
-  NS_LOG_DEBUG ("ReportLastTx: removing tracked packet (flowId="
-                << flowId << ", packetId=" << packetId << ").");
-
-  m_trackedPackets.erase (tracked); // we don't need to track this packet anymore
 }
 
 void
@@ -269,14 +320,18 @@ FlowMonitor::ReportDrop (Ptr<FlowProbe> probe, uint32_t flowId, uint32_t packetI
   stats.bytesDropped[reasonCode] += packetSize;
   NS_LOG_DEBUG ("++stats.packetsDropped[" << reasonCode<< "]; // becomes: " << stats.packetsDropped[reasonCode]);
 
-  TrackedPacketMap::iterator tracked = m_trackedPackets.find (std::make_pair (flowId, packetId));
+  if (!IsTracked (packetId))
+    {
+      return;
+    }
+  TrackedPacketMap::iterator tracked = m_trackedPackets.find (TrackedPacketKey (flowId, packetId));
   if (tracked != m_trackedPackets.end ())
     {
       // we don't need to track this packet anymore
       // FIXME: this will not necessarily be true with broadcast/multicast
       NS_LOG_DEBUG ("ReportDrop: removing tracked packet (flowId="
                     << flowId << ", packetId=" << packetId << ").");
-      m_trackedPackets.erase (tracked);
+      UntrackPacket (tracked);
     }
 }
 
@@ -287,28 +342,48 @@ FlowMonitor::GetFlowStats () const
 }
 
 
+inline bool
+FlowMonitor::IsTracked (FlowPacketId packetId) const
+{
+  return m_packetSampling == 1 || packetId % m_packetSampling == 0;
+}
+
+void
+FlowMonitor::UntrackPacket (TrackedPacketMap::iterator tracked)
+{
+  std::unordered_map<FlowId, uint32_t>::iterator inFlight = m_packetsInFlight.find (tracked->first.first);
+  NS_ASSERT (inFlight != m_packetsInFlight.end ());
+  if (--inFlight->second == 0)
+    {
+      m_packetsInFlight.erase (inFlight);
+    }
+  m_lastSeenPackets.erase (tracked->second.lastSeenNode);
+  m_trackedPackets.erase (tracked);
+}
+
 void
 FlowMonitor::CheckForLostPackets (Time maxDelay)
 {
   Time now = Simulator::Now ();
 
-  for (TrackedPacketMap::iterator iter = m_trackedPackets.begin ();
-       iter != m_trackedPackets.end (); )
+  // the packets are sorted by the time they were last seen, so only
+  // the packets considered lost are visited
+  while (!m_lastSeenPackets.empty ())
     {
-      if (now - iter->second.lastSeenTime >= maxDelay)
-        {
-          // packet is considered lost, add it to the loss statistics
-          FlowStatsContainerI flow = m_flowStats.find (iter->first.first);
-          NS_ASSERT (flow != m_flowStats.end ());
-          flow->second.lostPackets++;
-
-          // we won't track it anymore
-          m_trackedPackets.erase (iter++);
-        }
-      else
+      TrackedPacketMap::iterator iter = m_trackedPackets.find (m_lastSeenPackets.front ());
+      NS_ASSERT (iter != m_trackedPackets.end ());
+      if (now - iter->second.lastSeenTime < maxDelay)
         {
-          iter++;
+          break;
         }
+
+      // packet is considered lost, add it to the loss statistics
+      FlowStatsContainerI flow = m_flowStats.find (iter->first.first);
+      NS_ASSERT (flow != m_flowStats.end ());
+      flow->second.lostPackets += m_packetSampling;
+
+      // we won't track it anymore
+      UntrackPacket (iter);
     }
 }
 
@@ -391,6 +466,74 @@ FlowMonitor::StopRightNow ()
   CheckForLostPackets ();
 }
 
+void
+FlowMonitor::EnableExport (Ptr<OutputStreamWrapper> stream)
+{
+  NS_ASSERT (m_exportInterval.IsStrictlyPositive ());
+  m_exportStream = stream;
+  *m_exportStream->GetStream () << "time,flowId,final,timeFirstTxPacket,timeLastTxPacket,"
+                                << "timeFirstRxPacket,timeLastRxPacket,txBytes,rxBytes,"
+                                << "txPackets,rxPackets,lostPackets,timesForwarded,"
+                                << "delaySum,jitterSum\n";
+  m_exportEvent.Cancel ();
+  m_exportEvent = Simulator::Schedule (m_exportInterval, &FlowMonitor::PeriodicExport, this);
+}
+
+void
+FlowMonitor::PeriodicExport ()
+{
+  ExportRightNow ();
+  m_exportEvent = Simulator::Schedule (m_exportInterval, &FlowMonitor::PeriodicExport, this);
+}
+
+void
+FlowMonitor::ExportFlow (FlowId flowId, const FlowStats &stats, bool final)
+{
+  *m_exportStream->GetStream ()
+    << Simulator::Now ().GetSeconds () << "," << flowId << "," << final << ","
+    << stats.timeFirstTxPacket.GetSeconds () << "," << stats.timeLastTxPacket.GetSeconds () << ","
+    << stats.timeFirstRxPacket.GetSeconds () << "," << stats.timeLastRxPacket.GetSeconds () << ","
+    << stats.txBytes << "," << stats.rxBytes << ","
+    << stats.txPackets << "," << stats.rxPackets << ","
+    << stats.lostPackets << "," << stats.timesForwarded << ","
+    << stats.delaySum.GetSeconds () << "," << stats.jitterSum.GetSeconds () << "\n";
+}
+
+void
+FlowMonitor::ExportRightNow ()
+{
+  if (!m_exportStream)
+    {
+      return;
+    }
+
+  CheckForLostPackets ();
+
+  Time now = Simulator::Now ();
+  for (FlowStatsContainerI iter = m_flowStats.begin (); iter != m_flowStats.end (); )
+    {
+      // flows with packets in flight are not evicted, whatever their idle time
+      Time lastActivity = std::max (iter->second.timeLastTxPacket, iter->second.timeLastRxPacket);
+      bool final = m_flowIdleTimeout.IsStrictlyPositive ()
+        && now - lastActivity >= m_flowIdleTimeout
+        && m_packetsInFlight.find (iter->first) == m_packetsInFlight.end ();
+      ExportFlow (iter->first, iter->second, final);
+      if (final)
+        {
+          for (FlowProbeContainerI probe = m_flowProbes.begin (); probe != m_flowProbes.end (); probe++)
+            {
+              (*probe)->RemoveFlowStats (iter->first);
+            }
+          m_flowStats.erase (iter++);
+        }
+      else
+        {
+          iter++;
+        }
+    }
+  m_exportStream->GetStream ()->flush ();
+}
+
 void
 FlowMonitor::AddFlowClassifier (Ptr<FlowClassifier> classifier)
 {
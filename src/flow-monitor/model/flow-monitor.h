@@ -23,6 +23,8 @@
 
 #include <vector>
 #include <map>
+#include <list>
+#include <unordered_map>
 
 #include "ns3/ptr.h"
 #include "ns3/object.h"
@@ -31,6 +33,7 @@
 #include "ns3/histogram.h"
 #include "ns3/nstime.h"
 #include "ns3/event-id.h"
+#include "ns3/output-stream-wrapper.h"
 
 namespace ns3 {
 
@@ -74,7 +77,9 @@ public:
     Time     timeLastRxPacket;
 
     /// Contains the sum of all end-to-end delays for all received
-    /// packets of the flow.
+    /// packets of the flow.  With packet sampling, the sum of the
+    /// delays of the tracked packets, multiplied by the sampling
+    /// period, estimates this value.
     Time     delaySum; // delayCount == rxPackets
 
     /// Contains the sum of all end-to-end delay jitter (delay
@@ -256,6 +261,23 @@ public:
   /// \param enableProbes if true, include also the per-probe/flow pair statistics in the output
   void SerializeToXmlFile (std::string fileName, bool enableHistograms, bool enableProbes);
 
+  /// Periodically export the flow statistics to a stream, in CSV format.
+  ///
+  /// Every ExportInterval, one line is written for each flow, with the
+  /// cumulative statistics of the flow.  Flows idle for FlowIdleTimeout,
+  /// with no packet in flight, are exported one last time, marked as
+  /// final, and are removed from the statistics returned by
+  /// GetFlowStats and from those of the probes, so that the memory used
+  /// is proportional to the active flows.  The flow classifiers keep the
+  /// FlowId of every flow seen, so that a flow which becomes active again
+  /// keeps its FlowId.
+  /// \param stream the output stream
+  void EnableExport (Ptr<OutputStreamWrapper> stream);
+
+  /// Export the flow statistics right now, and evict the idle flows.
+  /// Does nothing if EnableExport was not called.
+  void ExportRightNow ();
+
 
 protected:
 
@@ -264,21 +286,42 @@ protected:
 
 private:
 
+  /// (FlowId,PacketId) of a tracked packet
+  typedef std::pair<FlowId, FlowPacketId> TrackedPacketKey;
+
+  /// Hash function of a TrackedPacketKey
+  struct TrackedPacketKeyHash
+  {
+    /// \param key the TrackedPacketKey
+    /// \return the hash of the key
+    size_t operator() (const TrackedPacketKey &key) const
+    {
+      return key.second + key.first * 2654435761U;
+    }
+  };
+
+  /// Tracked packets, in increasing lastSeenTime order
+  typedef std::list<TrackedPacketKey> TrackedPacketList;
+
   /// Structure to represent a single tracked packet data
   struct TrackedPacket
   {
     Time firstSeenTime; //!< absolute time when the packet was first seen by a probe
     Time lastSeenTime; //!< absolute time when the packet was last seen by a probe
     uint32_t timesForwarded; //!< number of times the packet was reportedly forwarded
+    TrackedPacketList::iterator lastSeenNode; //!< position of the packet in m_lastSeenPackets
   };
 
   /// FlowId --> FlowStats
   FlowStatsContainer m_flowStats;
 
   /// (FlowId,PacketId) --> TrackedPacket
-  typedef std::map< std::pair<FlowId, FlowPacketId>, TrackedPacket> TrackedPacketMap;
+  typedef std::unordered_map<TrackedPacketKey, TrackedPacket, TrackedPacketKeyHash> TrackedPacketMap;
   TrackedPacketMap m_trackedPackets; //!< Tracked packets
+  TrackedPacketList m_lastSeenPackets; //!< Tracked packets, least recently seen first
+  std::unordered_map<FlowId, uint32_t> m_packetsInFlight; //!< Number of tracked packets, per flow
   Time m_maxPerHopDelay; //!< Minimum per-hop delay
+  uint32_t m_packetSampling; //!< Track one packet in m_packetSampling of each flow
   FlowProbeContainer m_flowProbes; //!< all the FlowProbes
 
   // note: this is needed only for serialization
@@ -298,8 +341,31 @@ private:
   /// \returns the stats of the flow
   FlowStats& GetStatsForFlow (FlowId flowId);
 
+  /// Check if a packet is tracked, according to the packet sampling
+  /// \param packetId Packet ID
+  /// \returns true if the packet is tracked
+  bool IsTracked (FlowPacketId packetId) const;
+
+  /// Stop tracking a packet
+  /// \param tracked the tracked packet
+  void UntrackPacket (TrackedPacketMap::iterator tracked);
+
   /// Periodic function to check for lost packets and prune statistics
   void PeriodicCheckForLostPackets ();
+
+  /// Periodic function to export the flow statistics
+  void PeriodicExport ();
+
+  /// Write the statistics of a flow to the export stream
+  /// \param flowId the Flow identification
+  /// \param stats the stats of the flow
+  /// \param final true if the flow is evicted
+  void ExportFlow (FlowId flowId, const FlowStats &stats, bool final);
+
+  Ptr<OutputStreamWrapper> m_exportStream; //!< Export stream
+  Time m_exportInterval;    //!< Interval between the exports
+  Time m_flowIdleTimeout;   //!< Idle time after which a flow is evicted
+  EventId m_exportEvent;    //!< Periodic export event
 };
 
 
@@ -96,6 +96,10 @@ public:
   /// \returns the partial flow statistics
   Stats GetStats () const;
 
+  /// Remove the statistics of a flow from this probe
+  /// \param flowId the flow Identifier
+  void RemoveFlowStats (FlowId flowId);
+
   /// Serializes the results to an std::ostream in XML format
   /// \param os the output stream
   /// \param indent number of spaces to use as base indentation level
@@ -23,6 +23,8 @@
 
 #include <stdint.h>
 #include <map>
+#include <vector>
+#include <unordered_map>
 
 #include "ns3/ipv4-header.h"
 #include "ns3/flow-classifier.h"
@@ -92,12 +94,31 @@ public:
 
 private:
 
+  /// Hash function of a FiveTuple
+  struct FiveTupleHash
+  {
+    /// \param tuple the FiveTuple
+    /// \return the hash of the tuple
+    size_t operator() (const FiveTuple &tuple) const;
+  };
+
+  /// Structure to represent the state of a flow
+  struct FlowInfo
+  {
+    FiveTuple tuple;               //!< Flow identifiers
+    FlowPacketId lastPacketId;     //!< Identifier of the last packet of the flow
+    std::map<Ipv4Header::DscpType, uint32_t> dscpCounts; //!< (DSCP value, packet count) pairs
+  };
+
+  /// Get the state of a flow, aborting if the flow is unknown
+  /// \param flowId the FlowId
+  /// \returns the state of the flow
+  const FlowInfo & GetFlowInfo (FlowId flowId) const;
+
   /// Map to Flows Identifiers to FlowIds
-  std::map<FiveTuple, FlowId> m_flowMap;
-  /// Map to FlowIds to FlowPacketId
-  std::map<FlowId, FlowPacketId> m_flowPktIdMap;
-  /// Map FlowIds to (DSCP value, packet count) pairs
-  std::map<FlowId, std::map<Ipv4Header::DscpType, uint32_t> > m_flowDscpMap;
+  std::unordered_map<FiveTuple, FlowId, FiveTupleHash> m_flowMap;
+  /// State of the flows, indexed by FlowId - 1
+  std::vector<FlowInfo> m_flows;
 
 };
 
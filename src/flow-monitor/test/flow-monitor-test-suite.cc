@@ -0,0 +1,238 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 2 as
+// published by the Free Software Foundation;
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#include "ns3/flow-monitor.h"
+#include "ns3/flow-probe.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/test.h"
+#include <sstream>
+
+using namespace ns3;
+
+/**
+ * \ingroup flow-monitor-test
+ * \ingroup tests
+ *
+ * \brief A FlowProbe reporting the packet events scheduled by the tests
+ */
+class FlowMonitorTestProbe : public FlowProbe
+{
+public:
+  /// Constructor
+  /// \param monitor the FlowMonitor
+  FlowMonitorTestProbe (Ptr<FlowMonitor> monitor)
+    : FlowProbe (monitor)
+  {
+  }
+
+  /// Report a transmitted packet
+  /// \param flowId flow identification
+  /// \param packetId Packet ID
+  void FirstTx (FlowId flowId, FlowPacketId packetId)
+  {
+    m_flowMonitor->ReportFirstTx (this, flowId, packetId, 100);
+  }
+  /// Report a forwarded packet
+  /// \param flowId flow identification
+  /// \param packetId Packet ID
+  void Forwarding (FlowId flowId, FlowPacketId packetId)
+  {
+    m_flowMonitor->ReportForwarding (this, flowId, packetId, 100);
+  }
+  /// Report a received packet
+  /// \param flowId flow identification
+  /// \param packetId Packet ID
+  void LastRx (FlowId flowId, FlowPacketId packetId)
+  {
+    m_flowMonitor->ReportLastRx (this, flowId, packetId, 100);
+  }
+};
+
+/**
+ * \ingroup flow-monitor-test
+ * \ingroup tests
+ *
+ * \brief FlowMonitor packet tracking and packet sampling test
+ *
+ * Flow 1 sends 16 packets, received 10 ms later with one forwarding,
+ * and flow 2 sends 16 packets, none of them received. The packet 12 of
+ * flow 2 is forwarded late, so it is not yet lost when the other
+ * packets are.
+ */
+class FlowMonitorTrackingTestCase : public TestCase
+{
+public:
+  /// Constructor
+  /// \param sampling value of the PacketSampling attribute
+  FlowMonitorTrackingTestCase (uint32_t sampling);
+
+private:
+  virtual void DoRun (void);
+
+  /// Check the lost packets of flow 2
+  /// \param expected the expected number of lost packets
+  void CheckLost (uint32_t expected);
+
+  uint32_t m_sampling;          //!< PacketSampling of the monitor
+  Ptr<FlowMonitor> m_monitor;   //!< The FlowMonitor
+};
+
+FlowMonitorTrackingTestCase::FlowMonitorTrackingTestCase (uint32_t sampling)
+  : TestCase ("Check the packet tracking with a packet sampling of " + std::to_string (sampling)),
+    m_sampling (sampling)
+{
+}
+
+void
+FlowMonitorTrackingTestCase::CheckLost (uint32_t expected)
+{
+  m_monitor->CheckForLostPackets ();
+  FlowMonitor::FlowStats stats = m_monitor->GetFlowStats ().find (2)->second;
+  NS_TEST_EXPECT_MSG_EQ (stats.lostPackets, expected, "Wrong number of lost packets");
+}
+
+void
+FlowMonitorTrackingTestCase::DoRun (void)
+{
+  m_monitor = CreateObjectWithAttributes<FlowMonitor> ("PacketSampling", UintegerValue (m_sampling));
+  Ptr<FlowMonitorTestProbe> probe = Create<FlowMonitorTestProbe> (m_monitor);
+
+  for (uint32_t i = 0; i < 16; i++)
+    {
+      Time tx = MilliSeconds (1 + i);
+      Simulator::Schedule (tx, &FlowMonitorTestProbe::FirstTx, probe, 1, i);
+      Simulator::Schedule (tx + MilliSeconds (5), &FlowMonitorTestProbe::Forwarding, probe, 1, i);
+      Simulator::Schedule (tx + MilliSeconds (10), &FlowMonitorTestProbe::LastRx, probe, 1, i);
+      Simulator::Schedule (tx, &FlowMonitorTestProbe::FirstTx, probe, 2, i);
+    }
+  Simulator::Schedule (Seconds (5), &FlowMonitorTestProbe::Forwarding, probe, 2, 12);
+  Simulator::Schedule (Seconds (12), &FlowMonitorTrackingTestCase::CheckLost, this,
+                       m_sampling == 1 ? 15 : 12);
+  Simulator::Schedule (Seconds (16), &FlowMonitorTrackingTestCase::CheckLost, this, 16);
+  Simulator::Stop (Seconds (20));
+  Simulator::Run ();
+
+  FlowMonitor::FlowStats stats = m_monitor->GetFlowStats ().find (1)->second;
+  NS_TEST_EXPECT_MSG_EQ (stats.txPackets, 16, "Wrong number of transmitted packets");
+  NS_TEST_EXPECT_MSG_EQ (stats.rxPackets, 16, "Wrong number of received packets");
+  NS_TEST_EXPECT_MSG_EQ (stats.rxBytes, 1600, "Wrong number of received bytes");
+  NS_TEST_EXPECT_MSG_EQ (stats.delaySum, MilliSeconds (160), "Wrong delay estimate");
+  NS_TEST_EXPECT_MSG_EQ (stats.jitterSum, Seconds (0), "Wrong jitter estimate");
+  NS_TEST_EXPECT_MSG_EQ (stats.timesForwarded, 16, "Wrong forwarding estimate");
+  NS_TEST_EXPECT_MSG_EQ (stats.lostPackets, 0, "Wrong number of lost packets");
+  NS_TEST_EXPECT_MSG_EQ (stats.delayHistogram.GetBinCount (10), 16 / m_sampling,
+                         "Wrong number of delay samples");
+
+  FlowProbe::Stats probeStats = probe->GetStats ();
+  NS_TEST_EXPECT_MSG_EQ (probeStats[1].packets, 3 * 16 / m_sampling,
+                         "Wrong number of packets seen by the probe");
+
+  Simulator::Destroy ();
+  m_monitor = 0;
+}
+
+/**
+ * \ingroup flow-monitor-test
+ * \ingroup tests
+ *
+ * \brief FlowMonitor periodic export test
+ *
+ * Flow 1 sends 16 packets, all received, and flow 2 sends 16 packets,
+ * none of them received. Flow 1 is evicted once idle, while flow 2,
+ * with packets still in flight, is not.
+ */
+class FlowMonitorExportTestCase : public TestCase
+{
+public:
+  FlowMonitorExportTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+FlowMonitorExportTestCase::FlowMonitorExportTestCase ()
+  : TestCase ("Check the periodic export and the eviction of the idle flows")
+{
+}
+
+void
+FlowMonitorExportTestCase::DoRun (void)
+{
+  Ptr<FlowMonitor> monitor = CreateObjectWithAttributes<FlowMonitor> ("ExportInterval", TimeValue (Seconds (1)),
+                                                                      "FlowIdleTimeout", TimeValue (Seconds (2)));
+  Ptr<FlowMonitorTestProbe> probe = Create<FlowMonitorTestProbe> (monitor);
+  std::ostringstream os;
+  monitor->EnableExport (Create<OutputStreamWrapper> (&os));
+
+  for (uint32_t i = 0; i < 16; i++)
+    {
+      Time tx = MilliSeconds (1 + i);
+      Simulator::Schedule (tx, &FlowMonitorTestProbe::FirstTx, probe, 1, i);
+      Simulator::Schedule (tx + MilliSeconds (10), &FlowMonitorTestProbe::LastRx, probe, 1, i);
+      Simulator::Schedule (tx, &FlowMonitorTestProbe::FirstTx, probe, 2, i);
+    }
+  Simulator::Stop (Seconds (4.5));
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (monitor->GetFlowStats ().size (), 1, "Idle flow not evicted");
+  NS_TEST_EXPECT_MSG_EQ (monitor->GetFlowStats ().begin ()->first, 2, "Flow in flight evicted");
+  FlowProbe::Stats probeStats = probe->GetStats ();
+  NS_TEST_EXPECT_MSG_EQ (probeStats.size (), 1, "Idle flow not evicted from the probe");
+  NS_TEST_EXPECT_MSG_EQ (probeStats.begin ()->first, 2, "Flow in flight evicted from the probe");
+
+  std::istringstream is (os.str ());
+  std::string line;
+  std::getline (is, line);
+  NS_TEST_EXPECT_MSG_EQ (line.substr (0, 19), "time,flowId,final,t", "Wrong header");
+  uint32_t lines = 0;
+  while (std::getline (is, line))
+    {
+      ++lines;
+      if (line.substr (0, 6) == "3,1,1,")
+        {
+          NS_TEST_EXPECT_MSG_NE (line.find (",1600,1600,16,16,0,0,"), std::string::npos,
+                                 "Wrong final statistics");
+        }
+    }
+  // flows 1 and 2 at 1, 2 and 3 s, flow 2 alone at 4 s
+  NS_TEST_EXPECT_MSG_EQ (lines, 7, "Wrong number of exported records");
+  NS_TEST_EXPECT_MSG_NE (os.str ().find ("\n3,1,1,"), std::string::npos, "Flow 1 not exported as final");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup flow-monitor-test
+ * \ingroup tests
+ *
+ * \brief FlowMonitor TestSuite
+ */
+class FlowMonitorTestSuite : public TestSuite
+{
+public:
+  FlowMonitorTestSuite ();
+};
+
+FlowMonitorTestSuite::FlowMonitorTestSuite ()
+  : TestSuite ("flow-monitor", UNIT)
+{
+  AddTestCase (new FlowMonitorTrackingTestCase (1), TestCase::QUICK);
+  AddTestCase (new FlowMonitorTrackingTestCase (4), TestCase::QUICK);
+  AddTestCase (new FlowMonitorExportTestCase, TestCase::QUICK);
+}
+
+static FlowMonitorTestSuite g_flowMonitorTestSuite; //!< Static variable for test initialization
@@ -31,6 +31,8 @@
 #include "ipv4-interface.h"
 #include "ipv4-header.h"
 
+#include <vector>
+
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("ArpCache");
@@ -86,9 +88,12 @@ ArpCache::GetTypeId (void)
 
 ArpCache::ArpCache ()
   : m_device (0), 
-    m_interface (0)
+    m_interface (0),
+    m_waitReplyTimer (Timer::CANCEL_ON_DESTROY)
 {
   NS_LOG_FUNCTION (this);
+  m_waitReplyTimer.SetTimingWheel (true);
+  m_waitReplyTimer.SetFunction (&ArpCache::HandleWaitReplyTimeout, this);
 }
 
 ArpCache::~ArpCache ()
@@ -103,10 +108,7 @@ ArpCache::DoDispose (void)
   Flush ();
   m_device = 0;
   m_interface = 0;
-  if (!m_waitReplyTimer.IsRunning ())
-    {
-      Simulator::Remove (m_waitReplyTimer);
-    }
+  m_waitReplyTimer.Cancel ();
   Object::DoDispose ();
 }
 
@@ -186,8 +188,7 @@ ArpCache::StartWaitReplyTimer (void)
     {
       NS_LOG_LOGIC ("Starting WaitReplyTimer at " << Simulator::Now () << " for " <<
                     m_waitReplyTimeout);
-      m_waitReplyTimer = Simulator::Schedule (m_waitReplyTimeout, 
-                                              &ArpCache::HandleWaitReplyTimeout, this);
+      m_waitReplyTimer.Schedule (m_waitReplyTimeout);
     }
 }
 
@@ -195,12 +196,22 @@ void
 ArpCache::HandleWaitReplyTimeout (void)
 {
   NS_LOG_FUNCTION (this);
-  ArpCache::Entry* entry;
   bool restartWaitReplyTimer = false;
-  for (CacheI i = m_arpCache.begin (); i != m_arpCache.end (); i++) 
+
+  // Only the entries waiting for a reply need to be visited; take a
+  // snapshot, since marking an entry dead removes it from the index
+  std::vector<ArpCache::Entry *> waiting;
+  waiting.reserve (m_waitReply.size ());
+  for (std::map<Ipv4Address, ArpCache::Entry *>::iterator i = m_waitReply.begin ();
+       i != m_waitReply.end (); i++)
     {
-      entry = (*i).second;
-      if (entry != 0 && entry->IsWaitReply ())
+      waiting.push_back (i->second);
+    }
+
+  for (std::vector<ArpCache::Entry *>::iterator i = waiting.begin (); i != waiting.end (); i++)
+    {
+      ArpCache::Entry *entry = *i;
+      if (entry->IsWaitReply ())
         {
           if (entry->GetRetries () < m_maxRetries)
             {
@@ -232,11 +243,10 @@ ArpCache::HandleWaitReplyTimeout (void)
         }
 
     }
-  if (restartWaitReplyTimer)
+  if (restartWaitReplyTimer && m_waitReplyTimer.IsExpired ())
     {
       NS_LOG_LOGIC ("Restarting WaitReplyTimer at " << Simulator::Now ().GetSeconds ());
-      m_waitReplyTimer = Simulator::Schedule (m_waitReplyTimeout, 
-                                              &ArpCache::HandleWaitReplyTimeout, this);
+      m_waitReplyTimer.Schedule (m_waitReplyTimeout);
     }
 }
 
@@ -249,6 +259,8 @@ ArpCache::Flush (void)
       delete (*i).second;
     }
   m_arpCache.erase (m_arpCache.begin (), m_arpCache.end ());
+  m_macIndex.clear ();
+  m_waitReply.clear ();
   if (m_waitReplyTimer.IsRunning ())
     {
       NS_LOG_LOGIC ("Stopping WaitReplyTimer at " << Simulator::Now ().GetSeconds () << " due to ArpCache flush");
@@ -302,15 +314,37 @@ ArpCache::LookupInverse (Address to)
   NS_LOG_FUNCTION (this << to);
 
   std::list<ArpCache::Entry *> entryList;
-  for (CacheI i = m_arpCache.begin (); i != m_arpCache.end (); i++)
+  std::pair<MacIndexI, MacIndexI> range = m_macIndex.equal_range (to);
+  for (MacIndexI i = range.first; i != range.second; i++)
     {
-      ArpCache::Entry *entry = (*i).second;
-      if (entry->GetMacAddress () == to)
+      entryList.push_back (i->second);
+    }
+  return entryList;
+}
+
+void
+ArpCache::MacIndexInsert (ArpCache::Entry *entry)
+{
+  NS_LOG_FUNCTION (this << entry);
+  if (!entry->GetMacAddress ().IsInvalid ())
+    {
+      m_macIndex.insert (std::make_pair (entry->GetMacAddress (), entry));
+    }
+}
+
+void
+ArpCache::MacIndexErase (ArpCache::Entry *entry)
+{
+  NS_LOG_FUNCTION (this << entry);
+  std::pair<MacIndexI, MacIndexI> range = m_macIndex.equal_range (entry->GetMacAddress ());
+  for (MacIndexI i = range.first; i != range.second; i++)
+    {
+      if (i->second == entry)
         {
-          entryList.push_back (entry);
+          m_macIndex.erase (i);
+          return;
         }
     }
-  return entryList;
 }
 
 
@@ -342,16 +376,19 @@ void
 ArpCache::Remove (ArpCache::Entry *entry)
 {
   NS_LOG_FUNCTION (this << entry);
-  
-  for (CacheI i = m_arpCache.begin (); i != m_arpCache.end (); i++)
+
+  CacheI i = m_arpCache.find (entry->GetIpv4Address ());
+  if (i != m_arpCache.end () && (*i).second == entry)
     {
-      if ((*i).second == entry)
+      m_arpCache.erase (i);
+      MacIndexErase (entry);
+      if (entry->IsWaitReply ())
         {
-          m_arpCache.erase (i);
-          entry->ClearPendingPacket (); //clear the pending packets for entry's ipaddress
-          delete entry;
-          return;
+          m_waitReply.erase (entry->GetIpv4Address ());
         }
+      entry->ClearPendingPacket (); //clear the pending packets for entry's ipaddress
+      delete entry;
+      return;
     }
   NS_LOG_WARN ("Entry not found in this ARP Cache");
 }
@@ -396,7 +433,7 @@ ArpCache::Entry::MarkDead (void)
 {
   NS_LOG_FUNCTION (this);
   NS_ASSERT (m_state == ALIVE || m_state == WAIT_REPLY || m_state == DEAD);
-  m_state = DEAD;
+  SetState (DEAD);
   ClearRetries ();
   UpdateSeen ();
 }
@@ -405,8 +442,8 @@ ArpCache::Entry::MarkAlive (Address macAddress)
 {
   NS_LOG_FUNCTION (this << macAddress);
   NS_ASSERT (m_state == WAIT_REPLY);
-  m_macAddress = macAddress;
-  m_state = ALIVE;
+  SetMacAddress (macAddress);
+  SetState (ALIVE);
   ClearRetries ();
   UpdateSeen ();
 }
@@ -416,7 +453,7 @@ ArpCache::Entry::MarkPermanent (void)
   NS_LOG_FUNCTION (this << m_macAddress);
   NS_ASSERT (!m_macAddress.IsInvalid ());
 
-  m_state = PERMANENT;
+  SetState (PERMANENT);
   ClearRetries ();
   UpdateSeen ();
 }
@@ -444,7 +481,7 @@ ArpCache::Entry::MarkWaitReply (Ipv4PayloadHeaderPair waiting)
   NS_ASSERT (m_pending.empty ());
   NS_ASSERT_MSG (waiting.first, "Can not add a null packet to the ARP queue");
 
-  m_state = WAIT_REPLY;
+  SetState (WAIT_REPLY);
   m_pending.push_back (waiting);
   UpdateSeen ();
   m_arp->StartWaitReplyTimer ();
@@ -460,13 +497,15 @@ void
 ArpCache::Entry::SetMacAddresss (Address macAddress)
 {
   NS_LOG_FUNCTION (this);
-  m_macAddress = macAddress;
+  SetMacAddress (macAddress);
 }
 void 
 ArpCache::Entry::SetMacAddress (Address macAddress)
 {
   NS_LOG_FUNCTION (this);
+  m_arp->MacIndexErase (this);
   m_macAddress = macAddress;
+  m_arp->MacIndexInsert (this);
 }
 Ipv4Address 
 ArpCache::Entry::GetIpv4Address (void) const
@@ -480,6 +519,20 @@ ArpCache::Entry::SetIpv4Address (Ipv4Address destination)
   NS_LOG_FUNCTION (this << destination);
   m_ipv4Address = destination;
 }
+void
+ArpCache::Entry::SetState (ArpCacheEntryState_e state)
+{
+  NS_LOG_FUNCTION (this << state);
+  if (m_state == WAIT_REPLY && state != WAIT_REPLY)
+    {
+      m_arp->m_waitReply.erase (m_ipv4Address);
+    }
+  else if (m_state != WAIT_REPLY && state == WAIT_REPLY)
+    {
+      m_arp->m_waitReply[m_ipv4Address] = this;
+    }
+  m_state = state;
+}
 Time
 ArpCache::Entry::GetTimeout (void) const
 {
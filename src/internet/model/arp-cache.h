@@ -22,10 +22,12 @@
 
 #include <stdint.h>
 #include <list>
+#include <map>
 #include "ns3/simulator.h"
 #include "ns3/callback.h"
 #include "ns3/packet.h"
 #include "ns3/nstime.h"
+#include "ns3/timer.h"
 #include "ns3/net-device.h"
 #include "ns3/ipv4-address.h"
 #include "ns3/address.h"
@@ -149,6 +151,10 @@ public:
   ArpCache::Entry *Lookup (Ipv4Address destination);
   /**
    * \brief Do lookup in the ARP cache against a MAC address
+   *
+   * The lookup uses an index on the MAC address of the entries, so that
+   * entries still waiting for their MAC address are never returned.
+   *
    * \param destination The destination MAC address to lookup
    * of
    * \return A std::list of ArpCache::Entry with info about layer 2
@@ -306,6 +312,13 @@ private:
      */
     Time GetTimeout (void) const;
 
+    /**
+     * \brief Change the state of the entry, keeping the cache index of
+     * the entries in WAIT_REPLY state up to date
+     * \param state the new state
+     */
+    void SetState (ArpCacheEntryState_e state);
+
     ArpCache *m_arp; //!< pointer to the ARP cache owning the entry
     ArpCacheEntryState_e m_state; //!< state of the entry
     Time m_lastSeen; //!< last moment a packet from that address has been seen
@@ -324,6 +337,25 @@ private:
    * \brief ARP Cache container iterator
    */
   typedef sgi::hash_map<Ipv4Address, ArpCache::Entry *, Ipv4AddressHash>::iterator CacheI;
+  /**
+   * \brief Index of the ARP Cache entries by MAC address
+   */
+  typedef sgi::hash_multimap<Address, ArpCache::Entry *, AddressHash> MacIndex;
+  /**
+   * \brief Index of the ARP Cache entries by MAC address iterator
+   */
+  typedef sgi::hash_multimap<Address, ArpCache::Entry *, AddressHash>::iterator MacIndexI;
+
+  /**
+   * \brief Add an entry to the MAC address index, if it has a MAC address
+   * \param entry the entry
+   */
+  void MacIndexInsert (ArpCache::Entry *entry);
+  /**
+   * \brief Remove an entry from the MAC address index
+   * \param entry the entry
+   */
+  void MacIndexErase (ArpCache::Entry *entry);
 
   virtual void DoDispose (void);
 
@@ -332,7 +364,7 @@ private:
   Time m_aliveTimeout; //!< cache alive state timeout
   Time m_deadTimeout; //!< cache dead state timeout
   Time m_waitReplyTimeout; //!< cache reply state timeout
-  EventId m_waitReplyTimer;  //!< cache alive state timer
+  Timer m_waitReplyTimer;  //!< cache reply state timer, held by the timing wheel
   Callback<void, Ptr<const ArpCache>, Ipv4Address> m_arpRequestCallback;  //!< reply timeout callback
   uint32_t m_maxRetries; //!< max retries for a resolution
 
@@ -344,6 +376,8 @@ private:
   void HandleWaitReplyTimeout (void);
   uint32_t m_pendingQueueSize; //!< number of packets waiting for a resolution
   Cache m_arpCache; //!< the ARP cache
+  MacIndex m_macIndex; //!< the ARP cache entries, by MAC address
+  std::map<Ipv4Address, ArpCache::Entry *> m_waitReply; //!< the entries in WAIT_REPLY state, in address order
   TracedCallback<Ptr<const Packet> > m_dropTrace; //!< trace for packets dropped by the ARP cache queue
 };
 
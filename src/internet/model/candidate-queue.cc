@@ -57,16 +57,18 @@ operator<< (std::ostream& os, const CandidateQueue& q)
   for (CIter_t iter = list.begin (); iter != list.end (); iter++)
     {
       os << "<" 
-      << (*iter)->GetVertexId () << ", "
-      << (*iter)->GetDistanceFromRoot () << ", "
-      << (*iter)->GetVertexType () << ">" << std::endl;
+      << iter->second->GetVertexId () << ", "
+      << iter->second->GetDistanceFromRoot () << ", "
+      << iter->second->GetVertexType () << ">" << std::endl;
     }
   os << "*** CandidateQueue End ***";
   return os;
 }
 
 CandidateQueue::CandidateQueue()
-  : m_candidates ()
+  : m_candidates (),
+    m_index (),
+    m_sequence (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -94,11 +96,38 @@ CandidateQueue::Push (SPFVertex *vNew)
 {
   NS_LOG_FUNCTION (this << vNew);
 
-  CandidateList_t::iterator i = std::upper_bound (
-      m_candidates.begin (), m_candidates.end (), vNew,
-      &CandidateQueue::CompareSPFVertex
-      );
-  m_candidates.insert (i, vNew);
+  Insert (vNew);
+}
+
+void
+CandidateQueue::Insert (SPFVertex *v)
+{
+  NS_LOG_FUNCTION (this << v);
+
+  CandidateKey key;
+  key.distance = v->GetDistanceFromRoot ();
+  key.rank = v->GetVertexType () == SPFVertex::VertexNetwork ? 0 : 1;
+  key.sequence = m_sequence++;
+  CandidateList_t::iterator i = m_candidates.insert (std::make_pair (key, v)).first;
+  m_index.insert (std::make_pair (v->GetVertexId (), i));
+}
+
+void
+CandidateQueue::Unindex (SPFVertex *v)
+{
+  NS_LOG_FUNCTION (this << v);
+
+  std::pair<CandidateIndex_t::iterator, CandidateIndex_t::iterator> range =
+    m_index.equal_range (v->GetVertexId ());
+  for (CandidateIndex_t::iterator i = range.first; i != range.second; i++)
+    {
+      if (i->second->second == v)
+        {
+          m_index.erase (i);
+          return;
+        }
+    }
+  NS_ASSERT_MSG (false, "Vertex " << v->GetVertexId () << " is not in the queue");
 }
 
 SPFVertex *
@@ -110,8 +139,9 @@ CandidateQueue::Pop (void)
       return 0;
     }
 
-  SPFVertex *v = m_candidates.front ();
-  m_candidates.pop_front ();
+  SPFVertex *v = m_candidates.begin ()->second;
+  Unindex (v);
+  m_candidates.erase (m_candidates.begin ());
   return v;
 }
 
@@ -124,7 +154,7 @@ CandidateQueue::Top (void) const
       return 0;
     }
 
-  return m_candidates.front ();
+  return m_candidates.begin ()->second;
 }
 
 bool
@@ -145,18 +175,22 @@ SPFVertex *
 CandidateQueue::Find (const Ipv4Address addr) const
 {
   NS_LOG_FUNCTION (this);
-  CandidateList_t::const_iterator i = m_candidates.begin ();
-
-  for (; i != m_candidates.end (); i++)
+  std::pair<CandidateIndex_t::const_iterator, CandidateIndex_t::const_iterator> range =
+    m_index.equal_range (addr);
+  if (range.first == range.second)
     {
-      SPFVertex *v = *i;
-      if (v->GetVertexId () == addr)
+      return 0;
+    }
+  // Return the first of the vertices with this ID in queue order
+  CandidateList_t::iterator first = range.first->second;
+  for (CandidateIndex_t::const_iterator i = range.first; i != range.second; i++)
+    {
+      if (i->second->first < first->first)
         {
-          return v;
+          first = i->second;
         }
     }
-
-  return 0;
+  return first->second;
 }
 
 void
@@ -164,11 +198,47 @@ CandidateQueue::Reorder (void)
 {
   NS_LOG_FUNCTION (this);
 
-  m_candidates.sort (&CandidateQueue::CompareSPFVertex);
+  // Requeue every vertex in its current order, so that vertices of equal
+  // priority keep their relative order
+  CandidateList_t candidates;
+  candidates.swap (m_candidates);
+  m_index.clear ();
+  for (CandidateList_t::const_iterator i = candidates.begin (); i != candidates.end (); i++)
+    {
+      Insert (i->second);
+    }
   NS_LOG_LOGIC ("After reordering the CandidateQueue");
   NS_LOG_LOGIC (*this);
 }
 
+void
+CandidateQueue::Reorder (SPFVertex *v)
+{
+  NS_LOG_FUNCTION (this << v);
+
+  // The vertices tying with the new distance were all ahead of this one,
+  // so it goes last among them, as a stable Reorder () would leave it
+  std::pair<CandidateIndex_t::iterator, CandidateIndex_t::iterator> range =
+    m_index.equal_range (v->GetVertexId ());
+  for (CandidateIndex_t::iterator i = range.first; i != range.second; i++)
+    {
+      if (i->second->second == v)
+        {
+          if (i->second->first.distance == v->GetDistanceFromRoot ())
+            {
+              return;
+            }
+          m_candidates.erase (i->second);
+          m_index.erase (i);
+          Insert (v);
+          NS_LOG_LOGIC ("After reordering the CandidateQueue");
+          NS_LOG_LOGIC (*this);
+          return;
+        }
+    }
+  NS_ASSERT_MSG (false, "Vertex " << v->GetVertexId () << " is not in the queue");
+}
+
 /*
  * In this implementation, SPFVertex follows the ordering where
  * a vertex is ranked first if its GetDistanceFromRoot () is smaller;
@@ -177,24 +247,17 @@ CandidateQueue::Reorder (void)
  * This ordering is necessary for implementing ECMP
  */
 bool 
-CandidateQueue::CompareSPFVertex (const SPFVertex* v1, const SPFVertex* v2)
+CandidateQueue::CandidateKey::operator< (const CandidateKey &o) const
 {
-  NS_LOG_FUNCTION (&v1 << &v2);
-
-  bool result = false;
-  if (v1->GetDistanceFromRoot () < v2->GetDistanceFromRoot ())
+  if (distance != o.distance)
     {
-      result = true;
+      return distance < o.distance;
     }
-  else if (v1->GetDistanceFromRoot () == v2->GetDistanceFromRoot ())
+  if (rank != o.rank)
     {
-      if (v1->GetVertexType () == SPFVertex::VertexNetwork 
-          && v2->GetVertexType () == SPFVertex::VertexRouter)
-        {
-          result = true;
-        }
+      return rank < o.rank;
     }
-  return result;
+  return sequence < o.sequence;
 }
 
 } // namespace ns3
@@ -22,7 +22,7 @@
 #define CANDIDATE_QUEUE_H
 
 #include <stdint.h>
-#include <list>
+#include <map>
 #include "ns3/ipv4-address.h"
 
 namespace ns3 {
@@ -47,6 +47,12 @@ class SPFVertex;
  * for a Find () operation, the dynamic nature of the data and the derived
  * requirement for a Reorder () operation led us to implement this simple 
  * enhanced priority queue.
+ *
+ * The vertices are kept in an ordered map, keyed by a copy of their
+ * distance taken when they were queued, and are indexed by vertex ID, so
+ * that Push (), Pop (), Find () and Reorder (SPFVertex*) take logarithmic
+ * time.  Vertices with the same priority are popped in the order they
+ * were pushed.
  */
 class CandidateQueue
 {
@@ -154,6 +160,16 @@ public:
  */
   void Reorder (void);
 
+/**
+ * @brief Moves a vertex whose m_distanceFromRoot has decreased (or is
+ * unchanged) to its new place in the Candidate Queue.
+ * The result is the same as the one of Reorder (), but only the given
+ * vertex is moved.
+ * @see SPFVertex
+ * @param v The Shortest Path First Vertex, which must be in the queue.
+ */
+  void Reorder (SPFVertex *v);
+
 private:
 /**
  * Candidate Queue copy construction is disallowed (not implemented) to 
@@ -171,21 +187,40 @@ private:
  * \return copied object
  */
   CandidateQueue& operator= (CandidateQueue& sr);
-/**
- * \brief return true if v1 < v2
- *
- * SPFVertexes are added into the queue according to the ordering
- * defined by this method. If v1 should be popped before v2, this 
- * method return true; false otherwise
- *
- * \param v1 first operand
- * \param v2 second operand
- * \return True if v1 should be popped before v2; false otherwise
- */
-  static bool CompareSPFVertex (const SPFVertex* v1, const SPFVertex* v2);
 
-  typedef std::list<SPFVertex*> CandidateList_t; //!< container of SPFVertex pointers
+  /**
+   * \brief Priority of a queued vertex: its distance from the root when it
+   * was queued, its type rank (networks before routers) and its sequence
+   * number (first in, first out).
+   */
+  struct CandidateKey
+  {
+    uint32_t distance; //!< distance from the root
+    uint32_t rank;     //!< 0 for networks, 1 for other vertices
+    uint64_t sequence; //!< sequence number
+    /**
+     * \param o the other key
+     * \returns true if this key is popped before o
+     */
+    bool operator< (const CandidateKey &o) const;
+  };
+
+  /**
+   * \brief Queue a vertex under a new key.
+   * \param v the vertex
+   */
+  void Insert (SPFVertex *v);
+  /**
+   * \brief Remove a vertex from the vertex ID index.
+   * \param v the vertex
+   */
+  void Unindex (SPFVertex *v);
+
+  typedef std::map<CandidateKey, SPFVertex*> CandidateList_t; //!< container of SPFVertex pointers
+  typedef std::multimap<Ipv4Address, CandidateList_t::iterator> CandidateIndex_t; //!< container of vertex IDs / candidates
   CandidateList_t m_candidates;  //!< SPFVertex candidates
+  CandidateIndex_t m_index;      //!< SPFVertex candidates, by vertex ID
+  uint64_t m_sequence;           //!< next sequence number
 
   /**
    * \brief Stream insertion operator.
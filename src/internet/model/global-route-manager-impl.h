@@ -681,6 +681,12 @@ private:
 
   LSDBMap_t m_database; //!< database of IPv4 addresses / Link State Advertisements
   std::vector<GlobalRoutingLSA*> m_extdatabase; //!< database of External Link State Advertisements
+  /**
+   * Index of the LSAs by the LinkData of their TransitNetwork link records,
+   * built by the first GetLSAByLinkData () after the database changes.
+   */
+  mutable LSDBMap_t m_linkDataIndex;
+  mutable bool m_linkDataIndexValid; //!< true if m_linkDataIndex is up to date
 
 /**
  * @brief GlobalRouteManagerLSDB copy construction is disallowed.  There's no 
@@ -767,8 +773,20 @@ private:
   GlobalRouteManagerImpl& operator= (GlobalRouteManagerImpl& srmi);
 
   SPFVertex* m_spfroot; //!< the root node
+  Ptr<Node> m_spfrootNode; //!< the node the routes of the root vertex are written to
   GlobalRouteManagerLSDB* m_lsdb; //!< the Link State DataBase (LSDB) of the Global Route Manager
 
+  typedef std::map<Ipv4Address, Ptr<Node> > RouterNodeMap_t; //!< container of router IDs / nodes
+  RouterNodeMap_t m_routerNodes; //!< nodes with a GlobalRouter, by router ID
+
+  /**
+   * \brief Index the nodes with a GlobalRouter interface by router ID.
+   *
+   * This lets each SPF calculation find the node at its root without
+   * walking the node list once per vertex.
+   */
+  void BuildRouterNodeMap (void);
+
   /**
    * \brief Test if a node is a stub, from an OSPF sense.
    *
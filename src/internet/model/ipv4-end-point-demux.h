@@ -23,6 +23,7 @@
 
 #include <stdint.h>
 #include <list>
+#include <unordered_map>
 #include "ns3/ipv4-address.h"
 #include "ipv4-interface.h"
 
@@ -40,6 +41,11 @@ class Ipv4EndPoint;
  * of endpoints, and has APIs to add and find endpoints in this demux.  This
  * code is shared in common to TCP and UDP protocols in ns3.  This demux
  * sits between ns3's layer four and the socket layer
+ *
+ * Besides the list, the endpoints are indexed by their four-tuple and by
+ * their local port, so that Lookup () costs a handful of hash probes
+ * rather than a walk over every endpoint.  An endpoint keeps a pointer
+ * to its demux and re-indexes itself when its addresses or ports change.
  */
 
 class Ipv4EndPointDemux {
@@ -166,6 +172,86 @@ public:
   void DeAllocate (Ipv4EndPoint *endPoint);
 
 private:
+  friend class Ipv4EndPoint;
+
+  /**
+   * \brief The four-tuple an endpoint is indexed under.
+   */
+  struct TupleKey
+  {
+    Ipv4Address localAddress; //!< Local address
+    uint16_t localPort;       //!< Local port
+    Ipv4Address peerAddress;  //!< Peer address
+    uint16_t peerPort;        //!< Peer port
+
+    /**
+     * \brief Equal to operator.
+     * \param other the other key
+     * \returns true if the four-tuples are equal
+     */
+    bool operator == (const TupleKey &other) const;
+  };
+
+  /**
+   * \brief Hash function for TupleKey.
+   */
+  struct TupleKeyHash
+  {
+    /**
+     * \brief Hash a four-tuple.
+     * \param key the four-tuple
+     * \returns the hash
+     */
+    std::size_t operator () (const TupleKey &key) const;
+  };
+
+  /**
+   * \brief Endpoints indexed by their four-tuple.
+   */
+  typedef std::unordered_multimap<TupleKey, Ipv4EndPoint *, TupleKeyHash> TupleIndex;
+
+  /**
+   * \brief Endpoints indexed by their local port, in allocation order.
+   */
+  typedef std::unordered_map<uint16_t, EndPoints> PortIndex;
+
+  /**
+   * \brief Add an endpoint to the list and to the indexes.
+   * \param endPoint the end point to add
+   */
+  void Insert (Ipv4EndPoint *endPoint);
+
+  /**
+   * \brief Add an endpoint to the indexes under its current four-tuple.
+   * \param endPoint the end point to index
+   * \param withPort also append the endpoint to its local port bucket
+   */
+  void Index (Ipv4EndPoint *endPoint, bool withPort = false);
+
+  /**
+   * \brief Remove an endpoint from the indexes.
+   *
+   * Must be called before the four-tuple of the endpoint changes.
+   * The local port bucket is left untouched unless asked for, so that
+   * a re-indexed endpoint keeps its allocation order there.
+   *
+   * \param endPoint the end point to unindex
+   * \param withPort also remove the endpoint from its local port bucket
+   */
+  void Unindex (Ipv4EndPoint *endPoint, bool withPort = false);
+
+  /**
+   * \brief Append the receiving endpoints indexed under a four-tuple.
+   *
+   * Endpoints with Rx disabled, or bound to a NetDevice other than the
+   * incoming one, are skipped.
+   *
+   * \param key the four-tuple
+   * \param incomingInterface the incoming interface
+   * \param retval the list to append to
+   */
+  void LookupTuple (const TupleKey &key, Ptr<Ipv4Interface> incomingInterface,
+                    EndPoints &retval);
 
   /**
    * \brief Allocate an ephemeral port.
@@ -192,6 +278,16 @@ private:
    * \brief A list of IPv4 end points.
    */
   EndPoints m_endPoints;
+
+  /**
+   * \brief The end points indexed by four-tuple.
+   */
+  TupleIndex m_tupleIndex;
+
+  /**
+   * \brief The end points indexed by local port.
+   */
+  PortIndex m_portIndex;
 };
 
 } // namespace ns3
@@ -28,6 +28,7 @@
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/random-variable-stream.h"
+#include "ipv4-prefix-trie.h"
 
 namespace ns3 {
 
@@ -272,6 +273,10 @@ private:
   NetworkRoutes m_networkRoutes;       //!< Routes to networks
   ASExternalRoutes m_ASexternalRoutes; //!< External routes imported
 
+  Ipv4PrefixTrie<Ipv4RoutingTableEntry *> m_hostRouteTrie;       //!< m_hostRoutes indexed by destination
+  Ipv4PrefixTrie<Ipv4RoutingTableEntry *> m_networkRouteTrie;    //!< m_networkRoutes indexed by destination prefix
+  Ipv4PrefixTrie<Ipv4RoutingTableEntry *> m_ASexternalRouteTrie; //!< m_ASexternalRoutes indexed by destination prefix
+
   Ptr<Ipv4> m_ipv4; //!< associated IPv4 instance
 };
 
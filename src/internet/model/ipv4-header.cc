@@ -22,6 +22,7 @@
 #include "ns3/abort.h"
 #include "ns3/log.h"
 #include "ns3/header.h"
+#include "ns3/fixed-header-layout.h"
 #include "ipv4-header.h"
 
 namespace ns3 {
@@ -383,13 +384,13 @@ void
 Ipv4Header::Serialize (Buffer::Iterator start) const
 {
   NS_LOG_FUNCTION (this << &start);
-  Buffer::Iterator i = start;
+  FixedHeaderLayout<20> layout;
 
   uint8_t verIhl = (4 << 4) | (5);
-  i.WriteU8 (verIhl);
-  i.WriteU8 (m_tos);
-  i.WriteHtonU16 (m_payloadSize + 5*4);
-  i.WriteHtonU16 (m_identification);
+  layout.WriteU8<0> (verIhl);
+  layout.WriteU8<1> (m_tos);
+  layout.WriteHtonU16<2> (m_payloadSize + 5*4);
+  layout.WriteHtonU16<4> (m_identification);
   uint32_t fragmentOffset = m_fragmentOffset / 8;
   uint8_t flagsFrag = (fragmentOffset >> 8) & 0x1f;
   if (m_flags & DONT_FRAGMENT) 
@@ -400,24 +401,22 @@ Ipv4Header::Serialize (Buffer::Iterator start) const
     {
       flagsFrag |= (1<<5);
     }
-  i.WriteU8 (flagsFrag);
+  layout.WriteU8<6> (flagsFrag);
   uint8_t frag = fragmentOffset & 0xff;
-  i.WriteU8 (frag);
-  i.WriteU8 (m_ttl);
-  i.WriteU8 (m_protocol);
-  i.WriteHtonU16 (0);
-  i.WriteHtonU32 (m_source.Get ());
-  i.WriteHtonU32 (m_destination.Get ());
+  layout.WriteU8<7> (frag);
+  layout.WriteU8<8> (m_ttl);
+  layout.WriteU8<9> (m_protocol);
+  layout.WriteHtonU16<10> (0);
+  layout.WriteHtonU32<12> (m_source.Get ());
+  layout.WriteHtonU32<16> (m_destination.Get ());
 
   if (m_calcChecksum) 
     {
-      i = start;
-      uint16_t checksum = i.CalculateIpChecksum (20);
+      uint16_t checksum = layout.CalculateIpChecksum ();
       NS_LOG_LOGIC ("checksum=" <<checksum);
-      i = start;
-      i.Next (10);
-      i.WriteU16 (checksum);
+      layout.WriteU16<10> (checksum);
     }
+  layout.WriteTo (start);
 }
 uint32_t
 Ipv4Header::Deserialize (Buffer::Iterator start)
@@ -425,7 +424,7 @@ Ipv4Header::Deserialize (Buffer::Iterator start)
   NS_LOG_FUNCTION (this << &start);
   Buffer::Iterator i = start;
 
-  uint8_t verIhl = i.ReadU8 ();
+  uint8_t verIhl = i.PeekU8 ();
   uint8_t ihl = verIhl & 0x0f; 
   uint16_t headerSize = ihl * 4;
 
@@ -435,11 +434,13 @@ Ipv4Header::Deserialize (Buffer::Iterator start)
       return 0;
     }
 
-  m_tos = i.ReadU8 ();
-  uint16_t size = i.ReadNtohU16 ();
+  FixedHeaderLayout<20> layout;
+  layout.ReadFrom (i);
+  m_tos = layout.ReadU8<1> ();
+  uint16_t size = layout.ReadNtohU16<2> ();
   m_payloadSize = size - headerSize;
-  m_identification = i.ReadNtohU16 ();
-  uint8_t flags = i.ReadU8 ();
+  m_identification = layout.ReadNtohU16<4> ();
+  uint8_t flags = layout.ReadU8<6> ();
   m_flags = 0;
   if (flags & (1<<6)) 
     {
@@ -449,23 +450,30 @@ Ipv4Header::Deserialize (Buffer::Iterator start)
     {
       m_flags |= MORE_FRAGMENTS;
     }
-  i.Prev ();
-  m_fragmentOffset = i.ReadU8 () & 0x1f;
+  m_fragmentOffset = flags & 0x1f;
   m_fragmentOffset <<= 8;
-  m_fragmentOffset |= i.ReadU8 ();
+  m_fragmentOffset |= layout.ReadU8<7> ();
   m_fragmentOffset <<= 3;
-  m_ttl = i.ReadU8 ();
-  m_protocol = i.ReadU8 ();
-  m_checksum = i.ReadU16 ();
-  /* i.Next (2); // checksum */
-  m_source.Set (i.ReadNtohU32 ());
-  m_destination.Set (i.ReadNtohU32 ());
+  m_ttl = layout.ReadU8<8> ();
+  m_protocol = layout.ReadU8<9> ();
+  m_checksum = layout.ReadU16<10> ();
+  m_source.Set (layout.ReadNtohU32<12> ());
+  m_destination.Set (layout.ReadNtohU32<16> ());
   m_headerSize = headerSize;
 
   if (m_calcChecksum) 
     {
-      i = start;
-      uint16_t checksum = i.CalculateIpChecksum (headerSize);
+      uint16_t checksum;
+      if (headerSize == layout.GetSize ())
+        {
+          checksum = layout.CalculateIpChecksum ();
+        }
+      else
+        {
+          // The options are not part of the layout
+          i = start;
+          checksum = i.CalculateIpChecksum (headerSize);
+        }
       NS_LOG_LOGIC ("checksum=" <<checksum);
 
       m_goodChecksum = (checksum == 0);
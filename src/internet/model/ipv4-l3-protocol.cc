@@ -41,6 +41,8 @@
 #include "icmpv4-l4-protocol.h"
 #include "ipv4-interface.h"
 #include "ipv4-raw-socket-impl.h"
+#include "tcp-header.h"
+#include "tcp-gso-tag.h"
 
 namespace ns3 {
 
@@ -817,8 +819,7 @@ Ipv4L3Protocol::Send (Ptr<Packet> packet,
       NS_LOG_LOGIC ("Ipv4L3Protocol::Send case 3:  passed in with route");
       ipHeader = BuildHeader (source, destination, protocol, packet->GetSize (), ttl, tos, mayFragment);
       int32_t interface = GetInterfaceForDevice (route->GetOutputDevice ());
-      m_sendOutgoingTrace (ipHeader, packet, interface);
-      SendRealOut (route, packet->Copy (), ipHeader);
+      SendOutgoing (route, packet, ipHeader, interface);
       return; 
     } 
   // 4) packet is not broadcast, and is passed in with a route entry but route->GetGateway is not set (e.g., on-demand)
@@ -847,8 +848,7 @@ Ipv4L3Protocol::Send (Ptr<Packet> packet,
   if (newRoute)
     {
       int32_t interface = GetInterfaceForDevice (newRoute->GetOutputDevice ());
-      m_sendOutgoingTrace (ipHeader, packet, interface);
-      SendRealOut (newRoute, packet->Copy (), ipHeader);
+      SendOutgoing (newRoute, packet, ipHeader, interface);
     }
   else
     {
@@ -857,6 +857,32 @@ Ipv4L3Protocol::Send (Ptr<Packet> packet,
     }
 }
 
+void
+Ipv4L3Protocol::SendOutgoing (Ptr<Ipv4Route> route, Ptr<Packet> packet,
+                              const Ipv4Header &ipHeader, int32_t interface)
+{
+  NS_LOG_FUNCTION (this << route << packet << ipHeader << interface);
+
+  TcpGsoTag gsoTag;
+  if (packet->PeekPacketTag (gsoTag))
+    {
+      // Split the super-segment before any trace or queue sees it, so
+      // that the rest of the stack only deals with wire segments.
+      std::list<Ipv4PayloadHeaderPair> listSegments;
+      DoSegmentation (packet, ipHeader, gsoTag.GetSegmentSize (), listSegments);
+      for (std::list<Ipv4PayloadHeaderPair>::iterator it = listSegments.begin ();
+           it != listSegments.end (); it++)
+        {
+          m_sendOutgoingTrace (it->second, it->first, interface);
+          SendRealOut (route, it->first, it->second);
+        }
+      return;
+    }
+
+  m_sendOutgoingTrace (ipHeader, packet, interface);
+  SendRealOut (route, packet->Copy (), ipHeader);
+}
+
 // \todo when should we set ip_id?   check whether we are incrementing
 // m_identification on packets that may later be dropped in this stack
 // and whether that deviates from Linux
@@ -1489,6 +1515,72 @@ Ipv4L3Protocol::DoFragmentation (Ptr<Packet> packet, const Ipv4Header & ipv4Head
   return;
 }
 
+void
+Ipv4L3Protocol::DoSegmentation (Ptr<Packet> packet, const Ipv4Header & ipv4Header, uint16_t segmentSize, std::list<Ipv4PayloadHeaderPair>& listSegments)
+{
+  NS_LOG_FUNCTION (this << *packet << segmentSize << &listSegments);
+  NS_ASSERT (segmentSize > 0);
+
+  Ptr<Packet> p = packet->Copy ();
+  TcpGsoTag gsoTag;
+  p->RemovePacketTag (gsoTag);
+
+  TcpHeader tcpHeader;
+  p->RemoveHeader (tcpHeader);
+
+  uint8_t flags = tcpHeader.GetFlags ();
+  SequenceNumber32 seq = tcpHeader.GetSequenceNumber ();
+  uint64_t srcDst = uint64_t (ipv4Header.GetDestination ().Get ())
+    | (uint64_t (ipv4Header.GetSource ().Get ()) << 32);
+  std::pair<uint64_t, uint8_t> key = std::make_pair (srcDst, ipv4Header.GetProtocol ());
+
+  uint32_t offset = 0;
+  do
+    {
+      uint32_t size = std::min<uint32_t> (segmentSize, p->GetSize () - offset);
+      bool isFirst = (offset == 0);
+      bool isLast = (offset + size == p->GetSize ());
+
+      // CWR goes with the first segment only, FIN and PSH with the last one
+      uint8_t segmentFlags = flags;
+      if (!isFirst)
+        {
+          segmentFlags &= ~TcpHeader::CWR;
+        }
+      if (!isLast)
+        {
+          segmentFlags &= ~(TcpHeader::FIN | TcpHeader::PSH);
+        }
+
+      TcpHeader segmentTcpHeader = tcpHeader;
+      segmentTcpHeader.SetSequenceNumber (seq + SequenceNumber32 (offset));
+      segmentTcpHeader.SetFlags (segmentFlags);
+      if (Node::ChecksumEnabled ())
+        {
+          segmentTcpHeader.EnableChecksums ();
+          segmentTcpHeader.InitializeChecksum (ipv4Header.GetSource (),
+                                               ipv4Header.GetDestination (),
+                                               ipv4Header.GetProtocol ());
+        }
+
+      Ptr<Packet> segment = p->CreateFragment (offset, size);
+      segment->AddHeader (segmentTcpHeader);
+
+      Ipv4Header segmentIpHeader = ipv4Header;
+      segmentIpHeader.SetPayloadSize (segment->GetSize ());
+      if (!isFirst)
+        {
+          segmentIpHeader.SetIdentification (m_identification[key]++);
+        }
+
+      NS_LOG_LOGIC ("New segment " << segmentIpHeader << " " << segmentTcpHeader);
+      listSegments.push_back (Ipv4PayloadHeaderPair (segment, segmentIpHeader));
+
+      offset += size;
+    }
+  while (offset < p->GetSize ());
+}
+
 bool
 Ipv4L3Protocol::ProcessFragment (Ptr<Packet>& packet, Ipv4Header& ipHeader, uint32_t iif)
 {
@@ -405,6 +405,30 @@ private:
    */
   void DoFragmentation (Ptr<Packet> packet, const Ipv4Header& ipv4Header, uint32_t outIfaceMtu, std::list<Ipv4PayloadHeaderPair>& listFragments);
 
+  /**
+   * \brief Split a TCP super-segment into wire-sized segments
+   *
+   * The super-segment is built by TcpSocketBase when segmentation offload
+   * is enabled and is marked with a TcpGsoTag. Each resulting segment gets
+   * its own TCP header (with the sequence number and flags adjusted) and
+   * its own IPv4 header.
+   *
+   * \param packet the super-segment, starting with the TCP header
+   * \param ipv4Header the IPv4 header built for the super-segment
+   * \param segmentSize the payload size of each segment
+   * \param listSegments the list of segments
+   */
+  void DoSegmentation (Ptr<Packet> packet, const Ipv4Header& ipv4Header, uint16_t segmentSize, std::list<Ipv4PayloadHeaderPair>& listSegments);
+
+  /**
+   * \brief Send a packet, splitting it first if it is a TCP super-segment
+   * \param route the route
+   * \param packet the packet
+   * \param ipHeader the IPv4 header
+   * \param interface the output interface index
+   */
+  void SendOutgoing (Ptr<Ipv4Route> route, Ptr<Packet> packet, const Ipv4Header& ipHeader, int32_t interface);
+
   /**
    * \brief Process a packet fragment
    * \param packet the packet
@@ -0,0 +1,373 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef IPV4_PREFIX_TRIE_H
+#define IPV4_PREFIX_TRIE_H
+
+#include <stdint.h>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include "ns3/ipv4-address.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup ipv4Routing
+ *
+ * \brief Path-compressed binary trie (Patricia trie) of IPv4 prefixes.
+ *
+ * Each prefix holds any number of values, e.g. the routing table entries
+ * towards that network.  Lookup () walks at most 33 nodes, whatever the
+ * number of prefixes, and returns the values of every prefix matching
+ * the address.
+ *
+ * The values are returned in the order they were inserted, so that a
+ * routing protocol can run its usual selection (longest prefix, metric,
+ * ECMP, first match) over the few matching entries and get the same
+ * result as scanning its whole route list.
+ *
+ * Masks which are not a contiguous run of leading ones cannot be stored
+ * in the trie; their values are kept aside and checked on every lookup.
+ *
+ * \tparam T the value type, which must be copyable and comparable.
+ */
+template <typename T>
+class Ipv4PrefixTrie
+{
+public:
+  Ipv4PrefixTrie ();
+  ~Ipv4PrefixTrie ();
+
+  /**
+   * \brief Add a value to a prefix.
+   * \param network the network address (bits outside of the mask are ignored)
+   * \param mask the network mask
+   * \param value the value
+   */
+  void Insert (Ipv4Address network, Ipv4Mask mask, const T &value);
+
+  /**
+   * \brief Remove a value from a prefix.
+   * \param network the network address (bits outside of the mask are ignored)
+   * \param mask the network mask
+   * \param value the value
+   * \returns true if the value was found and removed
+   */
+  bool Remove (Ipv4Address network, Ipv4Mask mask, const T &value);
+
+  /**
+   * \brief Remove all the values.
+   */
+  void Clear (void);
+
+  /**
+   * \brief Get the values of all the prefixes matching an address.
+   * \param dest the address
+   * \param [out] values the matching values, in insertion order
+   */
+  void Lookup (Ipv4Address dest, std::vector<T> &values) const;
+
+private:
+  /// A value, with its insertion sequence number
+  typedef std::pair<uint64_t, T> Value;
+
+  /// A trie node, holding the values of one prefix
+  struct Node
+  {
+    uint32_t prefix;           //!< Prefix bits (host bits are zero)
+    uint8_t length;            //!< Prefix length
+    Node *child[2];            //!< Children, by the bit following the prefix
+    std::vector<Value> values; //!< Values of this prefix, empty for branching nodes
+  };
+
+  /// A value stored under a non-contiguous mask
+  struct Irregular
+  {
+    Ipv4Address network; //!< Network address
+    Ipv4Mask mask;       //!< Network mask
+    Value value;         //!< Value
+  };
+
+  /**
+   * \brief Copy constructor, disabled.
+   * \param o object to copy
+   */
+  Ipv4PrefixTrie (const Ipv4PrefixTrie &o);
+  /**
+   * \brief Assignment operator, disabled.
+   * \param o object to copy
+   * \returns this object
+   */
+  Ipv4PrefixTrie &operator = (const Ipv4PrefixTrie &o);
+
+  /**
+   * \brief Get the mask of a prefix length.
+   * \param length the prefix length
+   * \returns the mask bits
+   */
+  static uint32_t GetMaskBits (uint8_t length);
+  /**
+   * \brief Get one bit of an address.
+   * \param bits the address bits
+   * \param index the bit index, 0 being the most significant bit
+   * \returns the bit
+   */
+  static uint32_t GetBit (uint32_t bits, uint8_t index);
+  /**
+   * \brief Get the prefix length of a contiguous mask.
+   * \param mask the mask
+   * \param [out] length the prefix length
+   * \returns false if the mask is not contiguous
+   */
+  static bool GetLength (Ipv4Mask mask, uint8_t &length);
+  /**
+   * \brief Delete a sub-trie.
+   * \param node the sub-trie root
+   */
+  static void Delete (Node *node);
+
+  Node *m_root;                       //!< Root of the trie
+  std::vector<Irregular> m_irregular; //!< Values with a non-contiguous mask
+  uint64_t m_sequence;                //!< Next insertion sequence number
+};
+
+} // namespace ns3
+
+/***************************************************************
+ *  Implementation of the templates declared above.
+ ***************************************************************/
+
+namespace ns3 {
+
+template <typename T>
+Ipv4PrefixTrie<T>::Ipv4PrefixTrie ()
+  : m_root (0),
+    m_sequence (0)
+{
+}
+
+template <typename T>
+Ipv4PrefixTrie<T>::~Ipv4PrefixTrie ()
+{
+  Delete (m_root);
+}
+
+template <typename T>
+uint32_t
+Ipv4PrefixTrie<T>::GetMaskBits (uint8_t length)
+{
+  return length == 0 ? 0 : 0xffffffff << (32 - length);
+}
+
+template <typename T>
+uint32_t
+Ipv4PrefixTrie<T>::GetBit (uint32_t bits, uint8_t index)
+{
+  return (bits >> (31 - index)) & 1;
+}
+
+template <typename T>
+bool
+Ipv4PrefixTrie<T>::GetLength (Ipv4Mask mask, uint8_t &length)
+{
+  length = mask.GetPrefixLength ();
+  return mask.Get () == GetMaskBits (length);
+}
+
+template <typename T>
+void
+Ipv4PrefixTrie<T>::Delete (Node *node)
+{
+  if (node != 0)
+    {
+      Delete (node->child[0]);
+      Delete (node->child[1]);
+      delete node;
+    }
+}
+
+template <typename T>
+void
+Ipv4PrefixTrie<T>::Insert (Ipv4Address network, Ipv4Mask mask, const T &value)
+{
+  Value v = std::make_pair (m_sequence++, value);
+  uint8_t length;
+  if (!GetLength (mask, length))
+    {
+      Irregular irregular = { network, mask, v };
+      m_irregular.push_back (irregular);
+      return;
+    }
+  uint32_t prefix = network.Get () & GetMaskBits (length);
+
+  Node **link = &m_root;
+  while (true)
+    {
+      Node *node = *link;
+      if (node == 0)
+        {
+          node = new Node;
+          node->prefix = prefix;
+          node->length = length;
+          node->child[0] = node->child[1] = 0;
+          node->values.push_back (v);
+          *link = node;
+          return;
+        }
+      // Length of the prefix shared by the node and the new prefix
+      uint8_t common = std::min (length, node->length);
+      uint32_t diff = prefix ^ node->prefix;
+      for (uint8_t i = 0; i < common; i++)
+        {
+          if (GetBit (diff, i))
+            {
+              common = i;
+              break;
+            }
+        }
+      if (common < node->length)
+        {
+          // Split the edge above the node
+          Node *split = new Node;
+          split->prefix = prefix & GetMaskBits (common);
+          split->length = common;
+          split->child[0] = split->child[1] = 0;
+          split->child[GetBit (node->prefix, common)] = node;
+          *link = split;
+          if (common == length)
+            {
+              split->values.push_back (v);
+              return;
+            }
+          link = &split->child[GetBit (prefix, common)];
+          continue;
+        }
+      if (node->length == length)
+        {
+          node->values.push_back (v);
+          return;
+        }
+      link = &node->child[GetBit (prefix, node->length)];
+    }
+}
+
+template <typename T>
+bool
+Ipv4PrefixTrie<T>::Remove (Ipv4Address network, Ipv4Mask mask, const T &value)
+{
+  uint8_t length;
+  if (!GetLength (mask, length))
+    {
+      for (typename std::vector<Irregular>::iterator i = m_irregular.begin (); i != m_irregular.end (); i++)
+        {
+          if (i->mask == mask && i->value.second == value
+              && i->mask.IsMatch (i->network, network))
+            {
+              m_irregular.erase (i);
+              return true;
+            }
+        }
+      return false;
+    }
+  uint32_t prefix = network.Get () & GetMaskBits (length);
+
+  Node **link = &m_root;
+  while (*link != 0)
+    {
+      Node *node = *link;
+      if (node->length > length
+          || ((prefix ^ node->prefix) & GetMaskBits (node->length)) != 0)
+        {
+          return false;
+        }
+      if (node->length < length)
+        {
+          link = &node->child[GetBit (prefix, node->length)];
+          continue;
+        }
+      for (typename std::vector<Value>::iterator i = node->values.begin (); i != node->values.end (); i++)
+        {
+          if (i->second == value)
+            {
+              node->values.erase (i);
+              // Drop the node once it neither holds values nor branches
+              if (node->values.empty () && (node->child[0] == 0 || node->child[1] == 0))
+                {
+                  *link = node->child[0] != 0 ? node->child[0] : node->child[1];
+                  delete node;
+                }
+              return true;
+            }
+        }
+      return false;
+    }
+  return false;
+}
+
+template <typename T>
+void
+Ipv4PrefixTrie<T>::Clear (void)
+{
+  Delete (m_root);
+  m_root = 0;
+  m_irregular.clear ();
+}
+
+template <typename T>
+void
+Ipv4PrefixTrie<T>::Lookup (Ipv4Address dest, std::vector<T> &values) const
+{
+  uint32_t bits = dest.Get ();
+  std::vector<Value> found;
+  for (const Node *node = m_root; node != 0; )
+    {
+      if (((bits ^ node->prefix) & GetMaskBits (node->length)) != 0)
+        {
+          break;
+        }
+      found.insert (found.end (), node->values.begin (), node->values.end ());
+      if (node->length == 32)
+        {
+          break;
+        }
+      node = node->child[GetBit (bits, node->length)];
+    }
+  for (typename std::vector<Irregular>::const_iterator i = m_irregular.begin (); i != m_irregular.end (); i++)
+    {
+      if (i->mask.IsMatch (dest, i->network))
+        {
+          found.push_back (i->value);
+        }
+    }
+
+  if (found.size () > 1)
+    {
+      std::sort (found.begin (), found.end (),
+                 [] (const Value &a, const Value &b) { return a.first < b.first; });
+    }
+  values.clear ();
+  values.reserve (found.size ());
+  for (typename std::vector<Value>::const_iterator i = found.begin (); i != found.end (); i++)
+    {
+      values.push_back (i->second);
+    }
+}
+
+} // namespace ns3
+
+#endif /* IPV4_PREFIX_TRIE_H */
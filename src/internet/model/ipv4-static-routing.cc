@@ -73,6 +73,7 @@ Ipv4StaticRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         nextHop,
                                                         interface);
   m_networkRoutes.push_back (make_pair (route,metric));
+  m_networkRouteTrie.Insert (network, networkMask, make_pair (route,metric));
 }
 
 void 
@@ -87,6 +88,7 @@ Ipv4StaticRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         networkMask,
                                                         interface);
   m_networkRoutes.push_back (make_pair (route,metric));
+  m_networkRouteTrie.Insert (network, networkMask, make_pair (route,metric));
 }
 
 void 
@@ -144,6 +146,7 @@ Ipv4StaticRouting::SetDefaultMulticastRoute (uint32_t outputInterface)
                                                         networkMask,
                                                         outputInterface);
   m_networkRoutes.push_back (make_pair (route,0));
+  m_networkRouteTrie.Insert (network, networkMask, make_pair (route,0));
 }
 
 uint32_t 
@@ -240,8 +243,11 @@ Ipv4StaticRouting::LookupStatic (Ipv4Address dest, Ptr<NetDevice> oif)
     }
 
 
-  for (NetworkRoutesI i = m_networkRoutes.begin (); 
-       i != m_networkRoutes.end (); 
+  // Only the routes whose prefix matches, in m_networkRoutes order
+  std::vector<std::pair <Ipv4RoutingTableEntry *, uint32_t> > matches;
+  m_networkRouteTrie.Lookup (dest, matches);
+  for (std::vector<std::pair <Ipv4RoutingTableEntry *, uint32_t> >::const_iterator i = matches.begin (); 
+       i != matches.end (); 
        i++) 
     {
       Ipv4RoutingTableEntry *j=i->first;
@@ -447,6 +453,7 @@ Ipv4StaticRouting::RemoveRoute (uint32_t index)
     {
       if (tmp == index)
         {
+          m_networkRouteTrie.Remove (j->first->GetDestNetwork (), j->first->GetDestNetworkMask (), *j);
           delete j->first;
           m_networkRoutes.erase (j);
           return;
@@ -575,6 +582,7 @@ Ipv4StaticRouting::DoDispose (void)
     {
       delete (j->first);
     }
+  m_networkRouteTrie.Clear ();
   for (MulticastRoutesI i = m_multicastRoutes.begin (); 
        i != m_multicastRoutes.end (); 
        i = m_multicastRoutes.erase (i)) 
@@ -613,6 +621,7 @@ Ipv4StaticRouting::NotifyInterfaceDown (uint32_t i)
     {
       if (it->first->GetInterface () == i)
         {
+          m_networkRouteTrie.Remove (it->first->GetDestNetwork (), it->first->GetDestNetworkMask (), *it);
           delete it->first;
           it = m_networkRoutes.erase (it);
         }
@@ -660,6 +669,7 @@ Ipv4StaticRouting::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress
           && it->first->GetDestNetwork () == networkAddress
           && it->first->GetDestNetworkMask () == networkMask)
         {
+          m_networkRouteTrie.Remove (it->first->GetDestNetwork (), it->first->GetDestNetworkMask (), *it);
           delete it->first;
           it = m_networkRoutes.erase (it);
         }
@@ -31,6 +31,7 @@
 #include "ns3/ptr.h"
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
+#include "ipv4-prefix-trie.h"
 
 namespace ns3 {
 
@@ -418,6 +419,11 @@ private:
    */
   NetworkRoutes m_networkRoutes;
 
+  /**
+   * \brief the network routes indexed by destination prefix.
+   */
+  Ipv4PrefixTrie<std::pair <Ipv4RoutingTableEntry *, uint32_t> > m_networkRouteTrie;
+
   /**
    * \brief the forwarding table for multicast.
    */
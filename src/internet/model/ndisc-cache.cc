@@ -64,6 +64,7 @@ void NdiscCache::DoDispose ()
 {
   NS_LOG_FUNCTION_NOARGS ();
   Flush ();
+  m_nudEvent.Cancel ();
   m_device = 0;
   m_interface = 0;
   m_icmpv6 = 0;
@@ -109,12 +110,13 @@ std::list<NdiscCache::Entry*> NdiscCache::LookupInverse (Address dst)
   NS_LOG_FUNCTION (this << dst);
 
   std::list<NdiscCache::Entry *> entryList;
-  for (CacheI i = m_ndCache.begin (); i != m_ndCache.end (); i++)
+  std::pair<MacIndexI, MacIndexI> range = m_macIndex.equal_range (dst);
+  for (MacIndexI i = range.first; i != range.second; i++)
     {
       NdiscCache::Entry *entry = (*i).second;
       if (entry->GetMacAddress () == dst)
         {
-          NS_LOG_LOGIC ("Found an entry:" << (*i).first << " to " << (*i).second);
+          NS_LOG_LOGIC ("Found an entry:" << entry->GetIpv6Address () << " to " << entry);
           entryList.push_back (entry);
         }
     }
@@ -137,16 +139,17 @@ void NdiscCache::Remove (NdiscCache::Entry* entry)
 {
   NS_LOG_FUNCTION_NOARGS ();
 
-  for (CacheI i = m_ndCache.begin (); i != m_ndCache.end (); i++)
+  CacheI i = m_ndCache.find (entry->GetIpv6Address ());
+  if (i != m_ndCache.end () && (*i).second == entry)
     {
-      if ((*i).second == entry)
-        {
-          m_ndCache.erase (i);
-          entry->ClearWaitingPacket ();
-          delete entry;
-          return;
-        }
+      m_ndCache.erase (i);
+      NudCancel (entry);
+      MacIndexErase (entry);
+      entry->ClearWaitingPacket ();
+      delete entry;
+      return;
     }
+  NS_LOG_WARN ("Entry not found in this NDISC cache");
 }
 
 void NdiscCache::Flush ()
@@ -159,6 +162,98 @@ void NdiscCache::Flush ()
     }
 
   m_ndCache.erase (m_ndCache.begin (), m_ndCache.end ());
+  m_macIndex.clear ();
+  m_nudQueue.clear ();
+  m_nudEvent.Cancel ();
+}
+
+void NdiscCache::MacIndexInsert (NdiscCache::Entry *entry)
+{
+  NS_LOG_FUNCTION (this << entry);
+  if (!entry->m_macAddress.IsInvalid ())
+    {
+      m_macIndex.insert (std::make_pair (entry->m_macAddress, entry));
+    }
+}
+
+void NdiscCache::MacIndexErase (NdiscCache::Entry *entry)
+{
+  NS_LOG_FUNCTION (this << entry);
+  std::pair<MacIndexI, MacIndexI> range = m_macIndex.equal_range (entry->m_macAddress);
+  for (MacIndexI i = range.first; i != range.second; i++)
+    {
+      if ((*i).second == entry)
+        {
+          m_macIndex.erase (i);
+          return;
+        }
+    }
+}
+
+void NdiscCache::NudSchedule (NdiscCache::Entry *entry)
+{
+  NS_LOG_FUNCTION (this << entry << entry->m_nudExpire);
+
+  if (entry->m_nudQueued)
+    {
+      if (entry->m_nudNode->first <= entry->m_nudExpire)
+        {
+          /* postponed: the entry is queued again when it reaches the head */
+          return;
+        }
+      m_nudQueue.erase (entry->m_nudNode);
+    }
+  entry->m_nudNode = m_nudQueue.insert (std::make_pair (entry->m_nudExpire, entry));
+  entry->m_nudQueued = true;
+
+  if (!m_nudEvent.IsRunning () || entry->m_nudExpire < TimeStep (m_nudEvent.GetTs ()))
+    {
+      m_nudEvent.Cancel ();
+      m_nudEvent = Simulator::Schedule (entry->m_nudExpire - Simulator::Now (),
+                                        &NdiscCache::HandleNudTimeout, this);
+    }
+}
+
+void NdiscCache::NudCancel (NdiscCache::Entry *entry)
+{
+  NS_LOG_FUNCTION (this << entry);
+
+  if (entry->m_nudQueued)
+    {
+      m_nudQueue.erase (entry->m_nudNode);
+      entry->m_nudQueued = false;
+    }
+  /* the event is left pending, and finds nothing to expire at worst */
+}
+
+void NdiscCache::HandleNudTimeout ()
+{
+  NS_LOG_FUNCTION (this);
+
+  Time now = Simulator::Now ();
+  while (!m_nudQueue.empty () && m_nudQueue.begin ()->first <= now)
+    {
+      NdiscCache::Entry *entry = m_nudQueue.begin ()->second;
+      m_nudQueue.erase (m_nudQueue.begin ());
+      entry->m_nudQueued = false;
+
+      if (entry->m_nudExpire > now)
+        {
+          entry->m_nudNode = m_nudQueue.insert (std::make_pair (entry->m_nudExpire, entry));
+          entry->m_nudQueued = true;
+          continue;
+        }
+
+      /* the timeout functions may re-arm the timer or remove the entry */
+      (entry->*(entry->m_nudFunction))();
+    }
+
+  m_nudEvent.Cancel ();
+  if (!m_nudQueue.empty ())
+    {
+      m_nudEvent = Simulator::Schedule (m_nudQueue.begin ()->first - now,
+                                        &NdiscCache::HandleNudTimeout, this);
+    }
 }
 
 void NdiscCache::SetUnresQlen (uint32_t unresQlen)
@@ -228,7 +323,8 @@ NdiscCache::Entry::Entry (NdiscCache* nd)
   : m_ndCache (nd),
     m_waiting (),
     m_router (false),
-    m_nudTimer (Timer::CANCEL_ON_DESTROY),
+    m_nudFunction (0),
+    m_nudQueued (false),
     m_lastReachabilityConfirmation (Seconds (0.0)),
     m_nsRetransmit (0)
 {
@@ -408,6 +504,21 @@ void NdiscCache::Entry::SetIpv6Address (Ipv6Address ipv6Address)
   m_ipv6Address = ipv6Address;
 }
 
+Ipv6Address NdiscCache::Entry::GetIpv6Address () const
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  return m_ipv6Address;
+}
+
+void NdiscCache::Entry::ScheduleNudTimer (void (NdiscCache::Entry::*function)(), Time delay)
+{
+  NS_LOG_FUNCTION (this << delay);
+  m_nudFunction = function;
+  m_nudDelay = delay;
+  m_nudExpire = Simulator::Now () + delay;
+  m_ndCache->NudSchedule (this);
+}
+
 Time NdiscCache::Entry::GetLastReachabilityConfirmation () const
 {
   NS_LOG_FUNCTION_NOARGS ();
@@ -417,15 +528,9 @@ Time NdiscCache::Entry::GetLastReachabilityConfirmation () const
 void NdiscCache::Entry::StartReachableTimer ()
 {
   NS_LOG_FUNCTION_NOARGS ();
-  if (m_nudTimer.IsRunning ())
-    {
-      m_nudTimer.Cancel ();
-    }
-
   m_lastReachabilityConfirmation = Simulator::Now ();
-  m_nudTimer.SetFunction (&NdiscCache::Entry::FunctionReachableTimeout, this);
-  m_nudTimer.SetDelay (m_ndCache->m_icmpv6->GetReachableTime ());
-  m_nudTimer.Schedule ();
+  ScheduleNudTimer (&NdiscCache::Entry::FunctionReachableTimeout,
+                    m_ndCache->m_icmpv6->GetReachableTime ());
 }
 
 void NdiscCache::Entry::UpdateReachableTimer ()
@@ -435,57 +540,38 @@ void NdiscCache::Entry::UpdateReachableTimer ()
   if (m_state == REACHABLE)
     {
       m_lastReachabilityConfirmation = Simulator::Now ();
-      if (m_nudTimer.IsRunning ())
+      if (m_nudFunction)
         {
-          m_nudTimer.Cancel ();
+          ScheduleNudTimer (m_nudFunction, m_nudDelay);
         }
-      m_nudTimer.Schedule ();
     }
 }
 
 void NdiscCache::Entry::StartProbeTimer ()
 {
   NS_LOG_FUNCTION_NOARGS ();
-  if (m_nudTimer.IsRunning ())
-    {
-      m_nudTimer.Cancel ();
-    }
-
-  m_nudTimer.SetFunction (&NdiscCache::Entry::FunctionProbeTimeout, this);
-  m_nudTimer.SetDelay (m_ndCache->m_icmpv6->GetRetransmissionTime ());
-  m_nudTimer.Schedule ();
+  ScheduleNudTimer (&NdiscCache::Entry::FunctionProbeTimeout,
+                    m_ndCache->m_icmpv6->GetRetransmissionTime ());
 }
 
 void NdiscCache::Entry::StartDelayTimer ()
 {
   NS_LOG_FUNCTION_NOARGS ();
-  if (m_nudTimer.IsRunning ())
-    {
-      m_nudTimer.Cancel ();
-    }
-
-  m_nudTimer.SetFunction (&NdiscCache::Entry::FunctionDelayTimeout, this);
-  m_nudTimer.SetDelay (m_ndCache->m_icmpv6->GetDelayFirstProbe ());
-  m_nudTimer.Schedule ();
+  ScheduleNudTimer (&NdiscCache::Entry::FunctionDelayTimeout,
+                    m_ndCache->m_icmpv6->GetDelayFirstProbe ());
 }
 
 void NdiscCache::Entry::StartRetransmitTimer ()
 {
   NS_LOG_FUNCTION_NOARGS ();
-  if (m_nudTimer.IsRunning ())
-    {
-      m_nudTimer.Cancel ();
-    }
-
-  m_nudTimer.SetFunction (&NdiscCache::Entry::FunctionRetransmitTimeout, this);
-  m_nudTimer.SetDelay (m_ndCache->m_icmpv6->GetRetransmissionTime ());
-  m_nudTimer.Schedule ();
+  ScheduleNudTimer (&NdiscCache::Entry::FunctionRetransmitTimeout,
+                    m_ndCache->m_icmpv6->GetRetransmissionTime ());
 }
 
 void NdiscCache::Entry::StopNudTimer ()
 {
   NS_LOG_FUNCTION_NOARGS ();
-  m_nudTimer.Cancel ();
+  m_ndCache->NudCancel (this);
   m_nsRetransmit = 0;
 }
 
@@ -504,7 +590,7 @@ std::list<NdiscCache::Ipv6PayloadHeaderPair> NdiscCache::Entry::MarkReachable (A
 {
   NS_LOG_FUNCTION (this << mac);
   m_state = REACHABLE;
-  m_macAddress = mac;
+  SetMacAddress (mac);
   return m_waiting;
 }
 
@@ -530,7 +616,7 @@ std::list<NdiscCache::Ipv6PayloadHeaderPair> NdiscCache::Entry::MarkStale (Addre
 {
   NS_LOG_FUNCTION (this << mac);
   m_state = STALE;
-  m_macAddress = mac;
+  SetMacAddress (mac);
   return m_waiting;
 }
 
@@ -592,7 +678,9 @@ Address NdiscCache::Entry::GetMacAddress () const
 void NdiscCache::Entry::SetMacAddress (Address mac)
 {
   NS_LOG_FUNCTION (this << mac << int(m_state));
+  m_ndCache->MacIndexErase (this);
   m_macAddress = mac;
+  m_ndCache->MacIndexInsert (this);
 }
 
 } /* namespace ns3 */
@@ -23,13 +23,14 @@
 
 #include <stdint.h>
 #include <list>
+#include <map>
 
 #include "ns3/packet.h"
 #include "ns3/nstime.h"
 #include "ns3/net-device.h"
 #include "ns3/ipv6-address.h"
 #include "ns3/ptr.h"
-#include "ns3/timer.h"
+#include "ns3/simulator.h"
 #include "ns3/sgi-hashmap.h"
 #include "ns3/output-stream-wrapper.h"
 
@@ -93,6 +94,10 @@ public:
 
   /**
    * \brief Lookup in the cache for a MAC address.
+   *
+   * The lookup uses an index on the MAC address of the entries, so that
+   * entries without a MAC address are never returned.
+   *
    * \param dst destination MAC address.
    * \return a list of matching entries.
    */
@@ -342,7 +347,26 @@ public:
      */
     void SetIpv6Address (Ipv6Address ipv6Address);
 
+    /**
+     * \brief Get the IPv6 address.
+     * \return the IPv6 address
+     */
+    Ipv6Address GetIpv6Address () const;
+
 private:
+    friend class NdiscCache;
+
+    /**
+     * \brief Arm the NUD timer.
+     *
+     * The timer is driven by the expiry queue of the cache, which
+     * schedules a single event for all of its entries.
+     *
+     * \param function the function to call when the timer expires
+     * \param delay the delay before the expiration
+     */
+    void ScheduleNudTimer (void (NdiscCache::Entry::*function)(), Time delay);
+
     /**
      * \brief The IPv6 address.
      */
@@ -387,9 +411,33 @@ private:
     bool m_router;
 
     /**
-     * \brief Timer (used for NUD).
+     * \brief Function called when the NUD timer expires.
      */
-    Timer m_nudTimer;
+    void (NdiscCache::Entry::*m_nudFunction)();
+
+    /**
+     * \brief Delay of the NUD timer.
+     */
+    Time m_nudDelay;
+
+    /**
+     * \brief Expiration time of the NUD timer.
+     */
+    Time m_nudExpire;
+
+    /**
+     * \brief True if the entry is in the expiry queue of the cache.
+     */
+    bool m_nudQueued;
+
+    /**
+     * \brief Position of the entry in the expiry queue of the cache.
+     *
+     * The position may be earlier than the expiration time, when the
+     * timer has been postponed: the entry is then queued again when it
+     * reaches the head of the queue.
+     */
+    std::multimap<Time, NdiscCache::Entry *>::iterator m_nudNode;
 
     /**
      * \brief Last time we see a reachability confirmation.
@@ -411,6 +459,52 @@ private:
    * \brief Neighbor Discovery Cache container iterator
    */
   typedef sgi::hash_map<Ipv6Address, NdiscCache::Entry *, Ipv6AddressHash>::iterator CacheI;
+  /**
+   * \brief Index of the Neighbor Discovery Cache entries by MAC address
+   */
+  typedef sgi::hash_multimap<Address, NdiscCache::Entry *, AddressHash> MacIndex;
+  /**
+   * \brief Index of the Neighbor Discovery Cache entries by MAC address iterator
+   */
+  typedef sgi::hash_multimap<Address, NdiscCache::Entry *, AddressHash>::iterator MacIndexI;
+  /**
+   * \brief Expiry queue of the NUD timers, by expiration time
+   */
+  typedef std::multimap<Time, NdiscCache::Entry *> NudQueue;
+
+  /**
+   * \brief Add an entry to the MAC address index, if it has a MAC address
+   * \param entry the entry
+   */
+  void MacIndexInsert (NdiscCache::Entry *entry);
+
+  /**
+   * \brief Remove an entry from the MAC address index
+   * \param entry the entry
+   */
+  void MacIndexErase (NdiscCache::Entry *entry);
+
+  /**
+   * \brief Queue the NUD timer of an entry
+   *
+   * A timer postponed since it was queued keeps its position, and is
+   * queued again when it reaches the head of the queue: refreshing the
+   * reachable timer of an entry does not touch the event queue.
+   *
+   * \param entry the entry
+   */
+  void NudSchedule (NdiscCache::Entry *entry);
+
+  /**
+   * \brief Remove the NUD timer of an entry from the expiry queue
+   * \param entry the entry
+   */
+  void NudCancel (NdiscCache::Entry *entry);
+
+  /**
+   * \brief Expire the NUD timers that reached their expiration time
+   */
+  void HandleNudTimeout ();
 
   /**
    * \brief Copy constructor.
@@ -452,6 +546,21 @@ private:
    */
   Cache m_ndCache;
 
+  /**
+   * \brief The entries, by MAC address.
+   */
+  MacIndex m_macIndex;
+
+  /**
+   * \brief The running NUD timers, by expiration time.
+   */
+  NudQueue m_nudQueue;
+
+  /**
+   * \brief The event expiring the head of m_nudQueue.
+   */
+  EventId m_nudEvent;
+
   /**
    * \brief Max number of packet stored in m_waiting.
    */
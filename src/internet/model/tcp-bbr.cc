@@ -0,0 +1,778 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#include "tcp-bbr.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/double.h"
+#include "ns3/uinteger.h"
+#include <cmath>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TcpBbr");
+NS_OBJECT_ENSURE_REGISTERED (TcpBbr);
+
+/** Number of phases of the PROBE_BW gain cycle */
+static const uint32_t GAIN_CYCLE_LENGTH = 8;
+
+/** Pacing gains of the PROBE_BW phases: probe, drain, then cruise */
+static const double PACING_GAIN_CYCLE[GAIN_CYCLE_LENGTH] = {5.0 / 4, 3.0 / 4, 1, 1, 1, 1, 1, 1};
+
+/** Window gain in PROBE_BW, to tolerate delayed and stretched ACKs */
+static const double CWND_GAIN = 2;
+
+/** Growth of the bandwidth that keeps STARTUP going */
+static const double FULL_BW_THRESH = 5.0 / 4;
+
+/** Rounds without growth of the bandwidth that end STARTUP */
+static const uint32_t FULL_BW_COUNT = 3;
+
+/** Minimum window (segments), also used in PROBE_RTT */
+static const uint32_t MIN_PIPE_CWND = 4;
+
+const char* const
+TcpBbr::BbrModeName[BBR_PROBE_RTT + 1] =
+{
+  "BBR_STARTUP", "BBR_DRAIN", "BBR_PROBE_BW", "BBR_PROBE_RTT"
+};
+
+TypeId
+TcpBbr::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TcpBbr")
+    .SetParent<TcpCongestionOps> ()
+    .AddConstructor<TcpBbr> ()
+    .SetGroupName ("Internet")
+    .AddAttribute ("HighGain", "Pacing and window gain of STARTUP; the default, "
+                   "2/ln(2), is the smallest gain that doubles the rate each round",
+                   DoubleValue (2.0 / std::log (2.0)),
+                   MakeDoubleAccessor (&TcpBbr::m_highGain),
+                   MakeDoubleChecker<double> (1.0))
+    .AddAttribute ("BwWindowLength", "Length of the max bandwidth filter (rounds)",
+                   UintegerValue (10),
+                   MakeUintegerAccessor (&TcpBbr::m_bwWindowLength),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("RttWindowLength", "Length of the min RTT filter",
+                   TimeValue (Seconds (10)),
+                   MakeTimeAccessor (&TcpBbr::m_minRttWindowLength),
+                   MakeTimeChecker ())
+    .AddAttribute ("ProbeRttDuration", "Minimum time spent in PROBE_RTT",
+                   TimeValue (MilliSeconds (200)),
+                   MakeTimeAccessor (&TcpBbr::m_probeRttDuration),
+                   MakeTimeChecker ())
+    .AddAttribute ("PacingMargin", "Fraction of the bandwidth estimate left unused "
+                   "when pacing, to drain the queues at the bottleneck",
+                   DoubleValue (0.01),
+                   MakeDoubleAccessor (&TcpBbr::m_pacingMargin),
+                   MakeDoubleChecker<double> (0.0, 1.0))
+  ;
+  return tid;
+}
+
+TcpBbr::TcpBbr ()
+  : TcpCongestionOps (),
+    m_state (BBR_STARTUP),
+    m_pacingGain (1),
+    m_cWndGain (1),
+    m_roundCount (0),
+    m_roundStart (false),
+    m_nextRoundDelivered (0),
+    m_minRtt (Time::Max ()),
+    m_minRttStamp (Seconds (0)),
+    m_probeRttDoneStamp (Seconds (0)),
+    m_probeRttRoundDone (false),
+    m_packetConservation (false),
+    m_priorCwnd (0),
+    m_idleRestart (false),
+    m_prevCaState (TcpSocketState::CA_OPEN),
+    m_fullBwReached (false),
+    m_fullBw (0),
+    m_fullBwCount (0),
+    m_cycleIndex (0),
+    m_cycleStamp (Seconds (0)),
+    m_hasSeenRtt (false)
+{
+  NS_LOG_FUNCTION (this);
+  m_uv = CreateObject<UniformRandomVariable> ();
+}
+
+TcpBbr::TcpBbr (const TcpBbr &sock)
+  : TcpCongestionOps (sock),
+    m_highGain (sock.m_highGain),
+    m_bwWindowLength (sock.m_bwWindowLength),
+    m_minRttWindowLength (sock.m_minRttWindowLength),
+    m_probeRttDuration (sock.m_probeRttDuration),
+    m_pacingMargin (sock.m_pacingMargin),
+    m_state (sock.m_state),
+    m_pacingGain (sock.m_pacingGain),
+    m_cWndGain (sock.m_cWndGain),
+    m_roundCount (sock.m_roundCount),
+    m_roundStart (sock.m_roundStart),
+    m_nextRoundDelivered (sock.m_nextRoundDelivered),
+    m_minRtt (sock.m_minRtt),
+    m_minRttStamp (sock.m_minRttStamp),
+    m_probeRttDoneStamp (sock.m_probeRttDoneStamp),
+    m_probeRttRoundDone (sock.m_probeRttRoundDone),
+    m_packetConservation (sock.m_packetConservation),
+    m_priorCwnd (sock.m_priorCwnd),
+    m_idleRestart (sock.m_idleRestart),
+    m_prevCaState (sock.m_prevCaState),
+    m_fullBwReached (sock.m_fullBwReached),
+    m_fullBw (sock.m_fullBw),
+    m_fullBwCount (sock.m_fullBwCount),
+    m_cycleIndex (sock.m_cycleIndex),
+    m_cycleStamp (sock.m_cycleStamp),
+    m_hasSeenRtt (sock.m_hasSeenRtt)
+{
+  NS_LOG_FUNCTION (this);
+  for (uint32_t i = 0; i < 3; ++i)
+    {
+      m_maxBwFilter[i] = sock.m_maxBwFilter[i];
+    }
+  m_uv = CreateObject<UniformRandomVariable> ();
+}
+
+int64_t
+TcpBbr::AssignStreams (int64_t stream)
+{
+  NS_LOG_FUNCTION (this << stream);
+  m_uv->SetStream (stream);
+  return 1;
+}
+
+std::string
+TcpBbr::GetName () const
+{
+  return "TcpBbr";
+}
+
+Ptr<TcpCongestionOps>
+TcpBbr::Fork ()
+{
+  return CopyObject<TcpBbr> (this);
+}
+
+bool
+TcpBbr::HasCongControl () const
+{
+  return true;
+}
+
+void
+TcpBbr::Init (Ptr<TcpSocketState> tcb)
+{
+  NS_LOG_FUNCTION (this << tcb);
+
+  // BBR relies on pacing: without it, the window alone would send bursts
+  // at line rate into the (possibly shallow) bottleneck queue
+  tcb->m_pacing = true;
+
+  m_minRtt = tcb->m_minRtt;
+  m_minRttStamp = Simulator::Now ();
+  m_priorCwnd = 0;
+  m_prevCaState = TcpSocketState::CA_OPEN;
+  m_nextRoundDelivered = 0;
+  m_roundCount = 0;
+  m_roundStart = false;
+  m_idleRestart = false;
+  m_fullBwReached = false;
+  m_fullBw = DataRate (0);
+  m_fullBwCount = 0;
+  m_packetConservation = false;
+  m_probeRttDoneStamp = Seconds (0);
+  m_probeRttRoundDone = false;
+  m_cycleIndex = 0;
+  m_cycleStamp = Simulator::Now ();
+  m_hasSeenRtt = false;
+  for (uint32_t i = 0; i < 3; ++i)
+    {
+      m_maxBwFilter[i] = MaxBwSample ();
+    }
+
+  EnterStartup ();
+  InitPacingRateFromRtt (tcb);
+}
+
+void
+TcpBbr::UpdateMaxBwFilter (uint32_t round, DataRate bw)
+{
+  NS_LOG_FUNCTION (this << round << bw);
+
+  MaxBwSample val;
+  val.m_round = round;
+  val.m_bw = bw;
+
+  // Reset the filter if the sample is a new maximum, or if nothing has
+  // been measured for a whole window
+  if (bw >= m_maxBwFilter[0].m_bw || round - m_maxBwFilter[2].m_round > m_bwWindowLength)
+    {
+      m_maxBwFilter[0] = m_maxBwFilter[1] = m_maxBwFilter[2] = val;
+      return;
+    }
+
+  if (bw >= m_maxBwFilter[1].m_bw)
+    {
+      m_maxBwFilter[2] = m_maxBwFilter[1] = val;
+    }
+  else if (bw >= m_maxBwFilter[2].m_bw)
+    {
+      m_maxBwFilter[2] = val;
+    }
+
+  // Expire the best sample (and the second one if it is also too old),
+  // or refresh the second and third ones once a quarter and half of the
+  // window has passed
+  uint32_t dt = round - m_maxBwFilter[0].m_round;
+  if (dt > m_bwWindowLength)
+    {
+      m_maxBwFilter[0] = m_maxBwFilter[1];
+      m_maxBwFilter[1] = m_maxBwFilter[2];
+      m_maxBwFilter[2] = val;
+      if (round - m_maxBwFilter[0].m_round > m_bwWindowLength)
+        {
+          m_maxBwFilter[0] = m_maxBwFilter[1];
+          m_maxBwFilter[1] = m_maxBwFilter[2];
+          m_maxBwFilter[2] = val;
+        }
+    }
+  else if (m_maxBwFilter[1].m_round == m_maxBwFilter[0].m_round && dt > m_bwWindowLength / 4)
+    {
+      m_maxBwFilter[2] = m_maxBwFilter[1] = val;
+    }
+  else if (m_maxBwFilter[2].m_round == m_maxBwFilter[1].m_round && dt > m_bwWindowLength / 2)
+    {
+      m_maxBwFilter[2] = val;
+    }
+}
+
+DataRate
+TcpBbr::GetMaxBw () const
+{
+  return m_maxBwFilter[0].m_bw;
+}
+
+uint32_t
+TcpBbr::InFlight (Ptr<const TcpSocketState> tcb, DataRate bw, double gain) const
+{
+  NS_LOG_FUNCTION (this << tcb << bw << gain);
+
+  if (m_minRtt == Time::Max ())
+    {
+      // No RTT sample yet: keep the initial window
+      return tcb->m_initialCWnd * tcb->m_segmentSize;
+    }
+
+  double bdp = bw.GetBitRate () * m_minRtt.GetSeconds () / 8.0;
+  uint32_t segs = static_cast<uint32_t> (std::ceil (gain * bdp / tcb->m_segmentSize));
+
+  // Allow enough data in flight to keep the sender busy while the ACKs of
+  // the last segments are on their way, and round up to an even number of
+  // segments to avoid a stall with delayed ACKs
+  segs += 3;
+  segs = (segs + 1) & ~1U;
+
+  // Ensure that the probing phase of the gain cycle actually probes
+  if (m_state == BBR_PROBE_BW && m_cycleIndex == 0)
+    {
+      segs += 2;
+    }
+
+  return segs * tcb->m_segmentSize;
+}
+
+void
+TcpBbr::SetPacingRate (Ptr<TcpSocketState> tcb, double gain)
+{
+  NS_LOG_FUNCTION (this << tcb << gain);
+
+  if (!m_hasSeenRtt && tcb->m_minRtt != Time::Max ())
+    {
+      InitPacingRateFromRtt (tcb);
+    }
+
+  DataRate bw = GetMaxBw ();
+  if (bw.GetBitRate () == 0)
+    {
+      return;
+    }
+
+  DataRate rate (static_cast<uint64_t> (gain * bw.GetBitRate () * (1 - m_pacingMargin)));
+  rate = std::min (rate, tcb->m_maxPacingRate);
+
+  // Do not slow down below the initial rate before the pipe is full
+  if (m_fullBwReached || rate > tcb->m_currentPacingRate)
+    {
+      NS_LOG_DEBUG ("Pacing rate " << tcb->m_currentPacingRate << " -> " << rate);
+      tcb->m_currentPacingRate = rate;
+    }
+}
+
+void
+TcpBbr::InitPacingRateFromRtt (Ptr<TcpSocketState> tcb)
+{
+  NS_LOG_FUNCTION (this << tcb);
+
+  Time rtt;
+  if (tcb->m_minRtt != Time::Max ())
+    {
+      rtt = tcb->m_minRtt;
+      m_hasSeenRtt = true;
+    }
+  else
+    {
+      rtt = MilliSeconds (1);
+    }
+
+  // Send the initial window at the STARTUP rate over one RTT
+  double bw = tcb->m_cWnd * 8.0 / rtt.GetSeconds ();
+  DataRate rate (static_cast<uint64_t> (m_highGain * bw * (1 - m_pacingMargin)));
+  tcb->m_currentPacingRate = std::min (rate, tcb->m_maxPacingRate);
+  NS_LOG_DEBUG ("Initial pacing rate " << tcb->m_currentPacingRate << " from RTT " << rtt);
+}
+
+void
+TcpBbr::UpdateBandwidth (const TcpRateOps::TcpRateConnection &rc,
+                         const TcpRateOps::TcpRateSample &rs)
+{
+  NS_LOG_FUNCTION (this);
+
+  m_roundStart = false;
+  if (!rs.IsValid ())
+    {
+      return;
+    }
+
+  // A round ends when a segment sent after the beginning of the round is
+  // delivered
+  if (rs.m_priorDelivered >= m_nextRoundDelivered)
+    {
+      m_nextRoundDelivered = rc.m_delivered;
+      ++m_roundCount;
+      m_roundStart = true;
+      m_packetConservation = false;
+      NS_LOG_DEBUG ("Starting round " << m_roundCount);
+    }
+
+  // An app-limited sample only underestimates the bandwidth, unless it is
+  // higher than the current estimate
+  if (!rs.m_isAppLimited || rs.m_deliveryRate >= GetMaxBw ())
+    {
+      UpdateMaxBwFilter (m_roundCount, rs.m_deliveryRate);
+    }
+}
+
+bool
+TcpBbr::IsNextCyclePhase (Ptr<TcpSocketState> tcb, const TcpRateOps::TcpRateSample &rs) const
+{
+  NS_LOG_FUNCTION (this << tcb);
+
+  bool isFullLength = (Simulator::Now () - m_cycleStamp) > m_minRtt;
+
+  if (m_pacingGain == 1)
+    {
+      return isFullLength;
+    }
+
+  // Probe until the queue is (likely) built, or losses appear
+  if (m_pacingGain > 1)
+    {
+      return isFullLength
+             && (rs.m_bytesLoss > 0
+                 || rs.m_priorInFlight >= InFlight (tcb, GetMaxBw (), m_pacingGain));
+    }
+
+  // Drain until the queue built by the probe is (likely) gone
+  return isFullLength || rs.m_priorInFlight <= InFlight (tcb, GetMaxBw (), 1);
+}
+
+void
+TcpBbr::AdvanceCyclePhase ()
+{
+  NS_LOG_FUNCTION (this);
+  m_cycleIndex = (m_cycleIndex + 1) % GAIN_CYCLE_LENGTH;
+  m_cycleStamp = Simulator::Now ();
+  NS_LOG_DEBUG ("Gain cycle phase " << m_cycleIndex);
+}
+
+void
+TcpBbr::UpdateCyclePhase (Ptr<TcpSocketState> tcb, const TcpRateOps::TcpRateSample &rs)
+{
+  NS_LOG_FUNCTION (this << tcb);
+  if (m_state == BBR_PROBE_BW && IsNextCyclePhase (tcb, rs))
+    {
+      AdvanceCyclePhase ();
+    }
+}
+
+void
+TcpBbr::CheckFullBwReached (const TcpRateOps::TcpRateSample &rs)
+{
+  NS_LOG_FUNCTION (this);
+
+  if (m_fullBwReached || !m_roundStart || rs.m_isAppLimited)
+    {
+      return;
+    }
+
+  DataRate maxBw = GetMaxBw ();
+  if (maxBw.GetBitRate () >= m_fullBw.GetBitRate () * FULL_BW_THRESH)
+    {
+      m_fullBw = maxBw;
+      m_fullBwCount = 0;
+      return;
+    }
+
+  ++m_fullBwCount;
+  m_fullBwReached = m_fullBwCount >= FULL_BW_COUNT;
+  if (m_fullBwReached)
+    {
+      NS_LOG_DEBUG ("Full bandwidth reached: " << m_fullBw);
+    }
+}
+
+void
+TcpBbr::CheckDrain (Ptr<TcpSocketState> tcb)
+{
+  NS_LOG_FUNCTION (this << tcb);
+
+  if (m_state == BBR_STARTUP && m_fullBwReached)
+    {
+      EnterDrain ();
+      tcb->m_ssThresh = InFlight (tcb, GetMaxBw (), 1);
+    }
+
+  if (m_state == BBR_DRAIN && tcb->m_bytesInFlight <= InFlight (tcb, GetMaxBw (), 1))
+    {
+      EnterProbeBw ();
+    }
+}
+
+void
+TcpBbr::UpdateMinRtt (Ptr<TcpSocketState> tcb, const TcpRateOps::TcpRateConnection &rc,
+                      const TcpRateOps::TcpRateSample &rs)
+{
+  NS_LOG_FUNCTION (this << tcb);
+
+  Time now = Simulator::Now ();
+  bool filterExpired = now > m_minRttStamp + m_minRttWindowLength;
+
+  Time rtt = tcb->m_lastRtt;
+  if (rtt.IsStrictlyPositive () && (rtt < m_minRtt || filterExpired))
+    {
+      NS_LOG_DEBUG ("Min RTT " << m_minRtt << " -> " << rtt);
+      m_minRtt = rtt;
+      m_minRttStamp = now;
+    }
+
+  if (m_probeRttDuration.IsStrictlyPositive () && filterExpired
+      && !m_idleRestart && m_state != BBR_PROBE_RTT)
+    {
+      EnterProbeRtt ();
+      SaveCwnd (tcb);
+      m_probeRttDoneStamp = Seconds (0);
+    }
+
+  if (m_state == BBR_PROBE_RTT)
+    {
+      // Wait for the data in flight to drop to the minimum window, then
+      // stay there for ProbeRttDuration and at least one round
+      if (m_probeRttDoneStamp.IsZero ()
+          && tcb->m_bytesInFlight <= MIN_PIPE_CWND * tcb->m_segmentSize)
+        {
+          m_probeRttDoneStamp = now + m_probeRttDuration;
+          m_probeRttRoundDone = false;
+          m_nextRoundDelivered = rc.m_delivered;
+        }
+      else if (!m_probeRttDoneStamp.IsZero ())
+        {
+          if (m_roundStart)
+            {
+              m_probeRttRoundDone = true;
+            }
+          if (m_probeRttRoundDone && now > m_probeRttDoneStamp)
+            {
+              m_minRttStamp = now;
+              RestoreCwnd (tcb);
+              ResetMode ();
+            }
+        }
+    }
+
+  if (rs.m_delivered > 0)
+    {
+      m_idleRestart = false;
+    }
+}
+
+void
+TcpBbr::UpdateGains ()
+{
+  NS_LOG_FUNCTION (this);
+  switch (m_state)
+    {
+    case BBR_STARTUP:
+      m_pacingGain = m_highGain;
+      m_cWndGain = m_highGain;
+      break;
+    case BBR_DRAIN:
+      m_pacingGain = 1 / m_highGain;
+      m_cWndGain = m_highGain;
+      break;
+    case BBR_PROBE_BW:
+      m_pacingGain = PACING_GAIN_CYCLE[m_cycleIndex];
+      m_cWndGain = CWND_GAIN;
+      break;
+    case BBR_PROBE_RTT:
+      m_pacingGain = 1;
+      m_cWndGain = 1;
+      break;
+    default:
+      NS_FATAL_ERROR ("BBR should not be in this state");
+      break;
+    }
+}
+
+void
+TcpBbr::UpdateModel (Ptr<TcpSocketState> tcb, const TcpRateOps::TcpRateConnection &rc,
+                     const TcpRateOps::TcpRateSample &rs)
+{
+  NS_LOG_FUNCTION (this << tcb);
+  UpdateBandwidth (rc, rs);
+  UpdateCyclePhase (tcb, rs);
+  CheckFullBwReached (rs);
+  CheckDrain (tcb);
+  UpdateMinRtt (tcb, rc, rs);
+  UpdateGains ();
+}
+
+bool
+TcpBbr::SetCwndToRecoverOrRestore (Ptr<TcpSocketState> tcb,
+                                   const TcpRateOps::TcpRateConnection &rc,
+                                   const TcpRateOps::TcpRateSample &rs,
+                                   uint32_t *newCwnd)
+{
+  NS_LOG_FUNCTION (this << tcb);
+
+  TcpSocketState::TcpCongState_t state = tcb->m_congState;
+  uint32_t cwnd = tcb->m_cWnd;
+  uint32_t inFlight = tcb->m_bytesInFlight;
+
+  // An ACK for a loss-marked segment means it has left the network
+  if (rs.m_bytesLoss > 0)
+    {
+      cwnd = std::max<int64_t> (static_cast<int64_t> (cwnd) - rs.m_bytesLoss,
+                                tcb->m_segmentSize);
+    }
+
+  if (state == TcpSocketState::CA_RECOVERY && m_prevCaState != TcpSocketState::CA_RECOVERY)
+    {
+      // Starting the first round of recovery: send one segment per
+      // segment delivered
+      m_packetConservation = true;
+      m_nextRoundDelivered = rc.m_delivered;
+      cwnd = inFlight + rs.m_ackedSacked;
+    }
+  else if (m_prevCaState >= TcpSocketState::CA_RECOVERY
+           && state < TcpSocketState::CA_RECOVERY)
+    {
+      // Exiting loss recovery: restore the window
+      cwnd = std::max (cwnd, m_priorCwnd);
+      m_packetConservation = false;
+    }
+  m_prevCaState = state;
+
+  if (m_packetConservation)
+    {
+      *newCwnd = std::max (cwnd, inFlight + rs.m_ackedSacked);
+      return true;
+    }
+
+  *newCwnd = cwnd;
+  return false;
+}
+
+void
+TcpBbr::SetCwnd (Ptr<TcpSocketState> tcb, const TcpRateOps::TcpRateConnection &rc,
+                 const TcpRateOps::TcpRateSample &rs)
+{
+  NS_LOG_FUNCTION (this << tcb);
+
+  uint32_t cwnd = tcb->m_cWnd;
+
+  if (rs.m_ackedSacked > 0 && !SetCwndToRecoverOrRestore (tcb, rc, rs, &cwnd))
+    {
+      uint32_t target = InFlight (tcb, GetMaxBw (), m_cWndGain);
+
+      // Grow up to the target once the pipe is full; before, slow start
+      // towards it, never going below the initial window
+      if (m_fullBwReached)
+        {
+          cwnd = std::min (cwnd + rs.m_ackedSacked, target);
+        }
+      else if (cwnd < target || rc.m_delivered < tcb->m_initialCWnd * tcb->m_segmentSize)
+        {
+          cwnd = cwnd + rs.m_ackedSacked;
+        }
+      cwnd = std::max (cwnd, MIN_PIPE_CWND * tcb->m_segmentSize);
+    }
+
+  if (m_state == BBR_PROBE_RTT)
+    {
+      cwnd = std::min (cwnd, MIN_PIPE_CWND * tcb->m_segmentSize);
+    }
+
+  tcb->m_cWnd = cwnd;
+}
+
+void
+TcpBbr::SaveCwnd (Ptr<const TcpSocketState> tcb)
+{
+  NS_LOG_FUNCTION (this << tcb);
+  if (m_prevCaState < TcpSocketState::CA_RECOVERY && m_state != BBR_PROBE_RTT)
+    {
+      m_priorCwnd = tcb->m_cWnd;
+    }
+  else
+    {
+      // Already reduced: keep the largest window before the reductions
+      m_priorCwnd = std::max (m_priorCwnd, tcb->m_cWnd.Get ());
+    }
+}
+
+void
+TcpBbr::RestoreCwnd (Ptr<TcpSocketState> tcb)
+{
+  NS_LOG_FUNCTION (this << tcb);
+  tcb->m_cWnd = std::max (m_priorCwnd, tcb->m_cWnd.Get ());
+}
+
+void
+TcpBbr::ResetMode ()
+{
+  NS_LOG_FUNCTION (this);
+  if (!m_fullBwReached)
+    {
+      EnterStartup ();
+    }
+  else
+    {
+      EnterProbeBw ();
+    }
+}
+
+void
+TcpBbr::EnterStartup ()
+{
+  NS_LOG_FUNCTION (this);
+  NS_LOG_DEBUG (BbrModeName[m_state] << " -> BBR_STARTUP");
+  m_state = BBR_STARTUP;
+  UpdateGains ();
+}
+
+void
+TcpBbr::EnterDrain ()
+{
+  NS_LOG_FUNCTION (this);
+  NS_LOG_DEBUG (BbrModeName[m_state] << " -> BBR_DRAIN");
+  m_state = BBR_DRAIN;
+  UpdateGains ();
+}
+
+void
+TcpBbr::EnterProbeBw ()
+{
+  NS_LOG_FUNCTION (this);
+  NS_LOG_DEBUG (BbrModeName[m_state] << " -> BBR_PROBE_BW");
+  m_state = BBR_PROBE_BW;
+
+  // Start at a random phase, but never in the drain one: the advance
+  // below moves to the phase after it
+  m_cycleIndex = GAIN_CYCLE_LENGTH - 1 - m_uv->GetInteger (0, GAIN_CYCLE_LENGTH - 2);
+  AdvanceCyclePhase ();
+  UpdateGains ();
+}
+
+void
+TcpBbr::EnterProbeRtt ()
+{
+  NS_LOG_FUNCTION (this);
+  NS_LOG_DEBUG (BbrModeName[m_state] << " -> BBR_PROBE_RTT");
+  m_state = BBR_PROBE_RTT;
+  UpdateGains ();
+}
+
+void
+TcpBbr::CongControl (Ptr<TcpSocketState> tcb,
+                     const TcpRateOps::TcpRateConnection &rc,
+                     const TcpRateOps::TcpRateSample &rs)
+{
+  NS_LOG_FUNCTION (this << tcb);
+  UpdateModel (tcb, rc, rs);
+  SetPacingRate (tcb, m_pacingGain);
+  SetCwnd (tcb, rc, rs);
+}
+
+void
+TcpBbr::IncreaseWindow (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked)
+{
+  NS_LOG_FUNCTION (this << tcb << segmentsAcked);
+  // The window is set in CongControl
+}
+
+uint32_t
+TcpBbr::GetSsThresh (Ptr<const TcpSocketState> tcb, uint32_t bytesInFlight)
+{
+  NS_LOG_FUNCTION (this << tcb << bytesInFlight);
+  // Losses do not change the model: only remember the window, to restore
+  // it at the end of the recovery
+  SaveCwnd (tcb);
+  return tcb->m_ssThresh;
+}
+
+void
+TcpBbr::CongestionStateSet (Ptr<TcpSocketState> tcb,
+                            const TcpSocketState::TcpCongState_t newState)
+{
+  NS_LOG_FUNCTION (this << tcb << newState);
+  if (newState == TcpSocketState::CA_LOSS)
+    {
+      // After a RTO, restart the search of the full bandwidth, and treat
+      // the timeout as the end of a round
+      m_prevCaState = TcpSocketState::CA_LOSS;
+      m_fullBw = DataRate (0);
+      m_roundStart = true;
+    }
+}
+
+void
+TcpBbr::CwndEvent (Ptr<TcpSocketState> tcb,
+                   const TcpSocketState::TcpCAEvent_t event)
+{
+  NS_LOG_FUNCTION (this << tcb << event);
+  if (event == TcpSocketState::CA_EVENT_TX_START)
+    {
+      // Restarting after idle: the old queue has drained, so resume at the
+      // estimated bandwidth rather than at the (maybe lower) probing rate
+      m_idleRestart = true;
+      if (m_state == BBR_PROBE_BW)
+        {
+          SetPacingRate (tcb, 1);
+        }
+    }
+}
+
+} // namespace ns3
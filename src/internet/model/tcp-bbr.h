@@ -0,0 +1,331 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef TCPBBR_H
+#define TCPBBR_H
+
+#include "ns3/tcp-congestion-ops.h"
+#include "ns3/random-variable-stream.h"
+
+class TcpBbrTestCase;
+
+namespace ns3 {
+
+/**
+ * \ingroup congestionOps
+ *
+ * \brief BBR (Bottleneck Bandwidth and Round-trip propagation time)
+ * congestion control
+ *
+ * BBR does not react to losses or to the growth of the delay: it builds an
+ * explicit model of the path, made of the bottleneck bandwidth (the
+ * maximum of the delivery rate samples over the last BwWindowLength
+ * rounds) and of the round-trip propagation time (the minimum RTT over
+ * the last RttWindowLength).  The sender is then paced at about the
+ * bottleneck bandwidth, and the data in flight is capped to a small
+ * multiple of the bandwidth-delay product, so that the link is kept full
+ * without building a standing queue.  This is what allows a high
+ * utilization of long-RTT paths with shallow buffers, where a single loss
+ * makes a window-based algorithm halve its rate.
+ *
+ * The model is refreshed by a state machine:
+ *
+ * - STARTUP doubles the sending rate each round, until the bandwidth has
+ *   not grown by 25% for three rounds;
+ * - DRAIN empties the queue built during STARTUP;
+ * - PROBE_BW cycles the pacing gain over eight phases (1.25, 0.75, then
+ *   1 for six phases) to discover new bandwidth and drain what the probe
+ *   has queued;
+ * - PROBE_RTT is entered when the minimum RTT has not been refreshed for
+ *   RttWindowLength: the window is reduced to four segments for
+ *   ProbeRttDuration (and at least one round) to measure the propagation
+ *   delay again.
+ *
+ * BBR sets the congestion window and the pacing rate through
+ * TcpCongestionOps::CongControl, and thus enables pacing on the socket
+ * and replaces the recovery algorithm: during loss recovery it uses
+ * packet conservation for the first round, and it restores the window
+ * when the recovery ends.
+ *
+ * The implementation follows BBR v1 as found in Linux's tcp_bbr.c; the
+ * long-term bandwidth sampling (policer detection) and the ACK aggregation
+ * compensation are not implemented.
+ *
+ * More information: http://queue.acm.org/detail.cfm?id=3022184
+ */
+class TcpBbr : public TcpCongestionOps
+{
+public:
+  /**
+   * \brief BBR operating modes
+   */
+  enum BbrMode_t
+  {
+    BBR_STARTUP,        //!< Ramp up sending rate rapidly to fill pipe
+    BBR_DRAIN,          //!< Drain any queue created during startup
+    BBR_PROBE_BW,       //!< Discover, share bw: pace around estimated bw
+    BBR_PROBE_RTT,      //!< Cut inflight to min to probe min_rtt
+  };
+
+  /**
+   * \brief Literal names of BBR mode for use in log messages
+   */
+  static const char* const BbrModeName[BBR_PROBE_RTT + 1];
+
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  TcpBbr ();
+
+  /**
+   * Copy constructor
+   * \param sock Socket to copy
+   */
+  TcpBbr (const TcpBbr &sock);
+
+  /**
+   * Assign a fixed random variable stream number to the random variables
+   * used by this model.
+   *
+   * \param stream first stream index to use
+   * \return the number of stream indices assigned by this model
+   */
+  int64_t AssignStreams (int64_t stream);
+
+  virtual std::string GetName () const;
+  virtual void Init (Ptr<TcpSocketState> tcb);
+  virtual void IncreaseWindow (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked);
+  virtual uint32_t GetSsThresh (Ptr<const TcpSocketState> tcb,
+                                uint32_t bytesInFlight);
+  virtual void CongestionStateSet (Ptr<TcpSocketState> tcb,
+                                   const TcpSocketState::TcpCongState_t newState);
+  virtual void CwndEvent (Ptr<TcpSocketState> tcb,
+                          const TcpSocketState::TcpCAEvent_t event);
+  virtual bool HasCongControl () const;
+  virtual void CongControl (Ptr<TcpSocketState> tcb,
+                            const TcpRateOps::TcpRateConnection &rc,
+                            const TcpRateOps::TcpRateSample &rs);
+
+  virtual Ptr<TcpCongestionOps> Fork ();
+
+private:
+  /**
+   * \brief TcpBbrTestCase friend class (for tests).
+   * \relates TcpBbrTestCase
+   */
+  friend class ::TcpBbrTestCase;
+
+  /**
+   * \brief A sample of the windowed max filter of the bandwidth
+   */
+  struct MaxBwSample
+  {
+    uint32_t m_round {0};  //!< Round in which the sample was taken
+    DataRate m_bw    {0};  //!< Bandwidth sample
+  };
+
+  /**
+   * \brief Update the windowed max filter of the bandwidth
+   *
+   * As Linux's minmax_running_max, the filter keeps the best, second best
+   * and third best samples of the window, taken in successive sub-windows,
+   * so that the maximum expires without keeping the full history.
+   *
+   * \param round the current round
+   * \param bw the new bandwidth sample
+   */
+  void UpdateMaxBwFilter (uint32_t round, DataRate bw);
+
+  /**
+   * \return the bottleneck bandwidth estimate
+   */
+  DataRate GetMaxBw () const;
+
+  /**
+   * \brief Compute the data in flight needed to reach a rate
+   *
+   * The bandwidth-delay product, scaled by the gain, plus three segments
+   * to keep the sender busy while waiting for the ACKs (in segments, and
+   * rounded up to an even number).
+   *
+   * \param tcb Transmission Control Block of the connection
+   * \param bw the bandwidth
+   * \param gain the gain on the bandwidth-delay product
+   * \return the target in flight (bytes)
+   */
+  uint32_t InFlight (Ptr<const TcpSocketState> tcb, DataRate bw, double gain) const;
+
+  /**
+   * \brief Set the pacing rate at the given gain of the bottleneck bandwidth
+   * \param tcb Transmission Control Block of the connection
+   * \param gain the pacing gain
+   */
+  void SetPacingRate (Ptr<TcpSocketState> tcb, double gain);
+
+  /**
+   * \brief Initialize the pacing rate from the initial window and the RTT
+   * \param tcb Transmission Control Block of the connection
+   */
+  void InitPacingRateFromRtt (Ptr<TcpSocketState> tcb);
+
+  /**
+   * \brief Update the bandwidth filter and the round counter
+   * \param rc Rate information for the connection
+   * \param rs Rate sample of the last ACK
+   */
+  void UpdateBandwidth (const TcpRateOps::TcpRateConnection &rc,
+                        const TcpRateOps::TcpRateSample &rs);
+
+  /**
+   * \brief Advance the PROBE_BW gain cycle, if the current phase is over
+   * \param tcb Transmission Control Block of the connection
+   * \param rs Rate sample of the last ACK
+   */
+  void UpdateCyclePhase (Ptr<TcpSocketState> tcb, const TcpRateOps::TcpRateSample &rs);
+
+  /**
+   * \brief Check if the current phase of the PROBE_BW gain cycle is over
+   * \param tcb Transmission Control Block of the connection
+   * \param rs Rate sample of the last ACK
+   * \return true if the next phase can start
+   */
+  bool IsNextCyclePhase (Ptr<TcpSocketState> tcb, const TcpRateOps::TcpRateSample &rs) const;
+
+  /**
+   * \brief Move to the next phase of the PROBE_BW gain cycle
+   */
+  void AdvanceCyclePhase ();
+
+  /**
+   * \brief Detect that the bandwidth has stopped growing during STARTUP
+   * \param rs Rate sample of the last ACK
+   */
+  void CheckFullBwReached (const TcpRateOps::TcpRateSample &rs);
+
+  /**
+   * \brief Leave STARTUP for DRAIN, and DRAIN for PROBE_BW when the queue
+   * has been drained
+   * \param tcb Transmission Control Block of the connection
+   */
+  void CheckDrain (Ptr<TcpSocketState> tcb);
+
+  /**
+   * \brief Update the min RTT filter, and enter or leave PROBE_RTT
+   * \param tcb Transmission Control Block of the connection
+   * \param rc Rate information for the connection
+   * \param rs Rate sample of the last ACK
+   */
+  void UpdateMinRtt (Ptr<TcpSocketState> tcb, const TcpRateOps::TcpRateConnection &rc,
+                     const TcpRateOps::TcpRateSample &rs);
+
+  /**
+   * \brief Set the pacing and window gains of the current mode
+   */
+  void UpdateGains ();
+
+  /**
+   * \brief Update the model of the path with the last ACK
+   * \param tcb Transmission Control Block of the connection
+   * \param rc Rate information for the connection
+   * \param rs Rate sample of the last ACK
+   */
+  void UpdateModel (Ptr<TcpSocketState> tcb, const TcpRateOps::TcpRateConnection &rc,
+                    const TcpRateOps::TcpRateSample &rs);
+
+  /**
+   * \brief Apply packet conservation during the first round of a recovery,
+   * and restore the window when the recovery ends
+   * \param tcb Transmission Control Block of the connection
+   * \param rc Rate information for the connection
+   * \param rs Rate sample of the last ACK
+   * \param newCwnd the resulting window (bytes)
+   * \return true if packet conservation is in effect
+   */
+  bool SetCwndToRecoverOrRestore (Ptr<TcpSocketState> tcb,
+                                  const TcpRateOps::TcpRateConnection &rc,
+                                  const TcpRateOps::TcpRateSample &rs,
+                                  uint32_t *newCwnd);
+
+  /**
+   * \brief Grow the window towards the target in flight
+   * \param tcb Transmission Control Block of the connection
+   * \param rc Rate information for the connection
+   * \param rs Rate sample of the last ACK
+   */
+  void SetCwnd (Ptr<TcpSocketState> tcb, const TcpRateOps::TcpRateConnection &rc,
+                const TcpRateOps::TcpRateSample &rs);
+
+  /**
+   * \brief Remember the window before a reduction (recovery, PROBE_RTT)
+   * \param tcb Transmission Control Block of the connection
+   */
+  void SaveCwnd (Ptr<const TcpSocketState> tcb);
+
+  /**
+   * \brief Restore the window saved by SaveCwnd
+   * \param tcb Transmission Control Block of the connection
+   */
+  void RestoreCwnd (Ptr<TcpSocketState> tcb);
+
+  /**
+   * \brief Go back to STARTUP or PROBE_BW, depending on the pipe being full
+   */
+  void ResetMode ();
+
+  void EnterStartup ();   //!< Enter the STARTUP mode
+  void EnterDrain ();     //!< Enter the DRAIN mode
+  void EnterProbeBw ();   //!< Enter the PROBE_BW mode
+  void EnterProbeRtt ();  //!< Enter the PROBE_RTT mode
+
+  // User parameters
+  double   m_highGain;           //!< Gain of STARTUP, to double the rate each round
+  uint32_t m_bwWindowLength;     //!< Length of the max bandwidth filter (rounds)
+  Time     m_minRttWindowLength; //!< Length of the min RTT filter
+  Time     m_probeRttDuration;   //!< Minimum time spent in PROBE_RTT
+  double   m_pacingMargin;       //!< Fraction of the bandwidth not used, to avoid queues
+
+  // BBR state
+  BbrMode_t m_state;             //!< Current mode
+  double   m_pacingGain;         //!< Current pacing gain
+  double   m_cWndGain;           //!< Current window gain
+  MaxBwSample m_maxBwFilter[3];  //!< Windowed max filter of the bandwidth
+  uint32_t m_roundCount;         //!< Count of packet-timed rounds
+  bool     m_roundStart;         //!< The last ACK started a new round
+  uint64_t m_nextRoundDelivered; //!< Delivered count that ends the current round
+  Time     m_minRtt;             //!< Min RTT estimate
+  Time     m_minRttStamp;        //!< Time at which m_minRtt was taken
+  Time     m_probeRttDoneStamp;  //!< End of PROBE_RTT (zero if not scheduled yet)
+  bool     m_probeRttRoundDone;  //!< A round has elapsed in PROBE_RTT
+  bool     m_packetConservation; //!< Use packet conservation (first round of recovery)
+  uint32_t m_priorCwnd;          //!< Window saved before a reduction (bytes)
+  bool     m_idleRestart;        //!< Restarting after being idle
+  TcpSocketState::TcpCongState_t m_prevCaState; //!< Congestion state at the previous ACK
+  bool     m_fullBwReached;      //!< The pipe has been filled in STARTUP
+  DataRate m_fullBw;             //!< Bandwidth at the last significant growth
+  uint32_t m_fullBwCount;        //!< Rounds without significant bandwidth growth
+  uint32_t m_cycleIndex;         //!< Current phase of the PROBE_BW gain cycle
+  Time     m_cycleStamp;         //!< Beginning of the current phase
+  bool     m_hasSeenRtt;         //!< The pacing rate has been set from a RTT sample
+  Ptr<UniformRandomVariable> m_uv; //!< Random start phase of the PROBE_BW gain cycle
+};
+
+} // namespace ns3
+
+#endif // TCPBBR_H
@@ -20,6 +20,7 @@
 #define TCPCONGESTIONOPS_H
 
 #include "ns3/tcp-socket-state.h"
+#include "ns3/tcp-rate-ops.h"
 
 namespace ns3 {
 
@@ -73,6 +74,20 @@ public:
    */
   virtual std::string GetName () const = 0;
 
+  /**
+   * \brief Set configuration required by congestion control algorithm
+   *
+   * This function mimics the function init in Linux. It is called when
+   * the connection is established, after the initial cWnd and RTT
+   * estimation have been set.
+   *
+   * \param tcb internal congestion state
+   */
+  virtual void Init (Ptr<TcpSocketState> tcb)
+  {
+    NS_UNUSED (tcb);
+  }
+
   /**
    * \brief Get the slow start threshold after a loss event
    *
@@ -154,6 +169,41 @@ public:
     NS_UNUSED (tcb);
     NS_UNUSED (event);
   }
+
+  /**
+   * \brief Returns true when Congestion Control Algorithm implements CongControl
+   *
+   * \return true if CC implements CongControl function
+   *
+   * This function is the equivalent in C++ of the C checks that are used
+   * for asserting the existence of a function pointer in the Linux socket.
+   */
+  virtual bool HasCongControl () const
+  {
+    return false;
+  }
+
+  /**
+   * \brief Called when packets are delivered to update cwnd and pacing rate
+   *
+   * This function mimics the function cong_control in Linux. It is called
+   * once per ACK, after the delivery rate sample has been generated, and
+   * only if HasCongControl returns true. In that case, the congestion
+   * control takes full charge of cWnd and of the pacing rate, and the
+   * recovery algorithm is not consulted.
+   *
+   * \param tcb internal congestion state
+   * \param rc Rate information for the connection
+   * \param rs Rate sample (over a period of time) information
+   */
+  virtual void CongControl (Ptr<TcpSocketState> tcb,
+                            const TcpRateOps::TcpRateConnection &rc,
+                            const TcpRateOps::TcpRateSample &rs)
+  {
+    NS_UNUSED (tcb);
+    NS_UNUSED (rc);
+    NS_UNUSED (rs);
+  }
   // Present in Linux but not in ns-3 yet:
   /* call when ack arrives (optional) */
   // void (*in_ack_event)(struct sock *sk, u32 flags);
@@ -0,0 +1,496 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "tcp-cubic.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/boolean.h"
+#include "ns3/double.h"
+#include "ns3/uinteger.h"
+#include "ns3/enum.h"
+#include <cmath>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TcpCubic");
+NS_OBJECT_ENSURE_REGISTERED (TcpCubic);
+
+TypeId
+TcpCubic::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TcpCubic")
+    .SetParent<TcpCongestionOps> ()
+    .AddConstructor<TcpCubic> ()
+    .SetGroupName ("Internet")
+    .AddAttribute ("FastConvergence", "Enable (true) or disable (false) fast convergence",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&TcpCubic::m_fastConvergence),
+                   MakeBooleanChecker ())
+    .AddAttribute ("TcpFriendliness", "Enable (true) or disable (false) the "
+                   "growth of the window at least as fast as a standard TCP",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&TcpCubic::m_tcpFriendliness),
+                   MakeBooleanChecker ())
+    .AddAttribute ("Beta", "Beta for multiplicative decrease",
+                   DoubleValue (0.7),
+                   MakeDoubleAccessor (&TcpCubic::m_beta),
+                   MakeDoubleChecker <double> (0.0, 1.0))
+    .AddAttribute ("C", "Cubic Scaling factor",
+                   DoubleValue (0.4),
+                   MakeDoubleAccessor (&TcpCubic::m_c),
+                   MakeDoubleChecker <double> (0.0))
+    .AddAttribute ("HyStart", "Enable (true) or disable (false) hybrid slow start algorithm",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&TcpCubic::m_hystart),
+                   MakeBooleanChecker ())
+    .AddAttribute ("HyStartLowWindow", "Lower bound cWnd for hybrid slow start (segments)",
+                   UintegerValue (16),
+                   MakeUintegerAccessor (&TcpCubic::m_hystartLowWindow),
+                   MakeUintegerChecker <uint32_t> ())
+    .AddAttribute ("HyStartDetect", "Hybrid Slow Start detection mechanisms",
+                   EnumValue (BOTH),
+                   MakeEnumAccessor (&TcpCubic::m_hystartDetect),
+                   MakeEnumChecker (PACKET_TRAIN, "PacketTrain",
+                                    DELAY, "Delay",
+                                    BOTH, "Both"))
+    .AddAttribute ("HyStartMinSamples", "Number of delay samples for detecting the increase of delay",
+                   UintegerValue (8),
+                   MakeUintegerAccessor (&TcpCubic::m_hystartMinSamples),
+                   MakeUintegerChecker <uint8_t> (1))
+    .AddAttribute ("HyStartAckDelta", "Spacing between ack's indicating train",
+                   TimeValue (MilliSeconds (2)),
+                   MakeTimeAccessor (&TcpCubic::m_hystartAckDelta),
+                   MakeTimeChecker ())
+    .AddAttribute ("HyStartDelayMin", "Minimum time for hystart algorithm",
+                   TimeValue (MilliSeconds (4)),
+                   MakeTimeAccessor (&TcpCubic::m_hystartDelayMin),
+                   MakeTimeChecker ())
+    .AddAttribute ("HyStartDelayMax", "Maximum time for hystart algorithm",
+                   TimeValue (MilliSeconds (16)),
+                   MakeTimeAccessor (&TcpCubic::m_hystartDelayMax),
+                   MakeTimeChecker ())
+    .AddAttribute ("CubicDelta", "Delta Time to wait after fast recovery before adjusting param",
+                   TimeValue (Seconds (1)),
+                   MakeTimeAccessor (&TcpCubic::m_cubicDelta),
+                   MakeTimeChecker ())
+    .AddAttribute ("CntClamp", "Counter value when no losses are detected (counter is used"
+                   " when incrementing cWnd in congestion avoidance, to avoid"
+                   " floating point arithmetic). It is the modulo of the (avoided)"
+                   " division",
+                   UintegerValue (20),
+                   MakeUintegerAccessor (&TcpCubic::m_cntClamp),
+                   MakeUintegerChecker <uint8_t> (1))
+  ;
+  return tid;
+}
+
+TcpCubic::TcpCubic ()
+  : TcpCongestionOps (),
+    m_cWndCnt (0),
+    m_lastMaxCwnd (0),
+    m_bicOriginPoint (0),
+    m_bicK (0.0),
+    m_delayMin (Time::Min ()),
+    m_epochStart (Time::Min ()),
+    m_ackCnt (0),
+    m_tcpCwnd (0),
+    m_found (0),
+    m_roundStart (Seconds (0)),
+    m_endSeq (0),
+    m_lastAck (Seconds (0)),
+    m_currRtt (Time::Min ()),
+    m_sampleCnt (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+TcpCubic::TcpCubic (const TcpCubic &sock)
+  : TcpCongestionOps (sock),
+    m_fastConvergence (sock.m_fastConvergence),
+    m_tcpFriendliness (sock.m_tcpFriendliness),
+    m_beta (sock.m_beta),
+    m_c (sock.m_c),
+    m_hystart (sock.m_hystart),
+    m_hystartDetect (sock.m_hystartDetect),
+    m_hystartLowWindow (sock.m_hystartLowWindow),
+    m_hystartAckDelta (sock.m_hystartAckDelta),
+    m_hystartDelayMin (sock.m_hystartDelayMin),
+    m_hystartDelayMax (sock.m_hystartDelayMax),
+    m_hystartMinSamples (sock.m_hystartMinSamples),
+    m_cntClamp (sock.m_cntClamp),
+    m_cWndCnt (sock.m_cWndCnt),
+    m_lastMaxCwnd (sock.m_lastMaxCwnd),
+    m_bicOriginPoint (sock.m_bicOriginPoint),
+    m_bicK (sock.m_bicK),
+    m_delayMin (sock.m_delayMin),
+    m_epochStart (sock.m_epochStart),
+    m_ackCnt (sock.m_ackCnt),
+    m_tcpCwnd (sock.m_tcpCwnd),
+    m_found (sock.m_found),
+    m_roundStart (sock.m_roundStart),
+    m_endSeq (sock.m_endSeq),
+    m_lastAck (sock.m_lastAck),
+    m_cubicDelta (sock.m_cubicDelta),
+    m_currRtt (sock.m_currRtt),
+    m_sampleCnt (sock.m_sampleCnt)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+std::string
+TcpCubic::GetName () const
+{
+  return "TcpCubic";
+}
+
+void
+TcpCubic::HystartReset (Ptr<const TcpSocketState> tcb)
+{
+  NS_LOG_FUNCTION (this << tcb);
+
+  m_roundStart = m_lastAck = Simulator::Now ();
+  m_endSeq = tcb->m_highTxMark;
+  m_currRtt = Time::Min ();
+  m_sampleCnt = 0;
+}
+
+void
+TcpCubic::CubicReset (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  m_cWndCnt = 0;
+  m_lastMaxCwnd = 0;
+  m_bicOriginPoint = 0;
+  m_bicK = 0.0;
+  m_delayMin = Time::Min ();
+  m_epochStart = Time::Min ();
+  m_ackCnt = 0;
+  m_tcpCwnd = 0;
+  m_found = 0;
+}
+
+void
+TcpCubic::IncreaseWindow (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked)
+{
+  NS_LOG_FUNCTION (this << tcb << segmentsAcked);
+
+  if (tcb->m_cWnd < tcb->m_ssThresh)
+    {
+      if (m_hystart && tcb->m_lastAckedSeq > m_endSeq)
+        {
+          HystartReset (tcb);
+        }
+
+      // Grow by the segments acked, but no more than needed to reach ssThresh
+      uint32_t room = (tcb->m_ssThresh - tcb->m_cWnd + tcb->m_segmentSize - 1)
+        / tcb->m_segmentSize;
+      uint32_t used = std::min (segmentsAcked, room);
+      tcb->m_cWnd += used * tcb->m_segmentSize;
+      segmentsAcked -= used;
+
+      NS_LOG_INFO ("In SlowStart, updated to cwnd " << tcb->m_cWnd <<
+                   " ssthresh " << tcb->m_ssThresh);
+    }
+
+  if (tcb->m_cWnd >= tcb->m_ssThresh && segmentsAcked > 0)
+    {
+      uint32_t cnt = Update (tcb, segmentsAcked);
+
+      /* Grow the window by one segment every cnt segments acked, keeping
+       * the remainder in m_cWndCnt (as tcp_cong_avoid_ai in Linux)
+       */
+      if (m_cWndCnt >= cnt)
+        {
+          m_cWndCnt = 0;
+          tcb->m_cWnd += tcb->m_segmentSize;
+        }
+
+      m_cWndCnt += segmentsAcked;
+      if (m_cWndCnt >= cnt)
+        {
+          uint32_t delta = m_cWndCnt / cnt;
+          m_cWndCnt -= delta * cnt;
+          tcb->m_cWnd += delta * tcb->m_segmentSize;
+        }
+
+      NS_LOG_INFO ("In CongAvoid, updated to cwnd " << tcb->m_cWnd <<
+                   " cnt " << cnt << " cWndCnt " << m_cWndCnt);
+    }
+}
+
+uint32_t
+TcpCubic::Update (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked)
+{
+  NS_LOG_FUNCTION (this << tcb << segmentsAcked);
+
+  uint32_t segCwnd = tcb->GetCwndInSegments ();
+  uint32_t cnt;
+
+  m_ackCnt += segmentsAcked;
+
+  if (m_epochStart == Time::Min ())
+    {
+      m_epochStart = Simulator::Now ();   // record the beginning of an epoch
+      m_ackCnt = segmentsAcked;
+      m_tcpCwnd = segCwnd;
+
+      if (m_lastMaxCwnd <= segCwnd)
+        {
+          NS_LOG_DEBUG ("lastMaxCwnd <= m_cWnd. K=0 and origin=" << segCwnd);
+          m_bicK = 0.0;
+          m_bicOriginPoint = segCwnd;
+        }
+      else
+        {
+          m_bicK = std::pow ((m_lastMaxCwnd - segCwnd) / m_c, 1 / 3.);
+          m_bicOriginPoint = m_lastMaxCwnd;
+          NS_LOG_DEBUG ("lastMaxCwnd > m_cWnd. K=" << m_bicK <<
+                        " and origin=" << m_lastMaxCwnd);
+        }
+    }
+
+  // Aim at the window of one minimum RTT later, as Linux does
+  Time delayMin = m_delayMin == Time::Min () ? Time (0) : m_delayMin;
+  double t = (Simulator::Now () + delayMin - m_epochStart).GetSeconds ();
+  double offs = t - m_bicK;
+  double target = std::floor (m_bicOriginPoint + m_c * offs * offs * offs);
+
+  NS_LOG_DEBUG ("t=" << t << " K=" << m_bicK << " target=" << target <<
+                " cwnd=" << segCwnd);
+
+  if (target > segCwnd)
+    {
+      cnt = static_cast<uint32_t> (segCwnd / (target - segCwnd));
+    }
+  else
+    {
+      cnt = 100 * segCwnd;   // very small increment
+    }
+
+  // The initial growth of cubic function may be too conservative
+  // when the available bandwidth is still unknown.
+  if (m_lastMaxCwnd == 0 && cnt > m_cntClamp)
+    {
+      cnt = m_cntClamp;
+    }
+
+  if (m_tcpFriendliness)
+    {
+      // Segments to be acked for a standard TCP with the same average
+      // throughput to grow by one segment
+      uint32_t delta = std::max (static_cast<uint32_t> (segCwnd * (1 + m_beta)
+                                                        / (3 * (1 - m_beta))), 1U);
+      while (m_ackCnt > delta)
+        {
+          m_ackCnt -= delta;
+          m_tcpCwnd++;
+        }
+
+      if (m_tcpCwnd > segCwnd)
+        {
+          uint32_t maxCnt = segCwnd / (m_tcpCwnd - segCwnd);
+          NS_LOG_DEBUG ("TCP friendly window " << m_tcpCwnd << ", max cnt " << maxCnt);
+          cnt = std::min (cnt, maxCnt);
+        }
+    }
+
+  // Never grow faster than slow start
+  return std::max (cnt, 2U);
+}
+
+void
+TcpCubic::PktsAcked (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked,
+                     const Time &rtt)
+{
+  NS_LOG_FUNCTION (this << tcb << segmentsAcked << rtt);
+
+  /* Discard delay samples right after fast recovery */
+  if (m_epochStart != Time::Min ()
+      && (Simulator::Now () - m_epochStart) < m_cubicDelta)
+    {
+      return;
+    }
+
+  if (!rtt.IsStrictlyPositive ())
+    {
+      return;
+    }
+
+  /* first time call or link delay decreases */
+  if (m_delayMin == Time::Min () || m_delayMin > rtt)
+    {
+      m_delayMin = rtt;
+    }
+
+  /* hystart triggers when cwnd is larger than some threshold */
+  if (m_hystart && m_found == 0 && tcb->m_cWnd < tcb->m_ssThresh
+      && tcb->GetCwndInSegments () >= m_hystartLowWindow)
+    {
+      HystartUpdate (tcb, rtt);
+    }
+}
+
+void
+TcpCubic::HystartUpdate (Ptr<TcpSocketState> tcb, const Time &delay)
+{
+  NS_LOG_FUNCTION (this << tcb << delay);
+
+  if (m_found & m_hystartDetect)
+    {
+      return;
+    }
+
+  Time now = Simulator::Now ();
+
+  /* first detection parameter - ack-train detection */
+  if ((m_hystartDetect & PACKET_TRAIN)
+      && (now - m_lastAck) <= m_hystartAckDelta)
+    {
+      m_lastAck = now;
+
+      if ((now - m_roundStart) > m_delayMin / 2)
+        {
+          NS_LOG_DEBUG ("HyStart: ack train longer than half of the minimum RTT");
+          m_found |= PACKET_TRAIN;
+        }
+    }
+
+  /* obtain the minimum delay of more than sampling packets */
+  if (m_hystartDetect & DELAY)
+    {
+      if (m_sampleCnt < m_hystartMinSamples)
+        {
+          if (m_currRtt == Time::Min () || m_currRtt > delay)
+            {
+              m_currRtt = delay;
+            }
+
+          ++m_sampleCnt;
+        }
+      else if (m_currRtt > m_delayMin + HystartDelayThresh (m_delayMin / 8))
+        {
+          NS_LOG_DEBUG ("HyStart: RTT " << m_currRtt << " increased from " << m_delayMin);
+          m_found |= DELAY;
+        }
+    }
+
+  /* Either one of two conditions are met, we exit from slow start
+   * immediately.
+   */
+  if (m_found & m_hystartDetect)
+    {
+      NS_LOG_DEBUG ("Exit from SS, immediately :-)");
+      tcb->m_ssThresh = tcb->m_cWnd;
+    }
+}
+
+Time
+TcpCubic::HystartDelayThresh (const Time& t) const
+{
+  NS_LOG_FUNCTION (this << t);
+
+  Time ret = t;
+  if (t > m_hystartDelayMax)
+    {
+      ret = m_hystartDelayMax;
+    }
+  else if (t < m_hystartDelayMin)
+    {
+      ret = m_hystartDelayMin;
+    }
+
+  return ret;
+}
+
+uint32_t
+TcpCubic::GetSsThresh (Ptr<const TcpSocketState> tcb, uint32_t bytesInFlight)
+{
+  NS_LOG_FUNCTION (this << tcb << bytesInFlight);
+
+  uint32_t segCwnd = tcb->GetCwndInSegments ();
+  NS_LOG_DEBUG ("Loss at cWnd=" << segCwnd << " segments in flight=" <<
+                bytesInFlight / tcb->m_segmentSize);
+
+  /* Wmax and fast convergence */
+  if (segCwnd < m_lastMaxCwnd && m_fastConvergence)
+    {
+      m_lastMaxCwnd = static_cast<uint32_t> (segCwnd * (1 + m_beta) / 2);
+    }
+  else
+    {
+      m_lastMaxCwnd = segCwnd;
+    }
+
+  m_epochStart = Time::Min ();    // end of epoch
+
+  uint32_t ssThresh = std::max (static_cast<uint32_t> (segCwnd * m_beta), 2U)
+    * tcb->m_segmentSize;
+
+  NS_LOG_DEBUG ("New ssThresh " << ssThresh << " lastMaxCwnd " << m_lastMaxCwnd);
+
+  return ssThresh;
+}
+
+void
+TcpCubic::CongestionStateSet (Ptr<TcpSocketState> tcb,
+                              const TcpSocketState::TcpCongState_t newState)
+{
+  NS_LOG_FUNCTION (this << tcb << newState);
+
+  if (newState == TcpSocketState::CA_LOSS)
+    {
+      CubicReset ();
+      HystartReset (tcb);
+    }
+}
+
+void
+TcpCubic::CwndEvent (Ptr<TcpSocketState> tcb,
+                     const TcpSocketState::TcpCAEvent_t event)
+{
+  NS_LOG_FUNCTION (this << tcb << event);
+
+  /* The application was idle: the curve must not count the time since
+   * the last transmission, otherwise the window would jump ahead once the
+   * transfer restarts
+   */
+  if (event == TcpSocketState::CA_EVENT_TX_START
+      && m_epochStart != Time::Min () && tcb->m_lastSendTime != Time::Min ())
+    {
+      Time now = Simulator::Now ();
+      Time idle = now - tcb->m_lastSendTime;
+      if (idle.IsStrictlyPositive ())
+        {
+          m_epochStart += idle;
+          if (m_epochStart > now)
+            {
+              m_epochStart = now;
+            }
+          NS_LOG_DEBUG ("Idle for " << idle << ", epoch shifted to " << m_epochStart);
+        }
+    }
+}
+
+Ptr<TcpCongestionOps>
+TcpCubic::Fork (void)
+{
+  NS_LOG_FUNCTION (this);
+  return CopyObject<TcpCubic> (this);
+}
+
+} // namespace ns3
@@ -0,0 +1,188 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef TCPCUBIC_H
+#define TCPCUBIC_H
+
+#include "ns3/tcp-congestion-ops.h"
+
+class TcpCubicTestCase;
+
+namespace ns3 {
+
+/**
+ * \ingroup congestionOps
+ *
+ * \brief The Cubic Congestion Control Algorithm
+ *
+ * TCP Cubic is the default congestion control of Linux.  After a loss, the
+ * window follows a cubic function of the time elapsed since the loss:
+ *
+ * \f[ W(t) = C (t - K)^3 + W_{max} \f]
+ *
+ * where \f$ W_{max} \f$ is the window before the loss and \f$ K \f$ the
+ * time needed to grow back to it.  The window grows quickly far from
+ * \f$ W_{max} \f$, flattens around it, and then probes for more bandwidth.
+ * Since the growth depends on time rather than on the arrival of ACKs,
+ * flows with long RTTs (such as satellite paths) are not penalized as they
+ * are with AIMD.
+ *
+ * The implementation follows Linux's tcp_cubic.c:
+ *
+ * - on a loss the window is reduced by the factor Beta (0.7), and if the
+ *   window had not grown back to the previous maximum, this maximum is
+ *   lowered (fast convergence), to leave room to new flows;
+ * - the window never grows slower than the one of a standard TCP with the
+ *   same average throughput (TCP friendliness);
+ * - the slow start is left before the first loss when HyStart detects
+ *   that the path is full, either because a train of closely spaced ACKs
+ *   lasts more than half of the minimum RTT, or because the RTT of the
+ *   first ACKs of a round grew by more than a threshold;
+ * - the cubic epoch is shifted by the time spent without data in flight,
+ *   so that an application-limited flow does not jump ahead on the curve.
+ *
+ * As in Linux, slow start grows the window by the number of segments
+ * acknowledged, and the spare ones are used for congestion avoidance once
+ * the slow start threshold is reached.
+ *
+ * More information on CUBIC: RFC 8312 and
+ * http://doi.acm.org/10.1145/1400097.1400105
+ * More information on HyStart:
+ * http://doi.org/10.1016/j.comnet.2011.01.014
+ */
+class TcpCubic : public TcpCongestionOps
+{
+public:
+  /**
+   * \brief Values to detect the Slow Start mode of HyStart
+   */
+  enum HybridSSDetectionMode
+  {
+    PACKET_TRAIN = 1, //!< Detection by trains of packet
+    DELAY        = 2, //!< Detection by delay value
+    BOTH         = 3, //!< Detection by both
+  };
+
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  TcpCubic ();
+
+  /**
+   * Copy constructor
+   * \param sock Socket to copy
+   */
+  TcpCubic (const TcpCubic& sock);
+
+  virtual std::string GetName () const;
+  virtual void PktsAcked (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked,
+                          const Time &rtt);
+  virtual void IncreaseWindow (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked);
+  virtual uint32_t GetSsThresh (Ptr<const TcpSocketState> tcb,
+                                uint32_t bytesInFlight);
+  virtual void CongestionStateSet (Ptr<TcpSocketState> tcb,
+                                   const TcpSocketState::TcpCongState_t newState);
+  virtual void CwndEvent (Ptr<TcpSocketState> tcb,
+                          const TcpSocketState::TcpCAEvent_t event);
+
+  virtual Ptr<TcpCongestionOps> Fork ();
+
+private:
+  /**
+   * \brief TcpCubicTestCase friend class (for tests).
+   * \relates TcpCubicTestCase
+   */
+  friend class ::TcpCubicTestCase;
+
+  /**
+   * \brief Reset HyStart parameters, at the beginning of a round
+   * \param tcb Transmission Control Block of the connection
+   */
+  void HystartReset (Ptr<const TcpSocketState> tcb);
+
+  /**
+   * \brief Reset Cubic parameters
+   */
+  void CubicReset (void);
+
+  /**
+   * \brief Cubic window update after a new ack received
+   * \param tcb Transmission Control Block of the connection
+   * \param segmentsAcked Segments acked
+   * \returns the number of segments to be acked to grow the window by one segment
+   */
+  uint32_t Update (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked);
+
+  /**
+   * \brief Update HyStart parameters and leave slow start if the path is full
+   * \param tcb Transmission Control Block of the connection
+   * \param delay Delay for HyStart algorithm
+   */
+  void HystartUpdate (Ptr<TcpSocketState> tcb, const Time &delay);
+
+  /**
+   * \brief Clamp time value in a range
+   *
+   * The returned value is t, clamped in a range specified
+   * by attributes (HystartDelayMin < t < HystartDelayMax)
+   *
+   * \param t Time value to clamp
+   * \return t itself if it is in range, otherwise the min or max
+   * value
+   */
+  Time HystartDelayThresh (const Time &t) const;
+
+  // User parameters
+  bool     m_fastConvergence;  //!< Enable or disable fast convergence algorithm
+  bool     m_tcpFriendliness;  //!< Enable or disable TCP friendliness
+  double   m_beta;             //!< Beta for cubic multiplicative decrease
+  double   m_c;                //!< Cubic Scaling factor
+
+  bool     m_hystart;          //!< Enable or disable HyStart algorithm
+  HybridSSDetectionMode m_hystartDetect; //!< Detect way for HyStart algorithm
+  uint32_t m_hystartLowWindow; //!< Lower bound cWnd for hybrid slow start (segments)
+  Time     m_hystartAckDelta;  //!< Spacing between ack's indicating train
+  Time     m_hystartDelayMin;  //!< Minimum time for hystart algorithm
+  Time     m_hystartDelayMax;  //!< Maximum time for hystart algorithm
+  uint8_t  m_hystartMinSamples; //!< Number of delay samples for detecting the increase of delay
+
+  uint8_t  m_cntClamp;         //!< Modulo of the (avoided) float division for cWnd
+
+  // Cubic parameters
+  uint32_t m_cWndCnt;         //!<  cWnd integer-to-float counter
+  uint32_t m_lastMaxCwnd;     //!<  Last maximum cWnd (segments)
+  uint32_t m_bicOriginPoint;  //!<  Origin point of bic function (segments)
+  double   m_bicK;            //!<  Time to origin point from the beginning of the epoch (s)
+  Time     m_delayMin;        //!<  Min delay
+  Time     m_epochStart;      //!<  Beginning of an epoch
+  uint32_t m_ackCnt;          //!<  Number of segments acked in the epoch
+  uint32_t m_tcpCwnd;         //!<  Estimated cWnd of a standard TCP (segments)
+  uint8_t  m_found;           //!<  The exit points HyStart has found
+  Time     m_roundStart;      //!<  Beginning of each round
+  SequenceNumber32 m_endSeq;  //!<  End sequence of the round
+  Time     m_lastAck;         //!<  Last time when the ACK spacing is close
+  Time     m_cubicDelta;      //!<  Time to wait after recovery before update
+  Time     m_currRtt;         //!<  Current Rtt
+  uint32_t m_sampleCnt;       //!<  Count of samples for HyStart
+};
+
+} // namespace ns3
+
+#endif // TCPCUBIC_H
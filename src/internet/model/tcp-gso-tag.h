@@ -0,0 +1,93 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef TCP_GSO_TAG_H
+#define TCP_GSO_TAG_H
+
+#include "ns3/tag.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup tcp
+ *
+ * \brief Marks a TCP super-segment carrying more than one MSS of data
+ *
+ * On the send side, TcpSocketBase attaches this tag to a segment built
+ * from several MSS-sized chunks (generic segmentation offload); the
+ * IPv4 layer splits the packet back into wire-sized segments after
+ * routing. On the receive side, TcpL4Protocol attaches it to a packet
+ * obtained by coalescing consecutive segments (generic receive offload),
+ * so that the socket can account for the number of segments it carries.
+ */
+class TcpGsoTag : public Tag
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+
+  TcpGsoTag ();
+
+  /**
+   * \brief Constructor
+   * \param segmentSize size of each wire segment payload
+   * \param segments number of wire segments carried
+   */
+  TcpGsoTag (uint16_t segmentSize, uint16_t segments);
+
+  /**
+   * \brief Set the size of each wire segment payload
+   * \param segmentSize the segment size
+   */
+  void SetSegmentSize (uint16_t segmentSize);
+
+  /**
+   * \brief Get the size of each wire segment payload
+   * \return the segment size
+   */
+  uint16_t GetSegmentSize (void) const;
+
+  /**
+   * \brief Set the number of wire segments carried
+   * \param segments the number of segments
+   */
+  void SetSegments (uint16_t segments);
+
+  /**
+   * \brief Get the number of wire segments carried
+   * \return the number of segments
+   */
+  uint16_t GetSegments (void) const;
+
+  // inherited from Tag
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (TagBuffer i) const;
+  virtual void Deserialize (TagBuffer i);
+  virtual void Print (std::ostream &os) const;
+
+private:
+  uint16_t m_segmentSize; //!< Size of each wire segment payload
+  uint16_t m_segments;    //!< Number of wire segments
+};
+
+} // namespace ns3
+
+#endif /* TCP_GSO_TAG_H */
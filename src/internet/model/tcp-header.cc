@@ -23,6 +23,7 @@
 #include "tcp-header.h"
 #include "tcp-option.h"
 #include "ns3/buffer.h"
+#include "ns3/fixed-header-layout.h"
 #include "ns3/address-utils.h"
 #include "ns3/log.h"
 
@@ -315,14 +316,16 @@ void
 TcpHeader::Serialize (Buffer::Iterator start)  const
 {
   Buffer::Iterator i = start;
-  i.WriteHtonU16 (m_sourcePort);
-  i.WriteHtonU16 (m_destinationPort);
-  i.WriteHtonU32 (m_sequenceNumber.GetValue ());
-  i.WriteHtonU32 (m_ackNumber.GetValue ());
-  i.WriteHtonU16 (GetLength () << 12 | m_flags); //reserved bits are all zero
-  i.WriteHtonU16 (m_windowSize);
-  i.WriteHtonU16 (0);
-  i.WriteHtonU16 (m_urgentPointer);
+  FixedHeaderLayout<20> layout;
+  layout.WriteHtonU16<0> (m_sourcePort);
+  layout.WriteHtonU16<2> (m_destinationPort);
+  layout.WriteHtonU32<4> (m_sequenceNumber.GetValue ());
+  layout.WriteHtonU32<8> (m_ackNumber.GetValue ());
+  layout.WriteHtonU16<12> (GetLength () << 12 | m_flags); //reserved bits are all zero
+  layout.WriteHtonU16<14> (m_windowSize);
+  layout.WriteHtonU16<16> (0);
+  layout.WriteHtonU16<18> (m_urgentPointer);
+  layout.WriteTo (i);
 
   // Serialize options if they exist
   // This implementation does not presently try to align options on word
@@ -361,16 +364,17 @@ TcpHeader::Deserialize (Buffer::Iterator start)
 {
   m_optionsLen = 0;
   Buffer::Iterator i = start;
-  m_sourcePort = i.ReadNtohU16 ();
-  m_destinationPort = i.ReadNtohU16 ();
-  m_sequenceNumber = i.ReadNtohU32 ();
-  m_ackNumber = i.ReadNtohU32 ();
-  uint16_t field = i.ReadNtohU16 ();
+  FixedHeaderLayout<20> layout;
+  layout.ReadFrom (i);
+  m_sourcePort = layout.ReadNtohU16<0> ();
+  m_destinationPort = layout.ReadNtohU16<2> ();
+  m_sequenceNumber = layout.ReadNtohU32<4> ();
+  m_ackNumber = layout.ReadNtohU32<8> ();
+  uint16_t field = layout.ReadNtohU16<12> ();
   m_flags = field & 0xFF;
   m_length = field >> 12;
-  m_windowSize = i.ReadNtohU16 ();
-  i.Next (2);
-  m_urgentPointer = i.ReadNtohU16 ();
+  m_windowSize = layout.ReadNtohU16<14> ();
+  m_urgentPointer = layout.ReadNtohU16<18> ();
 
   // Deserialize options if they exist
   m_options.clear ();
@@ -44,6 +44,9 @@
 #include "tcp-congestion-ops.h"
 #include "tcp-recovery-ops.h"
 #include "rtt-estimator.h"
+#include "tcp-option-ts.h"
+#include "tcp-gso-tag.h"
+#include "ipv4-interface.h"
 
 #include <vector>
 #include <sstream>
@@ -86,6 +89,13 @@ TcpL4Protocol::GetTypeId (void)
                    TypeIdValue (TcpClassicRecovery::GetTypeId ()),
                    MakeTypeIdAccessor (&TcpL4Protocol::m_recoveryTypeId),
                    MakeTypeIdChecker ())
+    .AddAttribute ("GroTimeout",
+                   "Maximum time an in-sequence data segment is held to be "
+                   "coalesced with the following ones of the same flow "
+                   "(zero disables receive offload)",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&TcpL4Protocol::m_groTimeout),
+                   MakeTimeChecker (Seconds (0)))
     .AddAttribute ("SocketList", "The list of sockets associated to this protocol.",
                    ObjectVectorValue (),
                    MakeObjectVectorAccessor (&TcpL4Protocol::m_sockets),
@@ -162,6 +172,12 @@ TcpL4Protocol::DoDispose (void)
   NS_LOG_FUNCTION (this);
   m_sockets.clear ();
 
+  for (std::map<GroKey, GroEntry>::iterator it = m_gro.begin (); it != m_gro.end (); ++it)
+    {
+      it->second.m_flushEvent.Cancel ();
+    }
+  m_gro.clear ();
+
   if (m_endPoints != 0)
     {
       delete m_endPoints;
@@ -449,6 +465,22 @@ TcpL4Protocol::Receive (Ptr<Packet> packet,
       return checksumControl;
     }
 
+  if (m_groTimeout.IsStrictlyPositive ())
+    {
+      return GroReceive (packet, incomingIpHeader, incomingTcpHeader, incomingInterface);
+    }
+
+  return Deliver (packet, incomingIpHeader, incomingTcpHeader, incomingInterface);
+}
+
+enum IpL4Protocol::RxStatus
+TcpL4Protocol::Deliver (Ptr<Packet> packet,
+                        const Ipv4Header &incomingIpHeader,
+                        const TcpHeader &incomingTcpHeader,
+                        Ptr<Ipv4Interface> incomingInterface)
+{
+  NS_LOG_FUNCTION (this << packet << incomingIpHeader << incomingTcpHeader << incomingInterface);
+
   Ipv4EndPointDemux::EndPoints endPoints;
   endPoints = m_endPoints->Lookup (incomingIpHeader.GetDestination (),
                                    incomingTcpHeader.GetDestinationPort (),
@@ -497,6 +529,192 @@ TcpL4Protocol::Receive (Ptr<Packet> packet,
   return IpL4Protocol::RX_OK;
 }
 
+bool
+TcpL4Protocol::GroCanMerge (const GroEntry &entry, const Ipv4Header &incomingIpHeader,
+                            const TcpHeader &incomingTcpHeader, uint32_t payloadSize) const
+{
+  const TcpHeader &held = entry.m_tcpHeader;
+
+  if (entry.m_lastPayload != entry.m_segmentSize
+      || incomingTcpHeader.GetSequenceNumber () != entry.m_nextSeq
+      || incomingTcpHeader.GetAckNumber () != held.GetAckNumber ()
+      || incomingTcpHeader.GetWindowSize () != held.GetWindowSize ()
+      || incomingTcpHeader.GetSerializedSize () != held.GetSerializedSize ()
+      || incomingIpHeader.GetTos () != entry.m_ipHeader.GetTos ()
+      || entry.m_packet->GetSize () + payloadSize > 65535U - 20U)
+    {
+      return false;
+    }
+
+  // Only the timestamp option is allowed, and it must be the same
+  if (held.HasOption (TcpOption::TS))
+    {
+      Ptr<const TcpOptionTS> heldTs = DynamicCast<const TcpOptionTS> (held.GetOption (TcpOption::TS));
+      Ptr<const TcpOptionTS> ts = DynamicCast<const TcpOptionTS> (incomingTcpHeader.GetOption (TcpOption::TS));
+      if (ts == 0 || ts->GetTimestamp () != heldTs->GetTimestamp ()
+          || ts->GetEcho () != heldTs->GetEcho ())
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+enum IpL4Protocol::RxStatus
+TcpL4Protocol::GroReceive (Ptr<Packet> packet,
+                           const Ipv4Header &incomingIpHeader,
+                           const TcpHeader &incomingTcpHeader,
+                           Ptr<Ipv4Interface> incomingInterface)
+{
+  NS_LOG_FUNCTION (this << packet << incomingIpHeader << incomingTcpHeader << incomingInterface);
+
+  GroKey key (uint64_t (incomingIpHeader.GetSource ().Get ()) << 32 | uint64_t (incomingIpHeader.GetDestination ().Get ()),
+              uint32_t (incomingTcpHeader.GetSourcePort ()) << 16 | uint32_t (incomingTcpHeader.GetDestinationPort ()));
+  uint32_t payloadSize = packet->GetSize () - incomingTcpHeader.GetSerializedSize ();
+
+  // Only pure data segments, carrying no option other than the timestamp
+  // (and the padding)
+  bool mergeable = incomingTcpHeader.GetFlags () == TcpHeader::ACK && payloadSize > 0;
+  const TcpHeader::TcpOptionList &options = incomingTcpHeader.GetOptionList ();
+  for (TcpHeader::TcpOptionList::const_iterator it = options.begin ();
+       mergeable && it != options.end (); ++it)
+    {
+      uint8_t kind = (*it)->GetKind ();
+      mergeable = kind == TcpOption::TS || kind == TcpOption::NOP || kind == TcpOption::END;
+    }
+
+  std::map<GroKey, GroEntry>::iterator it = m_gro.find (key);
+  if (it != m_gro.end () && it->second.m_packet != 0)
+    {
+      GroEntry &entry = it->second;
+      if (mergeable && GroCanMerge (entry, incomingIpHeader, incomingTcpHeader, payloadSize))
+        {
+          entry.m_packet->AddAtEnd (packet->CreateFragment (incomingTcpHeader.GetSerializedSize (),
+                                                            payloadSize));
+          entry.m_nextSeq += payloadSize;
+          entry.m_lastPayload = payloadSize;
+          entry.m_lastArrival = Simulator::Now ();
+          ++entry.m_segments;
+          NS_LOG_LOGIC ("Coalesced segment " << incomingTcpHeader.GetSequenceNumber () <<
+                        ", " << entry.m_segments << " segments held");
+          return IpL4Protocol::RX_OK;
+        }
+      GroDeliver (key);
+      // The delivery may have changed the table
+      it = m_gro.find (key);
+    }
+
+  if (!mergeable)
+    {
+      return Deliver (packet, incomingIpHeader, incomingTcpHeader, incomingInterface);
+    }
+
+  // Only hold the segment if the previous data segment of the flow arrived
+  // less than GroTimeout ago: a flow whose segments are further apart would
+  // never coalesce, and would only be delayed.
+  if (it == m_gro.end () || Simulator::Now () - it->second.m_lastArrival > m_groTimeout)
+    {
+      enum IpL4Protocol::RxStatus status = Deliver (packet, incomingIpHeader,
+                                                    incomingTcpHeader, incomingInterface);
+      if (status == IpL4Protocol::RX_OK)
+        {
+          GroEntry &entry = m_gro[key];
+          entry.m_lastArrival = Simulator::Now ();
+          if (!entry.m_flushEvent.IsRunning ())
+            {
+              entry.m_flushEvent = Simulator::Schedule (m_groTimeout, &TcpL4Protocol::GroFlush, this, key);
+            }
+        }
+      return status;
+    }
+
+  // Deliver the segment now if no endpoint matches it, so that the
+  // endpoint lookup failure is reported to the IP layer
+  Ipv4EndPointDemux::EndPoints endPoints;
+  endPoints = m_endPoints->Lookup (incomingIpHeader.GetDestination (),
+                                   incomingTcpHeader.GetDestinationPort (),
+                                   incomingIpHeader.GetSource (),
+                                   incomingTcpHeader.GetSourcePort (),
+                                   incomingInterface);
+  if (endPoints.empty ())
+    {
+      return Deliver (packet, incomingIpHeader, incomingTcpHeader, incomingInterface);
+    }
+
+  GroEntry &entry = it->second;
+  entry.m_packet = packet->Copy ();
+  entry.m_ipHeader = incomingIpHeader;
+  entry.m_tcpHeader = incomingTcpHeader;
+  entry.m_interface = incomingInterface;
+  entry.m_nextSeq = incomingTcpHeader.GetSequenceNumber () + SequenceNumber32 (payloadSize);
+  entry.m_segmentSize = payloadSize;
+  entry.m_lastPayload = payloadSize;
+  entry.m_lastArrival = Simulator::Now ();
+  entry.m_segments = 1;
+  entry.m_flushEvent.Cancel ();
+  entry.m_flushEvent = Simulator::Schedule (m_groTimeout, &TcpL4Protocol::GroFlush, this, key);
+  return IpL4Protocol::RX_OK;
+}
+
+void
+TcpL4Protocol::GroDeliver (GroKey key)
+{
+  NS_LOG_FUNCTION (this);
+
+  std::map<GroKey, GroEntry>::iterator it = m_gro.find (key);
+  NS_ASSERT (it != m_gro.end () && it->second.m_packet != 0);
+
+  // Take the segments out of the entry before delivering, as the socket
+  // may send (and receive, over a loopback) packets of the same flow
+  GroEntry &entry = it->second;
+  Ptr<Packet> packet = entry.m_packet;
+  Ipv4Header ipHeader = entry.m_ipHeader;
+  TcpHeader tcpHeader = entry.m_tcpHeader;
+  Ptr<Ipv4Interface> incomingInterface = entry.m_interface;
+  entry.m_packet = 0;
+  entry.m_interface = 0;
+
+  if (entry.m_segments > 1)
+    {
+      NS_LOG_LOGIC ("Delivering " << entry.m_segments << " coalesced segments");
+      packet->AddPacketTag (TcpGsoTag (static_cast<uint16_t> (entry.m_segmentSize),
+                                       entry.m_segments));
+      ipHeader.SetPayloadSize (packet->GetSize ());
+    }
+  Deliver (packet, ipHeader, tcpHeader, incomingInterface);
+}
+
+void
+TcpL4Protocol::GroFlush (GroKey key)
+{
+  NS_LOG_FUNCTION (this);
+
+  std::map<GroKey, GroEntry>::iterator it = m_gro.find (key);
+  NS_ASSERT (it != m_gro.end ());
+
+  if (it->second.m_packet != 0)
+    {
+      GroDeliver (key);
+      it = m_gro.find (key);
+      if (it == m_gro.end () || it->second.m_flushEvent.IsRunning ())
+        {
+          return;
+        }
+    }
+
+  // Forget the flow once no segment arrived for GroTimeout, so that its
+  // next segment is delivered without being held
+  Time idle = Simulator::Now () - it->second.m_lastArrival;
+  if (idle < m_groTimeout)
+    {
+      it->second.m_flushEvent = Simulator::Schedule (m_groTimeout - idle, &TcpL4Protocol::GroFlush, this, key);
+    }
+  else
+    {
+      m_gro.erase (it);
+    }
+}
+
 enum IpL4Protocol::RxStatus
 TcpL4Protocol::Receive (Ptr<Packet> packet,
                         Ipv6Header const &incomingIpHeader,
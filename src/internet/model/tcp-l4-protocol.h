@@ -22,11 +22,16 @@
 #define TCP_L4_PROTOCOL_H
 
 #include <stdint.h>
+#include <map>
 
 #include "ns3/ipv4-address.h"
 #include "ns3/ipv6-address.h"
+#include "ns3/ipv4-header.h"
 #include "ns3/sequence-number.h"
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
 #include "ip-l4-protocol.h"
+#include "tcp-header.h"
 
 
 namespace ns3 {
@@ -314,6 +319,95 @@ protected:
                          const Address &incomingDAddr);
 
 private:
+  /**
+   * \brief Demultiplex an IPv4 segment whose checksum has been verified
+   *
+   * \param packet the packet, starting with the TCP header
+   * \param incomingIpHeader the IPv4 header
+   * \param incomingTcpHeader the TCP header
+   * \param incomingInterface the interface the packet was received on
+   * \return the result of the delivery
+   */
+  enum IpL4Protocol::RxStatus Deliver (Ptr<Packet> packet,
+                                       const Ipv4Header &incomingIpHeader,
+                                       const TcpHeader &incomingTcpHeader,
+                                       Ptr<Ipv4Interface> incomingInterface);
+
+  /**
+   * \brief Key of a flow in the receive offload table
+   *
+   * The first element combines the source and destination addresses,
+   * the second one the source and destination ports.
+   */
+  typedef std::pair<uint64_t, uint32_t> GroKey;
+
+  /**
+   * \brief Segments of a flow held for coalescing
+   *
+   * The entry of a flow is kept, without any held segment, until no data
+   * segment of the flow arrived for GroTimeout.
+   */
+  struct GroEntry
+  {
+    Ptr<Packet> m_packet;            //!< Coalesced packet, with the first TCP header, or 0
+    Ipv4Header m_ipHeader;           //!< IPv4 header of the first segment
+    TcpHeader m_tcpHeader;           //!< TCP header of the first segment
+    Ptr<Ipv4Interface> m_interface;  //!< Incoming interface
+    SequenceNumber32 m_nextSeq;      //!< Sequence number expected to coalesce
+    uint32_t m_segmentSize {0};      //!< Payload size of the first segment
+    uint32_t m_lastPayload {0};      //!< Payload size of the last segment
+    uint16_t m_segments {0};         //!< Number of coalesced segments
+    Time m_lastArrival;              //!< Arrival time of the last data segment
+    EventId m_flushEvent;            //!< Timeout flushing or removing the entry
+  };
+
+  /**
+   * \brief Coalesce an IPv4 segment with the ones held for its flow
+   *
+   * In-sequence data segments of the same flow are held for at most
+   * GroTimeout and delivered as a single packet, marked with a TcpGsoTag
+   * counting the segments. Any other segment flushes the held ones first.
+   *
+   * A data segment is only held if the previous data segment of its flow
+   * arrived less than GroTimeout ago, and if an endpoint matches it: the
+   * other segments are delivered at once, so that the flows which never
+   * coalesce are not delayed and the lookup failures are reported.
+   *
+   * \param packet the packet, starting with the TCP header
+   * \param incomingIpHeader the IPv4 header
+   * \param incomingTcpHeader the TCP header
+   * \param incomingInterface the interface the packet was received on
+   * \return the result of the delivery
+   */
+  enum IpL4Protocol::RxStatus GroReceive (Ptr<Packet> packet,
+                                          const Ipv4Header &incomingIpHeader,
+                                          const TcpHeader &incomingTcpHeader,
+                                          Ptr<Ipv4Interface> incomingInterface);
+
+  /**
+   * \brief Check if a segment can be appended to the held ones
+   * \param entry the segments held for the flow
+   * \param incomingIpHeader the IPv4 header of the segment
+   * \param incomingTcpHeader the TCP header of the segment
+   * \param payloadSize the payload size of the segment
+   * \return true if the segment can be coalesced
+   */
+  bool GroCanMerge (const GroEntry &entry, const Ipv4Header &incomingIpHeader,
+                    const TcpHeader &incomingTcpHeader, uint32_t payloadSize) const;
+
+  /**
+   * \brief Deliver the segments held for a flow
+   * \param key the flow
+   */
+  void GroDeliver (GroKey key);
+
+  /**
+   * \brief Deliver the segments held for a flow at the end of GroTimeout,
+   * and remove the entry of the flow once it is idle
+   * \param key the flow
+   */
+  void GroFlush (GroKey key);
+
   Ptr<Node> m_node;                //!< the node this stack is associated with
   Ipv4EndPointDemux *m_endPoints;  //!< A list of IPv4 end points.
   Ipv6EndPointDemux *m_endPoints6; //!< A list of IPv6 end points.
@@ -323,6 +417,8 @@ private:
   std::vector<Ptr<TcpSocketBase> > m_sockets;      //!< list of sockets
   IpL4Protocol::DownTargetCallback m_downTarget;   //!< Callback to send packets over IPv4
   IpL4Protocol::DownTargetCallback6 m_downTarget6; //!< Callback to send packets over IPv6
+  Time m_groTimeout;                               //!< Max time a segment is held for coalescing
+  std::map<GroKey, GroEntry> m_gro;                //!< Segments held for coalescing, per flow
 
   /**
    * \brief Copy constructor
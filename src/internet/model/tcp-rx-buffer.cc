@@ -113,9 +113,9 @@ TcpRxBuffer::MaxRxSequence (void) const
     { // No data allowed beyond FIN
       return m_finSeq;
     }
-  else if (m_data.size () && m_nextRxSeq > m_data.begin ()->first)
+  else if (m_availBytes > 0)
     { // No data allowed beyond Rx window allowed
-      return m_data.begin ()->first + SequenceNumber32 (m_maxBuffer);
+      return SequenceNumber32 (m_nextRxSeq.Get ().GetValue () - m_availBytes + m_maxBuffer);
     }
   return m_nextRxSeq + SequenceNumber32 (m_maxBuffer);
 }
@@ -149,14 +149,23 @@ TcpRxBuffer::Add (Ptr<Packet> p, TcpHeader const& tcph)
 
   // Trim packet to fit Rx window specification
   if (headSeq < m_nextRxSeq) headSeq = m_nextRxSeq;
-  if (m_data.size ())
+  if (m_size > 0)
     {
-      SequenceNumber32 maxSeq = m_data.begin ()->first + SequenceNumber32 (m_maxBuffer);
+      SequenceNumber32 firstSeq = m_availBytes > 0
+        ? SequenceNumber32 (m_nextRxSeq.Get ().GetValue () - m_availBytes)
+        : m_data.begin ()->first;
+      SequenceNumber32 maxSeq = firstSeq + SequenceNumber32 (m_maxBuffer);
       if (maxSeq < tailSeq) tailSeq = maxSeq;
       if (tailSeq < headSeq) headSeq = tailSeq;
     }
-  // Remove overlapped bytes from packet
-  BufIterator i = m_data.begin ();
+  // Remove overlapped bytes from packet. The in-sequence data ends at
+  // m_nextRxSeq, so only the out-of-order blocks can overlap: start from
+  // the last one beginning at or before headSeq.
+  BufIterator i = m_data.upper_bound (headSeq);
+  if (i != m_data.begin ())
+    {
+      --i;
+    }
   while (i != m_data.end () && i->first <= tailSeq)
     {
       SequenceNumber32 lastByteSeq = i->first + SequenceNumber32 (i->second->GetSize ());
@@ -192,33 +201,29 @@ TcpRxBuffer::Add (Ptr<Packet> p, TcpHeader const& tcph)
       p = p->CreateFragment (start, length);
       NS_ASSERT (length == p->GetSize ());
     }
-  // Insert packet into buffer
-  NS_ASSERT (m_data.find (headSeq) == m_data.end ()); // Shouldn't be there yet
-  m_data [ headSeq ] = p;
+
+  NS_LOG_LOGIC ("Buffered packet of seqno=" << headSeq << " len=" << p->GetSize ());
+  m_size += p->GetSize ();      // Occupancy
 
   if (headSeq > m_nextRxSeq)
     {
+      // Insert packet into the out-of-order blocks
+      NS_ASSERT (m_data.find (headSeq) == m_data.end ()); // Shouldn't be there yet
+      m_data [ headSeq ] = p;
+
       // Generate a new SACK block
       UpdateSackList (headSeq, tailSeq);
     }
-
-  NS_LOG_LOGIC ("Buffered packet of seqno=" << headSeq << " len=" << p->GetSize ());
-  // Update variables
-  m_size += p->GetSize ();      // Occupancy
-  for (i = m_data.begin (); i != m_data.end (); ++i)
+  else
     {
-      if (i->first < m_nextRxSeq)
-        {
-          continue;
-        }
-      else if (i->first > m_nextRxSeq)
-        {
-          break;
-        };
-      m_nextRxSeq = i->first + SequenceNumber32 (i->second->GetSize ());
-      m_availBytes += i->second->GetSize ();
+      // In-sequence packet, which may fill the hole before other blocks
+      m_inSeqData.push_back (p);
+      m_nextRxSeq = tailSeq;
+      m_availBytes += p->GetSize ();
+      PullInSequenceData ();
       ClearSackList (m_nextRxSeq);
     }
+
   NS_LOG_LOGIC ("Updated buffer occupancy=" << m_size << " nextRxSeq=" << m_nextRxSeq);
   if (m_gotFin && m_nextRxSeq == m_finSeq)
     { // Account for the FIN packet
@@ -227,6 +232,21 @@ TcpRxBuffer::Add (Ptr<Packet> p, TcpHeader const& tcph)
   return true;
 }
 
+void
+TcpRxBuffer::PullInSequenceData (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  BufIterator i = m_data.begin ();
+  while (i != m_data.end () && i->first == m_nextRxSeq)
+    {
+      m_nextRxSeq = i->first + SequenceNumber32 (i->second->GetSize ());
+      m_availBytes += i->second->GetSize ();
+      m_inSeqData.push_back (i->second);
+      m_data.erase (i++);
+    }
+}
+
 uint32_t
 TcpRxBuffer::GetSackListSize () const
 {
@@ -368,32 +388,41 @@ TcpRxBuffer::Extract (uint32_t maxSize)
   uint32_t extractSize = std::min (maxSize, m_availBytes);
   NS_LOG_LOGIC ("Requested to extract " << extractSize << " bytes from TcpRxBuffer of size=" << m_size);
   if (extractSize == 0) return nullptr;  // No contiguous block to return
-  NS_ASSERT (m_data.size ()); // At least we have something to extract
-  Ptr<Packet> outPkt = Create<Packet> (); // The packet that contains all the data to return
-  BufIterator i;
+  NS_ASSERT (m_inSeqData.size ()); // At least we have something to extract
+
+  // The packets are not referenced anywhere else, so the first one becomes
+  // the returned packet, and the following are appended to it
+  Ptr<Packet> outPkt = nullptr;
   while (extractSize)
     { // Check the buffered data for delivery
-      i = m_data.begin ();
-      NS_ASSERT (i->first <= m_nextRxSeq); // in-sequence data expected
+      Ptr<Packet> head = m_inSeqData.front ();
       // Check if we send the whole pkt or just a partial
-      uint32_t pktSize = i->second->GetSize ();
+      uint32_t pktSize = head->GetSize ();
+      Ptr<Packet> part;
       if (pktSize <= extractSize)
         { // Whole packet is extracted
-          outPkt->AddAtEnd (i->second);
-          m_data.erase (i);
-          m_size -= pktSize;
-          m_availBytes -= pktSize;
-          extractSize -= pktSize;
+          part = head;
+          m_inSeqData.pop_front ();
         }
       else
         { // Partial is extracted and done
-          outPkt->AddAtEnd (i->second->CreateFragment (0, extractSize));
-          m_data[i->first + SequenceNumber32 (extractSize)] = i->second->CreateFragment (extractSize, pktSize - extractSize);
-          m_data.erase (i);
-          m_size -= extractSize;
-          m_availBytes -= extractSize;
-          extractSize = 0;
+          part = head->CreateFragment (0, extractSize);
+          head->RemoveAtStart (extractSize);
+        }
+      uint32_t partSize = part->GetSize ();
+      if (outPkt == nullptr)
+        {
+          // Packet tags of the received segments are not delivered
+          outPkt = part;
+          outPkt->RemoveAllPacketTags ();
+        }
+      else
+        {
+          outPkt->AddAtEnd (part);
         }
+      m_size -= partSize;
+      m_availBytes -= partSize;
+      extractSize -= partSize;
     }
   if (outPkt->GetSize () == 0)
     {
@@ -401,7 +430,7 @@ TcpRxBuffer::Extract (uint32_t maxSize)
       return nullptr;
     }
   NS_LOG_LOGIC ("Extracted " << outPkt->GetSize ( ) << " bytes, bufsize=" << m_size
-                             << ", num pkts in buffer=" << m_data.size ());
+                             << ", num pkts in buffer=" << m_inSeqData.size () + m_data.size ());
   return outPkt;
 }
 
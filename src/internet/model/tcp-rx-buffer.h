@@ -22,6 +22,7 @@
 #define TCP_RX_BUFFER_H
 
 #include <map>
+#include <deque>
 #include "ns3/traced-value.h"
 #include "ns3/trace-source-accessor.h"
 #include "ns3/sequence-number.h"
@@ -215,6 +216,12 @@ private:
    */
   void ClearSackList (const SequenceNumber32 &seq);
 
+  /**
+   * \brief Move the out-of-order data that became in-sequence to the
+   * in-sequence queue, advancing the next Rx sequence accordingly
+   */
+  void PullInSequenceData (void);
+
   TcpOptionSack::SackList m_sackList; //!< Sack list (updated constantly)
 
   /// container for data stored in the buffer
@@ -225,7 +232,8 @@ private:
   uint32_t m_size;                           //!< Number of total data bytes in the buffer, not necessarily contiguous
   uint32_t m_maxBuffer;                      //!< Upper bound of the number of data bytes in buffer (RCV.WND)
   uint32_t m_availBytes;                     //!< Number of bytes available to read, i.e. contiguous block at head
-  std::map<SequenceNumber32, Ptr<Packet> > m_data; //!< Corresponding data (may be null)
+  std::deque<Ptr<Packet> > m_inSeqData;      //!< In-sequence data, ending at m_nextRxSeq (m_availBytes long)
+  std::map<SequenceNumber32, Ptr<Packet> > m_data; //!< Out-of-order data, as disjoint blocks indexed by their first byte
 };
 
 } //namespace ns3
@@ -58,6 +58,8 @@
 #include "tcp-option-sack.h"
 #include "tcp-congestion-ops.h"
 #include "tcp-recovery-ops.h"
+#include "tcp-rate-ops.h"
+#include "tcp-gso-tag.h"
 
 #include <math.h>
 #include <algorithm>
@@ -141,6 +143,13 @@ TcpSocketBase::GetTypeId (void)
                    BooleanValue (true),
                    MakeBooleanAccessor (&TcpSocketBase::m_limitedTx),
                    MakeBooleanChecker ())
+    .AddAttribute ("GsoMaxSegments",
+                   "Maximum number of MSS-sized segments handed down to IPv4 "
+                   "as a single super-segment, split after routing "
+                   "(1 disables segmentation offload)",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&TcpSocketBase::m_gsoMaxSegments),
+                   MakeUintegerChecker<uint32_t> (1, 44))
     .AddAttribute ("EcnMode", "Determines the mode of ECN",
                    EnumValue (EcnMode_t::NoEcn),
                    MakeEnumAccessor (&TcpSocketBase::m_ecnMode),
@@ -243,9 +252,11 @@ TcpSocketBase::TcpSocketBase (void)
   m_rxBuffer = CreateObject<TcpRxBuffer> ();
   m_txBuffer = CreateObject<TcpTxBuffer> ();
   m_tcb      = CreateObject<TcpSocketState> ();
+  m_rateOps  = CreateObject<TcpRateLinux> ();
 
   m_tcb->m_currentPacingRate = m_tcb->m_maxPacingRate;
   m_pacingTimer.SetFunction (&TcpSocketBase::NotifyPacingPerformed, this);
+  InitializeTimers ();
 
   bool ok;
 
@@ -329,6 +340,7 @@ TcpSocketBase::TcpSocketBase (const TcpSocketBase& sock)
     m_recover (sock.m_recover),
     m_retxThresh (sock.m_retxThresh),
     m_limitedTx (sock.m_limitedTx),
+    m_gsoMaxSegments (sock.m_gsoMaxSegments),
     m_isFirstPartialAck (sock.m_isFirstPartialAck),
     m_txTrace (sock.m_txTrace),
     m_rxTrace (sock.m_rxTrace),
@@ -356,9 +368,11 @@ TcpSocketBase::TcpSocketBase (const TcpSocketBase& sock)
   m_txBuffer = CopyObject (sock.m_txBuffer);
   m_rxBuffer = CopyObject (sock.m_rxBuffer);
   m_tcb = CopyObject (sock.m_tcb);
+  m_rateOps = CreateObject<TcpRateLinux> ();
 
   m_tcb->m_currentPacingRate = m_tcb->m_maxPacingRate;
   m_pacingTimer.SetFunction (&TcpSocketBase::NotifyPacingPerformed, this);
+  InitializeTimers ();
 
   if (sock.m_congestionControl)
     {
@@ -790,6 +804,12 @@ TcpSocketBase::Send (Ptr<Packet> p, uint32_t flags)
   NS_ABORT_MSG_IF (flags, "use of flags is not supported in TcpSocketBase::Send()");
   if (m_state == ESTABLISHED || m_state == SYN_SENT || m_state == CLOSE_WAIT)
     {
+      // If the sender was waiting for the application, the delivery rate
+      // samples taken from now on are application-limited
+      m_rateOps->CalculateAppLimited (m_tcb->m_cWnd, BytesInFlight (), m_tcb->m_segmentSize,
+                                      m_txBuffer->TailSequence (), m_tcb->m_nextTxSequence,
+                                      m_txBuffer->GetLost (), m_txBuffer->GetRetransmitsCount ());
+
       // Store the packet into Tx buffer
       if (!m_txBuffer->Add (p))
         { // TxBuffer overflow, send failed
@@ -1304,6 +1324,8 @@ TcpSocketBase::DoForwardUp (Ptr<Packet> packet, const Address &fromAddress,
           EstimateRtt (tcpHeader);
           m_highRxAckMark = tcpHeader.GetAckNumber ();
         }
+
+      m_congestionControl->Init (m_tcb);
     }
   else if (tcpHeader.GetFlags () & TcpHeader::ACK)
     {
@@ -1331,17 +1353,17 @@ TcpSocketBase::DoForwardUp (Ptr<Packet> packet, const Address &fromAddress,
     }
 
 
-  if (m_rWnd.Get () == 0 && m_persistEvent.IsExpired ())
+  if (m_rWnd.Get () == 0 && m_persistTimer.IsExpired ())
     { // Zero window: Enter persist state to send 1 byte to probe
       NS_LOG_LOGIC (this << " Enter zerowindow persist state");
       NS_LOG_LOGIC (this << " Cancelled ReTxTimeout event which was set to expire at " <<
-                    (Simulator::Now () + Simulator::GetDelayLeft (m_retxEvent)).GetSeconds ());
-      m_retxEvent.Cancel ();
+                    (Simulator::Now () + m_retxTimer.GetDelayLeft ()).GetSeconds ());
+      CancelReTxTimer ();
       NS_LOG_LOGIC ("Schedule persist timeout at time " <<
                     Simulator::Now ().GetSeconds () << " to expire at time " <<
                     (Simulator::Now () + m_persistTimeout).GetSeconds ());
-      m_persistEvent = Simulator::Schedule (m_persistTimeout, &TcpSocketBase::PersistTimeout, this);
-      NS_ASSERT (m_persistTimeout == Simulator::GetDelayLeft (m_persistEvent));
+      m_persistTimer.Schedule (m_persistTimeout);
+      NS_ASSERT (m_persistTimeout == m_persistTimer.GetDelayLeft ());
     }
 
   // TCP state machine code in different process functions
@@ -1395,11 +1417,11 @@ TcpSocketBase::DoForwardUp (Ptr<Packet> packet, const Address &fromAddress,
       break;
     }
 
-  if (m_rWnd.Get () != 0 && m_persistEvent.IsRunning ())
+  if (m_rWnd.Get () != 0 && m_persistTimer.IsRunning ())
     { // persist probes end, the other end has increased the window
       NS_ASSERT (m_connected);
       NS_LOG_LOGIC (this << " Leaving zerowindow persist state");
-      m_persistEvent.Cancel ();
+      m_persistTimer.Cancel ();
 
       SendPendingData (m_connected);
     }
@@ -1567,7 +1589,10 @@ TcpSocketBase::EnterRecovery ()
   // compatibility with old ns-3 versions
   uint32_t bytesInFlight = m_sackEnabled ? BytesInFlight () : BytesInFlight () + m_tcb->m_segmentSize;
   m_tcb->m_ssThresh = m_congestionControl->GetSsThresh (m_tcb, bytesInFlight);
-  m_recoveryOps->EnterRecovery (m_tcb, m_dupAckCount, UnAckDataCount (), m_txBuffer->GetSacked ());
+  if (!m_congestionControl->HasCongControl ())
+    {
+      m_recoveryOps->EnterRecovery (m_tcb, m_dupAckCount, UnAckDataCount (), m_txBuffer->GetSacked ());
+    }
 
   NS_LOG_INFO (m_dupAckCount << " dupack. Enter fast recovery mode." <<
                "Reset cwnd to " << m_tcb->m_cWnd << ", ssthresh to " <<
@@ -1625,7 +1650,10 @@ TcpSocketBase::DupAck ()
           // has left the network. This is equivalent to a SACK of one block.
           m_txBuffer->AddRenoSack ();
         }
-      m_recoveryOps->DoRecovery (m_tcb, 0, m_txBuffer->GetSacked ());
+      if (!m_congestionControl->HasCongControl ())
+        {
+          m_recoveryOps->DoRecovery (m_tcb, 0, m_txBuffer->GetSacked ());
+        }
       NS_LOG_INFO (m_dupAckCount << " Dupack received in fast recovery mode."
                    "Increase cwnd to " << m_tcb->m_cWnd);
     }
@@ -1680,12 +1708,16 @@ TcpSocketBase::ReceivedAck (Ptr<Packet> packet, const TcpHeader& tcpHeader)
   // RFC 6675, Section 5, 1st paragraph:
   // Upon the receipt of any ACK containing SACK information, the
   // scoreboard MUST be updated via the Update () routine (done in ReadOptions)
+  uint32_t priorInFlight = BytesInFlight ();
+  uint64_t previousDelivered = m_rateOps->GetConnectionRate ().m_delivered;
+  uint32_t previousLost = m_txBuffer->GetLost ();
+
   bool scoreboardUpdated = false;
   ReadOptions (tcpHeader, scoreboardUpdated);
 
   SequenceNumber32 ackNumber = tcpHeader.GetAckNumber ();
   SequenceNumber32 oldHeadSequence = m_txBuffer->HeadSequence ();
-  m_txBuffer->DiscardUpTo (ackNumber);
+  m_txBuffer->DiscardUpTo (ackNumber, MakeCallback (&TcpRateOps::SkbDelivered, m_rateOps));
 
   if (ackNumber > oldHeadSequence && (m_tcb->m_ecnState != TcpSocketState::ECN_DISABLED) && (tcpHeader.GetFlags () & TcpHeader::ECE))
     {
@@ -1702,6 +1734,22 @@ TcpSocketBase::ReceivedAck (Ptr<Packet> packet, const TcpHeader& tcpHeader)
   // are inside the function ProcessAck
   ProcessAck (ackNumber, scoreboardUpdated, oldHeadSequence);
 
+  // Sample the delivery rate over the newest (s)acked segment, and let a
+  // rate-based congestion control set cWnd and the pacing rate from it
+  uint32_t currentDelivered = static_cast<uint32_t> (m_rateOps->GetConnectionRate ().m_delivered - previousDelivered);
+  uint32_t currentLost = m_txBuffer->GetLost ();
+  uint32_t lost = currentLost > previousLost ? currentLost - previousLost : 0;
+  const TcpRateOps::TcpRateSample &rateSample = m_rateOps->GenerateSample (currentDelivered, lost,
+                                                                           false, priorInFlight,
+                                                                           m_tcb->m_minRtt);
+  if (m_congestionControl->HasCongControl ())
+    {
+      const TcpRateOps::TcpRateConnection &rateConn = m_rateOps->GetConnectionRate ();
+      m_tcb->m_bytesInFlight = BytesInFlight ();
+      m_congestionControl->CongControl (m_tcb, rateConn, rateSample);
+      m_tcb->m_cWndInfl = m_tcb->m_cWnd;
+    }
+
   // If there is any data piggybacked, store it into m_rxBuffer
   if (packet->GetSize () > 0)
     {
@@ -1837,7 +1885,7 @@ TcpSocketBase::ProcessAck (const SequenceNumber32 &ackNumber, bool scoreboardUpd
             }
           DoRetransmit (); // Assume the next seq is lost. Retransmit lost packet
           m_tcb->m_cWndInfl = SafeSubtraction (m_tcb->m_cWndInfl, bytesAcked);
-          if (segsAcked >= 1)
+          if (segsAcked >= 1 && !m_congestionControl->HasCongControl ())
             {
               m_recoveryOps->DoRecovery (m_tcb, bytesAcked, m_txBuffer->GetSacked ());
             }
@@ -1960,7 +2008,10 @@ TcpSocketBase::ProcessAck (const SequenceNumber32 &ackNumber, bool scoreboardUpd
           if (exitedFastRecovery)
             {
               NewAck (ackNumber, true);
-              m_recoveryOps->ExitRecovery (m_tcb);
+              if (!m_congestionControl->HasCongControl ())
+                {
+                  m_recoveryOps->ExitRecovery (m_tcb);
+                }
               NS_LOG_DEBUG ("Leaving Fast Recovery; BytesInFlight() = " <<
                             BytesInFlight () << "; cWnd = " << m_tcb->m_cWnd);
             }
@@ -2026,7 +2077,7 @@ TcpSocketBase::ProcessSynSent (Ptr<Packet> packet, const TcpHeader& tcpHeader)
       m_congestionControl->CongestionStateSet (m_tcb, TcpSocketState::CA_OPEN);
       m_state = ESTABLISHED;
       m_connected = true;
-      m_retxEvent.Cancel ();
+      CancelReTxTimer ();
       m_delAckCount = m_delAckMaxCount;
       ReceivedData (packet, tcpHeader);
       Simulator::ScheduleNow (&TcpSocketBase::ConnectionSucceeded, this);
@@ -2063,7 +2114,7 @@ TcpSocketBase::ProcessSynSent (Ptr<Packet> packet, const TcpHeader& tcpHeader)
       m_congestionControl->CongestionStateSet (m_tcb, TcpSocketState::CA_OPEN);
       m_state = ESTABLISHED;
       m_connected = true;
-      m_retxEvent.Cancel ();
+      CancelReTxTimer ();
       m_rxBuffer->SetNextRxSequence (tcpHeader.GetSequenceNumber () + SequenceNumber32 (1));
       m_tcb->m_highTxMark = ++m_tcb->m_nextTxSequence;
       m_txBuffer->SetHeadSequence (m_tcb->m_nextTxSequence);
@@ -2121,7 +2172,7 @@ TcpSocketBase::ProcessSynRcvd (Ptr<Packet> packet, const TcpHeader& tcpHeader,
       m_congestionControl->CongestionStateSet (m_tcb, TcpSocketState::CA_OPEN);
       m_state = ESTABLISHED;
       m_connected = true;
-      m_retxEvent.Cancel ();
+      CancelReTxTimer ();
       m_tcb->m_highTxMark = ++m_tcb->m_nextTxSequence;
       m_txBuffer->SetHeadSequence (m_tcb->m_nextTxSequence);
       if (m_endPoint)
@@ -2169,7 +2220,7 @@ TcpSocketBase::ProcessSynRcvd (Ptr<Packet> packet, const TcpHeader& tcpHeader,
       if (tcpHeader.GetSequenceNumber () == m_rxBuffer->NextRxSequence ())
         { // In-sequence FIN before connection complete. Set up connection and close.
           m_connected = true;
-          m_retxEvent.Cancel ();
+          CancelReTxTimer ();
           m_tcb->m_highTxMark = ++m_tcb->m_nextTxSequence;
           m_txBuffer->SetHeadSequence (m_tcb->m_nextTxSequence);
           if (m_endPoint)
@@ -2416,11 +2467,11 @@ TcpSocketBase::DoPeerClose (void)
     { // Need to ack, the application will close later
       SendEmptyPacket (TcpHeader::ACK);
     }
-  if (m_state == LAST_ACK)
+  if (m_state == LAST_ACK && m_lastAckTimer.IsExpired ())
     {
       NS_LOG_LOGIC ("TcpSocketBase " << this << " scheduling LATO1");
       Time lastRto = m_rtt->GetEstimate () + Max (m_clockGranularity, m_rtt->GetVariation () * 4);
-      m_lastAckEvent = Simulator::Schedule (lastRto, &TcpSocketBase::LastAckTimeout, this);
+      m_lastAckTimer.Schedule (lastRto);
     }
 }
 
@@ -2436,7 +2487,7 @@ TcpSocketBase::Destroy (void)
       m_tcp->RemoveSocket (this);
     }
   NS_LOG_LOGIC (this << " Cancelled ReTxTimeout event which was set to expire at " <<
-                (Simulator::Now () + Simulator::GetDelayLeft (m_retxEvent)).GetSeconds ());
+                (Simulator::Now () + m_retxTimer.GetDelayLeft ()).GetSeconds ());
   CancelAllTimers ();
 }
 
@@ -2452,7 +2503,7 @@ TcpSocketBase::Destroy6 (void)
       m_tcp->RemoveSocket (this);
     }
   NS_LOG_LOGIC (this << " Cancelled ReTxTimeout event which was set to expire at " <<
-                (Simulator::Now () + Simulator::GetDelayLeft (m_retxEvent)).GetSeconds ());
+                (Simulator::Now () + m_retxTimer.GetDelayLeft ()).GetSeconds ());
   CancelAllTimers ();
 }
 
@@ -2546,7 +2597,7 @@ TcpSocketBase::SendEmptyPacket (uint8_t flags)
 
   if (flags & TcpHeader::ACK)
     { // If sending an ACK, cancel the delay ACK as well
-      m_delAckEvent.Cancel ();
+      m_delAckTimer.Cancel ();
       m_delAckCount = 0;
       if (m_highTxAck < header.GetAckNumber ())
         {
@@ -2573,12 +2624,15 @@ TcpSocketBase::SendEmptyPacket (uint8_t flags)
     }
 
 
-  if (m_retxEvent.IsExpired () && (hasSyn || hasFin) && !isAck )
+  if (m_retxTimer.IsExpired () && (hasSyn || hasFin) && !isAck )
     { // Retransmit SYN / SYN+ACK / FIN / FIN+ACK to guard against lost
       NS_LOG_LOGIC ("Schedule retransmission timeout at time "
                     << Simulator::Now ().GetSeconds () << " to expire at time "
                     << (Simulator::Now () + m_rto.Get ()).GetSeconds ());
-      m_retxEvent = Simulator::Schedule (m_rto, &TcpSocketBase::SendEmptyPacket, this, flags);
+      m_retxTimer.SetFunction (&TcpSocketBase::SynFinReTxTimeout, this);
+      m_retxTimer.SetArguments (flags);
+      m_retxSynFin = true;
+      m_retxTimer.Schedule (m_rto);
 
       //TMC MMB2020: One simulation run did not finish due to endless FIN packets (bug?)
       //copied from TcpSocketBase::ReTxTimeout ()
@@ -2853,7 +2907,38 @@ TcpSocketBase::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize, bool with
       isRetransmission = true;
     }
 
-  Ptr<Packet> p = m_txBuffer->CopyFromSequence (maxSize, seq);
+  bool isStartOfTransmission = BytesInFlight () == 0U;
+  uint32_t segSize = m_tcb->m_segmentSize;
+  uint16_t gsoSegments = 1;
+  TcpTxItem *outItem = m_txBuffer->CopyFromSequence (std::min (maxSize, segSize), seq);
+  Ptr<Packet> p;
+  if (outItem != nullptr)
+    {
+      m_rateOps->SkbSent (outItem, isStartOfTransmission);
+      p = outItem->GetPacketCopy ();
+
+      // Segmentation offload: chain further MSS-sized items of new data
+      // into a super-segment. The items stay MSS-sized in the Tx buffer,
+      // so that the scoreboard does not see the difference.
+      while (p->GetSize () < maxSize && p->GetSize () % segSize == 0)
+        {
+          SequenceNumber32 nextSeq = seq + SequenceNumber32 (p->GetSize ());
+          TcpTxItem *nextItem = m_txBuffer->CopyFromSequence (std::min (maxSize - p->GetSize (), segSize),
+                                                              nextSeq);
+          if (nextItem == nullptr)
+            {
+              break;
+            }
+          m_rateOps->SkbSent (nextItem, false);
+          p->AddAtEnd (nextItem->GetPacketCopy ());
+          ++gsoSegments;
+        }
+    }
+  else
+    {
+      p = Create<Packet> ();
+    }
+  m_tcb->m_lastSendTime = Simulator::Now ();
   uint32_t sz = p->GetSize (); // Size of packet
   uint8_t flags = withAck ? TcpHeader::ACK : 0;
   uint32_t remainingData = m_txBuffer->SizeFromSequence (seq + SequenceNumber32 (sz));
@@ -2875,7 +2960,7 @@ TcpSocketBase::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize, bool with
 
   if (withAck)
     {
-      m_delAckEvent.Cancel ();
+      m_delAckTimer.Cancel ();
       m_delAckCount = 0;
     }
 
@@ -2901,6 +2986,12 @@ TcpSocketBase::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize, bool with
 
   AddSocketTags (p);
 
+  if (gsoSegments > 1)
+    {
+      NS_LOG_DEBUG ("Super-segment of " << gsoSegments << " segments, size " << sz);
+      p->AddPacketTag (TcpGsoTag (static_cast<uint16_t> (segSize), gsoSegments));
+    }
+
   if (m_closeOnEmpty && (remainingData == 0))
     {
       flags |= TcpHeader::FIN;
@@ -2932,14 +3023,14 @@ TcpSocketBase::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize, bool with
   header.SetWindowSize (AdvertisedWindowSize ());
   AddOptions (header);
 
-  if (m_retxEvent.IsExpired ())
+  if (m_retxTimer.IsExpired ())
     {
       // Schedules retransmit timeout. m_rto should be already doubled.
 
       NS_LOG_LOGIC (this << " SendDataPacket Schedule ReTxTimeout at time " <<
                     Simulator::Now ().GetSeconds () << " to expire at time " <<
                     (Simulator::Now () + m_rto.Get ()).GetSeconds () );
-      m_retxEvent = Simulator::Schedule (m_rto, &TcpSocketBase::ReTxTimeout, this);
+      m_retxTimer.Schedule (m_rto);
     }
 
   m_txTrace (p, header, this);
@@ -3090,6 +3181,17 @@ TcpSocketBase::SendPendingData (bool withAck)
 
           uint32_t s = std::min (availableWindow, m_tcb->m_segmentSize);
 
+          // Segmentation offload: send new data as a super-segment of
+          // whole MSS, split into wire segments by IPv4 after routing.
+          if (m_gsoMaxSegments > 1 && m_endPoint != nullptr && next == m_tcb->m_highTxMark)
+            {
+              // Leave room for the IPv4 and TCP headers of the super-segment
+              uint32_t gsoSize = std::min (m_gsoMaxSegments * m_tcb->m_segmentSize,
+                                           65535U - 20U - 60U);
+              gsoSize = std::min (availableWindow, gsoSize);
+              s = std::max (s, gsoSize / m_tcb->m_segmentSize * m_tcb->m_segmentSize);
+            }
+
           // (C.2) If any of the data octets sent in (C.1) are below HighData,
           //       HighRxt MUST be set to the highest sequence number of the
           //       retransmitted segment unless NextSeg () rule (4) was
@@ -3296,9 +3398,12 @@ TcpSocketBase::ReceivedData (Ptr<Packet> p, const TcpHeader& tcpHeader)
     }
   else
     { // In-sequence packet: ACK if delayed ack count allows
-      if (++m_delAckCount >= m_delAckMaxCount)
+      // A coalesced packet counts for every segment it carries
+      TcpGsoTag groTag;
+      m_delAckCount += p->PeekPacketTag (groTag) ? groTag.GetSegments () : 1;
+      if (m_delAckCount >= m_delAckMaxCount)
         {
-          m_delAckEvent.Cancel ();
+          m_delAckTimer.Cancel ();
           m_delAckCount = 0;
           m_congestionControl->CwndEvent (m_tcb, TcpSocketState::CA_EVENT_NON_DELAYED_ACK);
           if (m_tcb->m_ecnState == TcpSocketState::ECN_CE_RCVD || m_tcb->m_ecnState == TcpSocketState::ECN_SENDING_ECE)
@@ -3313,12 +3418,11 @@ TcpSocketBase::ReceivedData (Ptr<Packet> p, const TcpHeader& tcpHeader)
               SendEmptyPacket (TcpHeader::ACK);
             }
         }
-      else if (m_delAckEvent.IsExpired ())
+      else if (m_delAckTimer.IsExpired ())
         {
-          m_delAckEvent = Simulator::Schedule (m_delAckTimeout,
-                                               &TcpSocketBase::DelAckTimeout, this);
+          m_delAckTimer.Schedule (m_delAckTimeout);
           NS_LOG_LOGIC (this << " scheduled delayed ACK at " <<
-                        (Simulator::Now () + Simulator::GetDelayLeft (m_delAckEvent)).GetSeconds ());
+                        (Simulator::Now () + m_delAckTimer.GetDelayLeft ()).GetSeconds ());
         }
     }
 }
@@ -3393,8 +3497,8 @@ TcpSocketBase::NewAck (SequenceNumber32 const& ack, bool resetRTO)
   if (m_state != SYN_RCVD && resetRTO)
     { // Set RTO unless the ACK is received in SYN_RCVD state
       NS_LOG_LOGIC (this << " Cancelled ReTxTimeout event which was set to expire at " <<
-                    (Simulator::Now () + Simulator::GetDelayLeft (m_retxEvent)).GetSeconds ());
-      m_retxEvent.Cancel ();
+                    (Simulator::Now () + m_retxTimer.GetDelayLeft ()).GetSeconds ());
+      CancelReTxTimer ();
       // On receiving a "New" ack we restart retransmission timer .. RFC 6298
       // RFC 6298, clause 2.4
       m_rto = Max (m_rtt->GetEstimate () + Max (m_clockGranularity, m_rtt->GetVariation () * 4), m_minRto);
@@ -3402,7 +3506,7 @@ TcpSocketBase::NewAck (SequenceNumber32 const& ack, bool resetRTO)
       NS_LOG_LOGIC (this << " Schedule ReTxTimeout at time " <<
                     Simulator::Now ().GetSeconds () << " to expire at time " <<
                     (Simulator::Now () + m_rto.Get ()).GetSeconds ());
-      m_retxEvent = Simulator::Schedule (m_rto, &TcpSocketBase::ReTxTimeout, this);
+      m_retxTimer.Schedule (m_rto);
     }
 
   // Note the highest ACK and tell app to send more
@@ -3420,11 +3524,20 @@ TcpSocketBase::NewAck (SequenceNumber32 const& ack, bool resetRTO)
   if (m_txBuffer->Size () == 0 && m_state != FIN_WAIT_1 && m_state != CLOSING)
     { // No retransmit timer if no data to retransmit
       NS_LOG_LOGIC (this << " Cancelled ReTxTimeout event which was set to expire at " <<
-                    (Simulator::Now () + Simulator::GetDelayLeft (m_retxEvent)).GetSeconds ());
-      m_retxEvent.Cancel ();
+                    (Simulator::Now () + m_retxTimer.GetDelayLeft ()).GetSeconds ());
+      CancelReTxTimer ();
     }
 }
 
+void
+TcpSocketBase::SynFinReTxTimeout (uint8_t flags)
+{
+  NS_LOG_FUNCTION (this << static_cast<uint32_t> (flags));
+  m_retxTimer.SetFunction (&TcpSocketBase::ReTxTimeout, this);
+  m_retxSynFin = false;
+  SendEmptyPacket (flags);
+}
+
 // Retransmit timeout
 void
 TcpSocketBase::ReTxTimeout ()
@@ -3596,7 +3709,7 @@ TcpSocketBase::LastAckTimeout (void)
 {
   NS_LOG_FUNCTION (this);
 
-  m_lastAckEvent.Cancel ();
+  m_lastAckTimer.Cancel ();
   if (m_state == LAST_ACK)
     {
       CloseAndNotify ();
@@ -3615,7 +3728,9 @@ TcpSocketBase::PersistTimeout ()
 {
   NS_LOG_LOGIC ("PersistTimeout expired at " << Simulator::Now ().GetSeconds ());
   m_persistTimeout = std::min (Seconds (60), Time (2 * m_persistTimeout)); // max persist timeout = 60s
-  Ptr<Packet> p = m_txBuffer->CopyFromSequence (1, m_tcb->m_nextTxSequence);
+  // the probe is empty if the application has nothing left to send
+  TcpTxItem *item = m_txBuffer->CopyFromSequence (1, m_tcb->m_nextTxSequence);
+  Ptr<Packet> p = item ? item->GetPacketCopy () : Create<Packet> ();
   m_txBuffer->ResetLastSegmentSent ();
   TcpHeader tcpHeader;
   tcpHeader.SetSequenceNumber (m_tcb->m_nextTxSequence);
@@ -3659,7 +3774,7 @@ TcpSocketBase::PersistTimeout ()
   NS_LOG_LOGIC ("Schedule persist timeout at time "
                 << Simulator::Now ().GetSeconds () << " to expire at time "
                 << (Simulator::Now () + m_persistTimeout).GetSeconds ());
-  m_persistEvent = Simulator::Schedule (m_persistTimeout, &TcpSocketBase::PersistTimeout, this);
+  m_persistTimer.Schedule (m_persistTimeout);
 }
 
 void
@@ -3689,14 +3804,41 @@ TcpSocketBase::DoRetransmit ()
   NS_ASSERT (sz > 0);
 }
 
+void
+TcpSocketBase::InitializeTimers (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_retxTimer.SetTimingWheel (true);
+  m_retxTimer.SetFunction (&TcpSocketBase::ReTxTimeout, this);
+  m_lastAckTimer.SetTimingWheel (true);
+  m_lastAckTimer.SetFunction (&TcpSocketBase::LastAckTimeout, this);
+  m_delAckTimer.SetTimingWheel (true);
+  m_delAckTimer.SetFunction (&TcpSocketBase::DelAckTimeout, this);
+  m_persistTimer.SetTimingWheel (true);
+  m_persistTimer.SetFunction (&TcpSocketBase::PersistTimeout, this);
+  m_timewaitTimer.SetTimingWheel (true);
+  m_timewaitTimer.SetFunction (&TcpSocketBase::CloseAndNotify, this);
+}
+
+void
+TcpSocketBase::CancelReTxTimer (void)
+{
+  m_retxTimer.Cancel ();
+  if (m_retxSynFin)
+    {
+      m_retxTimer.SetFunction (&TcpSocketBase::ReTxTimeout, this);
+      m_retxSynFin = false;
+    }
+}
+
 void
 TcpSocketBase::CancelAllTimers ()
 {
-  m_retxEvent.Cancel ();
-  m_persistEvent.Cancel ();
-  m_delAckEvent.Cancel ();
-  m_lastAckEvent.Cancel ();
-  m_timewaitEvent.Cancel ();
+  CancelReTxTimer ();
+  m_persistTimer.Cancel ();
+  m_delAckTimer.Cancel ();
+  m_lastAckTimer.Cancel ();
+  m_timewaitTimer.Cancel ();
   m_sendPendingDataEvent.Cancel ();
   m_pacingTimer.Cancel ();
 }
@@ -3718,8 +3860,7 @@ TcpSocketBase::TimeWait ()
     }
   // Move from TIME_WAIT to CLOSED after 2*MSL. Max segment lifetime is 2 min
   // according to RFC793, p.28
-  m_timewaitEvent = Simulator::Schedule (Seconds (2 * m_msl),
-                                         &TcpSocketBase::CloseAndNotify, this);
+  m_timewaitTimer.Schedule (Seconds (2 * m_msl));
 }
 
 /* Below are the attribute get/set functions */
@@ -3973,7 +4114,7 @@ TcpSocketBase::ProcessOptionSack (const Ptr<const TcpOption> option)
 
   Ptr<const TcpOptionSack> s = DynamicCast<const TcpOptionSack> (option);
   TcpOptionSack::SackList list = s->GetSackList ();
-  return m_txBuffer->Update (list);
+  return m_txBuffer->Update (list, MakeCallback (&TcpRateOps::SkbDelivered, m_rateOps));
 }
 
 void
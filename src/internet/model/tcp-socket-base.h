@@ -43,6 +43,7 @@ class TcpL4Protocol;
 class TcpHeader;
 class TcpCongestionOps;
 class TcpRecoveryOps;
+class TcpRateOps;
 class RttEstimator;
 class TcpRxBuffer;
 class TcpTxBuffer;
@@ -813,11 +814,24 @@ protected:
    */
   void DoPeerClose (void);
 
+  /**
+   * \brief Set up the protocol timers, held by the timing wheel
+   */
+  void InitializeTimers (void);
+
   /**
    * \brief Cancel all timer when endpoint is deleted
    */
   void CancelAllTimers (void);
 
+  /**
+   * \brief Cancel the retransmission timer
+   *
+   * If the timer was set to retransmit a SYN or a FIN, it is bound again
+   * to ReTxTimeout.
+   */
+  void CancelReTxTimer (void);
+
   /**
    * \brief Move from CLOSING or FIN_WAIT_2 to TIME_WAIT state
    */
@@ -1015,6 +1029,13 @@ protected:
    */
   virtual void ReTxTimeout (void);
 
+  /**
+   * \brief Retransmit a SYN or a FIN upon the expiration of the
+   * retransmission timer, bound again to ReTxTimeout
+   * \param flags the TCP flags of the segment
+   */
+  void SynFinReTxTimeout (uint8_t flags);
+
   /**
    * \brief Action upon delay ACK timeout, i.e. send an ACK
    */
@@ -1170,11 +1191,13 @@ protected:
 
 protected:
   // Counters and events
-  EventId           m_retxEvent     {}; //!< Retransmission event
-  EventId           m_lastAckEvent  {}; //!< Last ACK timeout event
-  EventId           m_delAckEvent   {}; //!< Delayed ACK timeout event
-  EventId           m_persistEvent  {}; //!< Persist event: Send 1 byte to probe for a non-zero Rx window
-  EventId           m_timewaitEvent {}; //!< TIME_WAIT expiration event: Move this socket to CLOSED state
+  // The timers are held by the timing wheel (see InitializeTimers)
+  Timer m_retxTimer     {Timer::CANCEL_ON_DESTROY}; //!< Retransmission timer
+  Timer m_lastAckTimer  {Timer::CANCEL_ON_DESTROY}; //!< Last ACK timeout timer
+  Timer m_delAckTimer   {Timer::CANCEL_ON_DESTROY}; //!< Delayed ACK timeout timer
+  Timer m_persistTimer  {Timer::CANCEL_ON_DESTROY}; //!< Persist timer: Send 1 byte to probe for a non-zero Rx window
+  Timer m_timewaitTimer {Timer::CANCEL_ON_DESTROY}; //!< TIME_WAIT expiration timer: Move this socket to CLOSED state
+  bool  m_retxSynFin    {false}; //!< True if m_retxTimer retransmits a SYN or a FIN instead of calling ReTxTimeout
 
   // ACK management
   uint32_t          m_dupAckCount {0};     //!< Dupack counter
@@ -1249,10 +1272,14 @@ protected:
   uint32_t               m_retxThresh {3};   //!< Fast Retransmit threshold
   bool                   m_limitedTx  {true}; //!< perform limited transmit
 
+  // Segmentation offload
+  uint32_t m_gsoMaxSegments {1}; //!< Max MSS-sized segments per super-segment
+
   // Transmission Control Block
   Ptr<TcpSocketState>    m_tcb;               //!< Congestion control information
   Ptr<TcpCongestionOps>  m_congestionControl; //!< Congestion control
   Ptr<TcpRecoveryOps>    m_recoveryOps;       //!< Recovery Algorithm
+  Ptr<TcpRateOps>        m_rateOps;           //!< Rate operations
 
   // Guesses over the other connection end
   bool m_isFirstPartialAck {true}; //!< First partial ACK during RECOVERY
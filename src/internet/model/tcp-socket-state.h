@@ -153,6 +153,7 @@ public:
 
   TracedValue<uint32_t>  m_bytesInFlight {0};        //!< Bytes in flight
   TracedValue<Time>      m_lastRtt {Seconds (0.0)};  //!< Last RTT sample collected
+  Time                   m_lastSendTime {Time::Min ()}; //!< Time of the last data transmission
 
   /**
    * \brief Get cwnd in segments rather than bytes
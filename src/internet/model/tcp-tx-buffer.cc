@@ -212,7 +212,7 @@ TcpTxBuffer::SizeFromSequence (const SequenceNumber32& seq) const
   return 0;
 }
 
-Ptr<Packet>
+TcpTxItem*
 TcpTxBuffer::CopyFromSequence (uint32_t numBytes, const SequenceNumber32& seq)
 {
   NS_LOG_FUNCTION (this << numBytes << seq);
@@ -226,7 +226,7 @@ TcpTxBuffer::CopyFromSequence (uint32_t numBytes, const SequenceNumber32& seq)
 
   if (s == 0)
     {
-      return Create<Packet> ();
+      return nullptr;
     }
 
   TcpTxItem *outItem = nullptr;
@@ -265,14 +265,13 @@ TcpTxBuffer::CopyFromSequence (uint32_t numBytes, const SequenceNumber32& seq)
     }
 
   outItem->m_lastSent = Simulator::Now ();
-  Ptr<Packet> toRet = outItem->m_packet->Copy ();
 
-  NS_ASSERT (toRet->GetSize () <= s);
+  NS_ASSERT (outItem->m_packet->GetSize () <= s);
   NS_ASSERT_MSG (outItem->m_startSeq >= m_firstByteSeq,
                  "Returning an item " << *outItem << " with SND.UNA as " <<
                  m_firstByteSeq);
   ConsistencyCheck ();
-  return toRet;
+  return outItem;
 }
 
 TcpTxItem*
@@ -296,6 +295,7 @@ TcpTxBuffer::GetNewSegment (uint32_t numBytes)
   m_appList.erase (it);
   m_sentList.insert (m_sentList.end (), item);
   m_sentSize += item->m_packet->GetSize ();
+  IndexSentItem (--m_sentList.end ());
 
   return item;
 }
@@ -308,40 +308,53 @@ TcpTxBuffer::GetTransmittedSegment (uint32_t numBytes, const SequenceNumber32 &s
   NS_ASSERT (numBytes <= m_sentSize);
   NS_ASSERT (m_sentList.size () >= 1);
 
-  auto it = m_sentList.begin ();
-  bool listEdited = false;
   uint32_t s = numBytes;
 
   // Avoid to merge different packet for this retransmission if flags are
   // different.
-  for (; it != m_sentList.end(); ++it)
+  auto found = m_sentIndex.find (seq);
+  if (found != m_sentIndex.end ())
     {
-      if ((*it)->m_startSeq == seq)
+      auto it = found->second;
+      auto next = it;
+      next++;
+      if (next != m_sentList.end ())
         {
-          auto next = it;
-          next++;
-          if (next != m_sentList.end ())
+          // Next is not sacked... there is the possibility to merge
+          if (! (*next)->m_sacked)
             {
-              // Next is not sacked... there is the possibility to merge
-              if (! (*next)->m_sacked)
-                {
-                  s = std::min(s, (*it)->m_packet->GetSize () + (*next)->m_packet->GetSize ());
-                }
-              else
-                {
-                  // Next is sacked... better to retransmit only the first segment
-                  s = std::min(s, (*it)->m_packet->GetSize ());
-                }
+              s = std::min(s, (*it)->m_packet->GetSize () + (*next)->m_packet->GetSize ());
             }
           else
             {
+              // Next is sacked... better to retransmit only the first segment
               s = std::min(s, (*it)->m_packet->GetSize ());
             }
-          break;
+        }
+      else
+        {
+          s = std::min(s, (*it)->m_packet->GetSize ());
         }
     }
 
-  TcpTxItem *item = GetPacketFromList (m_sentList, m_firstByteSeq, s, seq, &listEdited);
+  // Move the items that overlap the requested block in a list of their own,
+  // so that the split and merge operations do not walk the entire sent list.
+  auto first = m_sentIndex.upper_bound (seq);
+  NS_ASSERT (first != m_sentIndex.begin ());
+  --first;
+
+  PacketList::iterator blockBegin = first->second;
+  PacketList::iterator blockEnd = blockBegin;
+  while (blockEnd != m_sentList.end () && (*blockEnd)->m_startSeq < seq + s)
+    {
+      UnindexSentItem (*blockEnd);
+      ++blockEnd;
+    }
+
+  PacketList block;
+  block.splice (block.begin (), m_sentList, blockBegin, blockEnd);
+
+  TcpTxItem *item = GetPacketFromList (block, block.front ()->m_startSeq, s, seq);
 
   if (! item->m_retrans)
     {
@@ -349,6 +362,14 @@ TcpTxBuffer::GetTransmittedSegment (uint32_t numBytes, const SequenceNumber32 &s
       item->m_retrans = true;
     }
 
+  // Splicing does not invalidate the iterators
+  PacketList::iterator it = block.begin ();
+  m_sentList.splice (blockEnd, block);
+  for (; it != blockEnd; ++it)
+    {
+      IndexSentItem (it);
+    }
+
   return item;
 }
 
@@ -357,21 +378,14 @@ TcpTxBuffer::FindHighestSacked () const
 {
   NS_LOG_FUNCTION (this);
 
-  SequenceNumber32 beginOfCurrentPacket = m_firstByteSeq;
-
-  auto ret = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
-
-  for (auto it = m_sentList.begin (); it != m_sentList.end (); ++it)
+  if (m_sackedSeqs.empty ())
     {
-      const TcpTxItem *item = *it;
-      if (item->m_sacked)
-        {
-          ret = std::make_pair (it, beginOfCurrentPacket);
-        }
-      beginOfCurrentPacket += item->m_packet->GetSize ();
+      return std::make_pair (m_sentList.cend (), SequenceNumber32 (0));
     }
 
-  return ret;
+  SequenceNumber32 highest = *m_sackedSeqs.rbegin ();
+  PacketList::const_iterator it = m_sentIndex.at (highest);
+  return std::make_pair (it, highest);
 }
 
 
@@ -389,6 +403,7 @@ TcpTxBuffer::SplitItems (TcpTxItem *t1, TcpTxItem *t2, uint32_t size) const
   t1->m_lastSent = t2->m_lastSent;
   t1->m_retrans = t2->m_retrans;
   t1->m_lost = t2->m_lost;
+  t1->m_rateInfo = t2->m_rateInfo;
 
   t2->m_startSeq += size;
 
@@ -620,6 +635,7 @@ TcpTxBuffer::MergeItems (TcpTxItem *t1, TcpTxItem *t2) const
   if (t1->m_lastSent < t2->m_lastSent)
     {
       t1->m_lastSent = t2->m_lastSent;
+      t1->m_rateInfo = t2->m_rateInfo;
     }
 
   t1->m_packet->AddAtEnd (t2->m_packet);
@@ -648,8 +664,64 @@ TcpTxBuffer::RemoveFromCounts (TcpTxItem *item, uint32_t size)
       m_lostOut -= size;
     }
 }
+
+void
+TcpTxBuffer::IndexSentItem (PacketList::iterator it)
+{
+  NS_LOG_FUNCTION (this << **it);
+  m_sentIndex[(*it)->m_startSeq] = it;
+  ScoreboardInsert (*it);
+}
+
+void
+TcpTxBuffer::UnindexSentItem (const TcpTxItem *item)
+{
+  NS_LOG_FUNCTION (this << *item);
+  m_sentIndex.erase (item->m_startSeq);
+  ScoreboardErase (item);
+}
+
+void
+TcpTxBuffer::ScoreboardInsert (const TcpTxItem *item)
+{
+  const SequenceNumber32 &seq = item->m_startSeq;
+
+  if (item->m_sacked)
+    {
+      m_sackedSeqs.insert (seq);
+    }
+  if (item->m_lost)
+    {
+      m_lostSeqs.insert (seq);
+    }
+  if (!item->m_lost && !item->m_sacked)
+    {
+      m_outSeqs.insert (seq);
+    }
+  if (!item->m_retrans && !item->m_sacked)
+    {
+      m_notRtxSeqs.insert (seq);
+      if (item->m_lost)
+        {
+          m_lostNotRtxSeqs.insert (seq);
+        }
+    }
+}
+
 void
-TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
+TcpTxBuffer::ScoreboardErase (const TcpTxItem *item)
+{
+  const SequenceNumber32 &seq = item->m_startSeq;
+
+  m_sackedSeqs.erase (seq);
+  m_lostSeqs.erase (seq);
+  m_outSeqs.erase (seq);
+  m_notRtxSeqs.erase (seq);
+  m_lostNotRtxSeqs.erase (seq);
+}
+void
+TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq,
+                          const Callback<void, TcpTxItem *> &beforeDelCb)
 {
   NS_LOG_FUNCTION (this << seq);
 
@@ -671,7 +743,7 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
       if (i == m_sentList.end ())
         {
           // Move data from app list to sent list, so we can delete the item
-          Ptr<Packet> p = CopyFromSequence (offset, m_firstByteSeq);
+          TcpTxItem *p = CopyFromSequence (offset, m_firstByteSeq);
           NS_ASSERT (p != nullptr);
           NS_UNUSED (p);
           i = m_sentList.begin ();
@@ -693,6 +765,12 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
 
           RemoveFromCounts (item, pktSize);
 
+          if (!beforeDelCb.IsNull ())
+            {
+              beforeDelCb (item);
+            }
+
+          UnindexSentItem (item);
           i = m_sentList.erase (i);
           NS_LOG_INFO ("Removed " << *item << " lost: " << m_lostOut <<
                        " retrans: " << m_retrans << " sacked: " << m_sackedOut <<
@@ -704,8 +782,10 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
           pktSize -= offset;
           NS_LOG_INFO (*item);
           // PacketTags are preserved when fragmenting
+          UnindexSentItem (item);
           item->m_packet = item->m_packet->CreateFragment (offset, pktSize);
           item->m_startSeq += offset;
+          IndexSentItem (i);
           m_size -= offset;
           m_sentSize -= offset;
           m_firstByteSeq += offset;
@@ -733,7 +813,9 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
           // It is not possible to have the UNA sacked; otherwise, it would
           // have been ACKed. This is, most likely, our wrong guessing
           // when adding Reno dupacks in the count.
+          ScoreboardErase (head);
           head->m_sacked = false;
+          ScoreboardInsert (head);
           m_sackedOut -= head->m_packet->GetSize ();
           NS_LOG_INFO ("Moving the SACK flag from the HEAD to another segment");
           AddRenoSack ();
@@ -759,7 +841,8 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
 }
 
 bool
-TcpTxBuffer::Update (const TcpOptionSack::SackList &list)
+TcpTxBuffer::Update (const TcpOptionSack::SackList &list,
+                     const Callback<void, TcpTxItem *> &sackedCb)
 {
   NS_LOG_FUNCTION (this);
   NS_LOG_INFO ("Updating scoreboard, got " << list.size () << " blocks to analyze");
@@ -768,68 +851,79 @@ TcpTxBuffer::Update (const TcpOptionSack::SackList &list)
 
   for (auto option_it = list.begin (); option_it != list.end (); ++option_it)
     {
-      PacketList::iterator item_it = m_sentList.begin ();
-      SequenceNumber32 beginOfCurrentPacket = m_firstByteSeq;
-
       if (m_firstByteSeq + m_sentSize < (*option_it).first && !modified)
         {
           NS_LOG_INFO ("Not updating scoreboard, the option block is outside the sent list");
           return false;
         }
 
+      // Start from the first item that begins inside the block
+      auto index_it = m_sentIndex.lower_bound ((*option_it).first);
+      if (index_it == m_sentIndex.end ())
+        {
+          continue;
+        }
+
+      PacketList::iterator item_it = index_it->second;
+
       while (item_it != m_sentList.end ())
         {
-          uint32_t pktSize = (*item_it)->m_packet->GetSize ();
+          TcpTxItem *item = *item_it;
+          SequenceNumber32 beginOfCurrentPacket = item->m_startSeq;
+          uint32_t pktSize = item->m_packet->GetSize ();
 
           // Check the boundary of this packet ... only mark as sacked if
           // it is precisely mapped over the option. It means that if the receiver
           // is reporting as sacked single range bytes that are not mapped 1:1
           // in what we have, the option is discarded. There's room for improvement
           // here.
-          if (beginOfCurrentPacket >= (*option_it).first
-              && beginOfCurrentPacket + pktSize <= (*option_it).second)
+          if (beginOfCurrentPacket + pktSize > (*option_it).second)
             {
-              if ((*item_it)->m_sacked)
+              // We already passed the received block end. Exit from the loop
+              NS_LOG_INFO ("Received block [" << *option_it <<
+                           ", checking sentList for block " << *item <<
+                           "], not found, breaking loop");
+              break;
+            }
+
+          if (item->m_sacked)
+            {
+              NS_ASSERT (!item->m_lost);
+              NS_LOG_INFO ("Received block " << *option_it <<
+                           ", checking sentList for block " << *item <<
+                           ", found in the sackboard already sacked");
+            }
+          else
+            {
+              ScoreboardErase (item);
+              if (item->m_lost)
                 {
-                  NS_ASSERT (!(*item_it)->m_lost);
-                  NS_LOG_INFO ("Received block " << *option_it <<
-                               ", checking sentList for block " << *(*item_it) <<
-                               ", found in the sackboard already sacked");
+                  item->m_lost = false;
+                  m_lostOut -= pktSize;
                 }
-              else
-                {
-                  if ((*item_it)->m_lost)
-                    {
-                      (*item_it)->m_lost = false;
-                      m_lostOut -= (*item_it)->m_packet->GetSize ();
-                    }
 
-                  (*item_it)->m_sacked = true;
-                  m_sackedOut += (*item_it)->m_packet->GetSize ();
+              item->m_sacked = true;
+              m_sackedOut += pktSize;
+              ScoreboardInsert (item);
 
-                  if (m_highestSack.first == m_sentList.end()
-                      || m_highestSack.second <= beginOfCurrentPacket + pktSize)
-                    {
-                      m_highestSack = std::make_pair (item_it, beginOfCurrentPacket);
-                    }
+              if (!sackedCb.IsNull ())
+                {
+                  sackedCb (item);
+                }
 
-                  NS_LOG_INFO ("Received block " << *option_it <<
-                               ", checking sentList for block " << *(*item_it) <<
-                               ", found in the sackboard, sacking, current highSack: " <<
-                               m_highestSack.second);
+              if (m_highestSack.first == m_sentList.end()
+                  || m_highestSack.second <= beginOfCurrentPacket + pktSize)
+                {
+                  m_highestSack = std::make_pair (item_it, beginOfCurrentPacket);
                 }
-              modified = true;
-            }
-          else if (beginOfCurrentPacket + pktSize > (*option_it).second)
-            {
-              // We already passed the received block end. Exit from the loop
-              NS_LOG_INFO ("Received block [" << *option_it <<
-                           ", checking sentList for block " << *(*item_it) <<
-                           "], not found, breaking loop");
-              break;
+
+              NS_LOG_INFO ("Received block " << *option_it <<
+                           ", checking sentList for block " << *item <<
+                           ", found in the sackboard, sacking, current highSack: " <<
+                           m_highestSack.second);
             }
+          modified = true;
 
-          beginOfCurrentPacket += pktSize;
           ++item_it;
         }
     }
@@ -852,47 +946,31 @@ void
 TcpTxBuffer::UpdateLostCount ()
 {
   NS_LOG_FUNCTION (this);
-  uint32_t sacked = 0;
-  SequenceNumber32 beginOfCurrentPacket = m_highestSack.second;
-  if (m_highestSack.first == m_sentList.end ())
-    {
-      NS_LOG_INFO ("Status before the update: " << *this <<
-                   ", will start from the latest sent item");
-    }
-  else
-    {
-      NS_LOG_INFO ("Status before the update: " << *this <<
-                   ", will start from item " << *(*m_highestSack.first));
-    }
+  NS_LOG_INFO ("Status before the update: " << *this);
 
-  for (auto it = m_highestSack.first; it != m_sentList.begin(); --it)
+  uint32_t needed = std::max<uint32_t> (m_dupAckThresh, 1);
+  if (m_sackedSeqs.size () < needed)
     {
-      TcpTxItem *item = *it;
-      if (item->m_sacked)
-        {
-          sacked++;
-        }
-
-      if (sacked >= m_dupAckThresh)
-        {
-          if (!item->m_sacked && !item->m_lost)
-            {
-              item->m_lost = true;
-              m_lostOut += item->m_packet->GetSize ();
-            }
-        }
-      beginOfCurrentPacket -= item->m_packet->GetSize ();
+      NS_LOG_INFO ("Not enough sacked segments to mark anything as lost");
+      return;
     }
 
-  if (sacked >= m_dupAckThresh)
+  // Everything not sacked below the dupAckThresh-th highest sacked segment
+  // is lost. The items neither lost nor sacked are kept ordered, so we only
+  // visit the ones that become lost.
+  auto sackIt = m_sackedSeqs.rbegin ();
+  std::advance (sackIt, needed - 1);
+  SequenceNumber32 lostLimit = *sackIt;
+
+  while (!m_outSeqs.empty () && *m_outSeqs.begin () < lostLimit)
     {
-      TcpTxItem *item = *m_sentList.begin ();
-      if (!item->m_lost)
-        {
-          item->m_lost = true;
-          m_lostOut += item->m_packet->GetSize ();
-        }
+      TcpTxItem *item = *m_sentIndex.at (*m_outSeqs.begin ());
+      ScoreboardErase (item);
+      item->m_lost = true;
+      m_lostOut += item->m_packet->GetSize ();
+      ScoreboardInsert (item);
     }
+
   NS_LOG_INFO ("Status after the update: " << *this);
   ConsistencyCheck ();
 }
@@ -902,38 +980,28 @@ TcpTxBuffer::IsLost (const SequenceNumber32 &seq) const
 {
   NS_LOG_FUNCTION (this << seq);
 
-  SequenceNumber32 beginOfCurrentPacket = m_firstByteSeq;
-  PacketList::const_iterator it;
-
   if (seq >= m_highestSack.second)
     {
       return false;
     }
 
-  // In theory, using a map and hints when inserting elements can improve
-  // performance
-  for (it = m_sentList.begin (); it != m_sentList.end (); ++it)
+  // The segment is lost if, starting from seq, we meet a lost segment
+  // before a sacked one
+  auto lost = m_lostSeqs.lower_bound (seq);
+  if (lost == m_lostSeqs.end ())
     {
-      // Search for the right iterator before calling IsLost()
-      if (beginOfCurrentPacket >= seq)
-        {
-          if ((*it)->m_lost == true)
-            {
-              NS_LOG_INFO ("seq=" << seq << " is lost because of lost flag");
-              return true;
-            }
-
-          if ((*it)->m_sacked == true)
-            {
-              NS_LOG_INFO ("seq=" << seq << " is not lost because of sacked flag");
-              return false;
-            }
-        }
+      return false;
+    }
 
-      beginOfCurrentPacket += (*it)->m_packet->GetSize ();
+  auto sacked = m_sackedSeqs.lower_bound (seq);
+  if (sacked != m_sackedSeqs.end () && *sacked < *lost)
+    {
+      NS_LOG_INFO ("seq=" << seq << " is not lost because of sacked flag");
+      return false;
     }
 
-  return false;
+  NS_LOG_INFO ("seq=" << seq << " is lost because of lost flag");
+  return true;
 }
 
 bool
@@ -954,35 +1022,11 @@ TcpTxBuffer::NextSeg (SequenceNumber32 *seq, bool isRecovery) const
    *
    *     (1.c) IsLost (S2) returns true.
    */
-  PacketList::const_iterator it;
-  TcpTxItem *item;
-  SequenceNumber32 seqPerRule3;
-  bool isSeqPerRule3Valid = false;
-  SequenceNumber32 beginOfCurrentPkt = m_firstByteSeq;
-
-  for (it = m_sentList.begin (); it != m_sentList.end (); ++it)
+  if (!m_lostNotRtxSeqs.empty ())
     {
-      item = *it;
-
-      // Condition 1.a , 1.b , and 1.c
-      if (item->m_retrans == false && item->m_sacked == false)
-        {
-          if (item->m_lost)
-            {
-              NS_LOG_INFO("IsLost, returning" << beginOfCurrentPkt);
-              *seq = beginOfCurrentPkt;
-              return true;
-            }
-          else if (seqPerRule3.GetValue () == 0 && isRecovery)
-            {
-              NS_LOG_INFO ("Saving for rule 3 the seq " << beginOfCurrentPkt);
-              isSeqPerRule3Valid = true;
-              seqPerRule3 = beginOfCurrentPkt;
-            }
-        }
-
-      // Nothing found, iterate
-      beginOfCurrentPkt += item->m_packet->GetSize ();
+      *seq = *m_lostNotRtxSeqs.begin ();
+      NS_LOG_INFO ("IsLost, returning" << *seq);
+      return true;
     }
 
   /* (2) If no sequence number 'S2' per rule (1) exists but there
@@ -1008,10 +1052,10 @@ TcpTxBuffer::NextSeg (SequenceNumber32 *seq, bool isRecovery) const
    *     (specifically excluding step (1.c)), then one segment of up to
    *     SMSS octets starting with S3 SHOULD be returned.
    */
-  if (isSeqPerRule3Valid)
+  if (isRecovery && !m_notRtxSeqs.empty ())
     {
-      NS_LOG_INFO ("Rule3 valid. " << seqPerRule3);
-      *seq = seqPerRule3;
+      *seq = *m_notRtxSeqs.begin ();
+      NS_LOG_INFO ("Rule3 valid. " << *seq);
       return true;
     }
 
@@ -1180,9 +1224,12 @@ TcpTxBuffer::ResetRenoSack ()
   NS_LOG_FUNCTION (this);
 
   m_sackedOut = 0;
-  for (auto it = m_sentList.begin (); it != m_sentList.end (); ++it)
+  while (!m_sackedSeqs.empty ())
     {
-      (*it)->m_sacked = false;
+      TcpTxItem *item = *m_sentIndex.at (*m_sackedSeqs.begin ());
+      ScoreboardErase (item);
+      item->m_sacked = false;
+      ScoreboardInsert (item);
     }
 
   m_highestSack = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
@@ -1203,6 +1250,13 @@ TcpTxBuffer::ResetSentList ()
       m_sentList.pop_back ();
     }
 
+  m_sentIndex.clear ();
+  m_sackedSeqs.clear ();
+  m_lostSeqs.clear ();
+  m_outSeqs.clear ();
+  m_lostNotRtxSeqs.clear ();
+  m_notRtxSeqs.clear ();
+
   m_sentSize = 0;
   m_lostOut = 0;
   m_retrans = 0;
@@ -1218,6 +1272,7 @@ TcpTxBuffer::ResetLastSegmentSent ()
     {
       TcpTxItem *item = m_sentList.back ();
 
+      UnindexSentItem (item);
       m_sentList.pop_back ();
       m_sentSize -= item->m_packet->GetSize ();
       if (item->m_retrans)
@@ -1248,6 +1303,7 @@ TcpTxBuffer::SetSentListLost (bool resetSack)
 
   for (auto it = m_sentList.begin (); it != m_sentList.end (); ++it)
     {
+      ScoreboardErase (*it);
       if (resetSack)
         {
           (*it)->m_sacked = false;
@@ -1269,6 +1325,7 @@ TcpTxBuffer::SetSentListLost (bool resetSack)
         }
 
       (*it)->m_retrans = false;
+      ScoreboardInsert (*it);
     }
 
   NS_LOG_INFO ("Set sent list lost, status: " << *this);
@@ -1301,8 +1358,10 @@ TcpTxBuffer::DeleteRetransmittedFlagFromHead ()
 
   if (m_sentList.front ()->m_retrans)
     {
+      ScoreboardErase (m_sentList.front ());
       m_sentList.front ()->m_retrans = false;
       m_retrans -= m_sentList.front ()->m_packet->GetSize ();
+      ScoreboardInsert (m_sentList.front ());
     }
   ConsistencyCheck ();
 }
@@ -1312,6 +1371,8 @@ TcpTxBuffer::MarkHeadAsLost ()
 {
   if (m_sentList.size () > 0)
     {
+      ScoreboardErase (m_sentList.front ());
+
       // If the head is sacked (reneging by the receiver the previously sent
       // information) we revert the sacked flag.
       // A sacked head means that we should advance SND.UNA.. so it's an error.
@@ -1332,6 +1393,8 @@ TcpTxBuffer::MarkHeadAsLost ()
           m_sentList.front()->m_lost = true;
           m_lostOut += m_sentList.front ()->m_packet->GetSize ();
         }
+
+      ScoreboardInsert (m_sentList.front ());
     }
   ConsistencyCheck ();
 }
@@ -1344,19 +1407,27 @@ TcpTxBuffer::AddRenoSack (void)
 
   m_renoSack = true;
 
-  // We can _never_ SACK the head, so start from the second segment sent
-  auto it = ++m_sentList.begin ();
-
-  // Find the "highest sacked" point, that is SND.UNA + m_sackedOut
-  while (it != m_sentList.end () && (*it)->m_sacked)
+  // We can _never_ SACK the head, so start from the second segment sent.
+  // The first "not sacked" segment after it is either lost, or not.
+  SequenceNumber32 head = m_sentList.front ()->m_startSeq;
+  auto lost = m_lostSeqs.upper_bound (head);
+  auto out = m_outSeqs.upper_bound (head);
+  auto it = m_sentList.end ();
+  if (lost != m_lostSeqs.end () && (out == m_outSeqs.end () || *lost < *out))
     {
-      ++it;
+      it = m_sentIndex.at (*lost);
+    }
+  else if (out != m_outSeqs.end ())
+    {
+      it = m_sentIndex.at (*out);
     }
 
   // Add to the sacked size the size of the first "not sacked" segment
   if (it != m_sentList.end ())
     {
+      ScoreboardErase (*it);
       (*it)->m_sacked = true;
+      ScoreboardInsert (*it);
       m_sackedOut += (*it)->m_packet->GetSize ();
       m_highestSack = std::make_pair (it, (*it)->m_startSeq);
       NS_LOG_INFO ("Added a Reno SACK, status: " << *this);
@@ -1384,8 +1455,20 @@ TcpTxBuffer::ConsistencyCheck () const
   uint32_t lost = 0;
   uint32_t retrans = 0;
 
+  NS_ASSERT_MSG (m_sentIndex.size () == m_sentList.size (),
+                 "Indexed " << m_sentIndex.size () << " items out of " <<
+                 m_sentList.size ());
+  NS_ASSERT (m_sackedSeqs.size () + m_lostSeqs.size () + m_outSeqs.size ()
+             == m_sentList.size ());
+
   for (auto it = m_sentList.begin (); it != m_sentList.end (); ++it)
     {
+      const SequenceNumber32 &seq = (*it)->m_startSeq;
+      NS_ASSERT (m_sentIndex.count (seq) == 1 && m_sentIndex.at (seq) == it);
+      NS_ASSERT ((m_sackedSeqs.count (seq) == 1) == (*it)->m_sacked);
+      NS_ASSERT ((m_lostSeqs.count (seq) == 1) == (*it)->m_lost);
+      NS_ASSERT ((m_notRtxSeqs.count (seq) == 1) == (!(*it)->m_retrans && !(*it)->m_sacked));
+
       if ((*it)->m_sacked)
         {
           sacked += (*it)->m_packet->GetSize ();
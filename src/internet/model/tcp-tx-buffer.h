@@ -28,6 +28,10 @@
 #include "ns3/nstime.h"
 #include "ns3/tcp-option-sack.h"
 #include "ns3/packet.h"
+#include "ns3/callback.h"
+
+#include <map>
+#include <set>
 
 namespace ns3 {
 class Packet;
@@ -55,12 +59,32 @@ public:
    */
   uint32_t GetSeqSize (void) const { return m_packet && m_packet->GetSize () > 0 ? m_packet->GetSize () : 1; }
 
+  /**
+   * \brief Get a copy of the packet of the item
+   *
+   * \return a copy of the application packet
+   */
+  Ptr<Packet> GetPacketCopy (void) const { return m_packet->Copy (); }
+
+  /**
+   * \brief State of the connection when the segment was sent, used to
+   * sample the delivery rate when it is acknowledged (\see TcpRateOps)
+   */
+  struct RateInformation
+  {
+    uint64_t m_delivered    {0};            //!< Connection's delivered data at the time the packet was sent
+    Time m_deliveredTime    {Time::Max ()}; //!< Connection's delivered time at the time the packet was sent
+    Time m_firstSent        {Time::Max ()}; //!< Connection's first sent time at the time the packet was sent
+    bool m_isAppLimited     {false};        //!< Connection's app limited at the time the packet was sent
+  };
+
   SequenceNumber32 m_startSeq {0};     //!< Sequence number of the item (if transmitted)
   Ptr<Packet> m_packet {nullptr};    //!< Application packet (can be null)
   bool m_lost          {false};      //!< Indicates if the segment has been lost (RTO)
   bool m_retrans       {false};      //!< Indicates if the segment is retransmitted
   Time m_lastSent      {Time::Min()};//!< Timestamp of the time at which the segment has been sent last time
   bool m_sacked        {false};      //!< Indicates if the segment has been SACKed
+  RateInformation m_rateInfo;        //!< Rate information of the item
 };
 
 /**
@@ -272,11 +296,17 @@ public:
    * from GetNewSegment, and then calling GetTransmittedSegment with the full
    * block range.
    *
+   * The returned item stays owned by the buffer: it is valid until the next
+   * call that modifies the buffer, and it is meant to let the caller get a
+   * copy of the packet and record per-segment information (e.g. for rate
+   * sampling).
+   *
    * \param numBytes number of bytes to copy
    * \param seq start sequence number to extract
-   * \returns a packet
+   * \returns the item that contains the block, or nullptr if there is no
+   * data at seq
    */
-  Ptr<Packet> CopyFromSequence (uint32_t numBytes, const SequenceNumber32& seq);
+  TcpTxItem* CopyFromSequence (uint32_t numBytes, const SequenceNumber32& seq);
 
   /**
    * \brief Set the head sequence of the buffer
@@ -292,15 +322,21 @@ public:
    *
    * \param seq The first sequence number to maintain after discarding all the
    * previous sequences.
+   * \param beforeDelCb Callback invoked, if it is not null, before the deletion
+   * of each item that is fully acknowledged
    */
-  void DiscardUpTo (const SequenceNumber32& seq);
+  void DiscardUpTo (const SequenceNumber32& seq,
+                    const Callback<void, TcpTxItem *> &beforeDelCb = MakeNullCallback<void, TcpTxItem *> ());
 
   /**
    * \brief Update the scoreboard
    * \param list list of SACKed blocks
+   * \param sackedCb Callback invoked, if it is not null, for each item that
+   * gets SACKed for the first time
    * \returns true in case of an update
    */
-  bool Update (const TcpOptionSack::SackList &list);
+  bool Update (const TcpOptionSack::SackList &list,
+               const Callback<void, TcpTxItem *> &sackedCb = MakeNullCallback<void, TcpTxItem *> ());
 
   /**
    * \brief Check if a segment is lost
@@ -411,10 +447,44 @@ private:
 
   typedef std::list<TcpTxItem*> PacketList; //!< container for data stored in the buffer
 
+  typedef std::map<SequenceNumber32, PacketList::iterator> SentIndex; //!< sent items by starting sequence
+  typedef std::set<SequenceNumber32> SeqSet; //!< set of starting sequences of sent items
+
+  /**
+   * \brief Add a sent item to the sequence index and to the scoreboard
+   * \param it iterator to the item, inside m_sentList
+   */
+  void IndexSentItem (PacketList::iterator it);
+
+  /**
+   * \brief Remove a sent item from the sequence index and from the scoreboard
+   *
+   * Must be called before changing the starting sequence of the item, or
+   * removing it from m_sentList.
+   * \param item item to remove
+   */
+  void UnindexSentItem (const TcpTxItem *item);
+
+  /**
+   * \brief Add a sent item to the scoreboard sets that match its flags
+   * \param item item to add
+   */
+  void ScoreboardInsert (const TcpTxItem *item);
+
+  /**
+   * \brief Remove a sent item from all the scoreboard sets
+   *
+   * Must be called before changing the flags of the item, and followed by
+   * ScoreboardInsert once they are updated.
+   * \param item item to remove
+   */
+  void ScoreboardErase (const TcpTxItem *item);
+
   /**
    * \brief Update the lost count
    *
-   * Reset lost to 0, then walk the sent list looking for lost segments.
+   * Mark as lost the segments that are not SACKed and that are below the
+   * "Dupack thresh"-th highest SACKed segment.
    * We have two possible algorithms for detecting lost packets:
    *
    * - RFC 6675 algorithm, which says that if more than "Dupack thresh" (e.g., 3)
@@ -426,8 +496,8 @@ private:
    * The {New}Reno cases, for now, are managed in TcpSocketBase through the
    * call to MarkHeadAsLost.
    * This function is, therefore, called after a SACK option has been received,
-   * and updates the lost count. It can be probably optimized by not walking
-   * the entire list, but a subset.
+   * and updates the lost count. Only the segments that change their state
+   * are visited.
    *
    */
   void UpdateLostCount ();
@@ -601,6 +671,16 @@ private:
 
   PacketList m_appList;  //!< Buffer for application data
   PacketList m_sentList; //!< Buffer for sent (but not acked) data
+
+  // Scoreboard: every sent item is indexed by its starting sequence, and
+  // the sets keep the items by state, so that the lookups needed when
+  // processing an ACK are logarithmic in the number of segments in flight.
+  SentIndex m_sentIndex;      //!< Sent items, by starting sequence
+  SeqSet m_sackedSeqs;        //!< Sacked items
+  SeqSet m_lostSeqs;          //!< Lost items
+  SeqSet m_outSeqs;           //!< Items neither lost nor sacked
+  SeqSet m_lostNotRtxSeqs;    //!< Lost items not sacked nor retransmitted (NextSeg, rule 1)
+  SeqSet m_notRtxSeqs;        //!< Items not sacked nor retransmitted (NextSeg, rule 3)
   uint32_t m_maxBuffer;  //!< Max number of data bytes in buffer (SND.WND)
   uint32_t m_size;       //!< Size of all data in this buffer
   uint32_t m_sentSize;   //!< Size of sent (and not discarded) segments
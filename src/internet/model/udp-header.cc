@@ -20,6 +20,7 @@
 
 #include "udp-header.h"
 #include "ns3/address-utils.h"
+#include "ns3/fixed-header-layout.h"
 
 namespace ns3 {
 
@@ -184,46 +185,42 @@ void
 UdpHeader::Serialize (Buffer::Iterator start) const
 {
   Buffer::Iterator i = start;
+  FixedHeaderLayout<8> layout;
 
-  i.WriteHtonU16 (m_sourcePort);
-  i.WriteHtonU16 (m_destinationPort);
+  layout.WriteHtonU16<0> (m_sourcePort);
+  layout.WriteHtonU16<2> (m_destinationPort);
   if (m_payloadSize == 0)
     {
-      i.WriteHtonU16 (start.GetSize ());
+      layout.WriteHtonU16<4> (start.GetSize ());
     }
   else
     {
-      i.WriteHtonU16 (m_payloadSize);
+      layout.WriteHtonU16<4> (m_payloadSize);
     }
+  layout.WriteU16<6> (m_checksum);
+  layout.WriteTo (i);
 
-  if ( m_checksum == 0)
+  if (m_checksum == 0 && m_calcChecksum)
     {
-      i.WriteU16 (0);
-
-      if (m_calcChecksum)
-        {
-          uint16_t headerChecksum = CalculateHeaderChecksum (start.GetSize ());
-          i = start;
-          uint16_t checksum = i.CalculateIpChecksum (start.GetSize (), headerChecksum);
-
-          i = start;
-          i.Next (6);
-          i.WriteU16 (checksum);
-        }
-    }
-  else
-    {
-      i.WriteU16 (m_checksum);
+      uint16_t headerChecksum = CalculateHeaderChecksum (start.GetSize ());
+      i = start;
+      uint16_t checksum = i.CalculateIpChecksum (start.GetSize (), headerChecksum);
+
+      i = start;
+      i.Next (6);
+      i.WriteU16 (checksum);
     }
 }
 uint32_t
 UdpHeader::Deserialize (Buffer::Iterator start)
 {
   Buffer::Iterator i = start;
-  m_sourcePort = i.ReadNtohU16 ();
-  m_destinationPort = i.ReadNtohU16 ();
-  m_payloadSize = i.ReadNtohU16 () - GetSerializedSize ();
-  m_checksum = i.ReadU16 ();
+  FixedHeaderLayout<8> layout;
+  layout.ReadFrom (i);
+  m_sourcePort = layout.ReadNtohU16<0> ();
+  m_destinationPort = layout.ReadNtohU16<2> ();
+  m_payloadSize = layout.ReadNtohU16<4> () - GetSerializedSize ();
+  m_checksum = layout.ReadU16<6> ();
 
   if (m_calcChecksum)
     {
@@ -0,0 +1,302 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+/**
+ * This is the test code for ipv4-end-point-demux.cc and
+ * ipv6-end-point-demux.cc
+ */
+
+#include "ns3/simulator.h"
+#include "ns3/test.h"
+#include "ns3/node.h"
+#include "ns3/loopback-net-device.h"
+#include "ns3/ipv4-interface.h"
+#include "ns3/ipv4-interface-address.h"
+#include "ns3/ipv6-interface.h"
+
+#include "../model/ipv4-end-point.h"
+#include "../model/ipv4-end-point-demux.h"
+#include "../model/ipv6-end-point.h"
+#include "../model/ipv6-end-point-demux.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Ipv4EndPointDemux lookup priorities and re-indexing test
+ */
+class Ipv4EndPointDemuxTestCase : public TestCase
+{
+public:
+  Ipv4EndPointDemuxTestCase ();
+  virtual ~Ipv4EndPointDemuxTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Lookup a packet expected to match a single endpoint.
+   * \param demux the demux
+   * \param daddr destination address
+   * \param dport destination port
+   * \param saddr source address
+   * \param sport source port
+   * \param iface the incoming interface
+   * \returns the matching endpoint, or 0 if none
+   */
+  Ipv4EndPoint * LookupOne (Ipv4EndPointDemux &demux,
+                            Ipv4Address daddr, uint16_t dport,
+                            Ipv4Address saddr, uint16_t sport,
+                            Ptr<Ipv4Interface> iface);
+};
+
+Ipv4EndPointDemuxTestCase::Ipv4EndPointDemuxTestCase ()
+  : TestCase ("Verify the IPv4 endpoint demux")
+{
+}
+
+Ipv4EndPointDemuxTestCase::~Ipv4EndPointDemuxTestCase ()
+{
+}
+
+Ipv4EndPoint *
+Ipv4EndPointDemuxTestCase::LookupOne (Ipv4EndPointDemux &demux,
+                                      Ipv4Address daddr, uint16_t dport,
+                                      Ipv4Address saddr, uint16_t sport,
+                                      Ptr<Ipv4Interface> iface)
+{
+  Ipv4EndPointDemux::EndPoints endPoints = demux.Lookup (daddr, dport, saddr, sport, iface);
+  return endPoints.empty () ? 0 : endPoints.front ();
+}
+
+void
+Ipv4EndPointDemuxTestCase::DoRun (void)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  Ptr<LoopbackNetDevice> device = CreateObject<LoopbackNetDevice> ();
+  node->AddDevice (device);
+  Ptr<Ipv4Interface> iface = CreateObject<Ipv4Interface> ();
+  iface->SetDevice (device);
+  iface->SetNode (node);
+  iface->AddAddress (Ipv4InterfaceAddress ("10.1.1.1", "255.255.255.0"));
+
+  Ipv4Address local ("10.1.1.1");
+  Ipv4Address peer ("10.1.1.2");
+  Ipv4EndPointDemux demux;
+
+  NS_TEST_ASSERT_MSG_EQ (demux.LookupPortLocal (80), false, "Port 80 should be free");
+  NS_TEST_ASSERT_MSG_EQ (LookupOne (demux, local, 80, peer, 1000, iface), 0,
+                         "Nothing should match an empty demux");
+
+  // Only local port matches
+  Ipv4EndPoint *any = demux.Allocate (0, 80);
+  NS_TEST_ASSERT_MSG_NE (any, 0, "Allocation failed");
+  NS_TEST_ASSERT_MSG_EQ (demux.LookupPortLocal (80), true, "Port 80 should be in use");
+  NS_TEST_ASSERT_MSG_EQ (demux.Allocate (0, 80), 0, "Duplicated endpoint allowed");
+  NS_TEST_ASSERT_MSG_EQ (LookupOne (demux, local, 80, peer, 1000, iface), any,
+                         "Wildcard endpoint not found");
+
+  // Only local port and local address match
+  Ipv4EndPoint *bound = demux.Allocate (0, local, 80);
+  NS_TEST_ASSERT_MSG_NE (bound, 0, "Allocation failed");
+  NS_TEST_ASSERT_MSG_EQ (LookupOne (demux, local, 80, peer, 1000, iface), bound,
+                         "Address-bound endpoint should win over the wildcard one");
+
+  // All but local address
+  Ipv4EndPoint *half = demux.Allocate (0, Ipv4Address::GetAny (), 80, peer, 1000);
+  NS_TEST_ASSERT_MSG_NE (half, 0, "Allocation failed");
+  NS_TEST_ASSERT_MSG_EQ (LookupOne (demux, local, 80, peer, 1000, iface), half,
+                         "Peer-bound endpoint should win over the address-bound one");
+
+  // Full match
+  Ipv4EndPoint *full = demux.Allocate (0, local, 80, peer, 1000);
+  NS_TEST_ASSERT_MSG_NE (full, 0, "Allocation failed");
+  NS_TEST_ASSERT_MSG_EQ (demux.Allocate (0, local, 80, peer, 1000), 0,
+                         "Duplicated four-tuple allowed");
+  NS_TEST_ASSERT_MSG_EQ (LookupOne (demux, local, 80, peer, 1000, iface), full,
+                         "Exact endpoint should win");
+  NS_TEST_ASSERT_MSG_EQ (LookupOne (demux, local, 80, peer, 1001, iface), bound,
+                         "Other peer ports should fall back to the address-bound endpoint");
+  NS_TEST_ASSERT_MSG_EQ (demux.SimpleLookup (local, 80, peer, 1000), full,
+                         "SimpleLookup should find the exact endpoint");
+
+  // Endpoints with Rx disabled are skipped
+  full->SetRxEnabled (false);
+  NS_TEST_ASSERT_MSG_EQ (LookupOne (demux, local, 80, peer, 1000, iface), half,
+                         "Rx-disabled endpoint should be skipped");
+  full->SetRxEnabled (true);
+
+  demux.DeAllocate (full);
+  demux.DeAllocate (half);
+  demux.DeAllocate (bound);
+  NS_TEST_ASSERT_MSG_EQ (LookupOne (demux, local, 80, peer, 1000, iface), any,
+                         "Deallocated endpoints should no longer match");
+  demux.DeAllocate (any);
+  NS_TEST_ASSERT_MSG_EQ (demux.LookupPortLocal (80), false, "Port 80 should be free again");
+
+  // Subnet-directed broadcast
+  Ipv4EndPoint *subnet = demux.Allocate (0, Ipv4Address ("10.1.1.0"), 90);
+  NS_TEST_ASSERT_MSG_EQ (LookupOne (demux, Ipv4Address ("10.1.1.255"), 90, peer, 1000, iface), subnet,
+                         "Subnet endpoint should match a subnet-directed broadcast");
+  NS_TEST_ASSERT_MSG_EQ (LookupOne (demux, Ipv4Address ("10.1.2.255"), 90, peer, 1000, iface), 0,
+                         "Subnet endpoint should not match another subnet");
+
+  // Endpoints re-index themselves when their four-tuple changes
+  Ipv4EndPoint *client = demux.Allocate ();
+  Ipv4EndPoint *other = demux.Allocate ();
+  NS_TEST_ASSERT_MSG_NE (client->GetLocalPort (), other->GetLocalPort (),
+                         "Ephemeral ports should differ");
+  uint16_t port = client->GetLocalPort ();
+  client->SetPeer (peer, 5000);
+  client->SetLocalAddress (local);
+  NS_TEST_ASSERT_MSG_EQ (LookupOne (demux, local, port, peer, 5000, iface), client,
+                         "Endpoint not found under its new four-tuple");
+  NS_TEST_ASSERT_MSG_EQ (LookupOne (demux, local, port, peer, 5001, iface), 0,
+                         "Endpoint still found under a wildcard four-tuple");
+  NS_TEST_ASSERT_MSG_EQ (demux.Allocate (0, local, port, peer, 5000), 0,
+                         "Duplicated four-tuple allowed after SetPeer");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Ipv6EndPointDemux lookup priorities and re-indexing test
+ */
+class Ipv6EndPointDemuxTestCase : public TestCase
+{
+public:
+  Ipv6EndPointDemuxTestCase ();
+  virtual ~Ipv6EndPointDemuxTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Lookup a packet expected to match a single endpoint.
+   * \param demux the demux
+   * \param daddr destination address
+   * \param dport destination port
+   * \param saddr source address
+   * \param sport source port
+   * \param iface the incoming interface
+   * \returns the matching endpoint, or 0 if none
+   */
+  Ipv6EndPoint * LookupOne (Ipv6EndPointDemux &demux,
+                            Ipv6Address daddr, uint16_t dport,
+                            Ipv6Address saddr, uint16_t sport,
+                            Ptr<Ipv6Interface> iface);
+};
+
+Ipv6EndPointDemuxTestCase::Ipv6EndPointDemuxTestCase ()
+  : TestCase ("Verify the IPv6 endpoint demux")
+{
+}
+
+Ipv6EndPointDemuxTestCase::~Ipv6EndPointDemuxTestCase ()
+{
+}
+
+Ipv6EndPoint *
+Ipv6EndPointDemuxTestCase::LookupOne (Ipv6EndPointDemux &demux,
+                                      Ipv6Address daddr, uint16_t dport,
+                                      Ipv6Address saddr, uint16_t sport,
+                                      Ptr<Ipv6Interface> iface)
+{
+  Ipv6EndPointDemux::EndPoints endPoints = demux.Lookup (daddr, dport, saddr, sport, iface);
+  return endPoints.empty () ? 0 : endPoints.front ();
+}
+
+void
+Ipv6EndPointDemuxTestCase::DoRun (void)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  Ptr<LoopbackNetDevice> device = CreateObject<LoopbackNetDevice> ();
+  node->AddDevice (device);
+  Ptr<Ipv6Interface> iface = CreateObject<Ipv6Interface> ();
+  iface->SetDevice (device);
+  iface->SetNode (node);
+
+  Ipv6Address local ("2001:1::1");
+  Ipv6Address peer ("2001:1::2");
+  Ipv6EndPointDemux demux;
+
+  Ipv6EndPoint *any = demux.Allocate (0, 80);
+  NS_TEST_ASSERT_MSG_EQ (LookupOne (demux, local, 80, peer, 1000, iface), any,
+                         "Wildcard endpoint not found");
+
+  Ipv6EndPoint *bound = demux.Allocate (0, local, 80);
+  NS_TEST_ASSERT_MSG_EQ (LookupOne (demux, local, 80, peer, 1000, iface), bound,
+                         "Address-bound endpoint should win over the wildcard one");
+
+  Ipv6EndPoint *half = demux.Allocate (0, Ipv6Address::GetAny (), 80, peer, 1000);
+  NS_TEST_ASSERT_MSG_EQ (LookupOne (demux, local, 80, peer, 1000, iface), half,
+                         "Peer-bound endpoint should win over the address-bound one");
+
+  Ipv6EndPoint *full = demux.Allocate (0, local, 80, peer, 1000);
+  NS_TEST_ASSERT_MSG_EQ (demux.Allocate (0, local, 80, peer, 1000), 0,
+                         "Duplicated four-tuple allowed");
+  NS_TEST_ASSERT_MSG_EQ (LookupOne (demux, local, 80, peer, 1000, iface), full,
+                         "Exact endpoint should win");
+  NS_TEST_ASSERT_MSG_EQ (LookupOne (demux, local, 80, peer, 1001, iface), bound,
+                         "Other peer ports should fall back to the address-bound endpoint");
+
+  demux.DeAllocate (full);
+  demux.DeAllocate (half);
+  demux.DeAllocate (bound);
+  NS_TEST_ASSERT_MSG_EQ (LookupOne (demux, local, 80, peer, 1000, iface), any,
+                         "Deallocated endpoints should no longer match");
+
+  // Changing the local port moves the endpoint between port buckets
+  any->SetLocalPort (8080);
+  NS_TEST_ASSERT_MSG_EQ (demux.LookupPortLocal (80), false, "Port 80 should be free");
+  NS_TEST_ASSERT_MSG_EQ (LookupOne (demux, local, 8080, peer, 1000, iface), any,
+                         "Endpoint not found under its new port");
+
+  Ipv6EndPoint *client = demux.Allocate ();
+  uint16_t port = client->GetLocalPort ();
+  client->SetPeer (peer, 5000);
+  client->SetLocalAddress (local);
+  NS_TEST_ASSERT_MSG_EQ (LookupOne (demux, local, port, peer, 5000, iface), client,
+                         "Endpoint not found under its new four-tuple");
+  NS_TEST_ASSERT_MSG_EQ (demux.SimpleLookup (local, port, peer, 5000), client,
+                         "SimpleLookup should find the exact endpoint");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Endpoint demux TestSuite
+ */
+class EndPointDemuxTestSuite : public TestSuite
+{
+public:
+  EndPointDemuxTestSuite () :
+    TestSuite ("end-point-demux", UNIT)
+  {
+    AddTestCase (new Ipv4EndPointDemuxTestCase (), TestCase::QUICK);
+    AddTestCase (new Ipv6EndPointDemuxTestCase (), TestCase::QUICK);
+  }
+};
+
+static EndPointDemuxTestSuite g_endPointDemuxTestSuite; //!< Static variable for test initialization
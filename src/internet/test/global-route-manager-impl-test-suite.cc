@@ -27,6 +27,8 @@
 #include "ns3/candidate-queue.h"
 #include "ns3/simulator.h"
 #include <cstdlib> // for rand()
+#include <algorithm>
+#include <vector>
 
 using namespace ns3;
 
@@ -226,6 +228,81 @@ GlobalRouteManagerImplTestCase::DoRun (void)
 }
 
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief CandidateQueue ordering, lookups and reordering, checked against
+ * a stable sort of the vertices.
+ */
+class CandidateQueueTestCase : public TestCase
+{
+public:
+  CandidateQueueTestCase ();
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \param v1 first vertex
+   * \param v2 second vertex
+   * \returns true if v1 has to be popped before v2
+   */
+  static bool Before (const SPFVertex *v1, const SPFVertex *v2);
+};
+
+CandidateQueueTestCase::CandidateQueueTestCase ()
+  : TestCase ("CandidateQueue against a stable sort")
+{
+}
+
+bool
+CandidateQueueTestCase::Before (const SPFVertex *v1, const SPFVertex *v2)
+{
+  if (v1->GetDistanceFromRoot () != v2->GetDistanceFromRoot ())
+    {
+      return v1->GetDistanceFromRoot () < v2->GetDistanceFromRoot ();
+    }
+  return v1->GetVertexType () == SPFVertex::VertexNetwork
+         && v2->GetVertexType () == SPFVertex::VertexRouter;
+}
+
+void
+CandidateQueueTestCase::DoRun (void)
+{
+  CandidateQueue candidate;
+  std::vector<SPFVertex *> expected;
+
+  for (uint32_t i = 0; i < 200; ++i)
+    {
+      SPFVertex *v = new SPFVertex;
+      v->SetVertexId (Ipv4Address (i + 1));
+      v->SetVertexType (std::rand () % 2 ? SPFVertex::VertexNetwork : SPFVertex::VertexRouter);
+      v->SetDistanceFromRoot (50 + std::rand () % 50);
+      candidate.Push (v);
+      expected.insert (std::upper_bound (expected.begin (), expected.end (), v, &Before), v);
+    }
+  NS_TEST_ASSERT_MSG_EQ (candidate.Size (), 200, "Wrong queue size");
+  NS_TEST_ASSERT_MSG_EQ (candidate.Find (Ipv4Address (1000)), 0, "Found a vertex not in the queue");
+
+  for (uint32_t i = 0; i < 100; ++i)
+    {
+      SPFVertex *v = expected[std::rand () % expected.size ()];
+      NS_TEST_ASSERT_MSG_EQ (candidate.Find (v->GetVertexId ()), v, "Vertex not found");
+      v->SetDistanceFromRoot (v->GetDistanceFromRoot () - std::rand () % 10);
+      candidate.Reorder (v);
+      std::stable_sort (expected.begin (), expected.end (), &Before);
+    }
+
+  for (uint32_t i = 0; i < expected.size (); ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ (candidate.Top (), expected[i], "Wrong vertex on top of the queue");
+      SPFVertex *v = candidate.Pop ();
+      NS_TEST_ASSERT_MSG_EQ (candidate.Find (v->GetVertexId ()), 0, "Popped vertex still found");
+      delete v;
+    }
+  NS_TEST_ASSERT_MSG_EQ (candidate.Empty (), true, "Queue not empty");
+}
+
 /**
  * \ingroup internet-test
  * \ingroup tests
@@ -243,6 +320,7 @@ GlobalRouteManagerImplTestSuite::GlobalRouteManagerImplTestSuite ()
   : TestSuite ("global-route-manager-impl", UNIT)
 {
   AddTestCase (new GlobalRouteManagerImplTestCase (), TestCase::QUICK);
+  AddTestCase (new CandidateQueueTestCase (), TestCase::QUICK);
 }
 
 static GlobalRouteManagerImplTestSuite g_globalRoutingManagerImplTestSuite; //!< Static variable for test initialization
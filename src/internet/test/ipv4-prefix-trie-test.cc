@@ -0,0 +1,202 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <list>
+#include <vector>
+#include "ns3/test.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/ipv4-prefix-trie.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Ipv4PrefixTrie basic lookups
+ */
+class Ipv4PrefixTrieTestCase : public TestCase
+{
+public:
+  Ipv4PrefixTrieTestCase ();
+  virtual ~Ipv4PrefixTrieTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+Ipv4PrefixTrieTestCase::Ipv4PrefixTrieTestCase ()
+  : TestCase ("Ipv4PrefixTrie lookups and removals")
+{
+}
+
+Ipv4PrefixTrieTestCase::~Ipv4PrefixTrieTestCase ()
+{
+}
+
+void
+Ipv4PrefixTrieTestCase::DoRun (void)
+{
+  Ipv4PrefixTrie<int> trie;
+  std::vector<int> values;
+
+  trie.Lookup (Ipv4Address ("10.1.2.3"), values);
+  NS_TEST_ASSERT_MSG_EQ (values.size (), 0, "Empty trie should not match");
+
+  trie.Insert (Ipv4Address ("10.1.2.0"), Ipv4Mask ("255.255.255.0"), 1);
+  trie.Insert (Ipv4Address ("0.0.0.0"), Ipv4Mask::GetZero (), 2);
+  trie.Insert (Ipv4Address ("10.1.2.3"), Ipv4Mask::GetOnes (), 3);
+  // host bits outside of the mask are ignored
+  trie.Insert (Ipv4Address ("10.1.255.255"), Ipv4Mask ("255.255.0.0"), 4);
+  trie.Insert (Ipv4Address ("10.1.2.0"), Ipv4Mask ("255.255.255.0"), 5);
+  trie.Insert (Ipv4Address ("10.1.3.0"), Ipv4Mask ("255.255.255.0"), 6);
+  // non-contiguous mask matching 10.x.2.x
+  trie.Insert (Ipv4Address ("10.0.2.0"), Ipv4Mask ("255.0.255.0"), 7);
+
+  trie.Lookup (Ipv4Address ("10.1.2.3"), values);
+  NS_TEST_ASSERT_MSG_EQ (values.size (), 6, "Wrong number of matches");
+  int expected[] = { 1, 2, 3, 4, 5, 7 };
+  for (uint32_t i = 0; i < values.size (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (values[i], expected[i], "Matches not in insertion order");
+    }
+
+  trie.Lookup (Ipv4Address ("10.1.3.1"), values);
+  NS_TEST_ASSERT_MSG_EQ (values.size (), 3, "Wrong number of matches");
+  NS_TEST_ASSERT_MSG_EQ (values[0], 2, "Default route should match");
+  NS_TEST_ASSERT_MSG_EQ (values[1], 4, "/16 should match");
+  NS_TEST_ASSERT_MSG_EQ (values[2], 6, "/24 should match");
+
+  trie.Lookup (Ipv4Address ("192.168.0.1"), values);
+  NS_TEST_ASSERT_MSG_EQ (values.size (), 1, "Only the default route should match");
+
+  NS_TEST_ASSERT_MSG_EQ (trie.Remove (Ipv4Address ("10.1.2.0"), Ipv4Mask ("255.255.255.0"), 1), true,
+                         "Removal failed");
+  NS_TEST_ASSERT_MSG_EQ (trie.Remove (Ipv4Address ("10.1.2.0"), Ipv4Mask ("255.255.255.0"), 1), false,
+                         "Removed twice");
+  NS_TEST_ASSERT_MSG_EQ (trie.Remove (Ipv4Address ("10.1.0.0"), Ipv4Mask ("255.255.255.0"), 5), false,
+                         "Removed from the wrong prefix");
+  NS_TEST_ASSERT_MSG_EQ (trie.Remove (Ipv4Address ("10.1.2.3"), Ipv4Mask::GetOnes (), 3), true,
+                         "Removal failed");
+  NS_TEST_ASSERT_MSG_EQ (trie.Remove (Ipv4Address ("10.0.2.0"), Ipv4Mask ("255.0.255.0"), 7), true,
+                         "Removal failed");
+  trie.Lookup (Ipv4Address ("10.1.2.3"), values);
+  NS_TEST_ASSERT_MSG_EQ (values.size (), 3, "Wrong number of matches after removal");
+  NS_TEST_ASSERT_MSG_EQ (values[2], 5, "Remaining /24 value should match");
+
+  trie.Clear ();
+  trie.Lookup (Ipv4Address ("10.1.2.3"), values);
+  NS_TEST_ASSERT_MSG_EQ (values.size (), 0, "Cleared trie should not match");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Ipv4PrefixTrie compared against a linear scan of random prefixes
+ */
+class Ipv4PrefixTrieRandomTestCase : public TestCase
+{
+public:
+  Ipv4PrefixTrieRandomTestCase ();
+  virtual ~Ipv4PrefixTrieRandomTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+Ipv4PrefixTrieRandomTestCase::Ipv4PrefixTrieRandomTestCase ()
+  : TestCase ("Ipv4PrefixTrie against a linear scan")
+{
+}
+
+Ipv4PrefixTrieRandomTestCase::~Ipv4PrefixTrieRandomTestCase ()
+{
+}
+
+void
+Ipv4PrefixTrieRandomTestCase::DoRun (void)
+{
+  struct Route
+  {
+    Ipv4Address network;
+    Ipv4Mask mask;
+    uint32_t id;
+  };
+  std::list<Route> routes;
+  Ipv4PrefixTrie<uint32_t> trie;
+
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  rng->SetStream (1);
+  // Keep addresses in a small space so that prefixes overlap
+  uint32_t base = Ipv4Address ("10.0.0.0").Get ();
+
+  for (uint32_t id = 0; id < 2000; id++)
+    {
+      if (!routes.empty () && rng->GetInteger (0, 3) == 0)
+        {
+          std::list<Route>::iterator victim = routes.begin ();
+          std::advance (victim, rng->GetInteger (0, routes.size () - 1));
+          NS_TEST_ASSERT_MSG_EQ (trie.Remove (victim->network, victim->mask, victim->id), true,
+                                 "Removal failed");
+          routes.erase (victim);
+        }
+      uint32_t length = rng->GetInteger (0, 32);
+      Route route;
+      route.network = Ipv4Address (base | rng->GetInteger (0, 0xffff));
+      route.mask = Ipv4Mask (length == 0 ? 0 : 0xffffffff << (32 - length));
+      route.id = id;
+      routes.push_back (route);
+      trie.Insert (route.network, route.mask, route.id);
+
+      Ipv4Address dest = Ipv4Address (base | rng->GetInteger (0, 0xffff));
+      std::vector<uint32_t> expected;
+      for (std::list<Route>::const_iterator i = routes.begin (); i != routes.end (); i++)
+        {
+          if (i->mask.IsMatch (dest, i->network))
+            {
+              expected.push_back (i->id);
+            }
+        }
+      std::vector<uint32_t> values;
+      trie.Lookup (dest, values);
+      NS_TEST_ASSERT_MSG_EQ (values.size (), expected.size (), "Wrong number of matches for " << dest);
+      for (uint32_t i = 0; i < values.size (); i++)
+        {
+          NS_TEST_ASSERT_MSG_EQ (values[i], expected[i], "Wrong match for " << dest);
+        }
+    }
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Ipv4PrefixTrie TestSuite
+ */
+class Ipv4PrefixTrieTestSuite : public TestSuite
+{
+public:
+  Ipv4PrefixTrieTestSuite () :
+    TestSuite ("ipv4-prefix-trie", UNIT)
+  {
+    AddTestCase (new Ipv4PrefixTrieTestCase (), TestCase::QUICK);
+    AddTestCase (new Ipv4PrefixTrieRandomTestCase (), TestCase::QUICK);
+  }
+};
+
+static Ipv4PrefixTrieTestSuite g_ipv4PrefixTrieTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,397 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/nstime.h"
+#include "ns3/uinteger.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/simple-channel.h"
+#include "ns3/mac48-address.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-l3-protocol.h"
+#include "ns3/ipv4-interface.h"
+#include "ns3/arp-cache.h"
+#include "ns3/ipv6-l3-protocol.h"
+#include "ns3/ipv6-interface.h"
+#include "ns3/icmpv6-l4-protocol.h"
+#include "ns3/ndisc-cache.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Add a SimpleNetDevice, on its own channel, to a node
+ * \param node the node
+ * \return the device
+ */
+static Ptr<SimpleNetDevice>
+AddSimpleDevice (Ptr<Node> node)
+{
+  Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+  device->SetAddress (Mac48Address::Allocate ());
+  device->SetChannel (CreateObject<SimpleChannel> ());
+  node->AddDevice (device);
+  return device;
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Create an NDISC cache on an IPv6 interface
+ * \param node the node, with an Internet stack
+ * \return the NDISC cache
+ */
+static Ptr<NdiscCache>
+CreateNdiscCache (Ptr<Node> node)
+{
+  Ptr<SimpleNetDevice> device = AddSimpleDevice (node);
+  Ptr<Ipv6L3Protocol> ipv6 = node->GetObject<Ipv6L3Protocol> ();
+  uint32_t i = ipv6->AddInterface (device);
+  ipv6->AddAddress (i, Ipv6InterfaceAddress (Ipv6Address ("2001:db8::1"), Ipv6Prefix (64)));
+  ipv6->SetUp (i);
+  return ipv6->GetInterface (i)->GetNdiscCache ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check that the NUD timers of the NDISC cache entries, driven by
+ * the expiry queue of the cache, expire in the order of their expiration
+ * times, whether they were postponed or re-armed earlier.
+ */
+class NdiscCacheExpiryTestCase : public TestCase
+{
+public:
+  NdiscCacheExpiryTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Mark an entry reachable and start its reachable timer
+   * \param entry the entry
+   */
+  void StartReachable (NdiscCache::Entry *entry);
+
+  /**
+   * \brief Refresh the reachable timer of an entry
+   * \param entry the entry
+   */
+  void UpdateReachable (NdiscCache::Entry *entry);
+
+  /**
+   * \brief Remove an entry from the cache
+   * \param entry the entry
+   */
+  void RemoveEntry (NdiscCache::Entry *entry);
+
+  /**
+   * \brief Check the state of the entries
+   * \param reachable the reachable state expected for the entries A, B, C
+   */
+  void CheckReachable (std::string reachable);
+
+  Ptr<NdiscCache> m_cache;            //!< the NDISC cache
+  Ptr<Icmpv6L4Protocol> m_icmpv6;     //!< the ICMPv6 protocol, holding the timer values
+  NdiscCache::Entry *m_entries[3];    //!< the entries A, B, C
+};
+
+NdiscCacheExpiryTestCase::NdiscCacheExpiryTestCase ()
+  : TestCase ("NDISC cache NUD timers expire in order")
+{
+}
+
+void
+NdiscCacheExpiryTestCase::StartReachable (NdiscCache::Entry *entry)
+{
+  entry->MarkReachable ();
+  entry->StartReachableTimer ();
+}
+
+void
+NdiscCacheExpiryTestCase::UpdateReachable (NdiscCache::Entry *entry)
+{
+  entry->UpdateReachableTimer ();
+}
+
+void
+NdiscCacheExpiryTestCase::RemoveEntry (NdiscCache::Entry *entry)
+{
+  m_cache->Remove (entry);
+}
+
+void
+NdiscCacheExpiryTestCase::CheckReachable (std::string reachable)
+{
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      bool expected = reachable[i] == '1';
+      NS_TEST_EXPECT_MSG_EQ (m_entries[i]->IsReachable (), expected,
+                             "Unexpected state of entry " << char ('A' + i) << " at " << Simulator::Now ().As (Time::S));
+      NS_TEST_EXPECT_MSG_EQ (m_entries[i]->IsStale (), !expected,
+                             "Unexpected state of entry " << char ('A' + i) << " at " << Simulator::Now ().As (Time::S));
+    }
+}
+
+void
+NdiscCacheExpiryTestCase::DoRun (void)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  InternetStackHelper internet;
+  internet.SetIpv4StackInstall (false);
+  internet.Install (node);
+  m_icmpv6 = node->GetObject<Icmpv6L4Protocol> ();
+  m_icmpv6->SetAttribute ("ReachableTime", TimeValue (Seconds (10)));
+  m_cache = CreateNdiscCache (node);
+
+  m_entries[0] = m_cache->Add (Ipv6Address ("2001:db8::a"));
+  m_entries[1] = m_cache->Add (Ipv6Address ("2001:db8::b"));
+  m_entries[2] = m_cache->Add (Ipv6Address ("2001:db8::c"));
+  NdiscCache::Entry *removed = m_cache->Add (Ipv6Address ("2001:db8::d"));
+
+  // A expires at 10 s, B at 11 s, C at 12 s, D at 10 s
+  Simulator::Schedule (Seconds (0), &NdiscCacheExpiryTestCase::StartReachable, this, m_entries[0]);
+  Simulator::Schedule (Seconds (0), &NdiscCacheExpiryTestCase::StartReachable, this, removed);
+  Simulator::Schedule (Seconds (1), &NdiscCacheExpiryTestCase::StartReachable, this, m_entries[1]);
+  Simulator::Schedule (Seconds (2), &NdiscCacheExpiryTestCase::StartReachable, this, m_entries[2]);
+  // A is postponed to 13 s, while staying at its queue position
+  Simulator::Schedule (Seconds (3), &NdiscCacheExpiryTestCase::UpdateReachable, this, m_entries[0]);
+  // D is removed while queued
+  Simulator::Schedule (Seconds (4), &NdiscCacheExpiryTestCase::RemoveEntry, this, removed);
+  // C is re-armed with a shorter delay: it now expires at 7 s, first
+  Simulator::Schedule (Seconds (5), &Icmpv6L4Protocol::SetAttribute, m_icmpv6,
+                       "ReachableTime", TimeValue (Seconds (2)));
+  Simulator::Schedule (Seconds (5), &NdiscCacheExpiryTestCase::StartReachable, this, m_entries[2]);
+
+  Simulator::Schedule (Seconds (6.9), &NdiscCacheExpiryTestCase::CheckReachable, this, "111");
+  Simulator::Schedule (Seconds (7.1), &NdiscCacheExpiryTestCase::CheckReachable, this, "110");
+  Simulator::Schedule (Seconds (10.1), &NdiscCacheExpiryTestCase::CheckReachable, this, "110");
+  Simulator::Schedule (Seconds (11.1), &NdiscCacheExpiryTestCase::CheckReachable, this, "100");
+  Simulator::Schedule (Seconds (12.9), &NdiscCacheExpiryTestCase::CheckReachable, this, "100");
+  Simulator::Schedule (Seconds (13.1), &NdiscCacheExpiryTestCase::CheckReachable, this, "000");
+  Simulator::Stop (Seconds (14));
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_cache->Lookup (Ipv6Address ("2001:db8::d")), 0, "Removed entry still in the cache");
+
+  m_cache = 0;
+  m_icmpv6 = 0;
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check the lookup of the NDISC cache entries by MAC address,
+ * after the MAC address of the entries changed and after their removal.
+ */
+class NdiscCacheMacIndexTestCase : public TestCase
+{
+public:
+  NdiscCacheMacIndexTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+NdiscCacheMacIndexTestCase::NdiscCacheMacIndexTestCase ()
+  : TestCase ("NDISC cache lookup by MAC address")
+{
+}
+
+void
+NdiscCacheMacIndexTestCase::DoRun (void)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  InternetStackHelper internet;
+  internet.SetIpv4StackInstall (false);
+  internet.Install (node);
+  Ptr<NdiscCache> cache = CreateNdiscCache (node);
+
+  Address mac1 = Mac48Address ("00:00:00:00:01:01");
+  Address mac2 = Mac48Address ("00:00:00:00:01:02");
+
+  NdiscCache::Entry *x = cache->Add (Ipv6Address ("2001:db8::a"));
+  NS_TEST_EXPECT_MSG_EQ (cache->LookupInverse (mac1).size (), 0, "Entry without a MAC address found");
+
+  x->MarkReachable (mac1);
+  std::list<NdiscCache::Entry *> found = cache->LookupInverse (mac1);
+  NS_TEST_ASSERT_MSG_EQ (found.size (), 1, "Entry not found by its MAC address");
+  NS_TEST_EXPECT_MSG_EQ (found.front (), x, "Wrong entry found");
+
+  NdiscCache::Entry *y = cache->Add (Ipv6Address ("2001:db8::b"));
+  y->MarkStale (mac1);
+  NS_TEST_EXPECT_MSG_EQ (cache->LookupInverse (mac1).size (), 2, "Entries sharing a MAC address not found");
+
+  // The MAC address of x changes
+  x->MarkStale (mac2);
+  found = cache->LookupInverse (mac1);
+  NS_TEST_ASSERT_MSG_EQ (found.size (), 1, "Entry found by its former MAC address");
+  NS_TEST_EXPECT_MSG_EQ (found.front (), y, "Wrong entry found");
+  found = cache->LookupInverse (mac2);
+  NS_TEST_ASSERT_MSG_EQ (found.size (), 1, "Entry not found by its new MAC address");
+  NS_TEST_EXPECT_MSG_EQ (found.front (), x, "Wrong entry found");
+
+  cache->Remove (y);
+  NS_TEST_EXPECT_MSG_EQ (cache->LookupInverse (mac1).size (), 0, "Removed entry found");
+  NS_TEST_EXPECT_MSG_EQ (cache->LookupInverse (mac2).size (), 1, "Entry lost on the removal of another one");
+
+  cache->Flush ();
+  NS_TEST_EXPECT_MSG_EQ (cache->LookupInverse (mac2).size (), 0, "Flushed entry found");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check the lookup of the ARP cache entries by MAC address, and
+ * the retransmissions of the entries waiting for a reply.
+ */
+class ArpCacheTestCase : public TestCase
+{
+public:
+  ArpCacheTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Count an ARP request
+   * \param cache the ARP cache
+   * \param destination the address to resolve
+   */
+  void ArpRequest (Ptr<const ArpCache> cache, Ipv4Address destination);
+
+  /**
+   * \brief Count a dropped packet
+   * \param p the packet
+   */
+  void Drop (Ptr<const Packet> p);
+
+  uint32_t m_requests; //!< the number of ARP requests
+  uint32_t m_drops;    //!< the number of dropped packets
+};
+
+ArpCacheTestCase::ArpCacheTestCase ()
+  : TestCase ("ARP cache lookup by MAC address and wait reply timeout"),
+    m_requests (0),
+    m_drops (0)
+{
+}
+
+void
+ArpCacheTestCase::ArpRequest (Ptr<const ArpCache> cache, Ipv4Address destination)
+{
+  NS_TEST_EXPECT_MSG_EQ (destination, Ipv4Address ("10.0.0.3"), "ARP request for an entry not waiting for a reply");
+  m_requests++;
+}
+
+void
+ArpCacheTestCase::Drop (Ptr<const Packet> p)
+{
+  m_drops++;
+}
+
+void
+ArpCacheTestCase::DoRun (void)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  InternetStackHelper internet;
+  internet.SetIpv6StackInstall (false);
+  internet.Install (node);
+  Ptr<SimpleNetDevice> device = AddSimpleDevice (node);
+  Ptr<Ipv4L3Protocol> ipv4 = node->GetObject<Ipv4L3Protocol> ();
+  uint32_t i = ipv4->AddInterface (device);
+  ipv4->AddAddress (i, Ipv4InterfaceAddress (Ipv4Address ("10.0.0.1"), Ipv4Mask ("255.255.255.0")));
+  ipv4->SetUp (i);
+  Ptr<ArpCache> cache = ipv4->GetInterface (i)->GetArpCache ();
+  cache->SetArpRequestCallback (MakeCallback (&ArpCacheTestCase::ArpRequest, this));
+  cache->TraceConnectWithoutContext ("Drop", MakeCallback (&ArpCacheTestCase::Drop, this));
+
+  Address mac1 = Mac48Address ("00:00:00:00:01:01");
+  Address mac2 = Mac48Address ("00:00:00:00:01:02");
+  ArpCache::Ipv4PayloadHeaderPair pending (Create<Packet> (100), Ipv4Header ());
+
+  // x is resolved to mac1, then moves to mac2
+  ArpCache::Entry *x = cache->Add (Ipv4Address ("10.0.0.2"));
+  x->MarkWaitReply (pending);
+  NS_TEST_EXPECT_MSG_EQ (cache->LookupInverse (mac1).size (), 0, "Entry waiting for a reply found");
+  x->MarkAlive (mac1);
+  std::list<ArpCache::Entry *> found = cache->LookupInverse (mac1);
+  NS_TEST_ASSERT_MSG_EQ (found.size (), 1, "Entry not found by its MAC address");
+  NS_TEST_EXPECT_MSG_EQ (found.front (), x, "Wrong entry found");
+  x->SetMacAddress (mac2);
+  NS_TEST_EXPECT_MSG_EQ (cache->LookupInverse (mac1).size (), 0, "Entry found by its former MAC address");
+
+  // y shares mac2
+  ArpCache::Entry *y = cache->Add (Ipv4Address ("10.0.0.4"));
+  y->SetMacAddress (mac2);
+  y->MarkPermanent ();
+  NS_TEST_EXPECT_MSG_EQ (cache->LookupInverse (mac2).size (), 2, "Entries sharing a MAC address not found");
+
+  cache->Remove (x);
+  found = cache->LookupInverse (mac2);
+  NS_TEST_ASSERT_MSG_EQ (found.size (), 1, "Removed entry found");
+  NS_TEST_EXPECT_MSG_EQ (found.front (), y, "Wrong entry found");
+
+  // z waits for a reply which never comes: it is retransmitted MaxRetries
+  // times, then marked dead and its pending packet dropped. The other
+  // entries are left alone.
+  UintegerValue maxRetries;
+  cache->GetAttribute ("MaxRetries", maxRetries);
+  ArpCache::Entry *z = cache->Add (Ipv4Address ("10.0.0.3"));
+  z->MarkWaitReply (pending);
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (z->IsDead (), true, "Entry not dead after the retransmissions");
+  NS_TEST_EXPECT_MSG_EQ (m_requests, maxRetries.Get (), "Unexpected number of ARP requests");
+  NS_TEST_EXPECT_MSG_EQ (m_drops, 1, "Pending packet not dropped");
+  NS_TEST_EXPECT_MSG_EQ (y->IsPermanent (), true, "Permanent entry changed");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief ARP and NDISC caches TestSuite
+ */
+class NeighborCacheTestSuite : public TestSuite
+{
+public:
+  NeighborCacheTestSuite ();
+};
+
+NeighborCacheTestSuite::NeighborCacheTestSuite ()
+  : TestSuite ("neighbor-cache", UNIT)
+{
+  AddTestCase (new NdiscCacheExpiryTestCase (), TestCase::QUICK);
+  AddTestCase (new NdiscCacheMacIndexTestCase (), TestCase::QUICK);
+  AddTestCase (new ArpCacheTestCase (), TestCase::QUICK);
+}
+
+static NeighborCacheTestSuite g_neighborCacheTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,309 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#include <cmath>
+#include "ns3/test.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/tcp-congestion-ops.h"
+#include "ns3/tcp-socket-base.h"
+#include "ns3/tcp-bbr.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("TcpBbrTestSuite");
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Testing the model and the state machine of TcpBbr: the windowed
+ * max filter of the bandwidth, the transitions STARTUP -> DRAIN ->
+ * PROBE_BW -> PROBE_RTT -> PROBE_BW, and the window during a recovery
+ */
+class TcpBbrTestCase : public TestCase
+{
+public:
+  TcpBbrTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Create a TCP socket state, with a RTT of 100 ms measured.
+   * \param cWnd Congestion window (segments).
+   * \returns the socket state.
+   */
+  Ptr<TcpSocketState> CreateTcb (uint32_t cWnd);
+
+  /// The bandwidth filter keeps the maximum over the window
+  void TestMaxBwFilter (void);
+  /// Pacing from the start, and exit of STARTUP when the pipe is full
+  void TestStartupDrain (void);
+  /// PROBE_RTT when the min RTT expires
+  void TestProbeRtt (void);
+  /// Packet conservation during recovery, and restoration of the window
+  void TestRecovery (void);
+
+  /**
+   * \brief Ack one round of data, delivered at the given rate.
+   * \param cong The congestion control.
+   * \param tcb The TCP socket state.
+   * \param bw The delivery rate of the round.
+   */
+  void AckRound (Ptr<TcpBbr> cong, Ptr<TcpSocketState> tcb, DataRate bw);
+
+  /**
+   * \brief Advance the simulation time
+   * \param t the new time
+   */
+  void RunUntil (Time t);
+
+  TcpRateOps::TcpRateConnection m_rc;         //!< Rate information of the connection
+  static const uint32_t SEGMENT_SIZE = 1000;  //!< Segment size
+};
+
+TcpBbrTestCase::TcpBbrTestCase ()
+  : TestCase ("Bbr model and state machine")
+{
+}
+
+Ptr<TcpSocketState>
+TcpBbrTestCase::CreateTcb (uint32_t cWnd)
+{
+  Ptr<TcpSocketState> tcb = CreateObject<TcpSocketState> ();
+  tcb->m_segmentSize = SEGMENT_SIZE;
+  tcb->m_initialCWnd = cWnd;
+  tcb->m_cWnd = cWnd * SEGMENT_SIZE;
+  tcb->m_ssThresh = UINT32_MAX;
+  tcb->m_maxPacingRate = DataRate ("4Gbps");
+  tcb->m_currentPacingRate = tcb->m_maxPacingRate;
+  tcb->m_lastRtt = MilliSeconds (100);
+  tcb->m_minRtt = MilliSeconds (100);
+  m_rc = TcpRateOps::TcpRateConnection ();
+  return tcb;
+}
+
+void
+TcpBbrTestCase::RunUntil (Time t)
+{
+  Simulator::Stop (t - Simulator::Now ());
+  Simulator::Run ();
+}
+
+void
+TcpBbrTestCase::AckRound (Ptr<TcpBbr> cong, Ptr<TcpSocketState> tcb, DataRate bw)
+{
+  // The bandwidth-delay product is delivered in one round
+  uint32_t bytes = static_cast<uint32_t> (bw.GetBitRate () * tcb->m_lastRtt.Get ().GetSeconds () / 8);
+
+  TcpRateOps::TcpRateSample rs;
+  rs.m_priorDelivered = m_rc.m_delivered;
+  rs.m_priorTime = Simulator::Now () - tcb->m_lastRtt.Get ();
+  rs.m_delivered = static_cast<int32_t> (bytes);
+  rs.m_interval = tcb->m_lastRtt;
+  rs.m_deliveryRate = bw;
+  rs.m_ackedSacked = bytes;
+  rs.m_priorInFlight = tcb->m_bytesInFlight;
+
+  m_rc.m_delivered += bytes;
+  m_rc.m_deliveredTime = Simulator::Now ();
+
+  cong->CongControl (tcb, m_rc, rs);
+}
+
+void
+TcpBbrTestCase::TestMaxBwFilter (void)
+{
+  Ptr<TcpBbr> cong = CreateObject<TcpBbr> ();
+
+  cong->UpdateMaxBwFilter (1, DataRate ("10Mbps"));
+  NS_TEST_ASSERT_MSG_EQ (cong->GetMaxBw (), DataRate ("10Mbps"), "Wrong max bandwidth");
+
+  cong->UpdateMaxBwFilter (5, DataRate ("5Mbps"));
+  cong->UpdateMaxBwFilter (11, DataRate ("4Mbps"));
+  NS_TEST_ASSERT_MSG_EQ (cong->GetMaxBw (), DataRate ("10Mbps"),
+                         "The maximum is kept for the whole window");
+
+  // The maximum expires, the best of the following samples is used
+  cong->UpdateMaxBwFilter (12, DataRate ("4Mbps"));
+  NS_TEST_ASSERT_MSG_EQ (cong->GetMaxBw (), DataRate ("5Mbps"), "The maximum did not expire");
+
+  cong->UpdateMaxBwFilter (16, DataRate ("3Mbps"));
+  NS_TEST_ASSERT_MSG_EQ (cong->GetMaxBw (), DataRate ("4Mbps"), "The maximum did not expire");
+
+  // A new maximum replaces everything
+  cong->UpdateMaxBwFilter (17, DataRate ("20Mbps"));
+  NS_TEST_ASSERT_MSG_EQ (cong->GetMaxBw (), DataRate ("20Mbps"), "Wrong max bandwidth");
+}
+
+void
+TcpBbrTestCase::TestStartupDrain (void)
+{
+  Ptr<TcpSocketState> tcb = CreateTcb (10);
+  Ptr<TcpBbr> cong = CreateObject<TcpBbr> ();
+  double highGain = 2 / std::log (2.0);
+
+  cong->Init (tcb);
+  NS_TEST_ASSERT_MSG_EQ (tcb->m_pacing, true, "Pacing should be enabled");
+  NS_TEST_ASSERT_MSG_EQ (cong->m_state, TcpBbr::BBR_STARTUP, "Should start in STARTUP");
+
+  // The initial window is paced at the STARTUP gain over the RTT
+  double expected = highGain * 10 * SEGMENT_SIZE * 8 / 0.1 * 0.99;
+  NS_TEST_ASSERT_MSG_EQ_TOL (tcb->m_currentPacingRate.GetBitRate (), expected, 1,
+                             "Wrong initial pacing rate");
+
+  tcb->m_bytesInFlight = 100 * SEGMENT_SIZE;
+
+  // The bandwidth doubles, then stops growing: STARTUP continues for three
+  // rounds without growth
+  AckRound (cong, tcb, DataRate ("1Mbps"));
+  NS_TEST_ASSERT_MSG_EQ_TOL (tcb->m_currentPacingRate.GetBitRate (), highGain * 1e6 * 0.99, 1,
+                             "Wrong pacing rate in STARTUP");
+  uint32_t cWnd = tcb->m_cWnd;
+  AckRound (cong, tcb, DataRate ("2Mbps"));
+  NS_TEST_ASSERT_MSG_EQ (tcb->m_cWnd.Get (), cWnd + 25000, "The window grows by the acked data");
+  for (uint32_t i = 0; i < 2; ++i)
+    {
+      AckRound (cong, tcb, DataRate ("2Mbps"));
+      NS_TEST_ASSERT_MSG_EQ (cong->m_state, TcpBbr::BBR_STARTUP, "Left STARTUP too early");
+    }
+
+  AckRound (cong, tcb, DataRate ("2Mbps"));
+  NS_TEST_ASSERT_MSG_EQ (cong->m_fullBwReached, true, "The pipe should be full");
+  NS_TEST_ASSERT_MSG_EQ (cong->m_state, TcpBbr::BBR_DRAIN, "Should be in DRAIN");
+  // BDP of 25 segments, plus 3, rounded to even
+  NS_TEST_ASSERT_MSG_EQ (tcb->m_ssThresh.Get (), 28 * SEGMENT_SIZE, "Wrong ssThresh");
+  NS_TEST_ASSERT_MSG_EQ_TOL (tcb->m_currentPacingRate.GetBitRate (), 2e6 / highGain * 0.99, 1,
+                             "Wrong pacing rate in DRAIN");
+
+  // The queue is drained
+  tcb->m_bytesInFlight = 20 * SEGMENT_SIZE;
+  AckRound (cong, tcb, DataRate ("2Mbps"));
+  NS_TEST_ASSERT_MSG_EQ (cong->m_state, TcpBbr::BBR_PROBE_BW, "Should be in PROBE_BW");
+  NS_TEST_ASSERT_MSG_NE (cong->m_pacingGain, 0.75, "PROBE_BW should not start draining");
+  NS_TEST_ASSERT_MSG_EQ (cong->m_cWndGain, 2, "Wrong window gain in PROBE_BW");
+  // Twice the BDP, plus 3, rounded to even (and 2 more in the probing phase)
+  NS_TEST_ASSERT_MSG_LT_OR_EQ (tcb->m_cWnd.Get (), 56 * SEGMENT_SIZE, "The window exceeds the target");
+
+  Simulator::Destroy ();
+}
+
+void
+TcpBbrTestCase::TestProbeRtt (void)
+{
+  Ptr<TcpSocketState> tcb = CreateTcb (10);
+  Ptr<TcpBbr> cong = CreateObject<TcpBbr> ();
+
+  cong->Init (tcb);
+  tcb->m_bytesInFlight = 20 * SEGMENT_SIZE;
+  for (uint32_t i = 0; i < 6; ++i)
+    {
+      AckRound (cong, tcb, DataRate ("2Mbps"));
+    }
+  NS_TEST_ASSERT_MSG_EQ (cong->m_state, TcpBbr::BBR_PROBE_BW, "Should be in PROBE_BW");
+
+  // The min RTT is not refreshed for 10 s: probe it
+  RunUntil (Seconds (10.1));
+  tcb->m_lastRtt = MilliSeconds (120);
+  tcb->m_bytesInFlight = tcb->m_cWnd;
+  AckRound (cong, tcb, DataRate ("2Mbps"));
+  NS_TEST_ASSERT_MSG_EQ (cong->m_state, TcpBbr::BBR_PROBE_RTT, "Should be in PROBE_RTT");
+  NS_TEST_ASSERT_MSG_EQ (cong->m_minRtt, MilliSeconds (120), "The expired min RTT is replaced");
+  NS_TEST_ASSERT_MSG_EQ (tcb->m_cWnd.Get (), 4 * SEGMENT_SIZE, "Wrong window in PROBE_RTT");
+
+  // PROBE_RTT lasts 200 ms (and one round) once the data in flight is at
+  // the minimum
+  tcb->m_bytesInFlight = 4 * SEGMENT_SIZE;
+  tcb->m_lastRtt = MilliSeconds (100);
+  AckRound (cong, tcb, DataRate ("2Mbps"));
+  NS_TEST_ASSERT_MSG_EQ (cong->m_minRtt, MilliSeconds (100), "Wrong min RTT");
+  RunUntil (Seconds (10.2));
+  AckRound (cong, tcb, DataRate ("2Mbps"));
+  NS_TEST_ASSERT_MSG_EQ (cong->m_state, TcpBbr::BBR_PROBE_RTT, "Left PROBE_RTT too early");
+  RunUntil (Seconds (10.31));
+  AckRound (cong, tcb, DataRate ("2Mbps"));
+  NS_TEST_ASSERT_MSG_EQ (cong->m_state, TcpBbr::BBR_PROBE_BW, "Should be back in PROBE_BW");
+  NS_TEST_ASSERT_MSG_EQ (tcb->m_cWnd.Get (), cong->InFlight (tcb, cong->GetMaxBw (), 2),
+                         "The window should be restored to the target");
+  NS_TEST_ASSERT_MSG_EQ (cong->m_minRttStamp, Seconds (10.31), "Wrong min RTT timestamp");
+
+  Simulator::Destroy ();
+}
+
+void
+TcpBbrTestCase::TestRecovery (void)
+{
+  Ptr<TcpSocketState> tcb = CreateTcb (10);
+  Ptr<TcpBbr> cong = CreateObject<TcpBbr> ();
+
+  cong->Init (tcb);
+  tcb->m_bytesInFlight = 20 * SEGMENT_SIZE;
+  for (uint32_t i = 0; i < 3; ++i)
+    {
+      AckRound (cong, tcb, DataRate ("2Mbps"));
+    }
+  uint32_t cWnd = tcb->m_cWnd;
+  uint32_t ssThresh = tcb->m_ssThresh;
+
+  // Losses do not change ssThresh, but the window is saved
+  tcb->m_congState = TcpSocketState::CA_RECOVERY;
+  NS_TEST_ASSERT_MSG_EQ (cong->GetSsThresh (tcb, tcb->m_bytesInFlight), ssThresh,
+                         "ssThresh should not change");
+  NS_TEST_ASSERT_MSG_EQ (cong->m_priorCwnd, cWnd, "The window should be saved");
+
+  // One segment sent per segment delivered
+  TcpRateOps::TcpRateSample rs;
+  rs.m_priorDelivered = m_rc.m_delivered;
+  rs.m_ackedSacked = SEGMENT_SIZE;
+  rs.m_delivered = -1;
+  tcb->m_bytesInFlight = 15 * SEGMENT_SIZE;
+  cong->CongControl (tcb, m_rc, rs);
+  NS_TEST_ASSERT_MSG_EQ (tcb->m_cWnd.Get (), 16 * SEGMENT_SIZE, "Packet conservation not applied");
+
+  // The window is restored at the end of the recovery
+  tcb->m_congState = TcpSocketState::CA_OPEN;
+  cong->CongControl (tcb, m_rc, rs);
+  NS_TEST_ASSERT_MSG_GT_OR_EQ (tcb->m_cWnd.Get (), cWnd, "The window should be restored");
+
+  Simulator::Destroy ();
+}
+
+void
+TcpBbrTestCase::DoRun ()
+{
+  TestMaxBwFilter ();
+  TestStartupDrain ();
+  TestProbeRtt ();
+  TestRecovery ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief TcpBbr TestSuite
+ */
+class TcpBbrTestSuite : public TestSuite
+{
+public:
+  TcpBbrTestSuite () : TestSuite ("tcp-bbr-test", UNIT)
+  {
+    AddTestCase (new TcpBbrTestCase (), TestCase::QUICK);
+  }
+};
+
+static TcpBbrTestSuite g_tcpBbrTest; //!< Static variable for test initialization
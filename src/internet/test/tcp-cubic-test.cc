@@ -0,0 +1,386 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <cmath>
+#include "ns3/test.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/boolean.h"
+#include "ns3/enum.h"
+#include "ns3/tcp-congestion-ops.h"
+#include "ns3/tcp-socket-base.h"
+#include "ns3/tcp-cubic.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("TcpCubicTestSuite");
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Testing the window of TcpCubic in slow start, on losses, along
+ * the cubic curve, with HyStart and after an idle period
+ */
+class TcpCubicTestCase : public TestCase
+{
+public:
+  TcpCubicTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Create a TCP socket state.
+   * \param cWnd Congestion window (segments).
+   * \param ssThresh Slow Start Threshold (segments).
+   * \returns the socket state.
+   */
+  Ptr<TcpSocketState> CreateTcb (uint32_t cWnd, uint32_t ssThresh);
+
+  /// Slow start stops at ssThresh and the spare acks go to congestion avoidance
+  void TestSlowStart (void);
+  /// ssThresh and the maximum window on losses, with fast convergence
+  void TestLoss (void);
+  /// The window reaches the previous maximum after K seconds
+  void TestCubicCurve (void);
+  /// HyStart leaves slow start when the RTT grows
+  void TestHystartDelay (void);
+  /// HyStart leaves slow start on a long train of ACKs
+  void TestHystartAckTrain (void);
+  /// The window does not grow with the time elapsed since the last transmission
+  void TestIdle (void);
+
+  /**
+   * \brief Ack one window worth of segments over an RTT.
+   * \param cong The congestion control.
+   * \param tcb The TCP socket state.
+   */
+  void AckRound (Ptr<TcpCubic> cong, Ptr<TcpSocketState> tcb);
+
+  /**
+   * \brief Ack one segment, measuring the given RTT.
+   * \param cong The congestion control.
+   * \param tcb The TCP socket state.
+   * \param rtt The RTT sample.
+   */
+  void AckSegment (Ptr<TcpCubic> cong, Ptr<TcpSocketState> tcb, Time rtt);
+
+  /**
+   * \brief Check whether slow start has been left.
+   * \param tcb The TCP socket state.
+   * \param left Whether it is expected to be left.
+   */
+  void CheckSlowStartLeft (Ptr<TcpSocketState> tcb, bool left);
+
+  /**
+   * \brief Ack one window worth of segments, sent at the given time.
+   * \param cong The congestion control.
+   * \param tcb The TCP socket state.
+   * \param sent The time of the transmission of the last segment.
+   */
+  void AckWindow (Ptr<TcpCubic> cong, Ptr<TcpSocketState> tcb, Time sent);
+
+  /**
+   * \brief Notify the end of an idle period.
+   * \param cong The congestion control.
+   * \param tcb The TCP socket state.
+   */
+  void TxStart (Ptr<TcpCubic> cong, Ptr<TcpSocketState> tcb);
+
+  /**
+   * \brief Get the window after an idle period.
+   *
+   * After a loss at 1000 segments, one window is acked every 100 ms
+   * during one second; the transfer then restarts at 5 s.
+   *
+   * \param lastSend The time of the last transmission before the idle period.
+   * \param notify Whether the restart is notified with CA_EVENT_TX_START.
+   * \returns the window (segments) one RTT after the restart.
+   */
+  uint32_t GetWindowAfterIdle (Time lastSend, bool notify);
+
+  static const uint32_t SEGMENT_SIZE = 1000; //!< Segment size
+};
+
+TcpCubicTestCase::TcpCubicTestCase ()
+  : TestCase ("Cubic window growth and HyStart")
+{
+}
+
+Ptr<TcpSocketState>
+TcpCubicTestCase::CreateTcb (uint32_t cWnd, uint32_t ssThresh)
+{
+  Ptr<TcpSocketState> tcb = CreateObject<TcpSocketState> ();
+  tcb->m_segmentSize = SEGMENT_SIZE;
+  tcb->m_cWnd = cWnd * SEGMENT_SIZE;
+  tcb->m_ssThresh = ssThresh * SEGMENT_SIZE;
+  return tcb;
+}
+
+void
+TcpCubicTestCase::TestSlowStart (void)
+{
+  Ptr<TcpSocketState> tcb = CreateTcb (10, 15);
+  Ptr<TcpCubic> cong = CreateObject<TcpCubic> ();
+  cong->SetAttribute ("HyStart", BooleanValue (false));
+
+  cong->IncreaseWindow (tcb, 4);
+  NS_TEST_ASSERT_MSG_EQ (tcb->m_cWnd.Get (), 14 * SEGMENT_SIZE,
+                         "Slow start should grow by the segments acked");
+
+  cong->IncreaseWindow (tcb, 4);
+  NS_TEST_ASSERT_MSG_EQ (tcb->m_cWnd.Get (), 15 * SEGMENT_SIZE,
+                         "Slow start should stop at ssThresh");
+  NS_TEST_ASSERT_MSG_EQ (cong->m_cWndCnt, 3,
+                         "The spare segments should be counted in congestion avoidance");
+  NS_TEST_ASSERT_MSG_EQ (cong->m_bicOriginPoint, 15,
+                         "The epoch should start at the current window");
+}
+
+void
+TcpCubicTestCase::TestLoss (void)
+{
+  Ptr<TcpSocketState> tcb = CreateTcb (100, 1000);
+  Ptr<TcpCubic> cong = CreateObject<TcpCubic> ();
+
+  uint32_t ssThresh = cong->GetSsThresh (tcb, tcb->m_cWnd);
+  NS_TEST_ASSERT_MSG_EQ (ssThresh, 70 * SEGMENT_SIZE, "Window should be reduced by Beta");
+  NS_TEST_ASSERT_MSG_EQ (cong->m_lastMaxCwnd, 100, "Wmax should be the window at the loss");
+
+  // Loss before growing back to Wmax: fast convergence lowers Wmax
+  tcb->m_cWnd = 80 * SEGMENT_SIZE;
+  ssThresh = cong->GetSsThresh (tcb, tcb->m_cWnd);
+  NS_TEST_ASSERT_MSG_EQ (ssThresh, 56 * SEGMENT_SIZE, "Window should be reduced by Beta");
+  NS_TEST_ASSERT_MSG_EQ (cong->m_lastMaxCwnd, 68, "Fast convergence should lower Wmax");
+
+  cong->SetAttribute ("FastConvergence", BooleanValue (false));
+  tcb->m_cWnd = 60 * SEGMENT_SIZE;
+  cong->GetSsThresh (tcb, tcb->m_cWnd);
+  NS_TEST_ASSERT_MSG_EQ (cong->m_lastMaxCwnd, 60, "Wmax should be the window at the loss");
+
+  // A timeout forgets everything
+  cong->CongestionStateSet (tcb, TcpSocketState::CA_LOSS);
+  NS_TEST_ASSERT_MSG_EQ (cong->m_lastMaxCwnd, 0, "Wmax should be reset on RTO");
+  NS_TEST_ASSERT_MSG_EQ (cong->m_epochStart, Time::Min (), "Epoch should be reset on RTO");
+}
+
+void
+TcpCubicTestCase::AckRound (Ptr<TcpCubic> cong, Ptr<TcpSocketState> tcb)
+{
+  cong->PktsAcked (tcb, tcb->GetCwndInSegments (), MilliSeconds (100));
+  cong->IncreaseWindow (tcb, tcb->GetCwndInSegments ());
+  Simulator::Schedule (MilliSeconds (100), &TcpCubicTestCase::AckRound, this, cong, tcb);
+}
+
+void
+TcpCubicTestCase::TestCubicCurve (void)
+{
+  // Loss at 100 segments, then one window acked every RTT of 100 ms
+  Ptr<TcpSocketState> tcb = CreateTcb (100, 1000);
+  Ptr<TcpCubic> cong = CreateObject<TcpCubic> ();
+  cong->m_delayMin = MilliSeconds (100);
+  tcb->m_ssThresh = cong->GetSsThresh (tcb, tcb->m_cWnd);
+  tcb->m_cWnd = tcb->m_ssThresh;
+
+  Simulator::Schedule (Seconds (0), &TcpCubicTestCase::AckRound, this, cong, tcb);
+  // K = cbrt ((100 - 70) / 0.4) = 4.22 s
+  Simulator::Stop (Seconds (4.22));
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ_TOL (cong->m_bicK, 4.217, 0.001, "Wrong K");
+  NS_TEST_ASSERT_MSG_EQ_TOL (tcb->GetCwndInSegments (), 100, 2,
+                             "Window should be back to Wmax after K seconds");
+
+  // Plateau around Wmax, then probing beyond it
+  Simulator::Stop (Seconds (1));
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_EQ_TOL (tcb->GetCwndInSegments (), 100, 2,
+                             "Window should grow slowly around Wmax");
+  Simulator::Stop (Seconds (3));
+  Simulator::Run ();
+  // W (8.22 s) = 0.4 * 4^3 + 100
+  NS_TEST_ASSERT_MSG_EQ_TOL (tcb->GetCwndInSegments (), 125, 3,
+                             "Window should probe beyond Wmax");
+  Simulator::Destroy ();
+}
+
+void
+TcpCubicTestCase::AckSegment (Ptr<TcpCubic> cong, Ptr<TcpSocketState> tcb, Time rtt)
+{
+  tcb->m_lastAckedSeq += SEGMENT_SIZE;
+  cong->PktsAcked (tcb, 1, rtt);
+  cong->IncreaseWindow (tcb, 1);
+  // Keep the window constant, to only check the slow start threshold
+  tcb->m_cWnd = 16 * SEGMENT_SIZE;
+}
+
+void
+TcpCubicTestCase::CheckSlowStartLeft (Ptr<TcpSocketState> tcb, bool left)
+{
+  NS_TEST_ASSERT_MSG_EQ ((tcb->m_ssThresh == tcb->m_cWnd), left,
+                         "Wrong slow start exit at " << Simulator::Now ());
+}
+
+void
+TcpCubicTestCase::TestHystartDelay (void)
+{
+  Ptr<TcpSocketState> tcb = CreateTcb (16, 1000);
+  tcb->m_highTxMark = SequenceNumber32 (1000 * SEGMENT_SIZE);
+  Ptr<TcpCubic> cong = CreateObject<TcpCubic> ();
+  cong->SetAttribute ("HyStartDetect", EnumValue (TcpCubic::DELAY));
+
+  // Minimum delay of 100 ms; the threshold is then 12.5 ms
+  AckSegment (cong, tcb, MilliSeconds (100));
+  for (uint32_t i = 0; i < 20; i++)
+    {
+      AckSegment (cong, tcb, MilliSeconds (110));
+    }
+  CheckSlowStartLeft (tcb, false);
+
+  // New round, where the delay grew beyond the threshold
+  tcb->m_highTxMark = SequenceNumber32 (2000 * SEGMENT_SIZE);
+  tcb->m_lastAckedSeq = SequenceNumber32 (1000 * SEGMENT_SIZE);
+  for (uint32_t i = 0; i < 9; i++)
+    {
+      AckSegment (cong, tcb, MilliSeconds (113));
+    }
+  CheckSlowStartLeft (tcb, false);
+  AckSegment (cong, tcb, MilliSeconds (113));
+  CheckSlowStartLeft (tcb, true);
+  NS_TEST_ASSERT_MSG_EQ (cong->m_found, TcpCubic::DELAY, "Wrong HyStart exit");
+  Simulator::Destroy ();
+}
+
+void
+TcpCubicTestCase::TestHystartAckTrain (void)
+{
+  Ptr<TcpSocketState> tcb = CreateTcb (16, 1000);
+  tcb->m_highTxMark = SequenceNumber32 (1000 * SEGMENT_SIZE);
+  Ptr<TcpCubic> cong = CreateObject<TcpCubic> ();
+  cong->SetAttribute ("HyStartDetect", EnumValue (TcpCubic::PACKET_TRAIN));
+
+  // ACKs every 3 ms are not a train
+  for (uint32_t i = 0; i < 40; i++)
+    {
+      Simulator::Schedule (MilliSeconds (3 * i), &TcpCubicTestCase::AckSegment,
+                           this, cong, tcb, MilliSeconds (100));
+    }
+  Simulator::Schedule (MilliSeconds (119), &TcpCubicTestCase::CheckSlowStartLeft,
+                       this, tcb, false);
+  Simulator::Run ();
+
+  // A new round where the ACKs come every ms for more than RTT/2
+  tcb->m_lastAckedSeq = SequenceNumber32 (1001 * SEGMENT_SIZE);
+  tcb->m_highTxMark = SequenceNumber32 (2000 * SEGMENT_SIZE);
+  for (uint32_t i = 0; i < 60; i++)
+    {
+      Simulator::Schedule (MilliSeconds (100 + i), &TcpCubicTestCase::AckSegment,
+                           this, cong, tcb, MilliSeconds (100));
+    }
+  Simulator::Schedule (MilliSeconds (150), &TcpCubicTestCase::CheckSlowStartLeft,
+                       this, tcb, false);
+  Simulator::Schedule (MilliSeconds (152), &TcpCubicTestCase::CheckSlowStartLeft,
+                       this, tcb, true);
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_EQ (cong->m_found, TcpCubic::PACKET_TRAIN, "Wrong HyStart exit");
+  Simulator::Destroy ();
+}
+
+void
+TcpCubicTestCase::AckWindow (Ptr<TcpCubic> cong, Ptr<TcpSocketState> tcb, Time sent)
+{
+  tcb->m_lastSendTime = sent;
+  cong->PktsAcked (tcb, tcb->GetCwndInSegments (), MilliSeconds (100));
+  cong->IncreaseWindow (tcb, tcb->GetCwndInSegments ());
+}
+
+void
+TcpCubicTestCase::TxStart (Ptr<TcpCubic> cong, Ptr<TcpSocketState> tcb)
+{
+  cong->CwndEvent (tcb, TcpSocketState::CA_EVENT_TX_START);
+  tcb->m_lastSendTime = Simulator::Now ();
+}
+
+uint32_t
+TcpCubicTestCase::GetWindowAfterIdle (Time lastSend, bool notify)
+{
+  Ptr<TcpSocketState> tcb = CreateTcb (1000, 10000);
+  Ptr<TcpCubic> cong = CreateObject<TcpCubic> ();
+  tcb->m_ssThresh = cong->GetSsThresh (tcb, tcb->m_cWnd);
+  tcb->m_cWnd = tcb->m_ssThresh;
+
+  for (Time t = Seconds (0); t <= Seconds (1); t += MilliSeconds (100))
+    {
+      Simulator::Schedule (t, &TcpCubicTestCase::AckWindow, this, cong, tcb,
+                           std::min (t, lastSend));
+    }
+  if (notify)
+    {
+      Simulator::Schedule (Seconds (5), &TcpCubicTestCase::TxStart, this, cong, tcb);
+    }
+  Simulator::Schedule (Seconds (5.1), &TcpCubicTestCase::AckWindow, this, cong, tcb,
+                       Seconds (5));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  return tcb->GetCwndInSegments ();
+}
+
+void
+TcpCubicTestCase::TestIdle (void)
+{
+  uint32_t notNotified = GetWindowAfterIdle (Seconds (1), false);
+  uint32_t lastSendAtOne = GetWindowAfterIdle (Seconds (1), true);
+  uint32_t lastSendAtHalf = GetWindowAfterIdle (Seconds (0.5), true);
+  NS_LOG_DEBUG ("Window after idle " << notNotified << " " << lastSendAtOne <<
+                " " << lastSendAtHalf);
+
+  NS_TEST_ASSERT_MSG_LT (lastSendAtOne, notNotified,
+                         "The window should not grow with the idle time");
+  // The ACKs stop at 1 s in both cases: only the time of the last
+  // transmission tells how long the connection was idle
+  NS_TEST_ASSERT_MSG_LT (lastSendAtHalf, lastSendAtOne,
+                         "The idle time should start at the last transmission");
+}
+
+void
+TcpCubicTestCase::DoRun (void)
+{
+  TestSlowStart ();
+  TestLoss ();
+  TestCubicCurve ();
+  TestHystartDelay ();
+  TestHystartAckTrain ();
+  TestIdle ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief TcpCubic TestSuite
+ */
+class TcpCubicTestSuite : public TestSuite
+{
+public:
+  TcpCubicTestSuite () : TestSuite ("tcp-cubic-test", UNIT)
+  {
+    AddTestCase (new TcpCubicTestCase (), TestCase::QUICK);
+  }
+};
+
+static TcpCubicTestSuite g_tcpCubicTest; //!< Static variable for test initialization
@@ -807,17 +807,17 @@ TcpGeneralTest::GetRWnd (SocketWho who)
     }
 }
 
-EventId
-TcpGeneralTest::GetPersistentEvent (SocketWho who)
+bool
+TcpGeneralTest::IsPersistentTimerRunning (SocketWho who)
 {
   if (who == SENDER)
     {
-      return DynamicCast<TcpSocketMsgBase> (m_senderSocket)->m_persistEvent;
+      return DynamicCast<TcpSocketMsgBase> (m_senderSocket)->m_persistTimer.IsRunning ();
     }
   else if (who == RECEIVER)
     {
 
-      return DynamicCast<TcpSocketMsgBase> (m_receiverSocket)->m_persistEvent;
+      return DynamicCast<TcpSocketMsgBase> (m_receiverSocket)->m_persistTimer.IsRunning ();
     }
   else
     {
@@ -1223,15 +1223,18 @@ TcpSocketSmallAcks::SendEmptyPacket (uint8_t flags)
 
   if (flags & TcpHeader::ACK)
     { // If sending an ACK, cancel the delay ACK as well
-      m_delAckEvent.Cancel ();
+      m_delAckTimer.Cancel ();
       m_delAckCount = 0;
     }
-  if (m_retxEvent.IsExpired () && (hasSyn || hasFin) && !isAck )
+  if (m_retxTimer.IsExpired () && (hasSyn || hasFin) && !isAck )
     { // Retransmit SYN / SYN+ACK / FIN / FIN+ACK to guard against lost
       NS_LOG_LOGIC ("Schedule retransmission timeout at time "
                     << Simulator::Now ().GetSeconds () << " to expire at time "
                     << (Simulator::Now () + m_rto.Get ()).GetSeconds ());
-      m_retxEvent = Simulator::Schedule (m_rto, &TcpSocketSmallAcks::SendEmptyPacket, this, flags);
+      m_retxTimer.SetFunction (&TcpSocketSmallAcks::SynFinReTxTimeout, this);
+      m_retxTimer.SetArguments (flags);
+      m_retxSynFin = true;
+      m_retxTimer.Schedule (m_rto);
     }
 
   // send another ACK if bytes remain
@@ -0,0 +1,388 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "tcp-general-test.h"
+#include "tcp-error-model.h"
+#include "ns3/node.h"
+#include "ns3/log.h"
+#include "ns3/uinteger.h"
+#include "ns3/tcp-l4-protocol.h"
+#include "ns3/tcp-gso-tag.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/simulator.h"
+#include "../model/ipv4-end-point.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("TcpGsoTestSuite");
+
+/**
+ * \ingroup internet-tests
+ * \ingroup tests
+ *
+ * \brief An error model that never drops, and records the TCP segments
+ * seen on the wire.
+ */
+class TcpWireObserverErrorModel : public TcpGeneralErrorModel
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  TcpWireObserverErrorModel ()
+    : TcpGeneralErrorModel (),
+      m_dataSegments (0),
+      m_dataBytes (0),
+      m_maxPayload (0)
+  {
+  }
+
+  uint32_t m_dataSegments; //!< Number of data segments seen
+  uint32_t m_dataBytes;    //!< Data bytes seen
+  uint32_t m_maxPayload;   //!< Largest payload seen
+
+protected:
+  virtual bool ShouldDrop (const Ipv4Header &ipHeader, const TcpHeader &tcpHeader,
+                           uint32_t packetSize)
+  {
+    if (packetSize > 0)
+      {
+        ++m_dataSegments;
+        m_dataBytes += packetSize;
+        m_maxPayload = std::max (m_maxPayload, packetSize);
+      }
+    return false;
+  }
+
+private:
+  virtual void DoReset (void) { }
+};
+
+NS_OBJECT_ENSURE_REGISTERED (TcpWireObserverErrorModel);
+
+TypeId
+TcpWireObserverErrorModel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TcpWireObserverErrorModel")
+    .SetParent<TcpGeneralErrorModel> ()
+    .AddConstructor<TcpWireObserverErrorModel> ()
+  ;
+  return tid;
+}
+
+/**
+ * \ingroup internet-tests
+ * \ingroup tests
+ *
+ * \brief Check the TCP segmentation and receive offload
+ *
+ * The sender hands super-segments of up to GsoMaxSegments to IPv4, the
+ * receiver optionally coalesces the wire segments. On the wire, segments
+ * must never exceed the MSS, and all the data must reach the receiver.
+ */
+class TcpGsoTest : public TcpGeneralTest
+{
+public:
+  /**
+   * \brief Constructor
+   * \param desc Test description
+   * \param gsoSegments value of the GsoMaxSegments socket attribute
+   * \param groTimeout value of the GroTimeout TcpL4Protocol attribute
+   */
+  TcpGsoTest (const std::string &desc, uint32_t gsoSegments, Time groTimeout);
+
+protected:
+  virtual void ConfigureEnvironment (void);
+  virtual Ptr<TcpSocketMsgBase> CreateSenderSocket (Ptr<Node> node);
+  virtual Ptr<TcpSocketMsgBase> CreateReceiverSocket (Ptr<Node> node);
+  virtual Ptr<ErrorModel> CreateReceiverErrorModel (void);
+  virtual void Tx (const Ptr<const Packet> p, const TcpHeader&h, SocketWho who);
+  virtual void Rx (const Ptr<const Packet> p, const TcpHeader&h, SocketWho who);
+  virtual void FinalChecks (void);
+
+private:
+  uint32_t m_gsoSegments;   //!< GsoMaxSegments of the sender
+  Time m_groTimeout;        //!< GroTimeout of the receiver node
+  Ptr<TcpWireObserverErrorModel> m_wire; //!< Observer of the wire segments
+  uint32_t m_superTx;       //!< Super-segments sent
+  uint32_t m_coalescedRx;   //!< Coalesced packets received
+  uint32_t m_rxBytes;       //!< Data bytes received by the socket
+};
+
+TcpGsoTest::TcpGsoTest (const std::string &desc, uint32_t gsoSegments, Time groTimeout)
+  : TcpGeneralTest (desc),
+    m_gsoSegments (gsoSegments),
+    m_groTimeout (groTimeout),
+    m_superTx (0),
+    m_coalescedRx (0),
+    m_rxBytes (0)
+{
+}
+
+void
+TcpGsoTest::ConfigureEnvironment (void)
+{
+  TcpGeneralTest::ConfigureEnvironment ();
+  SetAppPktCount (100);
+  SetAppPktSize (500);
+  SetAppPktInterval (Seconds (0));
+  SetPropagationDelay (MilliSeconds (50));
+}
+
+Ptr<TcpSocketMsgBase>
+TcpGsoTest::CreateSenderSocket (Ptr<Node> node)
+{
+  Ptr<TcpSocketMsgBase> socket = TcpGeneralTest::CreateSenderSocket (node);
+  socket->SetAttribute ("GsoMaxSegments", UintegerValue (m_gsoSegments));
+  return socket;
+}
+
+Ptr<TcpSocketMsgBase>
+TcpGsoTest::CreateReceiverSocket (Ptr<Node> node)
+{
+  node->GetObject<TcpL4Protocol> ()->SetAttribute ("GroTimeout", TimeValue (m_groTimeout));
+  return TcpGeneralTest::CreateReceiverSocket (node);
+}
+
+Ptr<ErrorModel>
+TcpGsoTest::CreateReceiverErrorModel (void)
+{
+  m_wire = CreateObject<TcpWireObserverErrorModel> ();
+  return m_wire;
+}
+
+void
+TcpGsoTest::Tx (const Ptr<const Packet> p, const TcpHeader &h, SocketWho who)
+{
+  if (who == SENDER && p->GetSize () > GetSegSize (SENDER))
+    {
+      NS_TEST_ASSERT_MSG_GT (m_gsoSegments, 1, "Super-segment sent without offload");
+      NS_TEST_ASSERT_MSG_LT_OR_EQ (p->GetSize (), m_gsoSegments * GetSegSize (SENDER),
+                                   "Super-segment larger than GsoMaxSegments");
+      ++m_superTx;
+    }
+}
+
+void
+TcpGsoTest::Rx (const Ptr<const Packet> p, const TcpHeader &h, SocketWho who)
+{
+  if (who != RECEIVER)
+    {
+      return;
+    }
+
+  m_rxBytes += p->GetSize ();
+  TcpGsoTag tag;
+  if (p->PeekPacketTag (tag))
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_groTimeout.IsStrictlyPositive (), true,
+                             "Coalesced packet received without offload");
+      NS_TEST_ASSERT_MSG_GT (p->GetSize (), GetSegSize (RECEIVER),
+                             "Coalesced packet not larger than one segment");
+      ++m_coalescedRx;
+    }
+  else
+    {
+      NS_TEST_ASSERT_MSG_LT_OR_EQ (p->GetSize (), GetSegSize (RECEIVER),
+                                   "Segment larger than MSS received without tag");
+    }
+}
+
+void
+TcpGsoTest::FinalChecks (void)
+{
+  NS_TEST_ASSERT_MSG_LT_OR_EQ (m_wire->m_maxPayload, GetSegSize (SENDER),
+                               "Segment larger than MSS seen on the wire");
+  NS_TEST_ASSERT_MSG_EQ (m_wire->m_dataBytes, 100 * 500,
+                         "Wrong amount of data seen on the wire");
+  NS_TEST_ASSERT_MSG_EQ (m_wire->m_dataSegments, 100,
+                         "Wrong number of data segments seen on the wire");
+  NS_TEST_ASSERT_MSG_EQ (m_rxBytes, 100 * 500, "Wrong amount of data received");
+
+  if (m_gsoSegments > 1)
+    {
+      NS_TEST_ASSERT_MSG_GT (m_superTx, 0, "No super-segment sent");
+    }
+  if (m_groTimeout.IsStrictlyPositive ())
+    {
+      NS_TEST_ASSERT_MSG_GT (m_coalescedRx, 0, "No coalesced packet received");
+    }
+}
+
+/**
+ * \ingroup internet-tests
+ * \ingroup tests
+ *
+ * \brief Check which segments the receive offload holds: the first segment
+ * of a burst, the isolated segments and the segments matching no endpoint
+ * are delivered at once.
+ */
+class TcpGroDeliveryTest : public TestCase
+{
+public:
+  TcpGroDeliveryTest ();
+
+private:
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+
+  /**
+   * \brief Pass a data segment to the TCP layer and check the result
+   * \param seq the sequence number of the segment
+   * \param status the expected result
+   * \param delivered the expected number of packets delivered afterwards
+   */
+  void ReceiveSegment (uint32_t seq, IpL4Protocol::RxStatus status, uint32_t delivered);
+
+  /**
+   * \brief Record a packet delivered to the endpoint
+   * \param p the packet
+   * \param header the IPv4 header
+   * \param sport the source port
+   * \param incomingInterface the incoming interface
+   */
+  void Deliver (Ptr<Packet> p, Ipv4Header header, uint16_t sport,
+                Ptr<Ipv4Interface> incomingInterface);
+
+  /// Remove the endpoint of the flow
+  void CloseEndPoint (void);
+
+  Ptr<TcpL4Protocol> m_tcp;       //!< The TCP layer
+  Ipv4EndPoint *m_endPoint;       //!< The endpoint of the flow
+  std::vector<Time> m_times;      //!< Delivery times
+  std::vector<uint32_t> m_sizes;  //!< Sizes of the delivered packets
+};
+
+TcpGroDeliveryTest::TcpGroDeliveryTest ()
+  : TestCase ("Receive offload only holds coalescing segments of known flows"),
+    m_endPoint (0)
+{
+}
+
+void
+TcpGroDeliveryTest::ReceiveSegment (uint32_t seq, IpL4Protocol::RxStatus status, uint32_t delivered)
+{
+  Ptr<Packet> p = Create<Packet> (100);
+  TcpHeader tcpHeader;
+  tcpHeader.SetSourcePort (49153);
+  tcpHeader.SetDestinationPort (50);
+  tcpHeader.SetSequenceNumber (SequenceNumber32 (seq));
+  tcpHeader.SetAckNumber (SequenceNumber32 (1));
+  tcpHeader.SetFlags (TcpHeader::ACK);
+  tcpHeader.SetWindowSize (1000);
+  p->AddHeader (tcpHeader);
+
+  Ipv4Header ipHeader;
+  ipHeader.SetSource (Ipv4Address ("10.0.0.2"));
+  ipHeader.SetDestination (Ipv4Address ("10.0.0.1"));
+  ipHeader.SetProtocol (TcpL4Protocol::PROT_NUMBER);
+  ipHeader.SetPayloadSize (p->GetSize ());
+
+  NS_TEST_EXPECT_MSG_EQ (m_tcp->Receive (p, ipHeader, 0), status,
+                         "Unexpected result for segment " << seq);
+  NS_TEST_EXPECT_MSG_EQ (m_times.size (), delivered,
+                         "Unexpected number of deliveries after segment " << seq);
+}
+
+void
+TcpGroDeliveryTest::Deliver (Ptr<Packet> p, Ipv4Header header, uint16_t sport,
+                             Ptr<Ipv4Interface> incomingInterface)
+{
+  m_times.push_back (Simulator::Now ());
+  m_sizes.push_back (p->GetSize ());
+}
+
+void
+TcpGroDeliveryTest::CloseEndPoint (void)
+{
+  m_tcp->DeAllocate (m_endPoint);
+  m_endPoint = 0;
+}
+
+void
+TcpGroDeliveryTest::DoRun (void)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  InternetStackHelper internet;
+  internet.Install (node);
+  m_tcp = node->GetObject<TcpL4Protocol> ();
+  m_tcp->SetAttribute ("GroTimeout", TimeValue (MilliSeconds (10)));
+  m_endPoint = m_tcp->Allocate (0, Ipv4Address ("10.0.0.1"), 50);
+  m_endPoint->SetRxCallback (MakeCallback (&TcpGroDeliveryTest::Deliver, this));
+
+  // A burst: the first segment is delivered at once, the next ones are
+  // held and coalesced until GroTimeout
+  Simulator::Schedule (Seconds (0), &TcpGroDeliveryTest::ReceiveSegment, this,
+                       1, IpL4Protocol::RX_OK, 1);
+  Simulator::Schedule (Seconds (0), &TcpGroDeliveryTest::ReceiveSegment, this,
+                       101, IpL4Protocol::RX_OK, 1);
+  Simulator::Schedule (Seconds (0), &TcpGroDeliveryTest::ReceiveSegment, this,
+                       201, IpL4Protocol::RX_OK, 1);
+  // An isolated segment is not held
+  Simulator::Schedule (MilliSeconds (30), &TcpGroDeliveryTest::ReceiveSegment, this,
+                       301, IpL4Protocol::RX_OK, 3);
+  // A segment following it, but matching no endpoint anymore, is not held
+  // either, and the failure is reported
+  Simulator::Schedule (MilliSeconds (31), &TcpGroDeliveryTest::CloseEndPoint, this);
+  Simulator::Schedule (MilliSeconds (31), &TcpGroDeliveryTest::ReceiveSegment, this,
+                       401, IpL4Protocol::RX_ENDPOINT_CLOSED, 3);
+  Simulator::Run ();
+
+  // The delivered packets start with the 20-byte TCP header
+  NS_TEST_ASSERT_MSG_EQ (m_times.size (), 3, "Unexpected number of deliveries");
+  NS_TEST_EXPECT_MSG_EQ (m_times[0], Seconds (0), "First segment of the burst delayed");
+  NS_TEST_EXPECT_MSG_EQ (m_sizes[0], 120, "First segment of the burst coalesced");
+  NS_TEST_EXPECT_MSG_EQ (m_times[1], MilliSeconds (10), "Held segments not delivered at GroTimeout");
+  NS_TEST_EXPECT_MSG_EQ (m_sizes[1], 220, "Held segments not coalesced");
+  NS_TEST_EXPECT_MSG_EQ (m_times[2], MilliSeconds (30), "Isolated segment delayed");
+  NS_TEST_EXPECT_MSG_EQ (m_sizes[2], 120, "Isolated segment coalesced");
+}
+
+void
+TcpGroDeliveryTest::DoTeardown (void)
+{
+  m_tcp = 0;
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup internet-tests
+ * \ingroup tests
+ *
+ * \brief TestSuite for the TCP segmentation and receive offload
+ */
+class TcpGsoTestSuite : public TestSuite
+{
+public:
+  TcpGsoTestSuite () : TestSuite ("tcp-gso-test", UNIT)
+  {
+    AddTestCase (new TcpGsoTest ("No offload", 1, Seconds (0)),
+                 TestCase::QUICK);
+    AddTestCase (new TcpGsoTest ("Segmentation offload", 8, Seconds (0)),
+                 TestCase::QUICK);
+    AddTestCase (new TcpGsoTest ("Receive offload", 1, MilliSeconds (1)),
+                 TestCase::QUICK);
+    AddTestCase (new TcpGsoTest ("Segmentation and receive offload", 8, MilliSeconds (1)),
+                 TestCase::QUICK);
+    AddTestCase (new TcpGroDeliveryTest (), TestCase::QUICK);
+  }
+};
+
+static TcpGsoTestSuite g_tcpGsoTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,315 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/tcp-rate-ops.h"
+#include "ns3/tcp-tx-buffer.h"
+#include "ns3/tcp-option-sack.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+#include "ns3/log.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("TcpRateOpsTestSuite");
+
+/**
+ * \ingroup internet-tests
+ * \ingroup tests
+ *
+ * \brief Test of the delivery rate estimation of TcpRateLinux
+ *
+ * Segments of 1000 bytes are sent through a TcpTxBuffer and (s)acked one
+ * RTT (100 ms) later, and the rate samples generated for each ACK are
+ * checked against the values computed by hand.
+ */
+class TcpRateLinuxTestCase : public TestCase
+{
+public:
+  /**
+   * \brief Scenario of the test
+   */
+  enum TestType
+  {
+    STEADY,      //!< One segment every 10 ms
+    APP_LIMITED, //!< The application stops writing for a while
+    SACK,        //!< Part of the window is SACKed before the cumulative ACK
+  };
+
+  /**
+   * \brief Constructor
+   * \param type scenario of the test
+   * \param desc description of the test
+   */
+  TcpRateLinuxTestCase (TestType type, const std::string &desc);
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Send (copy from the buffer) a segment
+   * \param index index of the segment
+   */
+  void Send (uint32_t index);
+
+  /**
+   * \brief Cumulatively acknowledge the segments up to index, and check
+   * the rate sample
+   * \param index index of the last acknowledged segment
+   */
+  void Ack (uint32_t index);
+
+  /**
+   * \brief SACK the segments from first to last (included), and check the
+   * rate sample
+   * \param first index of the first SACKed segment
+   * \param last index of the last SACKed segment
+   */
+  void Sack (uint32_t first, uint32_t last);
+
+  /**
+   * \brief Signal the rate estimator that the application has nothing
+   * more to send
+   */
+  void CheckAppLimited ();
+
+  /**
+   * \brief Add data to the buffer, as the application would
+   * \param bytes size of the data
+   */
+  void Write (uint32_t bytes);
+
+  /**
+   * \brief Check the sample generated for the last ACK
+   * \param delivered bytes delivered by the ACK
+   */
+  void CheckSample (uint32_t delivered);
+
+  TestType m_type;                //!< Scenario of the test
+  Ptr<TcpTxBuffer> m_txBuffer;    //!< Sender buffer
+  Ptr<TcpRateOps> m_rateOps;      //!< Rate estimator under test
+  uint32_t m_segmentSize {1000};  //!< Segment size
+  Time m_minRtt {MilliSeconds (100)}; //!< RTT of the path
+  uint64_t m_lastDelivered {0};   //!< Delivered count at the previous ACK
+  uint32_t m_inFlight {0};        //!< Number of segments in flight
+};
+
+TcpRateLinuxTestCase::TcpRateLinuxTestCase (TestType type, const std::string &desc)
+  : TestCase (desc),
+    m_type (type)
+{
+}
+
+void
+TcpRateLinuxTestCase::DoRun ()
+{
+  m_txBuffer = CreateObject<TcpTxBuffer> ();
+  m_txBuffer->SetHeadSequence (SequenceNumber32 (1));
+  m_txBuffer->SetSegmentSize (m_segmentSize);
+  m_txBuffer->SetDupAckThresh (3);
+  m_rateOps = CreateObject<TcpRateLinux> ();
+
+  if (m_type == STEADY)
+    {
+      m_txBuffer->Add (Create<Packet> (20 * m_segmentSize));
+      // ACKs are scheduled first, so that an ACK and a send at the same
+      // time are processed in this order
+      for (uint32_t i = 0; i < 20; ++i)
+        {
+          Simulator::Schedule (m_minRtt + MilliSeconds (10 * i), &TcpRateLinuxTestCase::Ack, this, i);
+        }
+      for (uint32_t i = 0; i < 20; ++i)
+        {
+          Simulator::Schedule (MilliSeconds (10 * i), &TcpRateLinuxTestCase::Send, this, i);
+        }
+    }
+  else if (m_type == APP_LIMITED)
+    {
+      // Five segments at once, then the application pauses for 50 ms
+      m_txBuffer->Add (Create<Packet> (5 * m_segmentSize));
+      for (uint32_t i = 0; i < 5; ++i)
+        {
+          Simulator::Schedule (Seconds (0), &TcpRateLinuxTestCase::Send, this, i);
+          Simulator::Schedule (m_minRtt, &TcpRateLinuxTestCase::Ack, this, i);
+        }
+      Simulator::Schedule (Seconds (0), &TcpRateLinuxTestCase::CheckAppLimited, this);
+      Simulator::Schedule (MilliSeconds (50), &TcpRateLinuxTestCase::Write, this, 5 * m_segmentSize);
+      for (uint32_t i = 5; i < 10; ++i)
+        {
+          Simulator::Schedule (MilliSeconds (50), &TcpRateLinuxTestCase::Send, this, i);
+          Simulator::Schedule (m_minRtt + MilliSeconds (50), &TcpRateLinuxTestCase::Ack, this, i);
+        }
+    }
+  else
+    {
+      // The first segment is lost, the three following are SACKed, then
+      // its retransmission is cumulatively acknowledged
+      m_txBuffer->Add (Create<Packet> (4 * m_segmentSize));
+      for (uint32_t i = 0; i < 4; ++i)
+        {
+          Simulator::Schedule (Seconds (0), &TcpRateLinuxTestCase::Send, this, i);
+        }
+      Simulator::Schedule (m_minRtt, &TcpRateLinuxTestCase::Sack, this, 1, 3);
+      Simulator::Schedule (m_minRtt, &TcpRateLinuxTestCase::Send, this, 0);
+      Simulator::Schedule (2 * m_minRtt, &TcpRateLinuxTestCase::Ack, this, 3);
+    }
+
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+void
+TcpRateLinuxTestCase::Send (uint32_t index)
+{
+  SequenceNumber32 seq (index * m_segmentSize + 1);
+  TcpTxItem *item = m_txBuffer->CopyFromSequence (m_segmentSize, seq);
+  NS_TEST_ASSERT_MSG_EQ ((item != nullptr), true, "No data to send at " << seq);
+  m_rateOps->SkbSent (item, m_inFlight == 0);
+  ++m_inFlight;
+}
+
+void
+TcpRateLinuxTestCase::Write (uint32_t bytes)
+{
+  m_txBuffer->Add (Create<Packet> (bytes));
+}
+
+void
+TcpRateLinuxTestCase::CheckAppLimited ()
+{
+  m_rateOps->CalculateAppLimited (10 * m_segmentSize, m_inFlight * m_segmentSize,
+                                  m_segmentSize, m_txBuffer->TailSequence (),
+                                  SequenceNumber32 (m_inFlight * m_segmentSize + 1), 0, 0);
+  NS_TEST_ASSERT_MSG_EQ (m_rateOps->GetConnectionRate ().m_appLimited, 5 * m_segmentSize,
+                         "The application-limited point should be the end of the data in flight");
+}
+
+void
+TcpRateLinuxTestCase::Sack (uint32_t first, uint32_t last)
+{
+  Ptr<TcpOptionSack> sack = CreateObject<TcpOptionSack> ();
+  sack->AddSackBlock (TcpOptionSack::SackBlock (SequenceNumber32 (first * m_segmentSize + 1),
+                                                SequenceNumber32 ((last + 1) * m_segmentSize + 1)));
+  m_txBuffer->Update (sack->GetSackList (), MakeCallback (&TcpRateOps::SkbDelivered, m_rateOps));
+  m_inFlight -= last - first + 1;
+  CheckSample ((last - first + 1) * m_segmentSize);
+
+  const TcpRateOps::TcpRateSample &rs = m_rateOps->GenerateSample (0, 0, false, 0, m_minRtt);
+  NS_TEST_ASSERT_MSG_EQ (rs.IsValid (), false,
+                         "A sample without new deliveries has no timing information");
+}
+
+void
+TcpRateLinuxTestCase::Ack (uint32_t index)
+{
+  SequenceNumber32 oldHead = m_txBuffer->HeadSequence ();
+  m_txBuffer->DiscardUpTo (SequenceNumber32 ((index + 1) * m_segmentSize + 1),
+                           MakeCallback (&TcpRateOps::SkbDelivered, m_rateOps));
+  uint32_t delivered = m_rateOps->GetConnectionRate ().m_delivered - m_lastDelivered;
+
+  if (m_type == SACK)
+    {
+      // The SACKed segments must not be counted twice
+      NS_TEST_ASSERT_MSG_EQ (delivered, m_segmentSize,
+                             "Only the retransmitted segment is newly delivered");
+      NS_TEST_ASSERT_MSG_EQ (m_rateOps->GetConnectionRate ().m_delivered, 4 * m_segmentSize,
+                             "Wrong count of delivered bytes");
+    }
+  else
+    {
+      NS_TEST_ASSERT_MSG_EQ (delivered, (index + 1) * m_segmentSize - (oldHead.GetValue () - 1),
+                             "Wrong count of delivered bytes");
+    }
+  m_inFlight -= delivered / m_segmentSize;
+  CheckSample (delivered);
+}
+
+void
+TcpRateLinuxTestCase::CheckSample (uint32_t delivered)
+{
+  uint32_t index = m_rateOps->GetConnectionRate ().m_delivered / m_segmentSize - 1;
+  const TcpRateOps::TcpRateSample &rs = m_rateOps->GenerateSample (delivered, 0, false,
+                                                                   m_inFlight * m_segmentSize,
+                                                                   m_minRtt);
+  m_lastDelivered = m_rateOps->GetConnectionRate ().m_delivered;
+
+  NS_TEST_ASSERT_MSG_EQ (rs.m_ackedSacked, delivered, "Wrong acked/sacked bytes in the sample");
+  NS_TEST_ASSERT_MSG_EQ (rs.IsValid (), true, "The sample should be valid");
+  NS_TEST_ASSERT_MSG_EQ ((rs.m_interval >= m_minRtt), true,
+                         "The sampling interval cannot be shorter than the RTT");
+
+  if (m_type == STEADY)
+    {
+      if (index < 10)
+        {
+          // The first window was sent before any delivery, so the sample
+          // spans from the beginning of the transmission
+          NS_TEST_ASSERT_MSG_EQ (rs.m_interval, m_minRtt + MilliSeconds (10 * index),
+                                 "Wrong sampling interval");
+          NS_TEST_ASSERT_MSG_EQ (rs.m_delivered, static_cast<int32_t> ((index + 1) * m_segmentSize),
+                                 "Wrong delivered bytes in the sample");
+        }
+      else
+        {
+          // One segment every 10 ms
+          NS_TEST_ASSERT_MSG_EQ (rs.m_deliveryRate, DataRate ("800kbps"),
+                                 "Wrong delivery rate");
+          NS_TEST_ASSERT_MSG_EQ (rs.m_interval, m_minRtt, "Wrong sampling interval");
+        }
+      NS_TEST_ASSERT_MSG_EQ (rs.m_isAppLimited, false, "The flow is never application-limited");
+    }
+  else if (m_type == APP_LIMITED)
+    {
+      // Only the segments sent after the pause are application-limited;
+      // the mark is cleared once the data in flight at the pause is delivered
+      NS_TEST_ASSERT_MSG_EQ (rs.m_isAppLimited, (index >= 5), "Wrong application-limited mark");
+      NS_TEST_ASSERT_MSG_EQ (m_rateOps->GetConnectionRate ().m_appLimited,
+                             (index >= 5 ? 0 : 5U * m_segmentSize),
+                             "Wrong application-limited point");
+    }
+  else
+    {
+      // The three SACKed segments are delivered in the first RTT, then the
+      // retransmission in the following one
+      NS_TEST_ASSERT_MSG_EQ (rs.m_interval, m_minRtt, "Wrong sampling interval");
+      NS_TEST_ASSERT_MSG_EQ (rs.m_delivered, static_cast<int32_t> ((index == 2 ? 3 : 1) * m_segmentSize),
+                             "Wrong delivered bytes in the sample");
+    }
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief the TestSuite for the TcpRateLinux test cases
+ */
+class TcpRateOpsTestSuite : public TestSuite
+{
+public:
+  TcpRateOpsTestSuite ()
+    : TestSuite ("tcp-rate-ops", UNIT)
+  {
+    AddTestCase (new TcpRateLinuxTestCase (TcpRateLinuxTestCase::STEADY,
+                                           "Delivery rate of a steady flow"), TestCase::QUICK);
+    AddTestCase (new TcpRateLinuxTestCase (TcpRateLinuxTestCase::APP_LIMITED,
+                                           "Application-limited samples"), TestCase::QUICK);
+    AddTestCase (new TcpRateLinuxTestCase (TcpRateLinuxTestCase::SACK,
+                                           "SACKed segments delivered once"), TestCase::QUICK);
+  }
+};
+
+static TcpRateOpsTestSuite g_tcpRateOpsTestSuite; //!< Static variable for test initialization
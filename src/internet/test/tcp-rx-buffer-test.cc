@@ -44,6 +44,11 @@ private:
    * \brief Test the SACK list update.
    */
   void TestUpdateSACKList ();
+
+  /**
+   * \brief Test the reassembly of a large window of reordered segments.
+   */
+  void TestReordering ();
 };
 
 TcpRxBufferTestCase::TcpRxBufferTestCase ()
@@ -55,6 +60,7 @@ void
 TcpRxBufferTestCase::DoRun ()
 {
   TestUpdateSACKList ();
+  TestReordering ();
 }
 
 void
@@ -338,6 +344,70 @@ TcpRxBufferTestCase::TestUpdateSACKList ()
                          "SACK list should contain no element");
 }
 
+void
+TcpRxBufferTestCase::TestReordering ()
+{
+  const uint32_t segmentSize = 100;
+  const uint32_t segments = 2000;
+  const uint32_t totalSize = segments * segmentSize;
+
+  // The byte at sequence 1 + n is n % 251
+  std::vector<uint8_t> data (totalSize);
+  for (uint32_t n = 0; n < totalSize; ++n)
+    {
+      data[n] = n % 251;
+    }
+
+  TcpRxBuffer rxBuf;
+  TcpHeader h;
+  rxBuf.SetNextRxSequence (SequenceNumber32 (1));
+  rxBuf.SetMaxBufferSize (totalSize);
+
+  // Segments arrive in reverse order, each one with a duplicate that
+  // overlaps the second half of it and the first half of the next one
+  for (uint32_t i = segments; i-- > 1; )
+    {
+      uint32_t offset = i * segmentSize;
+      h.SetSequenceNumber (SequenceNumber32 (1 + offset));
+      rxBuf.Add (Create<Packet> (&data[offset], segmentSize), h);
+
+      if (i < segments - 1)
+        {
+          h.SetSequenceNumber (SequenceNumber32 (1 + offset + segmentSize / 2));
+          rxBuf.Add (Create<Packet> (&data[offset + segmentSize / 2], segmentSize), h);
+        }
+    }
+
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.NextRxSequence (), SequenceNumber32 (1),
+                         "The first segment is missing");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Available (), 0, "Data available with a hole");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Size (), totalSize - segmentSize, "Wrong buffer occupancy");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.GetSackListSize (), 1, "The blocks should be merged");
+
+  h.SetSequenceNumber (SequenceNumber32 (1));
+  rxBuf.Add (Create<Packet> (&data[0], segmentSize), h);
+
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.NextRxSequence (), SequenceNumber32 (1 + totalSize),
+                         "The hole is filled");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Available (), totalSize, "All data should be available");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.GetSackListSize (), 0, "SACK list should be empty");
+
+  // Extract in chunks which do not align with the segments
+  std::vector<uint8_t> out (totalSize);
+  uint32_t extracted = 0;
+  while (rxBuf.Available () > 0)
+    {
+      Ptr<Packet> p = rxBuf.Extract (250);
+      NS_TEST_ASSERT_MSG_NE (p, 0, "Nothing extracted with data available");
+      p->CopyData (&out[extracted], p->GetSize ());
+      extracted += p->GetSize ();
+    }
+
+  NS_TEST_ASSERT_MSG_EQ (extracted, totalSize, "Wrong amount of data extracted");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Size (), 0, "Buffer should be empty");
+  NS_TEST_ASSERT_MSG_EQ ((out == data), true, "Data is not extracted in order");
+}
+
 void
 TcpRxBufferTestCase::DoTeardown ()
 {
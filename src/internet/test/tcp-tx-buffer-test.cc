@@ -49,6 +49,8 @@ private:
   void TestTransmittedBlock ();
   /** \brief Test the generation of the "next" block */
   void TestNextSeg ();
+  /** \brief Test the scoreboard with thousands of segments in flight */
+  void TestLargeWindow ();
 };
 
 TcpTxBufferTestCase::TcpTxBufferTestCase ()
@@ -81,6 +83,8 @@ TcpTxBufferTestCase::DoRun ()
                        &TcpTxBufferTestCase::TestTransmittedBlock, this);
   Simulator::Schedule (Seconds (0.0),
                        &TcpTxBufferTestCase::TestNextSeg, this);
+  Simulator::Schedule (Seconds (0.0),
+                       &TcpTxBufferTestCase::TestLargeWindow, this);
 
   Simulator::Run ();
   Simulator::Destroy ();
@@ -267,6 +271,72 @@ TcpTxBufferTestCase::TestNextSeg ()
                          "Data inside the buffer");
 }
 
+void
+TcpTxBufferTestCase::TestLargeWindow ()
+{
+  const uint32_t segmentSize = 1000;
+  const uint32_t segments = 4000;
+  const uint32_t holeEvery = 10;
+  const uint32_t holes = segments / holeEvery;
+
+  TcpTxBuffer txBuf;
+  SequenceNumber32 head (1);
+  SequenceNumber32 ret;
+  txBuf.SetHeadSequence (head);
+  txBuf.SetSegmentSize (segmentSize);
+  txBuf.SetDupAckThresh (3);
+  txBuf.SetMaxBufferSize (segments * segmentSize);
+
+  txBuf.Add (Create<Packet> (segments * segmentSize));
+  for (uint32_t i = 0; i < segments; ++i)
+    {
+      txBuf.CopyFromSequence (segmentSize, head + (segmentSize * i));
+    }
+
+  // Every holeEvery-th segment is missing, the others are SACKed
+  TcpOptionSack::SackList list;
+  for (uint32_t i = 0; i < segments; i += holeEvery)
+    {
+      list.push_back (TcpOptionSack::SackBlock (head + (segmentSize * (i + 1)),
+                                                head + (segmentSize * (i + holeEvery))));
+    }
+  NS_TEST_ASSERT_MSG_EQ (txBuf.Update (list), true, "Scoreboard not updated");
+
+  NS_TEST_ASSERT_MSG_EQ (txBuf.GetSacked (), (segments - holes) * segmentSize,
+                         "Wrong number of sacked bytes");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.GetLost (), holes * segmentSize,
+                         "Every hole should be marked as lost");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.BytesInFlight (), 0,
+                         "Nothing should be in flight");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.IsLost (head + (segmentSize * holeEvery)), true,
+                         "A hole is not lost");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.IsLost (head + (segmentSize * (holeEvery + 1))), false,
+                         "A sacked segment is lost");
+
+  // The holes are retransmitted in order
+  for (uint32_t i = 0; i < holes; ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ (txBuf.NextSeg (&ret, true), true,
+                             "No NextSeg with holes to retransmit");
+      NS_TEST_ASSERT_MSG_EQ (ret, head + (segmentSize * holeEvery * i),
+                             "NextSeg is not the lowest hole");
+      txBuf.CopyFromSequence (segmentSize, ret);
+    }
+  NS_TEST_ASSERT_MSG_EQ (txBuf.NextSeg (&ret, true), false,
+                         "NextSeg with every hole retransmitted");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.BytesInFlight (), holes * segmentSize,
+                         "Only the retransmissions should be in flight");
+
+  // The first retransmission is acknowledged, with the following SACKed data
+  txBuf.DiscardUpTo (head + (segmentSize * holeEvery));
+  NS_TEST_ASSERT_MSG_EQ (txBuf.GetLost (), (holes - 1) * segmentSize,
+                         "Wrong number of lost bytes after the ACK");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.GetSacked (), (segments - holes - holeEvery + 1) * segmentSize,
+                         "Wrong number of sacked bytes after the ACK");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.GetRetransmitsCount (), (holes - 1) * segmentSize,
+                         "Wrong number of retransmitted bytes after the ACK");
+}
+
 void
 TcpTxBufferTestCase::TestNewBlock ()
 {
@@ -284,7 +354,7 @@ TcpTxBufferTestCase::TestNewBlock ()
   NS_TEST_ASSERT_MSG_EQ (txBuf.BytesInFlight (), 0,
                          "TxBuf miscalculates size of in flight segments");
 
-  Ptr<Packet> ret = txBuf.CopyFromSequence (100, SequenceNumber32 (1));
+  Ptr<Packet> ret = txBuf.CopyFromSequence (100, SequenceNumber32 (1))->GetPacketCopy ();
   NS_TEST_ASSERT_MSG_EQ (ret->GetSize (), 100,
                          "Returned packet has different size than requested");
   NS_TEST_ASSERT_MSG_EQ (txBuf.SizeFromSequence (SequenceNumber32 (1)), 100,
@@ -303,7 +373,7 @@ TcpTxBufferTestCase::TestNewBlock ()
   Ptr<Packet> p2 = Create<Packet> (100);
   txBuf.Add (p2);
 
-  ret = txBuf.CopyFromSequence (50, SequenceNumber32 (101));
+  ret = txBuf.CopyFromSequence (50, SequenceNumber32 (101))->GetPacketCopy ();
   NS_TEST_ASSERT_MSG_EQ (ret->GetSize (), 50,
                          "Returned packet has different size than requested");
   NS_TEST_ASSERT_MSG_EQ (txBuf.SizeFromSequence (SequenceNumber32 (151)), 50,
@@ -315,7 +385,7 @@ TcpTxBufferTestCase::TestNewBlock ()
   Ptr<Packet> p3 = Create<Packet> (100);
   txBuf.Add (p3);
 
-  ret = txBuf.CopyFromSequence (70, SequenceNumber32 (151));
+  ret = txBuf.CopyFromSequence (70, SequenceNumber32 (151))->GetPacketCopy ();
   NS_TEST_ASSERT_MSG_EQ (ret->GetSize (), 70,
                          "Returned packet has different size than requested");
   NS_TEST_ASSERT_MSG_EQ (txBuf.SizeFromSequence (SequenceNumber32 (221)), 80,
@@ -323,7 +393,7 @@ TcpTxBufferTestCase::TestNewBlock ()
   NS_TEST_ASSERT_MSG_EQ (txBuf.BytesInFlight (), 120,
                          "TxBuf miscalculates size of in flight segments");
 
-  ret = txBuf.CopyFromSequence (3000, SequenceNumber32 (221));
+  ret = txBuf.CopyFromSequence (3000, SequenceNumber32 (221))->GetPacketCopy ();
   NS_TEST_ASSERT_MSG_EQ (ret->GetSize (), 80,
                          "Returned packet has different size than requested");
   NS_TEST_ASSERT_MSG_EQ (txBuf.SizeFromSequence (SequenceNumber32 (301)), 0,
@@ -28,6 +28,8 @@
 #include "ns3/names.h"
 #include "ns3/net-device.h"
 #include "ns3/pcap-file-wrapper.h"
+#include "ns3/binary-trace.h"
+#include "ns3/uinteger.h"
 
 #include "trace-helper.h"
 
@@ -35,6 +37,19 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("TraceHelper");
 
+/**
+ * The pcapng file filled by PcapHelperForDevice::EnablePcapNg, if any.
+ * PcapHelper::CreateFile adds an interface to it instead of creating a
+ * pcap file, so that the device helpers need not know about pcapng.
+ */
+static Ptr<PcapNgFile> g_pcapNgFile;
+
+/**
+ * The last wrapper created by PcapHelper::CreateFile for an interface of
+ * the pcapng file being filled.
+ */
+static Ptr<PcapFileWrapper> g_pcapNgWrapper;
+
 PcapHelper::PcapHelper ()
 {
   NS_LOG_FUNCTION_NOARGS ();
@@ -56,6 +71,19 @@ PcapHelper::CreateFile (
   NS_LOG_FUNCTION (filename << filemode << dataLinkType << snapLen << tzCorrection);
 
   Ptr<PcapFileWrapper> file = CreateObject<PcapFileWrapper> ();
+  if (g_pcapNgFile != 0)
+    {
+      if (snapLen == std::numeric_limits<uint32_t>::max ())
+        {
+          UintegerValue captureSize;
+          file->GetAttribute ("CaptureSize", captureSize);
+          snapLen = captureSize.Get ();
+        }
+      file->Attach (g_pcapNgFile, g_pcapNgFile->AddInterface (filename, dataLinkType, snapLen));
+      NS_ABORT_MSG_IF (file->Fail (), "Unable to add interface " << filename << " to the pcapng file");
+      g_pcapNgWrapper = file;
+      return file;
+    }
   file->Open (filename, filemode);
   NS_ABORT_MSG_IF (file->Fail (), "Unable to Open " << filename << " for mode " << filemode);
 
@@ -76,6 +104,17 @@ PcapHelper::CreateFile (
   return file;
 }
 
+Ptr<PcapNgFile>
+PcapHelper::CreatePcapNgFile (std::string filename)
+{
+  NS_LOG_FUNCTION (filename);
+
+  Ptr<PcapNgFile> file = Create<PcapNgFile> ();
+  file->Open (filename);
+  NS_ABORT_MSG_IF (file->Fail (), "Unable to Open " << filename);
+  return file;
+}
+
 std::string
 PcapHelper::GetFilenameFromDevice (std::string prefix, Ptr<NetDevice> device, bool useObjectNames)
 {
@@ -83,8 +122,16 @@ PcapHelper::GetFilenameFromDevice (std::string prefix, Ptr<NetDevice> device, bo
   NS_ABORT_MSG_UNLESS (prefix.size (), "Empty prefix string");
 
   std::ostringstream oss;
-  oss << prefix << "-";
+  oss << prefix << "-" << GetInterfaceNameFromDevice (device, useObjectNames) << ".pcap";
+  return oss.str ();
+}
 
+std::string
+PcapHelper::GetInterfaceNameFromDevice (Ptr<NetDevice> device, bool useObjectNames)
+{
+  NS_LOG_FUNCTION (device << useObjectNames);
+
+  std::ostringstream oss;
   std::string nodename;
   std::string devicename;
 
@@ -116,8 +163,6 @@ PcapHelper::GetFilenameFromDevice (std::string prefix, Ptr<NetDevice> device, bo
       oss << device->GetIfIndex ();
     }
 
-  oss << ".pcap";
-
   return oss.str ();
 }
 
@@ -177,6 +222,13 @@ PcapHelper::SinkWithHeader (Ptr<PcapFileWrapper> file, const Header &header, Ptr
   file->Write (Simulator::Now (), header, p);
 }
 
+void
+PcapHelper::DropSink (Ptr<PcapFileWrapper> file, std::string reason, Ptr<const Packet> p)
+{
+  NS_LOG_FUNCTION (file << reason << p);
+  file->Write (Simulator::Now (), p, reason);
+}
+
 AsciiTraceHelper::AsciiTraceHelper ()
 {
   NS_LOG_FUNCTION_NOARGS ();
@@ -208,6 +260,13 @@ AsciiTraceHelper::CreateFileStream (std::string filename, std::ios::openmode fil
   return StreamWrapper;
 }
 
+Ptr<OutputStreamWrapper>
+AsciiTraceHelper::CreateBinaryFileStream (std::string filename, bool packets)
+{
+  NS_LOG_FUNCTION (filename << packets);
+  return Create<OutputStreamWrapper> (new BinaryTraceWriter (filename, packets));
+}
+
 std::string
 AsciiTraceHelper::GetFilenameFromDevice (std::string prefix, Ptr<NetDevice> device, bool useObjectNames)
 {
@@ -310,6 +369,12 @@ void
 AsciiTraceHelper::DefaultEnqueueSinkWithoutContext (Ptr<OutputStreamWrapper> stream, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
+  BinaryTraceWriter *writer = stream->GetBinaryTraceWriter ();
+  if (writer != 0)
+    {
+      writer->Write (BinaryTraceWriter::ENQUEUE, std::string (), p);
+      return;
+    }
   *stream->GetStream () << "+ " << Simulator::Now ().GetSeconds () << " " << *p << std::endl;
 }
 
@@ -317,6 +382,12 @@ void
 AsciiTraceHelper::DefaultEnqueueSinkWithContext (Ptr<OutputStreamWrapper> stream, std::string context, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
+  BinaryTraceWriter *writer = stream->GetBinaryTraceWriter ();
+  if (writer != 0)
+    {
+      writer->Write (BinaryTraceWriter::ENQUEUE, context, p);
+      return;
+    }
   *stream->GetStream () << "+ " << Simulator::Now ().GetSeconds () << " " << context << " " << *p << std::endl;
 }
 
@@ -336,6 +407,12 @@ void
 AsciiTraceHelper::DefaultDropSinkWithoutContext (Ptr<OutputStreamWrapper> stream, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
+  BinaryTraceWriter *writer = stream->GetBinaryTraceWriter ();
+  if (writer != 0)
+    {
+      writer->Write (BinaryTraceWriter::DROP, std::string (), p);
+      return;
+    }
   *stream->GetStream () << "d " << Simulator::Now ().GetSeconds () << " " << *p << std::endl;
 }
 
@@ -343,6 +420,12 @@ void
 AsciiTraceHelper::DefaultDropSinkWithContext (Ptr<OutputStreamWrapper> stream, std::string context, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
+  BinaryTraceWriter *writer = stream->GetBinaryTraceWriter ();
+  if (writer != 0)
+    {
+      writer->Write (BinaryTraceWriter::DROP, context, p);
+      return;
+    }
   *stream->GetStream () << "d " << Simulator::Now ().GetSeconds () << " " << context << " " << *p << std::endl;
 }
 
@@ -363,6 +446,12 @@ void
 AsciiTraceHelper::DefaultDequeueSinkWithoutContext (Ptr<OutputStreamWrapper> stream, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
+  BinaryTraceWriter *writer = stream->GetBinaryTraceWriter ();
+  if (writer != 0)
+    {
+      writer->Write (BinaryTraceWriter::DEQUEUE, std::string (), p);
+      return;
+    }
   *stream->GetStream () << "- " << Simulator::Now ().GetSeconds () << " " << *p << std::endl;
 }
 
@@ -370,6 +459,12 @@ void
 AsciiTraceHelper::DefaultDequeueSinkWithContext (Ptr<OutputStreamWrapper> stream, std::string context, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
+  BinaryTraceWriter *writer = stream->GetBinaryTraceWriter ();
+  if (writer != 0)
+    {
+      writer->Write (BinaryTraceWriter::DEQUEUE, context, p);
+      return;
+    }
   *stream->GetStream () << "- " << Simulator::Now ().GetSeconds () << " " << context << " " << *p << std::endl;
 }
 
@@ -387,6 +482,12 @@ void
 AsciiTraceHelper::DefaultReceiveSinkWithoutContext (Ptr<OutputStreamWrapper> stream, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
+  BinaryTraceWriter *writer = stream->GetBinaryTraceWriter ();
+  if (writer != 0)
+    {
+      writer->Write (BinaryTraceWriter::RECEIVE, std::string (), p);
+      return;
+    }
   *stream->GetStream () << "r " << Simulator::Now ().GetSeconds () << " " << *p << std::endl;
 }
 
@@ -394,6 +495,12 @@ void
 AsciiTraceHelper::DefaultReceiveSinkWithContext (Ptr<OutputStreamWrapper> stream, std::string context, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
+  BinaryTraceWriter *writer = stream->GetBinaryTraceWriter ();
+  if (writer != 0)
+    {
+      writer->Write (BinaryTraceWriter::RECEIVE, context, p);
+      return;
+    }
   *stream->GetStream () << "r " << Simulator::Now ().GetSeconds () << " " << context << " " << *p << std::endl;
 }
 
@@ -441,6 +548,97 @@ PcapHelperForDevice::EnablePcapAll (std::string prefix, bool promiscuous)
   EnablePcap (prefix, NodeContainer::GetGlobal (), promiscuous);
 }
 
+void
+PcapHelperForDevice::EnablePcapNg (std::string prefix, NodeContainer n, bool promiscuous, bool drops)
+{
+  PcapHelper pcapHelper;
+  for (NodeContainer::Iterator i = n.Begin (); i != n.End (); ++i)
+    {
+      Ptr<Node> node = *i;
+      std::ostringstream oss;
+      oss << prefix << "-";
+      std::string nodename = Names::FindName (node);
+      if (nodename.size ())
+        {
+          oss << nodename;
+        }
+      else
+        {
+          oss << node->GetId ();
+        }
+      oss << ".pcapng";
+
+      NetDeviceContainer devs;
+      for (uint32_t j = 0; j < node->GetNDevices (); ++j)
+        {
+          devs.Add (node->GetDevice (j));
+        }
+      EnablePcapNgImpl (pcapHelper.CreatePcapNgFile (oss.str ()), devs, promiscuous, drops);
+    }
+}
+
+void
+PcapHelperForDevice::EnablePcapNg (std::string filename, NetDeviceContainer d, bool promiscuous, bool drops)
+{
+  PcapHelper pcapHelper;
+  EnablePcapNgImpl (pcapHelper.CreatePcapNgFile (filename), d, promiscuous, drops);
+}
+
+void
+PcapHelperForDevice::EnablePcapNgAll (std::string filename, bool promiscuous, bool drops)
+{
+  NodeContainer n = NodeContainer::GetGlobal ();
+  NetDeviceContainer devs;
+  for (NodeContainer::Iterator i = n.Begin (); i != n.End (); ++i)
+    {
+      Ptr<Node> node = *i;
+      for (uint32_t j = 0; j < node->GetNDevices (); ++j)
+        {
+          devs.Add (node->GetDevice (j));
+        }
+    }
+  EnablePcapNg (filename, devs, promiscuous, drops);
+}
+
+void
+PcapHelperForDevice::EnablePcapNgImpl (Ptr<PcapNgFile> file, NetDeviceContainer d, bool promiscuous, bool drops)
+{
+  PcapHelper pcapHelper;
+
+  //
+  // The device helpers create the pcap file of a device through
+  // PcapHelper::CreateFile, which adds an interface to the pcapng file
+  // while it is set.  The interfaces are named after the devices.
+  //
+  g_pcapNgFile = file;
+  for (NetDeviceContainer::Iterator i = d.Begin (); i != d.End (); ++i)
+    {
+      Ptr<NetDevice> dev = *i;
+      g_pcapNgWrapper = 0;
+      EnablePcapInternal (pcapHelper.GetInterfaceNameFromDevice (dev), dev, promiscuous, true);
+      if (drops && g_pcapNgWrapper != 0)
+        {
+          EnablePcapDropsInternal (dev, g_pcapNgWrapper);
+        }
+    }
+  g_pcapNgFile = 0;
+  g_pcapNgWrapper = 0;
+}
+
+void
+PcapHelperForDevice::EnablePcapDropsInternal (Ptr<NetDevice> nd, Ptr<PcapFileWrapper> file)
+{
+  PcapHelper pcapHelper;
+  if (!pcapHelper.HookDropSink<NetDevice> (nd, "MacTxDrop", file))
+    {
+      NS_LOG_WARN ("PcapHelperForDevice::EnablePcapDropsInternal(): Device " << nd << " has no MacTxDrop trace source");
+    }
+  if (!pcapHelper.HookDropSink<NetDevice> (nd, "PhyRxDrop", file))
+    {
+      NS_LOG_WARN ("PcapHelperForDevice::EnablePcapDropsInternal(): Device " << nd << " has no PhyRxDrop trace source");
+    }
+}
+
 void 
 PcapHelperForDevice::EnablePcap (std::string prefix, uint32_t nodeid, uint32_t deviceid, bool promiscuous)
 {
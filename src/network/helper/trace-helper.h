@@ -81,6 +81,16 @@ public:
    */
   std::string GetFilenameFromDevice (std::string prefix, Ptr<NetDevice> device, bool useObjectNames = true);
 
+  /**
+   * @brief Let the pcap helper figure out a reasonable name for a device,
+   * of the form <node>-<device>.
+   *
+   * @param device NetDevice
+   * @param useObjectNames use node and device names instead of indexes
+   * @returns interface name
+   */
+  std::string GetInterfaceNameFromDevice (Ptr<NetDevice> device, bool useObjectNames = true);
+
   /**
    * @brief Let the pcap helper figure out a reasonable filename to use for the
    * pcap file associated with a node.
@@ -96,6 +106,11 @@ public:
 
   /**
    * @brief Create and initialize a pcap file.
+   *
+   * When called while a device helper enables pcapng tracing (see
+   * PcapHelperForDevice::EnablePcapNg), no pcap file is created: the
+   * returned wrapper writes the packets to a new interface, named after
+   * the filename, of the pcapng file being filled.
    * 
    * @param filename file name
    * @param filemode file mode
@@ -109,6 +124,15 @@ public:
                                    DataLinkType dataLinkType,
                                    uint32_t snapLen = std::numeric_limits<uint32_t>::max (),
                                    int32_t tzCorrection = 0);
+
+  /**
+   * @brief Create a pcapng file, which can hold the packets of many interfaces.
+   *
+   * @param filename file name
+   * @returns a smart pointer to the pcapng file
+   */
+  Ptr<PcapNgFile> CreatePcapNgFile (std::string filename);
+
   /**
    * @brief Hook a trace source to the default trace sink
    * 
@@ -118,6 +142,19 @@ public:
    */
   template <typename T> void HookDefaultSink (Ptr<T> object, std::string traceName, Ptr<PcapFileWrapper> file);
 
+  /**
+   * @brief Hook a packet drop trace source to the drop trace sink
+   *
+   * The packets are written with the trace source name as comment, when
+   * the file is attached to a pcapng file.
+   *
+   * @param object object
+   * @param traceName trace source name
+   * @param file file wrapper
+   * @returns true if the trace source was hooked
+   */
+  template <typename T> bool HookDropSink (Ptr<T> object, std::string traceName, Ptr<PcapFileWrapper> file);
+
 private:
   /**
    * The basic default trace sink.
@@ -141,6 +178,15 @@ private:
    * @see DefaultSink
    */
   static void SinkWithHeader (Ptr<PcapFileWrapper> file, const Header& header, Ptr<const Packet> p);
+
+  /**
+   * The packet drop trace sink.
+   *
+   * @param file the file to write to
+   * @param reason the drop reason, written as the packet comment
+   * @param p the packet to write
+   */
+  static void DropSink (Ptr<PcapFileWrapper> file, std::string reason, Ptr<const Packet> p);
 };
 
 template <typename T> void
@@ -151,6 +197,12 @@ PcapHelper::HookDefaultSink (Ptr<T> object, std::string tracename, Ptr<PcapFileW
   NS_ASSERT_MSG (result == true, "PcapHelper::HookDefaultSink():  Unable to hook \"" << tracename << "\"");
 }
 
+template <typename T> bool
+PcapHelper::HookDropSink (Ptr<T> object, std::string tracename, Ptr<PcapFileWrapper> file)
+{
+  return object->TraceConnectWithoutContext (tracename.c_str (), MakeBoundCallback (&DropSink, file, tracename));
+}
+
 /**
  * \brief Manage ASCII trace files for device models
  *
@@ -222,6 +274,23 @@ public:
   Ptr<OutputStreamWrapper> CreateFileStream (std::string filename, 
                                              std::ios::openmode filemode = std::ios::out);
 
+  /**
+   * @brief Create and initialize an output stream object writing a binary
+   * trace file.
+   *
+   * The stream object can be used everywhere a stream object returned by
+   * CreateFileStream can.  The default trace sinks write a compact binary
+   * record per event instead of a line of text, and the text written by the
+   * other trace sinks is stored as is (see BinaryTraceWriter).  The file
+   * is decoded back to the ascii trace format by BinaryTraceReader.
+   *
+   * @param filename file name
+   * @param packets whether the packets are stored along with the records,
+   * so that the ascii trace can be reproduced exactly
+   * @returns a smart pointer to the output stream
+   */
+  Ptr<OutputStreamWrapper> CreateBinaryFileStream (std::string filename, bool packets = false);
+
   /**
    * @brief Hook a trace source to the default enqueue operation trace sink that
    * does not accept nor log a trace context.
@@ -572,6 +641,20 @@ public:
    */
   virtual void EnablePcapInternal (std::string prefix, Ptr<NetDevice> nd, bool promiscuous, bool explicitFilename) = 0;
 
+  /**
+   * @brief Write the packets dropped by the indicated net device to the
+   * given pcap file.
+   *
+   * The default implementation hooks the MacTxDrop and PhyRxDrop trace
+   * sources of the device, and logs a warning for each one the device
+   * does not provide.  Helpers of devices whose drop trace sources live
+   * on other objects override this method.
+   *
+   * @param nd Net device for which you want to capture the drops.
+   * @param file the pcap file, attached to a pcapng file
+   */
+  virtual void EnablePcapDropsInternal (Ptr<NetDevice> nd, Ptr<PcapFileWrapper> file);
+
   /**
    * @brief Enable pcap output the indicated net device.
    *
@@ -632,6 +715,54 @@ public:
    * @param promiscuous If true capture all possible packets available at the device.
    */
   void EnablePcapAll (std::string prefix, bool promiscuous = false);
+
+  /**
+   * @brief Enable pcapng output on each device (which is of the appropriate
+   * type) in the nodes provided in the container, in one pcapng file per node.
+   *
+   * The files are named <prefix>-<node>.pcapng and hold one interface per
+   * device of the node.
+   *
+   * @param prefix Filename prefix to use for pcapng files.
+   * @param n container of nodes.
+   * @param promiscuous If true capture all possible packets available at the device.
+   * @param drops If true also capture the packets dropped by the devices
+   */
+  void EnablePcapNg (std::string prefix, NodeContainer n, bool promiscuous = false, bool drops = false);
+
+  /**
+   * @brief Enable pcapng output on each device in the container which is of
+   * the appropriate type, in a single pcapng file.
+   *
+   * @param filename Name of the pcapng file.
+   * @param d container of devices.
+   * @param promiscuous If true capture all possible packets available at the device.
+   * @param drops If true also capture the packets dropped by the devices
+   */
+  void EnablePcapNg (std::string filename, NetDeviceContainer d, bool promiscuous = false, bool drops = false);
+
+  /**
+   * @brief Enable pcapng output on each device (which is of the appropriate
+   * type) in the set of all nodes created in the simulation, in a single
+   * pcapng file.
+   *
+   * @param filename Name of the pcapng file.
+   * @param promiscuous If true capture all possible packets available at the device.
+   * @param drops If true also capture the packets dropped by the devices
+   */
+  void EnablePcapNgAll (std::string filename, bool promiscuous = false, bool drops = false);
+
+private:
+  /**
+   * @brief Enable pcapng output on the devices in the container which are
+   * of the appropriate type, in the given pcapng file.
+   *
+   * @param file the pcapng file
+   * @param d container of devices.
+   * @param promiscuous If true capture all possible packets available at the device.
+   * @param drops If true also capture the packets dropped by the devices
+   */
+  void EnablePcapNgImpl (Ptr<PcapNgFile> file, NetDeviceContainer d, bool promiscuous, bool drops);
 };
 
 /**
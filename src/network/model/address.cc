@@ -20,6 +20,7 @@
 
 #include "ns3/assert.h"
 #include "ns3/log.h"
+#include "ns3/hash.h"
 #include "address.h"
 #include <cstring>
 #include <iostream>
@@ -284,6 +285,13 @@ std::istream& operator>> (std::istream& is, Address & address)
   return is;
 }
 
+size_t
+AddressHash::operator() (Address const &x) const
+{
+  uint8_t buffer[Address::MAX_SIZE];
+  uint32_t len = x.CopyTo (buffer);
+  return Hash32 (reinterpret_cast<const char *> (buffer), len);
+}
 
 
 } // namespace ns3
@@ -283,6 +283,25 @@ bool operator < (const Address &a, const Address &b);
 std::ostream& operator<< (std::ostream& os, const Address & address);
 std::istream& operator>> (std::istream& is, Address & address);
 
+/**
+ * \ingroup address
+ *
+ * \brief Class providing an hash for addresses
+ *
+ * Only the address value is hashed, since two addresses of different
+ * types can compare equal when one of the types is zero.
+ */
+class AddressHash
+{
+public:
+  /**
+   * Returns the hash of the address
+   * \param x the address
+   * \return the hash
+   */
+  size_t operator() (Address const &x) const;
+};
+
 
 } // namespace ns3
 
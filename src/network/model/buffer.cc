@@ -51,15 +51,16 @@ NS_LOG_COMPONENT_DEFINE ("Buffer");
 
 
 uint32_t Buffer::g_recommendedStart = 0;
+struct Buffer::AllocationStats Buffer::g_allocationStats;
 #ifdef BUFFER_FREE_LIST
 /* The following macros are pretty evil but they are needed to allow us to
  * keep track of 3 possible states for the g_freeList variable:
  *  - uninitialized means that no one has created a buffer yet
- *    so no one has created the associated free list (it is created
+ *    so no one has created the associated free lists (they are created
  *    on-demand when the first buffer is created)
- *  - initialized means that the free list exists and is valid
+ *  - initialized means that the free lists exist and are valid
  *  - destroyed means that the static destructors of this compilation unit
- *    have run so, the free list has been cleared from its content
+ *    have run so, the free lists have been cleared from their content
  * The key is that in destroyed state, we are careful not re-create it
  * which is a typical weakness of lazy evaluation schemes which use 
  * '0' as a special value to indicate both un-initialized and destroyed.
@@ -75,7 +76,6 @@ uint32_t Buffer::g_recommendedStart = 0;
 #define IS_INITIALIZED(x) (!IS_UNINITIALIZED (x) && !IS_DESTROYED (x))
 #define DESTROYED ((Buffer::FreeList*)MAGIC_DESTROYED)
 #define UNINITIALIZED ((Buffer::FreeList*)0)
-uint32_t Buffer::g_maxSize = 0;
 Buffer::FreeList *Buffer::g_freeList = 0;
 struct Buffer::LocalStaticDestructor Buffer::g_localStaticDestructor;
 
@@ -84,12 +84,15 @@ Buffer::LocalStaticDestructor::~LocalStaticDestructor(void)
   NS_LOG_FUNCTION (this);
   if (IS_INITIALIZED (g_freeList))
     {
-      for (Buffer::FreeList::iterator i = g_freeList->begin ();
-           i != g_freeList->end (); i++)
+      for (uint32_t c = 0; c < BUFFER_SIZE_CLASSES; c++)
         {
-          Buffer::Deallocate (*i);
+          for (Buffer::FreeList::iterator i = g_freeList[c].begin ();
+               i != g_freeList[c].end (); i++)
+            {
+              Buffer::Deallocate (*i);
+            }
         }
-      delete g_freeList;
+      delete [] g_freeList;
       g_freeList = DESTROYED;
     }
 }
@@ -100,18 +103,20 @@ Buffer::Recycle (struct Buffer::Data *data)
   NS_LOG_FUNCTION (data);
   NS_ASSERT (data->m_count == 0);
   NS_ASSERT (!IS_UNINITIALIZED (g_freeList));
-  g_maxSize = std::max (g_maxSize, data->m_size);
-  /* feed into free list */
-  if (data->m_size < g_maxSize ||
+  uint32_t sizeClass = GetSizeClass (data->m_size);
+  /* feed into the free list of its size class, unless the storage
+   * was allocated with a size which does not match any class. */
+  if (sizeClass == BUFFER_SIZE_CLASSES ||
+      data->m_size != GetSizeClassSize (sizeClass) ||
       IS_DESTROYED (g_freeList) ||
-      g_freeList->size () > 1000)
+      g_freeList[sizeClass].size () > 1000)
     {
       Buffer::Deallocate (data);
     }
   else
     {
       NS_ASSERT (IS_INITIALIZED (g_freeList));
-      g_freeList->push_back (data);
+      g_freeList[sizeClass].push_back (data);
     }
 }
 
@@ -119,25 +124,32 @@ Buffer::Data *
 Buffer::Create (uint32_t dataSize)
 {
   NS_LOG_FUNCTION (dataSize);
-  /* try to find a buffer correctly sized. */
+  uint32_t sizeClass = GetSizeClass (dataSize);
   if (IS_UNINITIALIZED (g_freeList))
     {
-      g_freeList = new Buffer::FreeList ();
+      g_freeList = new Buffer::FreeList [BUFFER_SIZE_CLASSES];
     }
   else if (IS_INITIALIZED (g_freeList))
     {
-      while (!g_freeList->empty ()) 
+      /* any buffer of the requested class or of a larger one is
+       * big enough. */
+      for (uint32_t c = sizeClass; c < BUFFER_SIZE_CLASSES; c++)
         {
-          struct Buffer::Data *data = g_freeList->back ();
-          g_freeList->pop_back ();
-          if (data->m_size >= dataSize) 
+          if (!g_freeList[c].empty ())
             {
+              struct Buffer::Data *data = g_freeList[c].back ();
+              g_freeList[c].pop_back ();
+              NS_ASSERT (data->m_size >= dataSize);
               data->m_count = 1;
+              g_allocationStats.hits++;
               return data;
             }
-          Buffer::Deallocate (data);
         }
     }
+  if (sizeClass < BUFFER_SIZE_CLASSES)
+    {
+      dataSize = GetSizeClassSize (sizeClass);
+    }
   struct Buffer::Data *data = Buffer::Allocate (dataSize);
   NS_ASSERT (data->m_count == 1);
   return data;
@@ -159,6 +171,24 @@ Buffer::Create (uint32_t size)
 }
 #endif /* BUFFER_FREE_LIST */
 
+uint32_t
+Buffer::GetSizeClass (uint32_t size)
+{
+  uint32_t sizeClass = 0;
+  while (sizeClass < BUFFER_SIZE_CLASSES &&
+         GetSizeClassSize (sizeClass) < size)
+    {
+      sizeClass++;
+    }
+  return sizeClass;
+}
+
+uint32_t
+Buffer::GetSizeClassSize (uint32_t sizeClass)
+{
+  return BUFFER_MIN_CLASS_SIZE << sizeClass;
+}
+
 struct Buffer::Data *
 Buffer::Allocate (uint32_t reqSize)
 {
@@ -173,6 +203,10 @@ Buffer::Allocate (uint32_t reqSize)
   struct Buffer::Data *data = reinterpret_cast<struct Buffer::Data*>(b);
   data->m_size = reqSize;
   data->m_count = 1;
+  g_allocationStats.misses++;
+  g_allocationStats.currentBytes += reqSize;
+  g_allocationStats.peakBytes = std::max (g_allocationStats.peakBytes,
+                                          g_allocationStats.currentBytes);
   return data;
 }
 
@@ -181,10 +215,18 @@ Buffer::Deallocate (struct Buffer::Data *data)
 {
   NS_LOG_FUNCTION (data);
   NS_ASSERT (data->m_count == 0);
+  g_allocationStats.currentBytes -= data->m_size;
   uint8_t *buf = reinterpret_cast<uint8_t *> (data);
   delete [] buf;
 }
 
+struct Buffer::AllocationStats
+Buffer::GetAllocationStats (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  return g_allocationStats;
+}
+
 Buffer::Buffer ()
 {
   NS_LOG_FUNCTION (this);
@@ -244,7 +286,7 @@ void
 Buffer::Initialize (uint32_t zeroSize)
 {
   NS_LOG_FUNCTION (this << zeroSize);
-  m_data = Buffer::Create (0);
+  m_data = Buffer::Create (g_recommendedStart);
   m_start = std::min (m_data->m_size, g_recommendedStart);
   m_maxZeroAreaStart = m_start;
   m_zeroAreaStart = m_start;
@@ -953,7 +995,7 @@ void
 Buffer::Iterator::Write (uint8_t const*buffer, uint32_t size)
 {
   NS_LOG_FUNCTION (this << &buffer << size);
-  NS_ASSERT_MSG (CheckNoZero (m_current, size),
+  NS_ASSERT_MSG (CheckNoZero (m_current, m_current + size),
                  GetWriteErrorMessage ());
   uint8_t *to;
   if (m_current <= m_zeroStart)
@@ -1123,9 +1165,29 @@ void
 Buffer::Iterator::Read (uint8_t *buffer, uint32_t size)
 {
   NS_LOG_FUNCTION (this << &buffer << size);
-  for (uint32_t i = 0; i < size; i++)
+  NS_ASSERT_MSG (m_current >= m_dataStart &&
+                 m_current + size <= m_dataEnd,
+                 GetReadErrorMessage ());
+  //
+  // A single copy when the bytes do not overlap the zero area, which
+  // reads as zeroes.
+  //
+  if (m_current + size <= m_zeroStart)
+    {
+      memcpy (buffer, &m_data[m_current], size);
+      m_current += size;
+    }
+  else if (m_current >= m_zeroEnd)
+    {
+      memcpy (buffer, &m_data[m_current - (m_zeroEnd - m_zeroStart)], size);
+      m_current += size;
+    }
+  else
     {
-      buffer[i] = ReadU8 ();
+      for (uint32_t i = 0; i < size; i++)
+        {
+          buffer[i] = ReadU8 ();
+        }
     }
 }
 
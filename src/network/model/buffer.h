@@ -26,6 +26,10 @@
 #include "ns3/assert.h"
 
 #define BUFFER_FREE_LIST 1
+/// Data size of the smallest Buffer storage size class
+#define BUFFER_MIN_CLASS_SIZE 64
+/// Number of Buffer storage size classes (64 to 4096 bytes)
+#define BUFFER_SIZE_CLASSES 7
 
 namespace ns3 {
 
@@ -642,6 +646,28 @@ private:
    */
   Buffer (uint32_t dataSize, bool initialize);
   ~Buffer ();
+
+  /**
+   * \brief Statistics of the storage allocator shared by all Buffer instances.
+   *
+   * Buffer storage is allocated in power-of-two size classes from
+   * BUFFER_MIN_CLASS_SIZE bytes up to BUFFER_SIZE_CLASSES classes; larger
+   * requests are allocated with their exact size and never recycled.
+   * Released storage of each class is kept in a per-class free list.
+   */
+  struct AllocationStats
+  {
+    uint64_t hits;          //!< storage requests served from a free list
+    uint64_t misses;        //!< storage requests allocated from the heap
+    uint64_t currentBytes;  //!< bytes currently allocated from the heap, free lists included
+    uint64_t peakBytes;     //!< maximum value reached by currentBytes
+  };
+
+  /**
+   * \brief Get the statistics of the Buffer storage allocator.
+   * \returns the allocator statistics since the start of the program
+   */
+  static struct AllocationStats GetAllocationStats (void);
 private:
   /**
    * This data structure is variable-sized through its last member whose size
@@ -748,6 +774,19 @@ private:
    * \param data the buffer data storage
    */
   static void Deallocate (struct Buffer::Data *data);
+  /**
+   * \brief Get the size class able to hold a storage size
+   * \param size the storage size
+   * \returns the index of the smallest size class which can hold
+   *          \p size bytes, or BUFFER_SIZE_CLASSES if there is none
+   */
+  static uint32_t GetSizeClass (uint32_t size);
+  /**
+   * \brief Get the storage size of a size class
+   * \param sizeClass the size class index
+   * \returns the storage size of the size class
+   */
+  static uint32_t GetSizeClassSize (uint32_t sizeClass);
 
   struct Data *m_data; //!< the buffer data storage
 
@@ -768,6 +807,7 @@ private:
    * value.
    */
   static uint32_t g_recommendedStart;
+  static struct AllocationStats g_allocationStats; //!< storage allocator statistics
 
   /**
    * offset to the start of the virtual zero area from the start
@@ -791,15 +831,14 @@ private:
   uint32_t m_end;
 
 #ifdef BUFFER_FREE_LIST
-  /// Container for buffer data
+  /// Container for buffer data of one size class
   typedef std::vector<struct Buffer::Data*> FreeList;
   /// Local static destructor structure
   struct LocalStaticDestructor 
   {
     ~LocalStaticDestructor ();
   };
-  static uint32_t g_maxSize; //!< Max observed data size
-  static FreeList *g_freeList; //!< Buffer data container
+  static FreeList *g_freeList; //!< Buffer data containers, one per size class
   static struct LocalStaticDestructor g_localStaticDestructor; //!< Local static destructor
 #endif
 };
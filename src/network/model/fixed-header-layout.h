@@ -0,0 +1,212 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef FIXED_HEADER_LAYOUT_H
+#define FIXED_HEADER_LAYOUT_H
+
+#include <stdint.h>
+#include <cstring>
+#include "buffer.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup packet
+ * \brief The fixed-size part of a header, serialized with a single copy
+ *
+ * Serializing a header field by field through Buffer::Iterator checks the
+ * bounds of the buffer for every field.  A FixedHeaderLayout holds instead
+ * the SIZE bytes of the fixed part of a header in a local array: the fields
+ * are written to and read from the array at offsets given as template
+ * arguments, whose bounds are checked at compile time, and the array is
+ * copied to or from the buffer at once by WriteTo and ReadFrom.
+ *
+ * The field accessors mirror those of Buffer::Iterator: the Hton and Ntoh
+ * variants use the network byte order, WriteU16 and ReadU16 the byte order
+ * of Buffer::Iterator::WriteU16 and ReadU16, as used for checksums.
+ *
+ * \code
+ *   FixedHeaderLayout<8> layout;
+ *   layout.WriteHtonU16<0> (m_sourcePort);
+ *   layout.WriteHtonU16<2> (m_destinationPort);
+ *   ...
+ *   layout.WriteTo (i);
+ * \endcode
+ *
+ * \tparam SIZE the size of the fixed part of the header, in bytes
+ */
+template <uint32_t SIZE>
+class FixedHeaderLayout
+{
+public:
+  /**
+   * Create a layout whose bytes are all zero.
+   */
+  FixedHeaderLayout ()
+  {
+    std::memset (m_data, 0, SIZE);
+  }
+
+  /**
+   * \returns the size of the layout, in bytes
+   */
+  static uint32_t GetSize (void)
+  {
+    return SIZE;
+  }
+
+  /**
+   * \tparam OFFSET the offset of the field
+   * \param data the field value
+   */
+  template <uint32_t OFFSET>
+  void WriteU8 (uint8_t data)
+  {
+    static_assert (OFFSET + 1 <= SIZE, "Field beyond the end of the layout");
+    m_data[OFFSET] = data;
+  }
+  /**
+   * \tparam OFFSET the offset of the field
+   * \param data the field value, written in network order
+   */
+  template <uint32_t OFFSET>
+  void WriteHtonU16 (uint16_t data)
+  {
+    static_assert (OFFSET + 2 <= SIZE, "Field beyond the end of the layout");
+    m_data[OFFSET] = (data >> 8) & 0xff;
+    m_data[OFFSET + 1] = data & 0xff;
+  }
+  /**
+   * \tparam OFFSET the offset of the field
+   * \param data the field value, written in network order
+   */
+  template <uint32_t OFFSET>
+  void WriteHtonU32 (uint32_t data)
+  {
+    static_assert (OFFSET + 4 <= SIZE, "Field beyond the end of the layout");
+    m_data[OFFSET] = (data >> 24) & 0xff;
+    m_data[OFFSET + 1] = (data >> 16) & 0xff;
+    m_data[OFFSET + 2] = (data >> 8) & 0xff;
+    m_data[OFFSET + 3] = data & 0xff;
+  }
+  /**
+   * \tparam OFFSET the offset of the field
+   * \param data the field value, written as by Buffer::Iterator::WriteU16
+   */
+  template <uint32_t OFFSET>
+  void WriteU16 (uint16_t data)
+  {
+    static_assert (OFFSET + 2 <= SIZE, "Field beyond the end of the layout");
+    m_data[OFFSET] = data & 0xff;
+    m_data[OFFSET + 1] = (data >> 8) & 0xff;
+  }
+
+  /**
+   * \tparam OFFSET the offset of the field
+   * \returns the field value
+   */
+  template <uint32_t OFFSET>
+  uint8_t ReadU8 (void) const
+  {
+    static_assert (OFFSET + 1 <= SIZE, "Field beyond the end of the layout");
+    return m_data[OFFSET];
+  }
+  /**
+   * \tparam OFFSET the offset of the field
+   * \returns the field value, read in network order
+   */
+  template <uint32_t OFFSET>
+  uint16_t ReadNtohU16 (void) const
+  {
+    static_assert (OFFSET + 2 <= SIZE, "Field beyond the end of the layout");
+    return (m_data[OFFSET] << 8) | m_data[OFFSET + 1];
+  }
+  /**
+   * \tparam OFFSET the offset of the field
+   * \returns the field value, read in network order
+   */
+  template <uint32_t OFFSET>
+  uint32_t ReadNtohU32 (void) const
+  {
+    static_assert (OFFSET + 4 <= SIZE, "Field beyond the end of the layout");
+    return (static_cast<uint32_t> (m_data[OFFSET]) << 24)
+           | (static_cast<uint32_t> (m_data[OFFSET + 1]) << 16)
+           | (static_cast<uint32_t> (m_data[OFFSET + 2]) << 8)
+           | m_data[OFFSET + 3];
+  }
+  /**
+   * \tparam OFFSET the offset of the field
+   * \returns the field value, read as by Buffer::Iterator::ReadU16
+   */
+  template <uint32_t OFFSET>
+  uint16_t ReadU16 (void) const
+  {
+    static_assert (OFFSET + 2 <= SIZE, "Field beyond the end of the layout");
+    return m_data[OFFSET] | (m_data[OFFSET + 1] << 8);
+  }
+
+  /**
+   * \brief Compute the IP checksum of the layout
+   *
+   * The result is the one of Buffer::Iterator::CalculateIpChecksum over
+   * the same bytes, to be written with WriteU16.
+   *
+   * \param initialChecksum the initial value of the sum
+   * \returns the checksum
+   */
+  uint16_t CalculateIpChecksum (uint32_t initialChecksum = 0) const
+  {
+    /* see RFC 1071 to understand this code. */
+    uint32_t sum = initialChecksum;
+    for (uint32_t j = 0; j + 1 < SIZE; j += 2)
+      {
+        sum += m_data[j] | (m_data[j + 1] << 8);
+      }
+    if (SIZE & 1)
+      {
+        sum += m_data[SIZE - 1];
+      }
+    while (sum >> 16)
+      {
+        sum = (sum & 0xffff) + (sum >> 16);
+      }
+    return ~sum;
+  }
+
+  /**
+   * Copy the layout to the buffer, and move the iterator after it.
+   * \param i the buffer iterator
+   */
+  void WriteTo (Buffer::Iterator &i) const
+  {
+    i.Write (m_data, SIZE);
+  }
+  /**
+   * Copy the layout from the buffer, and move the iterator after it.
+   * \param i the buffer iterator
+   */
+  void ReadFrom (Buffer::Iterator &i)
+  {
+    i.Read (m_data, SIZE);
+  }
+
+private:
+  uint8_t m_data[SIZE]; //!< the bytes of the layout
+};
+
+} // namespace ns3
+
+#endif /* FIXED_HEADER_LAYOUT_H */
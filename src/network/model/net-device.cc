@@ -41,4 +41,25 @@ NetDevice::~NetDevice ()
   NS_LOG_FUNCTION (this);
 }
 
+bool
+NetDevice::SupportsReadyCallback (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return false;
+}
+
+void
+NetDevice::SetReadyCallback (ReadyCallback cb)
+{
+  NS_LOG_FUNCTION (this);
+  NS_FATAL_ERROR ("This NetDevice does not support the ready callback");
+}
+
+uint32_t
+NetDevice::GetTxBudget (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return GetMtu ();
+}
+
 } // namespace ns3
@@ -359,6 +359,42 @@ public:
    */
   virtual bool SupportsSendFrom (void) const = 0;
 
+  /**
+   * \param device a pointer to the net device which is calling this callback
+   */
+  typedef Callback< void, Ptr<NetDevice> > ReadyCallback;
+
+  /**
+   * \return true if this device notifies that it is ready to send through
+   *         the callback set by SetReadyCallback, false otherwise.
+   *
+   * The default implementation returns false.
+   */
+  virtual bool SupportsReadyCallback (void) const;
+
+  /**
+   * \param cb callback to invoke whenever the device becomes ready to send,
+   *        i.e., when its transmitter is idle and no packet waits in its queue.
+   *
+   * This allows transmitting in pull mode: a scheduler sending a packet only
+   * when GetTxBudget returns a non-zero value, and otherwise waiting for this
+   * callback, keeps a single packet at a time in the device, and can make its
+   * decisions at the last moment.
+   *
+   * The default implementation aborts: it must only be called on devices
+   * for which SupportsReadyCallback returns true.
+   */
+  virtual void SetReadyCallback (ReadyCallback cb);
+
+  /**
+   * \return the number of bytes that the device can send right now without
+   *         queuing them behind other packets, zero if it is not ready.
+   *
+   * The default implementation returns the MTU: a device that does not
+   * support the ready callback is always considered ready.
+   */
+  virtual uint32_t GetTxBudget (void) const;
+
 };
 
 } // namespace ns3
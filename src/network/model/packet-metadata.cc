@@ -75,13 +75,16 @@ PacketMetadata::ReserveCopy (uint32_t size)
 {
   NS_LOG_FUNCTION (this << size);
   struct PacketMetadata::Data *newData = PacketMetadata::Create (m_used + size);
-  memcpy (newData->m_data, m_data->m_data, m_used);
-  newData->m_dirtyEnd = m_used;
-  m_data->m_count--;
-  if (m_data->m_count == 0) 
+  if (m_data != 0)
     {
-      PacketMetadata::Recycle (m_data);
+      memcpy (newData->m_data, m_data->m_data, m_used);
+      m_data->m_count--;
+      if (m_data->m_count == 0) 
+        {
+          PacketMetadata::Recycle (m_data);
+        }
     }
+  newData->m_dirtyEnd = m_used;
   m_data = newData;
   if (m_head != 0xffff)
     {
@@ -99,8 +102,8 @@ void
 PacketMetadata::Reserve (uint32_t size)
 {
   NS_LOG_FUNCTION (this << size);
-  NS_ASSERT (m_data != 0);
-  if (m_data->m_size >= m_used + size &&
+  if (m_data != 0 &&
+      m_data->m_size >= m_used + size &&
       (m_head == 0xffff ||
        m_data->m_count == 1 ||
        m_data->m_dirtyEnd == m_used))
@@ -133,6 +136,15 @@ bool
 PacketMetadata::IsStateOk (void) const
 {
   NS_LOG_FUNCTION (this);
+  if (m_nInline > PACKET_METADATA_INLINE_ITEMS ||
+      (m_nInline != 0 && (m_head != 0xffff || m_tail != 0xffff)))
+    {
+      return false;
+    }
+  if (m_data == 0)
+    {
+      return m_head == 0xffff && m_tail == 0xffff && m_used == 0;
+    }
   bool ok = m_used <= m_data->m_size;
   ok &= IsPointerOk (m_head);
   ok &= IsPointerOk (m_tail);
@@ -374,12 +386,12 @@ uint16_t
 PacketMetadata::AddSmall (const struct PacketMetadata::SmallItem *item)
 {
   NS_LOG_FUNCTION (this << item->next << item->prev << item->typeUid << item->size << item->chunkUid);
-  NS_ASSERT (m_data != 0);
   NS_ASSERT (m_used != item->prev && m_used != item->next);
   uint32_t typeUidSize = GetUleb128Size (item->typeUid);
   uint32_t sizeSize = GetUleb128Size (item->size);
   uint32_t n =  2 + 2 + typeUidSize + sizeSize + 2;
-  if (m_used + n > m_data->m_size ||
+  if (m_data == 0 ||
+      m_used + n > m_data->m_size ||
       (m_head != 0xffff &&
        m_data->m_count != 1 &&
        m_used != m_data->m_dirtyEnd))
@@ -407,7 +419,6 @@ PacketMetadata::AddBig (uint32_t next, uint32_t prev,
   NS_LOG_FUNCTION (this << next << prev <<
                    item->next << item->prev << item->typeUid << item->size << item->chunkUid <<
                    extraItem->fragmentStart << extraItem->fragmentEnd << extraItem->packetUid);
-  NS_ASSERT (m_data != 0);
   uint32_t typeUid = ((item->typeUid & 0x1) == 0x1) ? item->typeUid : item->typeUid+1;
   NS_ASSERT (m_used != prev && m_used != next);
 
@@ -417,7 +428,8 @@ PacketMetadata::AddBig (uint32_t next, uint32_t prev,
   uint32_t fragEndSize = GetUleb128Size (extraItem->fragmentEnd);
   uint32_t n = 2 + 2 + typeUidSize + sizeSize + 2 + fragStartSize + fragEndSize + 4;
 
-  if (m_used + n > m_data->m_size ||
+  if (m_data == 0 ||
+      m_used + n > m_data->m_size ||
       (m_head != 0xffff &&
        m_data->m_count != 1 &&
        m_used != m_data->m_dirtyEnd))
@@ -668,6 +680,17 @@ PacketMetadata::DoAddHeader (uint32_t uid, uint32_t size)
       m_metadataSkipped = true;
       return;
     }
+  if (CanAddInline (size))
+    {
+      struct PacketMetadata::InlineItem *item = &m_inline[m_nInline];
+      item->tid = uid >> 1;
+      item->size = size;
+      item->chunkUid = m_chunkUid;
+      m_chunkUid++;
+      m_nInline++;
+      return;
+    }
+  Materialize ();
 
   struct PacketMetadata::SmallItem item;
   item.next = m_head;
@@ -679,6 +702,46 @@ PacketMetadata::DoAddHeader (uint32_t uid, uint32_t size)
   uint16_t written = AddSmall (&item);
   UpdateHead (written);
 }
+void
+PacketMetadata::Materialize (void) const
+{
+  NS_LOG_FUNCTION (this);
+  if (m_nInline == 0)
+    {
+      return;
+    }
+  NS_ASSERT (m_head == 0xffff && m_tail == 0xffff);
+  // The items are encoded by a scratch object, whose list then replaces
+  // ours: the items represented by the metadata do not change.
+  PacketMetadata list (m_packetUid, 0);
+  if (m_data != 0 && m_data->m_count == 1)
+    {
+      // Write over the data, which no other packet shares.
+      list.m_data = m_data;
+    }
+  else if (m_data != 0)
+    {
+      m_data->m_count--;
+    }
+  for (uint8_t n = m_nInline; n > 0; n--)
+    {
+      struct PacketMetadata::SmallItem item;
+      item.next = 0xffff;
+      item.prev = list.m_tail;
+      item.typeUid = static_cast<uint32_t> (m_inline[n - 1].tid) << 1;
+      item.size = m_inline[n - 1].size;
+      item.chunkUid = m_inline[n - 1].chunkUid;
+      uint16_t written = list.AddSmall (&item);
+      list.UpdateTail (written);
+    }
+  m_data = list.m_data;
+  m_head = list.m_head;
+  m_tail = list.m_tail;
+  m_used = list.m_used;
+  m_nInline = 0;
+  list.m_data = 0;
+  NS_ASSERT (IsStateOk ());
+}
 void 
 PacketMetadata::RemoveHeader (const Header &header, uint32_t size)
 {
@@ -690,6 +753,21 @@ PacketMetadata::RemoveHeader (const Header &header, uint32_t size)
       m_metadataSkipped = true;
       return;
     }
+  if (m_nInline != 0)
+    {
+      const struct PacketMetadata::InlineItem *head = &m_inline[m_nInline - 1];
+      if ((static_cast<uint32_t> (head->tid) << 1) != uid ||
+          head->size != size)
+        {
+          if (m_enableChecking)
+            {
+              NS_FATAL_ERROR ("Removing unexpected header.");
+            }
+          return;
+        }
+      m_nInline--;
+      return;
+    }
   struct PacketMetadata::SmallItem item;
   struct PacketMetadata::ExtraItem extraItem;
   uint32_t read = ReadItems (m_head, &item, &extraItem);
@@ -738,6 +816,18 @@ PacketMetadata::AddTrailer (const Trailer &trailer, uint32_t size)
       m_metadataSkipped = true;
       return;
     }
+  if (CanAddInline (size))
+    {
+      std::memmove (&m_inline[1], &m_inline[0], m_nInline * sizeof (struct InlineItem));
+      m_inline[0].tid = uid >> 1;
+      m_inline[0].size = size;
+      m_inline[0].chunkUid = m_chunkUid;
+      m_chunkUid++;
+      m_nInline++;
+      NS_ASSERT (IsStateOk ());
+      return;
+    }
+  Materialize ();
   struct PacketMetadata::SmallItem item;
   item.next = 0xffff;
   item.prev = m_tail;
@@ -760,6 +850,21 @@ PacketMetadata::RemoveTrailer (const Trailer &trailer, uint32_t size)
       m_metadataSkipped = true;
       return;
     }
+  if (m_nInline != 0)
+    {
+      if ((static_cast<uint32_t> (m_inline[0].tid) << 1) != uid ||
+          m_inline[0].size != size)
+        {
+          if (m_enableChecking)
+            {
+              NS_FATAL_ERROR ("Removing unexpected trailer.");
+            }
+          return;
+        }
+      m_nInline--;
+      std::memmove (&m_inline[0], &m_inline[1], m_nInline * sizeof (struct InlineItem));
+      return;
+    }
   struct PacketMetadata::SmallItem item;
   struct PacketMetadata::ExtraItem extraItem;
   uint32_t read = ReadItems (m_tail, &item, &extraItem);
@@ -807,7 +912,7 @@ PacketMetadata::AddAtEnd (PacketMetadata const&o)
       m_metadataSkipped = true;
       return;
     }
-  if (m_tail == 0xffff)
+  if (m_tail == 0xffff && m_nInline == 0)
     {
       // We have no items so 'AddAtEnd' is 
       // equivalent to self-assignment.
@@ -815,12 +920,14 @@ PacketMetadata::AddAtEnd (PacketMetadata const&o)
       NS_ASSERT (IsStateOk ());
       return;
     }
-  if (o.m_head == 0xffff)
+  if (o.m_head == 0xffff && o.m_nInline == 0)
     {
       NS_ASSERT (o.m_tail == 0xffff);
       // we have nothing to append.
       return;
     }
+  Materialize ();
+  o.Materialize ();
   NS_ASSERT (m_head != 0xffff && m_tail != 0xffff);
 
   // We read the current tail because we are going to append
@@ -895,8 +1002,18 @@ PacketMetadata::RemoveAtStart (uint32_t start)
       m_metadataSkipped = true;
       return;
     }
-  NS_ASSERT (m_data != 0);
   uint32_t leftToRemove = start;
+  while (m_nInline != 0 && leftToRemove > 0 &&
+         m_inline[m_nInline - 1].size <= leftToRemove)
+    {
+      leftToRemove -= m_inline[m_nInline - 1].size;
+      m_nInline--;
+    }
+  if (m_nInline != 0 && leftToRemove > 0)
+    {
+      // fragment the head item.
+      Materialize ();
+    }
   uint16_t current = m_head;
   while (current != 0xffff && leftToRemove > 0)
     {
@@ -958,9 +1075,25 @@ PacketMetadata::RemoveAtEnd (uint32_t end)
       m_metadataSkipped = true;
       return;
     }
-  NS_ASSERT (m_data != 0);
 
   uint32_t leftToRemove = end;
+  uint32_t removed = 0;
+  while (removed < m_nInline && leftToRemove > 0 &&
+         m_inline[removed].size <= leftToRemove)
+    {
+      leftToRemove -= m_inline[removed].size;
+      removed++;
+    }
+  if (removed != 0)
+    {
+      m_nInline -= removed;
+      std::memmove (&m_inline[0], &m_inline[removed], m_nInline * sizeof (struct InlineItem));
+    }
+  if (m_nInline != 0 && leftToRemove > 0)
+    {
+      // fragment the tail item.
+      Materialize ();
+    }
   uint16_t current = m_tail;
   while (current != 0xffff && leftToRemove > 0)
     {
@@ -1018,6 +1151,10 @@ PacketMetadata::GetTotalSize (void) const
 {
   NS_LOG_FUNCTION (this);
   uint32_t totalSize = 0;
+  for (uint8_t i = 0; i < m_nInline; i++)
+    {
+      totalSize += m_inline[i].size;
+    }
   uint16_t current = m_head;
   uint16_t tail = m_tail;
   while (current != 0xffff)
@@ -1046,6 +1183,7 @@ PacketMetadata::ItemIterator
 PacketMetadata::BeginItem (Buffer buffer) const
 {
   NS_LOG_FUNCTION (this << &buffer);
+  Materialize ();
   return ItemIterator (this, buffer);
 }
 PacketMetadata::ItemIterator::ItemIterator (const PacketMetadata *metadata, Buffer buffer)
@@ -1133,6 +1271,7 @@ uint32_t
 PacketMetadata::GetSerializedSize (void) const
 {
   NS_LOG_FUNCTION (this);
+  Materialize ();
   uint32_t totalSize = 0;
 
   // add 8 bytes for the packet uid
@@ -1178,6 +1317,7 @@ uint32_t
 PacketMetadata::Serialize (uint8_t* buffer, uint32_t maxSize) const
 {
   NS_LOG_FUNCTION (this << &buffer << maxSize);
+  Materialize ();
   uint8_t* start = buffer;
 
   buffer = AddToRawU64 (m_packetUid, start, buffer, maxSize);
@@ -1279,6 +1419,7 @@ uint32_t
 PacketMetadata::Deserialize (const uint8_t* buffer, uint32_t size)
 {
   NS_LOG_FUNCTION (this << &buffer << size);
+  Materialize ();
   const uint8_t* start = buffer;
   uint32_t desSize = size - 4;
 
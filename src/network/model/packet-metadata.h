@@ -23,6 +23,7 @@
 #include <stdint.h>
 #include <vector>
 #include <limits>
+#include <cstring>
 #include "ns3/callback.h"
 #include "ns3/assert.h"
 #include "ns3/type-id.h"
@@ -61,7 +62,11 @@ class Trailer;
  *     if it is one.
  *
  * This linked list is flattened in a byte buffer stored in
- * struct PacketMetadata::Data. Each entry of the linked list is
+ * struct PacketMetadata::Data. The buffer is only allocated when
+ * the first item is recorded: a PacketMetadata without items (which
+ * includes every packet when metadata is disabled) holds no buffer
+ * at all, so that creating, copying and destroying packets does not
+ * touch the heap on behalf of this class. Each entry of the linked list is
  * identified by an offset which identifies the first byte of the
  * entry from the start of the data buffer. The size of this data
  * buffer is 2^16-1 bytes maximum which somewhat limits the number
@@ -74,6 +79,18 @@ class Trailer;
  * integers, and some others as variable-size 32-bit integers.
  * The variable-size 32 bit integers are stored using the uleb128
  * encoding.
+ *
+ * Most packets only ever see whole headers and trailers added to and
+ * removed from the packet they were created with, such as an
+ * Ethernet, IPv4 and TCP header stack on top of the payload.  Up to
+ * PACKET_METADATA_INLINE_ITEMS such items are kept in a fixed-size
+ * array inside the PacketMetadata object itself, which is copied
+ * along with the packet and needs neither the data buffer nor the
+ * list encoding.  The items are only moved to the linked list (they
+ * are "materialized") when an operation needs it: iterating over the
+ * items (to print the packet), serializing the metadata, fragmenting
+ * an item or concatenating packets, or recording more items than the
+ * array holds.
  */
 class PacketMetadata 
 {
@@ -494,6 +511,26 @@ private:
     uint64_t packetUid;
   };
 
+  /**
+   * the number of items stored in PacketMetadata::m_inline
+   */
+#define PACKET_METADATA_INLINE_ITEMS 6
+
+  /**
+   * \brief InlineItem structure
+   *
+   * A whole header, trailer or payload of the packet, stored in the
+   * PacketMetadata object until the items are materialized.
+   */
+  struct InlineItem {
+    /** the uid of the type of the header or trailer, zero for payload */
+    uint16_t tid;
+    /** the size (in bytes) of the header, trailer or payload */
+    uint16_t size;
+    /** the chunk uid of the item, as in SmallItem */
+    uint16_t chunkUid;
+  };
+
   /**
    * \brief Class to hold all the metadata
    */
@@ -620,6 +657,20 @@ public:
    * \param size header serialized size
    */
   void DoAddHeader (uint32_t uid, uint32_t size);
+  /**
+   * \brief Check if an item can be stored inline
+   * \param size the item size
+   * \returns true if the linked list is empty and there is room for
+   * an item of this size in the inline items
+   */
+  inline bool CanAddInline (uint32_t size) const;
+  /**
+   * \brief Move the inline items to the linked list
+   *
+   * This does not change the items represented by the metadata, hence
+   * it can be called from the const methods which need the linked list.
+   */
+  void Materialize (void) const;
   /**
    * \brief Check if the metadata state is ok
    * \returns true if the internal state is ok
@@ -675,16 +726,22 @@ public:
   static uint32_t m_maxSize; //!< maximum metadata size
   static uint16_t m_chunkUid; //!< Chunk Uid
 
-  struct Data *m_data; //!< Metadata storage
+  mutable struct Data *m_data; //!< Metadata storage, or 0 if no item was ever recorded
   /*
      head -(next)-> tail
        ^             |
         \---(prev)---|
    */
-  uint16_t m_head; //!< list head
-  uint16_t m_tail; //!< list tail
-  uint16_t m_used; //!< used portion
+  mutable uint16_t m_head; //!< list head
+  mutable uint16_t m_tail; //!< list tail
+  mutable uint16_t m_used; //!< used portion
   uint64_t m_packetUid; //!< packet Uid
+  /**
+   * The inline items, from the tail (index 0) to the head of the
+   * packet, used while the linked list is empty.
+   */
+  struct InlineItem m_inline[PACKET_METADATA_INLINE_ITEMS];
+  mutable uint8_t m_nInline; //!< number of inline items
 };
 
 } // namespace ns3
@@ -692,13 +749,13 @@ public:
 namespace ns3 {
 
 PacketMetadata::PacketMetadata (uint64_t uid, uint32_t size)
-  : m_data (PacketMetadata::Create (10)),
+  : m_data (0),
     m_head (0xffff),
     m_tail (0xffff),
     m_used (0),
-    m_packetUid (uid)
+    m_packetUid (uid),
+    m_nInline (0)
 {
-  memset (m_data->m_data, 0xff, 4);
   if (size > 0)
     {
       DoAddHeader (0, size);
@@ -709,11 +766,15 @@ PacketMetadata::PacketMetadata (PacketMetadata const &o)
     m_head (o.m_head),
     m_tail (o.m_tail),
     m_used (o.m_used),
-    m_packetUid (o.m_packetUid)
+    m_packetUid (o.m_packetUid),
+    m_nInline (o.m_nInline)
 {
-  NS_ASSERT (m_data != 0);
-  NS_ASSERT (m_data->m_count < std::numeric_limits<uint32_t>::max());
-  m_data->m_count++;
+  std::memcpy (m_inline, o.m_inline, m_nInline * sizeof (struct InlineItem));
+  if (m_data != 0)
+    {
+      NS_ASSERT (m_data->m_count < std::numeric_limits<uint32_t>::max());
+      m_data->m_count++;
+    }
 }
 PacketMetadata &
 PacketMetadata::operator = (PacketMetadata const& o)
@@ -721,25 +782,39 @@ PacketMetadata::operator = (PacketMetadata const& o)
   if (m_data != o.m_data) 
     {
       // not self assignment
-      NS_ASSERT (m_data != 0);
-      m_data->m_count--;
-      if (m_data->m_count == 0) 
+      if (m_data != 0)
         {
-          PacketMetadata::Recycle (m_data);
+          m_data->m_count--;
+          if (m_data->m_count == 0) 
+            {
+              PacketMetadata::Recycle (m_data);
+            }
         }
       m_data = o.m_data;
-      NS_ASSERT (m_data != 0);
-      m_data->m_count++;
+      if (m_data != 0)
+        {
+          m_data->m_count++;
+        }
     }
   m_head = o.m_head;
   m_tail = o.m_tail;
   m_used = o.m_used;
   m_packetUid = o.m_packetUid;
+  m_nInline = o.m_nInline;
+  std::memcpy (m_inline, o.m_inline, m_nInline * sizeof (struct InlineItem));
   return *this;
 }
+bool
+PacketMetadata::CanAddInline (uint32_t size) const
+{
+  return m_head == 0xffff && m_nInline < PACKET_METADATA_INLINE_ITEMS && size <= 0xffff;
+}
 PacketMetadata::~PacketMetadata ()
 {
-  NS_ASSERT (m_data != 0);
+  if (m_data == 0)
+    {
+      return;
+    }
   m_data->m_count--;
   if (m_data->m_count == 0) 
     {
@@ -29,11 +29,40 @@
 #include "ns3/fatal-error.h"
 #include "ns3/log.h"
 #include <cstring>
+#include <vector>
 
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("PacketTagList");
 
+/**
+ * \ingroup packet
+ *
+ * \brief Container of the released TagData nodes of pooled capacity
+ *
+ * Internal use only.
+ */
+static class TagDataFreeList : public std::vector<void *>
+{
+public:
+  ~TagDataFreeList ();
+} g_freeList; //!< Released TagData nodes of pooled capacity
+/**
+ * Set once g_freeList has been destroyed, so that nodes released
+ * by static Packet instances afterwards are freed directly.
+ */
+static bool g_freeListDestroyed = false;
+
+TagDataFreeList::~TagDataFreeList ()
+{
+  NS_LOG_FUNCTION (this);
+  for (iterator i = begin (); i != end (); i++)
+    {
+      std::free (*i);
+    }
+  g_freeListDestroyed = true;
+}
+
 PacketTagList::TagData *
 PacketTagList::CreateTagData (size_t dataSize)
 {
@@ -43,14 +72,45 @@ PacketTagList::CreateTagData (size_t dataSize)
                  << " exceeds maximum "
                  << std::numeric_limits<decltype(TagData::size)>::max () );
 
-  void * p = std::malloc (sizeof (TagData) + dataSize - 1);
-  // The matching frees are in RemoveAll and RemoveWriter
+  void * p;
+  if (dataSize <= PACKET_TAG_LIST_POOLED_DATA_SIZE)
+    {
+      if (!g_freeListDestroyed && !g_freeList.empty ())
+        {
+          p = g_freeList.back ();
+          g_freeList.pop_back ();
+        }
+      else
+        {
+          p = std::malloc (sizeof (TagData) + PACKET_TAG_LIST_POOLED_DATA_SIZE - 1);
+        }
+    }
+  else
+    {
+      p = std::malloc (sizeof (TagData) + dataSize - 1);
+    }
+  // The matching release is FreeTagData
 
   TagData * tag = new (p) TagData;
   tag->size = dataSize;
   return tag;
 }
 
+void
+PacketTagList::FreeTagData (TagData * tag)
+{
+  bool pooled = tag->size <= PACKET_TAG_LIST_POOLED_DATA_SIZE;
+  tag->~TagData ();
+  if (pooled && !g_freeListDestroyed && g_freeList.size () < 1000)
+    {
+      g_freeList.push_back (tag);
+    }
+  else
+    {
+      std::free (tag);
+    }
+}
+
 bool
 PacketTagList::COWTraverse (Tag & tag, PacketTagList::COWWriter Writer)
 {
@@ -194,8 +254,7 @@ PacketTagList::RemoveWriter (Tag & tag, bool preMerge,
   if (preMerge)
     {
       // found tid before first merge, so delete cur
-      cur->~TagData ();
-      std::free (cur);
+      FreeTagData (cur);
     }
   else
     {
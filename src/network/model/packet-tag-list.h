@@ -29,6 +29,13 @@
 #include <ostream>
 #include "ns3/type-id.h"
 
+/**
+ * Size of the data area of the TagData nodes which are recycled
+ * through the PacketTagList free list.  Tags which serialize to
+ * at most this many bytes never hit the heap in steady state.
+ */
+#define PACKET_TAG_LIST_POOLED_DATA_SIZE 20
+
 namespace ns3 {
 
 class Tag;
@@ -110,6 +117,11 @@ class Tag;
  *     (PacketTagList \c B started as a copy of PacketTagList \c A,
  *     before \c T6 was added to \c B).
  *
+ *   - TagData nodes whose data fits in #PACKET_TAG_LIST_POOLED_DATA_SIZE
+ *     bytes are all allocated with that capacity and recycled through a
+ *     free list when released, so that the per-packet tags added by the
+ *     common stacks do not allocate once the simulation is warmed up.
+ *
  *   - #Remove and #Replace are a little tricky, depending on where the
  *     target tag is found relative to the first branch point:
  *     - \e Target before <em> the first branch point: </em> \n
@@ -228,6 +240,14 @@ private:
    */
   static
   TagData * CreateTagData (size_t dataSize);
+  /**
+   * Destruct and release a TagData struct, returning it to the
+   * free list if it was allocated with the pooled capacity.
+   *
+   * \param [in] tag The TagData object to release.
+   */
+  static
+  void FreeTagData (TagData * tag);
   
   /**
    * Typedef of method function pointer for copy-on-write operations
@@ -341,15 +361,13 @@ PacketTagList::RemoveAll (void)
         }
       if (prev != 0) 
         {
-          prev->~TagData ();
-          std::free (prev);
+          FreeTagData (prev);
         }
       prev = cur;
     }
   if (prev != 0) 
     {
-      prev->~TagData ();
-      std::free (prev);
+      FreeTagData (prev);
     }
   m_next = 0;
 }
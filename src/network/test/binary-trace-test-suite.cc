@@ -0,0 +1,282 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <sstream>
+
+#include "ns3/test.h"
+#include "ns3/fatal-impl.h"
+#include "ns3/header.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+#include "ns3/binary-trace.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Header used to check the printing of the decoded packets
+ */
+class BinaryTraceTestHeader : public Header
+{
+public:
+  BinaryTraceTestHeader ();
+  /**
+   * \param data the header data
+   */
+  BinaryTraceTestHeader (uint16_t data);
+
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual void Print (std::ostream &os) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (Buffer::Iterator start) const;
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+
+private:
+  uint16_t m_data; //!< the header data
+};
+
+NS_OBJECT_ENSURE_REGISTERED (BinaryTraceTestHeader);
+
+BinaryTraceTestHeader::BinaryTraceTestHeader ()
+  : m_data (0)
+{
+}
+
+BinaryTraceTestHeader::BinaryTraceTestHeader (uint16_t data)
+  : m_data (data)
+{
+}
+
+TypeId
+BinaryTraceTestHeader::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::BinaryTraceTestHeader")
+    .SetParent<Header> ()
+    .SetGroupName ("Network")
+    .AddConstructor<BinaryTraceTestHeader> ()
+  ;
+  return tid;
+}
+
+TypeId
+BinaryTraceTestHeader::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+void
+BinaryTraceTestHeader::Print (std::ostream &os) const
+{
+  os << "data=" << m_data;
+}
+
+uint32_t
+BinaryTraceTestHeader::GetSerializedSize (void) const
+{
+  return 2;
+}
+
+void
+BinaryTraceTestHeader::Serialize (Buffer::Iterator start) const
+{
+  start.WriteHtonU16 (m_data);
+}
+
+uint32_t
+BinaryTraceTestHeader::Deserialize (Buffer::Iterator start)
+{
+  m_data = start.ReadNtohU16 ();
+  return 2;
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Check that the records of a binary trace file are decoded in the
+ * format of the ascii trace files
+ */
+class BinaryTraceTestCase : public TestCase
+{
+public:
+  /**
+   * \param packets whether the packets are stored in the file
+   */
+  BinaryTraceTestCase (bool packets);
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Write the events and the text of the test, and the expected ascii
+   * trace file.
+   * \param writer the binary trace writer
+   */
+  void WriteEvents (BinaryTraceWriter *writer);
+
+  bool m_packets;           //!< whether the packets are stored in the file
+  std::ostringstream m_ascii; //!< the expected ascii trace file
+};
+
+BinaryTraceTestCase::BinaryTraceTestCase (bool packets)
+  : TestCase (std::string ("Check the decoding of a binary trace file ") +
+              (packets ? "with" : "without") + " packets"),
+    m_packets (packets)
+{
+}
+
+void
+BinaryTraceTestCase::WriteEvents (BinaryTraceWriter *writer)
+{
+  std::string context = "/NodeList/3/DeviceList/1/$ns3::SimpleNetDevice/TxQueue/Enqueue";
+  Ptr<Packet> p = Create<Packet> (100);
+  p->AddHeader (BinaryTraceTestHeader (1234));
+
+  writer->Write (BinaryTraceWriter::ENQUEUE, context, p);
+  m_ascii << "+ " << Simulator::Now ().GetSeconds () << " " << context << " ";
+  if (m_packets)
+    {
+      m_ascii << *p << std::endl;
+    }
+  else
+    {
+      m_ascii << "ns3::BinaryTraceTestHeader (size=102)" << std::endl;
+    }
+
+  *writer->GetTextStream () << "text " << 42 << std::endl;
+  m_ascii << "text 42" << std::endl;
+
+  Ptr<Packet> q = Create<Packet> (10);
+  writer->Write (BinaryTraceWriter::RECEIVE, std::string (), q);
+  m_ascii << "r " << Simulator::Now ().GetSeconds () << " ";
+  if (m_packets)
+    {
+      m_ascii << *q << std::endl;
+    }
+  else
+    {
+      m_ascii << "(size=10)" << std::endl;
+    }
+}
+
+void
+BinaryTraceTestCase::DoRun (void)
+{
+  Packet::EnablePrinting ();
+  std::string filename = CreateTempDirFilename ("test.bin");
+  BinaryTraceWriter *writer = new BinaryTraceWriter (filename, m_packets);
+  Simulator::Schedule (Seconds (1.5), &BinaryTraceTestCase::WriteEvents, this, writer);
+  Simulator::Run ();
+  Simulator::Destroy ();
+  delete writer;
+
+  BinaryTraceReader reader (filename);
+  NS_TEST_ASSERT_MSG_EQ (reader.Fail (), false, "Unable to read " << filename);
+  BinaryTraceReader::Record record;
+  NS_TEST_ASSERT_MSG_EQ (reader.Read (record), true, "Missing first record");
+  NS_TEST_EXPECT_MSG_EQ (record.type, '+', "Unexpected event type");
+  NS_TEST_EXPECT_MSG_EQ (record.ts, 1500000000, "Unexpected event time");
+  NS_TEST_EXPECT_MSG_EQ (record.node, 3, "Unexpected node id");
+  NS_TEST_EXPECT_MSG_EQ (record.device, 1, "Unexpected device id");
+  NS_TEST_EXPECT_MSG_EQ (record.size, 102, "Unexpected packet size");
+  NS_TEST_EXPECT_MSG_EQ (record.summary, "ns3::BinaryTraceTestHeader", "Unexpected header summary");
+  NS_TEST_EXPECT_MSG_EQ ((record.packet != 0), m_packets, "Unexpected stored packet");
+  NS_TEST_ASSERT_MSG_EQ (reader.Read (record), true, "Missing text record");
+  NS_TEST_EXPECT_MSG_EQ (record.type, 0, "Unexpected text record type");
+  NS_TEST_EXPECT_MSG_EQ (record.text, "text 42", "Unexpected text");
+  NS_TEST_ASSERT_MSG_EQ (reader.Read (record), true, "Missing last record");
+  NS_TEST_EXPECT_MSG_EQ (record.node, BinaryTraceReader::NO_ID, "Unexpected node id without context");
+  NS_TEST_EXPECT_MSG_EQ (reader.Read (record), false, "Unexpected record");
+  NS_TEST_EXPECT_MSG_EQ (reader.Fail (), false, "Unexpected read failure");
+
+  std::ostringstream decoded;
+  NS_TEST_EXPECT_MSG_EQ (BinaryTraceReader::Decode (filename, decoded), true, "Unable to decode " << filename);
+  NS_TEST_EXPECT_MSG_EQ (decoded.str (), m_ascii.str (), "Decoded file differs from the ascii trace file");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Check that the buffered records are written to the file when a
+ * fatal error flushes the streams, but not on std::endl
+ */
+class BinaryTraceFatalFlushTestCase : public TestCase
+{
+public:
+  BinaryTraceFatalFlushTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+BinaryTraceFatalFlushTestCase::BinaryTraceFatalFlushTestCase ()
+  : TestCase ("Check the flush of a binary trace file on fatal errors")
+{
+}
+
+void
+BinaryTraceFatalFlushTestCase::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("fatal.bin");
+  BinaryTraceWriter *writer = new BinaryTraceWriter (filename, false);
+  *writer->GetTextStream () << "before the fatal error" << std::endl;
+
+  BinaryTraceReader::Record record;
+  {
+    BinaryTraceReader reader (filename);
+    NS_TEST_EXPECT_MSG_EQ (reader.Read (record), false, "Unexpected record written on std::endl");
+  }
+
+  // the streams flushed by NS_FATAL_ERROR before aborting
+  FatalImpl::FlushStreams ();
+
+  BinaryTraceReader reader (filename);
+  NS_TEST_ASSERT_MSG_EQ (reader.Fail (), false, "Unable to read " << filename);
+  NS_TEST_ASSERT_MSG_EQ (reader.Read (record), true, "Missing text record after a fatal error");
+  NS_TEST_EXPECT_MSG_EQ (record.text, "before the fatal error", "Unexpected text");
+  NS_TEST_EXPECT_MSG_EQ (reader.Read (record), false, "Unexpected record");
+  delete writer;
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Binary trace file TestSuite
+ */
+class BinaryTraceTestSuite : public TestSuite
+{
+public:
+  BinaryTraceTestSuite ();
+};
+
+BinaryTraceTestSuite::BinaryTraceTestSuite ()
+  : TestSuite ("binary-trace", UNIT)
+{
+  AddTestCase (new BinaryTraceTestCase (true), TestCase::QUICK);
+  AddTestCase (new BinaryTraceTestCase (false), TestCase::QUICK);
+  AddTestCase (new BinaryTraceFatalFlushTestCase (), TestCase::QUICK);
+}
+
+static BinaryTraceTestSuite binaryTraceTestSuite; //!< Static variable for test initialization
@@ -19,6 +19,7 @@
  */
 
 #include "ns3/buffer.h"
+#include "ns3/fixed-header-layout.h"
 #include "ns3/random-variable-stream.h"
 #include "ns3/double.h"
 #include "ns3/test.h"
@@ -376,6 +377,92 @@ BufferTest::DoRun (void)
   val2 <<= 8;
   val2 |= i.ReadU8 ();
   NS_TEST_ASSERT_MSG_EQ (val1, val2, "Bad ReadNtohU16()");
+
+  // released storage is reused through the free list of its size class
+  Buffer::AllocationStats before = Buffer::GetAllocationStats ();
+  buffer = Buffer ();
+  buffer.AddAtStart (1000);
+  buffer = Buffer ();
+  buffer.AddAtStart (1000);
+  Buffer::AllocationStats after = Buffer::GetAllocationStats ();
+  NS_TEST_ASSERT_MSG_GT (after.hits, before.hits, "Buffer storage not recycled");
+  NS_TEST_ASSERT_MSG_GT_OR_EQ (after.peakBytes, after.currentBytes, "Bad peak allocation size");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Check that FixedHeaderLayout writes the bytes written by Buffer::Iterator,
+ * and the reads of blocks of bytes.
+ */
+class FixedHeaderLayoutTest : public TestCase {
+public:
+  virtual void DoRun (void);
+  FixedHeaderLayoutTest ();
+};
+
+FixedHeaderLayoutTest::FixedHeaderLayoutTest ()
+  : TestCase ("FixedHeaderLayout") {
+}
+
+void
+FixedHeaderLayoutTest::DoRun (void)
+{
+  Buffer expected;
+  expected.AddAtStart (11);
+  Buffer::Iterator i = expected.Begin ();
+  i.WriteU8 (0x45);
+  i.WriteHtonU16 (0x1234);
+  i.WriteHtonU32 (0xdeadbeef);
+  i.WriteU16 (0x5678);
+  i.WriteU16 (0);
+  uint16_t expectedChecksum = expected.Begin ().CalculateIpChecksum (11, 7);
+
+  FixedHeaderLayout<11> layout;
+  layout.WriteU8<0> (0x45);
+  layout.WriteHtonU16<1> (0x1234);
+  layout.WriteHtonU32<3> (0xdeadbeef);
+  layout.WriteU16<7> (0x5678);
+  NS_TEST_EXPECT_MSG_EQ (layout.CalculateIpChecksum (7), expectedChecksum, "Bad checksum");
+
+  Buffer buffer;
+  buffer.AddAtStart (11);
+  i = buffer.Begin ();
+  layout.WriteTo (i);
+  NS_TEST_EXPECT_MSG_EQ (i.GetDistanceFrom (buffer.Begin ()), 11, "Iterator not moved after the layout");
+  NS_TEST_ASSERT_MSG_EQ (std::memcmp (buffer.PeekData (), expected.PeekData (), 11), 0,
+                         "Layout bytes differ from the iterator bytes");
+
+  FixedHeaderLayout<11> read;
+  i = buffer.Begin ();
+  read.ReadFrom (i);
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t)read.ReadU8<0> (), 0x45, "Bad ReadU8");
+  NS_TEST_EXPECT_MSG_EQ (read.ReadNtohU16<1> (), 0x1234, "Bad ReadNtohU16");
+  NS_TEST_EXPECT_MSG_EQ (read.ReadNtohU32<3> (), 0xdeadbeef, "Bad ReadNtohU32");
+  NS_TEST_EXPECT_MSG_EQ (read.ReadU16<7> (), 0x5678, "Bad ReadU16");
+
+  // blocks of bytes are read before, across and after the zero area
+  buffer = Buffer (4);
+  buffer.AddAtStart (2);
+  buffer.AddAtEnd (2);
+  i = buffer.Begin ();
+  i.WriteU8 (1);
+  i.WriteU8 (2);
+  i.Next (4);
+  i.WriteU8 (3);
+  i.WriteU8 (4);
+  uint8_t bytes[8];
+  i = buffer.Begin ();
+  i.Read (bytes, 8);
+  uint8_t all[8] = { 1, 2, 0, 0, 0, 0, 3, 4 };
+  NS_TEST_EXPECT_MSG_EQ (std::memcmp (bytes, all, 8), 0, "Bad read across the zero area");
+  i = buffer.Begin ();
+  i.Read (bytes, 2);
+  NS_TEST_EXPECT_MSG_EQ (std::memcmp (bytes, all, 2), 0, "Bad read before the zero area");
+  i.Next (4);
+  i.Read (bytes, 2);
+  NS_TEST_EXPECT_MSG_EQ (std::memcmp (bytes, all + 6, 2), 0, "Bad read after the zero area");
 }
 
 /**
@@ -394,6 +481,7 @@ BufferTestSuite::BufferTestSuite ()
   : TestSuite ("buffer", UNIT)
 {
   AddTestCase (new BufferTest, TestCase::QUICK);
+  AddTestCase (new FixedHeaderLayoutTest, TestCase::QUICK);
 }
 
 static BufferTestSuite g_bufferTestSuite; //!< Static variable for test initialization
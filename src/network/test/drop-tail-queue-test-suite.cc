@@ -18,6 +18,7 @@
 
 #include "ns3/test.h"
 #include "ns3/drop-tail-queue.h"
+#include "ns3/ring-buffer.h"
 #include "ns3/string.h"
 
 using namespace ns3;
@@ -83,6 +84,56 @@ DropTailQueueTestCase::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ ((packet == 0), true, "There are really no packets in there");
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * RingBuffer unit tests: the elements must come out in FIFO order while
+ * the buffer wraps around and grows.
+ */
+class RingBufferTestCase : public TestCase
+{
+public:
+  RingBufferTestCase ();
+  virtual void DoRun (void);
+};
+
+RingBufferTestCase::RingBufferTestCase ()
+  : TestCase ("Check the FIFO order of the ring buffer across wrap-around and growth")
+{
+}
+
+void
+RingBufferTestCase::DoRun (void)
+{
+  RingBuffer<uint32_t> buffer;
+  NS_TEST_EXPECT_MSG_EQ (buffer.IsEmpty (), true, "New buffer not empty");
+
+  uint32_t pushed = 0;
+  uint32_t popped = 0;
+  // the occupancy oscillates between 0 and 40 elements
+  for (uint32_t round = 0; round < 20; round++)
+    {
+      while (buffer.GetSize () < 10 + 3 * (round % 11))
+        {
+          buffer.PushBack (pushed++);
+        }
+      NS_TEST_EXPECT_MSG_EQ (buffer.At (buffer.GetSize () - 1), pushed - 1, "Wrong last element");
+      while (buffer.GetSize () > round % 7)
+        {
+          NS_TEST_EXPECT_MSG_EQ (buffer.Front (), popped, "Wrong front element");
+          NS_TEST_EXPECT_MSG_EQ (buffer.PopFront (), popped, "Wrong popped element");
+          popped++;
+        }
+    }
+  NS_TEST_EXPECT_MSG_EQ (buffer.GetSize (), pushed - popped, "Wrong size");
+  NS_TEST_EXPECT_MSG_EQ (buffer.GetCapacity (), 64, "Buffer grown beyond the peak occupancy");
+
+  buffer.Clear ();
+  NS_TEST_EXPECT_MSG_EQ (buffer.IsEmpty (), true, "Cleared buffer not empty");
+  NS_TEST_EXPECT_MSG_EQ (buffer.GetCapacity (), 64, "Storage released by Clear");
+}
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -96,6 +147,7 @@ public:
     : TestSuite ("drop-tail-queue", UNIT)
   {
     AddTestCase (new DropTailQueueTestCase (), TestCase::QUICK);
+    AddTestCase (new RingBufferTestCase (), TestCase::QUICK);
   }
 };
 
@@ -859,6 +859,72 @@ PacketMetadataTest::DoRun (void)
   p2 = p->CreateFragment (6,535-6);
   p1->AddAtEnd (p2);
 
+  // Packets without any item hold no metadata storage; they must
+  // still accept items after being copied or concatenated.
+  p = Create<Packet> (0);
+  p1 = p->Copy ();
+  ADD_HEADER (p1, 2);
+  CHECK_HISTORY (p1, 1, 2);
+  p2 = Create<Packet> (0);
+  p2->AddAtEnd (p1);
+  CHECK_HISTORY (p2, 1, 2);
+  ADD_TRAILER (p, 3);
+  CHECK_HISTORY (p, 1, 3);
+  CHECK_HISTORY (p1, 1, 2);
+
+  // Header stacks are kept inline until the history is needed or
+  // they outgrow the inline items.
+  p = Create<Packet> (10);
+  ADD_HEADER (p, 1);
+  ADD_HEADER (p, 2);
+  ADD_TRAILER (p, 3);
+  ADD_HEADER (p, 4);
+  ADD_TRAILER (p, 5);
+  REM_TRAILER (p, 5);
+  REM_HEADER (p, 4);
+  ADD_HEADER (p, 6);
+  ADD_HEADER (p, 7);
+  ADD_TRAILER (p, 8);
+  ADD_HEADER (p, 9);
+  ADD_TRAILER (p, 11);
+  REM_TRAILER (p, 11);
+  CHECK_HISTORY (p, 8,
+                 9, 7, 6, 2, 1, 10, 3, 8);
+  p1 = p->Copy ();
+  REM_HEADER (p1, 9);
+  REM_TRAILER (p1, 8);
+  CHECK_HISTORY (p1, 6,
+                 7, 6, 2, 1, 10, 3);
+  CHECK_HISTORY (p, 8,
+                 9, 7, 6, 2, 1, 10, 3, 8);
+
+  p = Create<Packet> (10);
+  ADD_HEADER (p, 1);
+  ADD_HEADER (p, 2);
+  ADD_TRAILER (p, 3);
+  p1 = p->CreateFragment (2, 13);
+  CHECK_HISTORY (p1, 3, 1, 10, 2);
+  p2 = p->CreateFragment (3, 10);
+  CHECK_HISTORY (p2, 1, 10);
+  p3 = p->Copy ();
+  p3->AddAtEnd (p);
+  CHECK_HISTORY (p3, 8,
+                 2, 1, 10, 3, 2, 1, 10, 3);
+  REM_HEADER (p, 2);
+  REM_TRAILER (p, 3);
+  CHECK_HISTORY (p, 2, 1, 10);
+
+  // A copy sharing the materialized items of the other packet.
+  p = Create<Packet> (10);
+  ADD_HEADER (p, 1);
+  p1 = p->Copy ();
+  CHECK_HISTORY (p, 2, 1, 10);
+  REM_HEADER (p1, 1);
+  ADD_HEADER (p1, 2);
+  ADD_HEADER (p1, 3);
+  CHECK_HISTORY (p1, 3, 3, 2, 10);
+  CHECK_HISTORY (p, 2, 1, 10);
+
   /// \internal
   /// See \bugid{1072}
   p = Create<Packet> (reinterpret_cast<const uint8_t*> ("hello world"), 11);
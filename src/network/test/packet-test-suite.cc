@@ -1035,6 +1035,136 @@ PacketTagListTest::DoRun (void)
     
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Packet Tag list storage recycling unit tests.
+ */
+class PacketTagListPoolTest : public TestCase
+{
+public:
+  PacketTagListPoolTest ();
+private:
+  void DoRun (void);
+  /**
+   * Checks that a tag is in the list, with the expected data
+   * \param ptl The list to test
+   * \param t The tag to look for
+   * \param data The expected tag data
+   * \param msg Message
+   */
+  void CheckTag (const PacketTagList & ptl,
+                 ATestTagBase & t,
+                 uint8_t data,
+                 const char * msg);
+};
+
+PacketTagListPoolTest::PacketTagListPoolTest ()
+  : TestCase ("PacketTagListPoolTest: ")
+{
+}
+
+void
+PacketTagListPoolTest::CheckTag (const PacketTagList & ptl,
+                                 ATestTagBase & t,
+                                 uint8_t data,
+                                 const char * msg)
+{
+  bool found = ptl.Peek (t);
+  NS_TEST_EXPECT_MSG_EQ (found, true, msg << ": tag not found");
+  NS_TEST_EXPECT_MSG_EQ (t.GetData (), data, msg << ": wrong tag data");
+  NS_TEST_EXPECT_MSG_EQ (t.m_error, false, msg << ": corrupted tag content");
+}
+
+void
+PacketTagListPoolTest::DoRun (void)
+{
+  // ATestTag<N> serializes to N + 1 bytes: 1 and 19 are pooled,
+  // 20 is just above the pooled capacity and 40 well above it
+  NS_TEST_ASSERT_MSG_EQ (ATestTag<19> ().GetSerializedSize (), PACKET_TAG_LIST_POOLED_DATA_SIZE,
+                         "Largest pooled test tag does not match the pooled capacity");
+
+  PacketTagList ptl;
+  {
+    ATestTag<1> t1 (1);
+    ptl.Add (t1);
+  }
+  const struct PacketTagList::TagData *released = ptl.Head ();
+  {
+    ATestTag<1> t1;
+    ptl.Remove (t1);
+  }
+  NS_TEST_EXPECT_MSG_EQ ((ptl.Head () == 0), true, "Tag not removed");
+
+  {
+    // the released node is reused for any pooled size
+    ATestTag<19> t19 (19);
+    ptl.Add (t19);
+    NS_TEST_EXPECT_MSG_EQ (ptl.Head (), released, "Pooled node not recycled");
+    CheckTag (ptl, t19, 19, "Recycled node");
+  }
+
+  {
+    ATestTag<20> t20 (20);
+    ATestTag<40> t40 (40);
+    ATestTag<7> t7 (7);
+    ptl.Add (t20);
+    ptl.Add (t40);
+    ptl.Add (t7);
+  }
+  {
+    ATestTag<19> t19;
+    ATestTag<20> t20;
+    ATestTag<40> t40;
+    ATestTag<7> t7;
+    CheckTag (ptl, t19, 19, "Pooled tag among mixed sizes");
+    CheckTag (ptl, t20, 20, "Unpooled tag");
+    CheckTag (ptl, t40, 40, "Large unpooled tag");
+    CheckTag (ptl, t7, 7, "Pooled tag");
+
+    // remove and add back across the sizes, the nodes of the
+    // pooled tags must not keep stale content
+    ptl.Remove (t19);
+    ptl.Remove (t40);
+    ptl.Remove (t7);
+  }
+  {
+    ATestTag<3> t3 (3);
+    ATestTag<40> t40 (41);
+    ATestTag<19> t19 (42);
+    ptl.Add (t3);
+    ptl.Add (t40);
+    ptl.Add (t19);
+  }
+  {
+    ATestTag<3> t3;
+    ATestTag<19> t19;
+    ATestTag<20> t20;
+    ATestTag<40> t40;
+    ATestTag<7> t7;
+    CheckTag (ptl, t3, 3, "Pooled tag added after removals");
+    CheckTag (ptl, t19, 42, "Pooled tag added back");
+    CheckTag (ptl, t20, 20, "Unpooled tag kept");
+    CheckTag (ptl, t40, 41, "Unpooled tag added back");
+    NS_TEST_EXPECT_MSG_EQ (ptl.Peek (t7), false, "Removed tag found");
+  }
+
+  // copies share the nodes, which are only released with the last copy
+  PacketTagList copy (ptl);
+  ptl.RemoveAll ();
+  {
+    ATestTag<3> t3;
+    ATestTag<20> t20;
+    CheckTag (copy, t3, 3, "Tag of a copy");
+    CheckTag (copy, t20, 20, "Unpooled tag of a copy");
+    ATestTag<5> t5 (5);
+    ptl.Add (t5);
+    CheckTag (copy, t3, 3, "Tag of a copy after reuse");
+    CheckTag (ptl, t5, 5, "Tag added after RemoveAll");
+  }
+}
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -1052,6 +1182,7 @@ PacketTestSuite::PacketTestSuite ()
 {
   AddTestCase (new PacketTest, TestCase::QUICK);
   AddTestCase (new PacketTagListTest, TestCase::QUICK);
+  AddTestCase (new PacketTagListPoolTest, TestCase::QUICK);
 }
 
 static PacketTestSuite g_packetTestSuite; //!< Static variable for test initialization
@@ -21,10 +21,17 @@
 #include <cstdlib>
 #include <sstream>
 #include <cstring>
+#include <fstream>
+#include <iterator>
+#include <ctime>
+#include <thread>
+#include <chrono>
 
 #include "ns3/log.h"
 #include "ns3/test.h"
 #include "ns3/pcap-file.h"
+#include "ns3/pcapng-file.h"
+#include "ns3/packet.h"
 
 using namespace ns3;
 
@@ -1144,6 +1151,269 @@ DiffTestCase::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (usec, 3696, "Files are different from 2.3696 seconds");
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Test case to make sure that buffered writes, with or without
+ * a writer thread, produce the same file as unbuffered writes.
+ */
+class BufferedWriteTestCase : public TestCase
+{
+public:
+  BufferedWriteTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Write the known packets to a file, twice: from a data buffer and from
+   * a Packet.
+   * \param filename the file name
+   * \param chunkSize the size of the buffer chunks, unbuffered if zero
+   * \param background whether the chunks are written by a writer thread
+   */
+  void WriteFile (std::string filename, uint32_t chunkSize, bool background);
+  /**
+   * \param filename the file name
+   * \returns the content of the file
+   */
+  std::string ReadFile (std::string filename);
+};
+
+BufferedWriteTestCase::BufferedWriteTestCase ()
+  : TestCase ("Check that PcapFile buffered writes produce the same file as unbuffered writes")
+{
+}
+
+void
+BufferedWriteTestCase::WriteFile (std::string filename, uint32_t chunkSize, bool background)
+{
+  PcapFile f;
+  f.Open (filename, std::ios::out);
+  NS_TEST_ASSERT_MSG_EQ (f.Fail (), false, "Open (" << filename << ", \"std::ios::out\") returns error");
+  // Truncate the packets to check that only the captured bytes are written
+  f.Init (1, 24);
+  f.SetBuffering (chunkSize, background);
+
+  for (uint32_t i = 0; i < N_KNOWN_PACKETS; ++i)
+    {
+      PacketEntry const & p = knownPackets[i];
+      f.Write (p.tsSec, p.tsUsec, (uint8_t const *)p.data, sizeof (p.data));
+      f.Write (p.tsSec, p.tsUsec, Create<Packet> ((uint8_t const *)p.data, sizeof (p.data)));
+    }
+  NS_TEST_EXPECT_MSG_EQ (f.Fail (), false, "Write must not fail");
+
+  // A flush makes the packets written so far visible in the file
+  f.Flush ();
+  NS_TEST_EXPECT_MSG_EQ (CheckFileLength (filename, 24 + 2 * N_KNOWN_PACKETS * (16 + 24)), true,
+                         "Flush () did not write all the packets to the file");
+  f.Close ();
+}
+
+std::string
+BufferedWriteTestCase::ReadFile (std::string filename)
+{
+  std::ifstream file (filename.c_str (), std::ios::in | std::ios::binary);
+  return std::string (std::istreambuf_iterator<char> (file), std::istreambuf_iterator<char> ());
+}
+
+void
+BufferedWriteTestCase::DoRun (void)
+{
+  std::string unbuffered = CreateTempDirFilename ("unbuffered.pcap");
+  std::string buffered = CreateTempDirFilename ("buffered.pcap");
+  std::string background = CreateTempDirFilename ("background.pcap");
+
+  // The chunks are smaller than the records, and not a multiple of their size
+  WriteFile (unbuffered, 0, false);
+  WriteFile (buffered, 30, false);
+  WriteFile (background, 30, true);
+
+  std::string expected = ReadFile (unbuffered);
+  NS_TEST_EXPECT_MSG_EQ (expected.size (), 24 + 2 * N_KNOWN_PACKETS * (16 + 24), "Unexpected unbuffered file size");
+  NS_TEST_EXPECT_MSG_EQ ((ReadFile (buffered) == expected), true, "Buffered file differs from the unbuffered file");
+  NS_TEST_EXPECT_MSG_EQ ((ReadFile (background) == expected), true, "Background written file differs from the unbuffered file");
+
+  remove (unbuffered.c_str ());
+  remove (buffered.c_str ());
+  remove (background.c_str ());
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Test case to make sure that the writer thread of a buffered file
+ * sleeps while there is nothing to write.
+ */
+class IdleWriterTestCase : public TestCase
+{
+public:
+  IdleWriterTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+IdleWriterTestCase::IdleWriterTestCase ()
+  : TestCase ("Check that the PcapFile writer thread does not spin while idle")
+{
+}
+
+void
+IdleWriterTestCase::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("idle.pcap");
+  PcapFile f;
+  f.Open (filename, std::ios::out);
+  NS_TEST_ASSERT_MSG_EQ (f.Fail (), false, "Open (" << filename << ", \"std::ios::out\") returns error");
+  f.Init (1, 24);
+  f.SetBuffering (1024, true);
+
+  // Write several chunks, so that the writer thread is woken up several times
+  for (uint32_t j = 0; j < 10; ++j)
+    {
+      for (uint32_t i = 0; i < N_KNOWN_PACKETS; ++i)
+        {
+          PacketEntry const & p = knownPackets[i];
+          f.Write (p.tsSec, p.tsUsec, (uint8_t const *)p.data, sizeof (p.data));
+        }
+      f.Flush ();
+    }
+
+  // The processor time used by the process while this thread sleeps is
+  // the one used by the writer thread
+  std::clock_t start = std::clock ();
+  std::this_thread::sleep_for (std::chrono::milliseconds (300));
+  double cpu = static_cast<double> (std::clock () - start) / CLOCKS_PER_SEC;
+  NS_TEST_EXPECT_MSG_LT (cpu, 0.1, "The idle writer thread used " << cpu << " s of processor time");
+
+  f.Close ();
+  NS_TEST_EXPECT_MSG_EQ (CheckFileLength (filename, 24 + 10 * N_KNOWN_PACKETS * (16 + 24)), true,
+                         "The packets were not all written to the file");
+  remove (filename.c_str ());
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Test case to make sure that PcapNgFile writes the expected blocks.
+ */
+class PcapNgFileTestCase : public TestCase
+{
+public:
+  PcapNgFileTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \param data the file content
+   * \param offset the offset of the value
+   * \returns the 32-bit value at the offset
+   */
+  uint32_t GetU32 (std::string const &data, uint32_t offset);
+  /**
+   * \param data the file content
+   * \param offset the offset of the value
+   * \returns the 16-bit value at the offset
+   */
+  uint16_t GetU16 (std::string const &data, uint32_t offset);
+};
+
+PcapNgFileTestCase::PcapNgFileTestCase ()
+  : TestCase ("Check that PcapNgFile writes the expected blocks")
+{
+}
+
+uint32_t
+PcapNgFileTestCase::GetU32 (std::string const &data, uint32_t offset)
+{
+  uint32_t value;
+  std::memcpy (&value, data.data () + offset, sizeof (value));
+  return value;
+}
+
+uint16_t
+PcapNgFileTestCase::GetU16 (std::string const &data, uint32_t offset)
+{
+  uint16_t value;
+  std::memcpy (&value, data.data () + offset, sizeof (value));
+  return value;
+}
+
+void
+PcapNgFileTestCase::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("test.pcapng");
+  {
+    PcapNgFile f;
+    f.Open (filename);
+    NS_TEST_ASSERT_MSG_EQ (f.Fail (), false, "Open (" << filename << ") returns error");
+    NS_TEST_EXPECT_MSG_EQ (f.AddInterface ("0-0", 9), 0, "Unexpected index of the first interface");
+    NS_TEST_EXPECT_MSG_EQ (f.AddInterface ("0-1", 1, 8), 1, "Unexpected index of the second interface");
+    NS_TEST_EXPECT_MSG_EQ (f.GetNInterfaces (), 2, "Unexpected number of interfaces");
+
+    PacketEntry const & p = knownPackets[0];
+    f.Write (0, 3000000001ULL, (uint8_t const *)p.data, 10);
+    f.Write (1, 3000000002ULL, Create<Packet> ((uint8_t const *)p.data, sizeof (p.data)), "MacTxDrop");
+    NS_TEST_EXPECT_MSG_EQ (f.Fail (), false, "Write must not fail");
+  }
+
+  std::ifstream file (filename.c_str (), std::ios::in | std::ios::binary);
+  std::string data ((std::istreambuf_iterator<char> (file)), std::istreambuf_iterator<char> ());
+
+  //
+  // Walk through the blocks, checking that their lengths are consistent
+  //
+  std::vector<uint32_t> offsets;
+  uint32_t offset = 0;
+  while (offset + 12 <= data.size ())
+    {
+      uint32_t length = GetU32 (data, offset + 4);
+      NS_TEST_ASSERT_MSG_EQ (length % 4, 0, "Block length is not a multiple of 4");
+      NS_TEST_ASSERT_MSG_LT_OR_EQ (offset + length, data.size (), "Block exceeds the file");
+      NS_TEST_EXPECT_MSG_EQ (GetU32 (data, offset + length - 4), length, "Trailing block length differs");
+      offsets.push_back (offset);
+      offset += length;
+    }
+  NS_TEST_EXPECT_MSG_EQ (offset, data.size (), "Unexpected trailing bytes");
+  NS_TEST_ASSERT_MSG_EQ (offsets.size (), 5, "Expected one SHB, two IDBs and two EPBs");
+
+  NS_TEST_EXPECT_MSG_EQ (GetU32 (data, 0), 0x0a0d0d0a, "First block is not a SHB");
+  NS_TEST_EXPECT_MSG_EQ (GetU32 (data, 8), 0x1a2b3c4d, "Wrong byte order magic");
+
+  uint32_t idb = offsets[2];
+  NS_TEST_EXPECT_MSG_EQ (GetU32 (data, idb), 1, "Third block is not an IDB");
+  NS_TEST_EXPECT_MSG_EQ (GetU16 (data, idb + 8), 1, "Wrong data link type");
+  NS_TEST_EXPECT_MSG_EQ (GetU32 (data, idb + 12), 8, "Wrong snap length");
+  NS_TEST_EXPECT_MSG_EQ (GetU16 (data, idb + 16), 2, "First option is not if_name");
+  NS_TEST_EXPECT_MSG_EQ (data.substr (idb + 20, GetU16 (data, idb + 18)), "0-1", "Wrong interface name");
+  NS_TEST_EXPECT_MSG_EQ (GetU16 (data, idb + 24), 9, "Second option is not if_tsresol");
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t) (uint8_t) data[idb + 28], 9, "Timestamps are not in nanoseconds");
+
+  uint32_t epb = offsets[3];
+  NS_TEST_EXPECT_MSG_EQ (GetU32 (data, epb), 6, "Fourth block is not an EPB");
+  NS_TEST_EXPECT_MSG_EQ (GetU32 (data, epb + 4), 44, "A 10-byte packet without comment takes 44 bytes");
+  NS_TEST_EXPECT_MSG_EQ (GetU32 (data, epb + 8), 0, "Wrong interface index");
+  uint64_t ts = ((uint64_t) GetU32 (data, epb + 12) << 32) | GetU32 (data, epb + 16);
+  NS_TEST_EXPECT_MSG_EQ (ts, 3000000001ULL, "Wrong timestamp");
+  NS_TEST_EXPECT_MSG_EQ (GetU32 (data, epb + 20), 10, "Wrong captured length");
+  NS_TEST_EXPECT_MSG_EQ (GetU32 (data, epb + 24), 10, "Wrong original length");
+
+  epb = offsets[4];
+  NS_TEST_EXPECT_MSG_EQ (GetU32 (data, epb + 8), 1, "Wrong interface index");
+  NS_TEST_EXPECT_MSG_EQ (GetU32 (data, epb + 20), 8, "The packet is not truncated to the snap length");
+  NS_TEST_EXPECT_MSG_EQ (GetU32 (data, epb + 24), sizeof (knownPackets[0].data), "Wrong original length");
+  NS_TEST_EXPECT_MSG_EQ (std::memcmp (data.data () + epb + 28, knownPackets[0].data, 8), 0, "Wrong packet data");
+  NS_TEST_EXPECT_MSG_EQ (GetU16 (data, epb + 36), 1, "The option is not a comment");
+  NS_TEST_EXPECT_MSG_EQ (data.substr (epb + 40, GetU16 (data, epb + 38)), "MacTxDrop", "Wrong comment");
+
+  remove (filename.c_str ());
+}
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -1167,6 +1437,9 @@ PcapFileTestSuite::PcapFileTestSuite ()
   AddTestCase (new RecordHeaderTestCase, TestCase::QUICK);
   AddTestCase (new ReadFileTestCase, TestCase::QUICK);
   AddTestCase (new DiffTestCase, TestCase::QUICK);
+  AddTestCase (new BufferedWriteTestCase, TestCase::QUICK);
+  AddTestCase (new IdleWriterTestCase, TestCase::QUICK);
+  AddTestCase (new PcapNgFileTestCase, TestCase::QUICK);
 }
 
 static PcapFileTestSuite pcapFileTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,438 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstring>
+#include <cstdlib>
+#include "ns3/abort.h"
+#include "ns3/fatal-impl.h"
+#include "ns3/log.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+#include "binary-trace.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("BinaryTrace");
+
+const uint32_t BINARY_TRACE_MAGIC = 0x4e533342;  /**< Magic number identifying a binary trace file ("NS3B") */
+const uint16_t BINARY_TRACE_VERSION = 1;         /**< Version of the binary trace file format */
+const uint16_t BINARY_TRACE_PACKETS = 1;         /**< Flag of the files storing the packets */
+
+/**
+ * \ingroup network
+ * The kinds of the records of a binary trace file
+ */
+enum BinaryTraceRecordKind
+{
+  STRING_RECORD = 1,  //!< A string, whose id is the number of strings before it
+  TEXT_RECORD = 2,    //!< A line of text
+  EVENT_RECORD = 3    //!< A packet event
+};
+
+BinaryTraceWriter::TextBuffer::TextBuffer (BinaryTraceWriter *writer)
+  : m_writer (writer)
+{
+}
+
+BinaryTraceWriter::TextBuffer::int_type
+BinaryTraceWriter::TextBuffer::overflow (int_type c)
+{
+  if (c == traits_type::eof ())
+    {
+      return traits_type::not_eof (c);
+    }
+  if (c == '\n')
+    {
+      m_writer->WriteText (m_line);
+      m_line.clear ();
+    }
+  else
+    {
+      m_line.push_back (traits_type::to_char_type (c));
+    }
+  return c;
+}
+
+std::streamsize
+BinaryTraceWriter::TextBuffer::xsputn (const char *s, std::streamsize n)
+{
+  for (std::streamsize i = 0; i < n; i++)
+    {
+      overflow (traits_type::to_int_type (s[i]));
+    }
+  return n;
+}
+
+int
+BinaryTraceWriter::TextBuffer::sync (void)
+{
+  return 0;
+}
+
+BinaryTraceWriter::FatalBuffer::FatalBuffer (BinaryTraceWriter *writer)
+  : m_writer (writer)
+{
+}
+
+int
+BinaryTraceWriter::FatalBuffer::sync (void)
+{
+  m_writer->Flush ();
+  return 0;
+}
+
+BinaryTraceWriter::BinaryTraceWriter (std::string filename, bool packets)
+  : m_packets (packets),
+    m_buffer (BUFFER_SIZE),
+    m_used (0),
+    m_nStrings (1),
+    m_textBuffer (this),
+    m_text (&m_textBuffer),
+    m_fatalBuffer (this),
+    m_fatal (&m_fatalBuffer)
+{
+  NS_LOG_FUNCTION (this << filename << packets);
+  m_file.open (filename.c_str (), std::ios::out | std::ios::binary);
+  NS_ABORT_MSG_UNLESS (m_file.is_open (), "BinaryTraceWriter::BinaryTraceWriter():  " <<
+                       "Unable to Open " << filename);
+
+  Append (BINARY_TRACE_MAGIC);
+  Append (BINARY_TRACE_VERSION);
+  Append<uint16_t> (packets ? BINARY_TRACE_PACKETS : 0);
+  FatalImpl::RegisterStream (&m_fatal);
+}
+
+BinaryTraceWriter::~BinaryTraceWriter ()
+{
+  NS_LOG_FUNCTION (this);
+  FatalImpl::UnregisterStream (&m_fatal);
+  Flush ();
+  m_file.close ();
+}
+
+std::ostream *
+BinaryTraceWriter::GetTextStream (void)
+{
+  return &m_text;
+}
+
+void
+BinaryTraceWriter::Flush (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_file.write ((const char *)m_buffer.data (), m_used);
+  m_file.flush ();
+  m_used = 0;
+}
+
+uint8_t *
+BinaryTraceWriter::Reserve (uint32_t size)
+{
+  if (m_used + size > m_buffer.size ())
+    {
+      Flush ();
+      if (size > m_buffer.size ())
+        {
+          m_buffer.resize (size);
+        }
+    }
+  uint8_t *data = m_buffer.data () + m_used;
+  m_used += size;
+  return data;
+}
+
+template <typename T>
+void
+BinaryTraceWriter::Append (T value)
+{
+  std::memcpy (Reserve (sizeof (value)), &value, sizeof (value));
+}
+
+uint32_t
+BinaryTraceWriter::AddString (std::string const &str)
+{
+  NS_LOG_FUNCTION (this << str);
+  Append<uint8_t> (STRING_RECORD);
+  Append<uint32_t> (str.size ());
+  std::memcpy (Reserve (str.size ()), str.data (), str.size ());
+  return m_nStrings++;
+}
+
+void
+BinaryTraceWriter::WriteText (std::string const &text)
+{
+  Append<uint8_t> (TEXT_RECORD);
+  Append<uint32_t> (text.size ());
+  std::memcpy (Reserve (text.size ()), text.data (), text.size ());
+}
+
+const BinaryTraceWriter::Context &
+BinaryTraceWriter::GetContext (std::string const &context)
+{
+  std::unordered_map<std::string, Context>::iterator it = m_contexts.find (context);
+  if (it != m_contexts.end ())
+    {
+      return it->second;
+    }
+
+  //
+  // Contexts are of the form /NodeList/<node>/DeviceList/<device>/...
+  //
+  Context fields;
+  fields.id = (context.empty () ? 0 : AddString (context));
+  fields.node = BinaryTraceReader::NO_ID;
+  fields.device = BinaryTraceReader::NO_ID;
+  std::string::size_type pos = context.find ("/NodeList/");
+  if (pos != std::string::npos)
+    {
+      fields.node = std::strtoul (context.c_str () + pos + 10, 0, 10);
+    }
+  pos = context.find ("/DeviceList/");
+  if (pos != std::string::npos)
+    {
+      fields.device = std::strtoul (context.c_str () + pos + 12, 0, 10);
+    }
+  return m_contexts.insert (std::make_pair (context, fields)).first->second;
+}
+
+uint32_t
+BinaryTraceWriter::GetSummary (Ptr<const Packet> p)
+{
+  m_headers.clear ();
+  PacketMetadata::ItemIterator i = p->BeginItem ();
+  while (i.HasNext ())
+    {
+      PacketMetadata::Item item = i.Next ();
+      if (item.type != PacketMetadata::Item::PAYLOAD)
+        {
+          m_headers.push_back (item.tid.GetUid ());
+        }
+    }
+  if (m_headers.empty ())
+    {
+      return 0;
+    }
+
+  std::map<std::vector<uint16_t>, uint32_t>::iterator it = m_summaries.find (m_headers);
+  if (it != m_summaries.end ())
+    {
+      return it->second;
+    }
+  std::string summary;
+  for (std::vector<uint16_t>::iterator j = m_headers.begin (); j != m_headers.end (); j++)
+    {
+      TypeId tid;
+      tid.SetUid (*j);
+      summary += (summary.empty () ? "" : " ") + tid.GetName ();
+    }
+  uint32_t id = AddString (summary);
+  m_summaries.insert (std::make_pair (m_headers, id));
+  return id;
+}
+
+void
+BinaryTraceWriter::Write (EventType type, std::string const &context, Ptr<const Packet> p)
+{
+  NS_LOG_FUNCTION (this << type << context << p);
+
+  // The strings must be written before the record using them
+  const Context &fields = GetContext (context);
+  uint32_t summary = GetSummary (p);
+
+  uint32_t serializedSize = 0;
+  if (m_packets)
+    {
+      serializedSize = (p->GetSerializedSize () + 3) & ~3;
+      m_serialized.resize (serializedSize / 4);
+      if (!p->Serialize (reinterpret_cast<uint8_t *> (m_serialized.data ()), serializedSize))
+        {
+          NS_LOG_WARN ("Unable to serialize packet " << p->GetUid ());
+          serializedSize = 0;
+        }
+    }
+
+  Append<uint8_t> (EVENT_RECORD);
+  Append<uint8_t> (type);
+  Append<int64_t> (Simulator::Now ().GetNanoSeconds ());
+  Append<uint32_t> (fields.id);
+  Append<uint32_t> (fields.node);
+  Append<uint32_t> (fields.device);
+  Append<uint64_t> (p->GetUid ());
+  Append<uint32_t> (p->GetSize ());
+  Append<uint32_t> (summary);
+  Append<uint32_t> (serializedSize);
+  if (serializedSize > 0)
+    {
+      std::memcpy (Reserve (serializedSize), m_serialized.data (), serializedSize);
+    }
+}
+
+
+BinaryTraceReader::BinaryTraceReader (std::string filename)
+  : m_fail (false)
+{
+  NS_LOG_FUNCTION (this << filename);
+  m_file.open (filename.c_str (), std::ios::in | std::ios::binary);
+  m_strings.push_back ("");
+
+  uint32_t magic = 0;
+  uint16_t version = 0;
+  uint16_t flags;
+  ReadValue (magic);
+  ReadValue (version);
+  ReadValue (flags);
+  if (m_file.fail () || magic != BINARY_TRACE_MAGIC || version != BINARY_TRACE_VERSION)
+    {
+      m_fail = true;
+    }
+}
+
+bool
+BinaryTraceReader::Fail (void) const
+{
+  return m_fail;
+}
+
+template <typename T>
+void
+BinaryTraceReader::ReadValue (T &value)
+{
+  m_file.read ((char *)&value, sizeof (value));
+}
+
+std::string const &
+BinaryTraceReader::GetString (uint32_t id)
+{
+  if (id >= m_strings.size ())
+    {
+      m_fail = true;
+      return m_strings[0];
+    }
+  return m_strings[id];
+}
+
+bool
+BinaryTraceReader::Read (Record &record)
+{
+  NS_LOG_FUNCTION (this);
+  while (!m_fail)
+    {
+      uint8_t kind;
+      ReadValue (kind);
+      if (m_file.eof ())
+        {
+          return false;
+        }
+
+      if (kind == STRING_RECORD || kind == TEXT_RECORD)
+        {
+          uint32_t size = 0;
+          ReadValue (size);
+          std::string str (size, '\0');
+          m_file.read (&str[0], size);
+          if (kind == STRING_RECORD)
+            {
+              m_strings.push_back (str);
+              continue;
+            }
+          record = Record ();
+          record.type = 0;
+          record.text = str;
+        }
+      else if (kind == EVENT_RECORD)
+        {
+          uint8_t type;
+          uint32_t context, summary, serializedSize;
+          ReadValue (type);
+          record.type = type;
+          ReadValue (record.ts);
+          ReadValue (context);
+          ReadValue (record.node);
+          ReadValue (record.device);
+          ReadValue (record.uid);
+          ReadValue (record.size);
+          ReadValue (summary);
+          ReadValue (serializedSize);
+          record.context = GetString (context);
+          record.summary = GetString (summary);
+          record.text.clear ();
+          record.packet = 0;
+          if (serializedSize > 0)
+            {
+              std::vector<uint32_t> serialized ((serializedSize + 3) / 4);
+              m_file.read ((char *)serialized.data (), serializedSize);
+              record.packet = Create<Packet> (reinterpret_cast<const uint8_t *> (serialized.data ()),
+                                              serializedSize, true);
+            }
+        }
+      else
+        {
+          m_fail = true;
+          break;
+        }
+
+      if (m_file.fail ())
+        {
+          m_fail = true;
+          break;
+        }
+      return true;
+    }
+  return false;
+}
+
+void
+BinaryTraceReader::Print (Record const &record, std::ostream &os)
+{
+  if (record.type == 0)
+    {
+      os << record.text << std::endl;
+      return;
+    }
+
+  os << record.type << " " << NanoSeconds (record.ts).GetSeconds () << " ";
+  if (!record.context.empty ())
+    {
+      os << record.context << " ";
+    }
+  if (record.packet != 0)
+    {
+      os << *record.packet << std::endl;
+    }
+  else
+    {
+      if (!record.summary.empty ())
+        {
+          os << record.summary << " ";
+        }
+      os << "(size=" << record.size << ")" << std::endl;
+    }
+}
+
+bool
+BinaryTraceReader::Decode (std::string filename, std::ostream &os)
+{
+  NS_LOG_FUNCTION (filename << &os);
+  BinaryTraceReader reader (filename);
+  Record record;
+  while (reader.Read (record))
+    {
+      Print (record, os);
+    }
+  return !reader.Fail ();
+}
+
+} // namespace ns3
@@ -0,0 +1,302 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef BINARY_TRACE_H
+#define BINARY_TRACE_H
+
+#include <string>
+#include <fstream>
+#include <streambuf>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <stdint.h>
+#include "ns3/ptr.h"
+
+namespace ns3 {
+
+class Packet;
+
+/**
+ * \ingroup network
+ * \brief Writer of a binary trace file, the compact alternative to the
+ * ascii trace files
+ *
+ * The ascii trace sinks format every event as text, including the printing
+ * of all the packet headers.  A binary trace file holds instead a fixed-size
+ * record per event (the time, the node and device ids, the event type, the
+ * packet uid and size, and a header summary), the strings of the records
+ * (the trace contexts and the header summaries) being written once, the
+ * first time they are used.  The header summary lists the names of the
+ * headers and trailers of the packet, as found in its metadata, without
+ * printing them.  The records are appended to an in-memory buffer, written
+ * to the file when full.
+ *
+ * Optionally, the packets themselves, with their metadata, are stored along
+ * with the records, so that BinaryTraceReader can reproduce the ascii trace
+ * file exactly.
+ *
+ * The text written to the stream returned by GetTextStream, for instance by
+ * the trace sinks which know nothing about binary traces, is stored as text
+ * records, one per line.  Flushing this stream does not write the
+ * buffered records to the file, except when a fatal error flushes the
+ * streams registered with FatalImpl.
+ *
+ * A binary trace file is usually created by
+ * AsciiTraceHelper::CreateBinaryFileStream, and the binary trace writer is
+ * then used by the default ascii trace sinks.
+ */
+class BinaryTraceWriter
+{
+public:
+  /**
+   * The types of the events, as written in the ascii trace files
+   */
+  enum EventType
+  {
+    ENQUEUE = '+',
+    DEQUEUE = '-',
+    DROP = 'd',
+    RECEIVE = 'r'
+  };
+
+  /**
+   * Create a binary trace file.
+   *
+   * \param filename the file name
+   * \param packets whether the packets are stored along with the records
+   */
+  BinaryTraceWriter (std::string filename, bool packets = false);
+  /**
+   * Write the buffered records and close the file.
+   */
+  ~BinaryTraceWriter ();
+
+  /**
+   * \brief Write an event record
+   *
+   * \param type the event type
+   * \param context the trace context, empty if none
+   * \param p the packet
+   */
+  void Write (EventType type, std::string const &context, Ptr<const Packet> p);
+
+  /**
+   * \returns the stream whose lines are written as text records
+   */
+  std::ostream *GetTextStream (void);
+
+  /**
+   * Write the buffered records to the file.
+   */
+  void Flush (void);
+
+private:
+  /**
+   * \brief The buffer of the text stream, writing a text record per line
+   */
+  class TextBuffer : public std::streambuf
+  {
+  public:
+    /**
+     * \param writer the binary trace writer
+     */
+    TextBuffer (BinaryTraceWriter *writer);
+
+  protected:
+    virtual int_type overflow (int_type c);
+    virtual std::streamsize xsputn (const char *s, std::streamsize n);
+    /**
+     * Keep the records buffered: the trace sinks end every line with
+     * std::endl, which would otherwise write the file for each record.
+     * \returns zero
+     */
+    virtual int sync (void);
+
+  private:
+    BinaryTraceWriter *m_writer;  //!< the binary trace writer
+    std::string m_line;           //!< the line being written
+  };
+
+  /**
+   * \brief The buffer of the stream registered with FatalImpl, writing
+   * the buffered records to the file when flushed
+   */
+  class FatalBuffer : public std::streambuf
+  {
+  public:
+    /**
+     * \param writer the binary trace writer
+     */
+    FatalBuffer (BinaryTraceWriter *writer);
+
+  protected:
+    /**
+     * Write the buffered records to the file.
+     * \returns zero
+     */
+    virtual int sync (void);
+
+  private:
+    BinaryTraceWriter *m_writer;  //!< the binary trace writer
+  };
+
+  /**
+   * \brief The fields of a trace context
+   */
+  struct Context
+  {
+    uint32_t id;      //!< the string id of the context
+    uint32_t node;    //!< the node id found in the context
+    uint32_t device;  //!< the device id found in the context
+  };
+
+  /**
+   * \param size the number of bytes to append
+   * \returns a pointer to the bytes appended to the buffer
+   */
+  uint8_t *Reserve (uint32_t size);
+  /**
+   * \param value the value to append to the buffer
+   */
+  template <typename T>
+  void Append (T value);
+  /**
+   * Write a string record.
+   * \param str the string
+   * \returns the string id
+   */
+  uint32_t AddString (std::string const &str);
+  /**
+   * Write a text record.
+   * \param text the text
+   */
+  void WriteText (std::string const &text);
+  /**
+   * \param context the trace context
+   * \returns the fields of the context, parsed the first time it is used
+   */
+  const Context &GetContext (std::string const &context);
+  /**
+   * \param p the packet
+   * \returns the string id of the header summary of the packet
+   */
+  uint32_t GetSummary (Ptr<const Packet> p);
+
+  static const uint32_t BUFFER_SIZE = 65536;  //!< size of the write buffer
+
+  std::ofstream m_file;                       //!< the file
+  bool m_packets;                             //!< whether the packets are stored
+  std::vector<uint8_t> m_buffer;              //!< the write buffer
+  uint32_t m_used;                            //!< number of bytes used in the write buffer
+  uint32_t m_nStrings;                        //!< number of strings written
+  std::unordered_map<std::string, Context> m_contexts;            //!< the contexts seen
+  std::map<std::vector<uint16_t>, uint32_t> m_summaries;          //!< the header summaries seen, by header type uids
+  std::vector<uint16_t> m_headers;            //!< the header type uids of the current packet
+  std::vector<uint32_t> m_serialized;         //!< the serialized packet, 32-bit aligned
+  TextBuffer m_textBuffer;                    //!< the buffer of the text stream
+  std::ostream m_text;                        //!< the text stream
+  FatalBuffer m_fatalBuffer;                  //!< the buffer of the fatal error stream
+  std::ostream m_fatal;                       //!< the stream flushed on fatal errors
+};
+
+/**
+ * \ingroup network
+ * \brief Reader of a binary trace file
+ *
+ * The reader decodes the records written by BinaryTraceWriter and prints
+ * them in the format of the ascii trace files.  The events are printed
+ * exactly as by the default ascii trace sinks if the packets were stored;
+ * otherwise, the packet is replaced by its header summary and its size.
+ */
+class BinaryTraceReader
+{
+public:
+  /**
+   * \brief A decoded event record
+   */
+  struct Record
+  {
+    char type;              //!< the event type, as in the ascii trace files
+    int64_t ts;             //!< the time of the event, in nanoseconds
+    std::string context;    //!< the trace context, empty if none
+    uint32_t node;          //!< the node id, or NO_ID
+    uint32_t device;        //!< the device id, or NO_ID
+    uint64_t uid;           //!< the packet uid
+    uint32_t size;          //!< the packet size
+    std::string summary;    //!< the header summary of the packet
+    Ptr<Packet> packet;     //!< the packet, if stored
+    std::string text;       //!< the line of a text record, without the end of line
+  };
+
+  static const uint32_t NO_ID = 0xffffffff;  //!< node or device id of the events without context
+
+  /**
+   * Open a binary trace file.
+   * \param filename the file name
+   */
+  BinaryTraceReader (std::string filename);
+
+  /**
+   * \returns true if the file is not a binary trace file or a read failed
+   */
+  bool Fail (void) const;
+
+  /**
+   * \brief Read the next event or text record
+   *
+   * \param [out] record the record; for a text record, only the text is set
+   * and the type is zero
+   * \returns false at the end of the file
+   */
+  bool Read (Record &record);
+
+  /**
+   * Print a record in the format of the ascii trace files.
+   * \param record the record
+   * \param os the output stream
+   */
+  static void Print (Record const &record, std::ostream &os);
+
+  /**
+   * Print all the records of a binary trace file in the format of the
+   * ascii trace files.
+   * \param filename the file name of the binary trace file
+   * \param os the output stream
+   * \returns false if the file is not a valid binary trace file
+   */
+  static bool Decode (std::string filename, std::ostream &os);
+
+private:
+  /**
+   * \param value [out] the value read from the file
+   */
+  template <typename T>
+  void ReadValue (T &value);
+  /**
+   * \param id the string id
+   * \returns the string
+   */
+  std::string const &GetString (uint32_t id);
+
+  std::ifstream m_file;                 //!< the file
+  bool m_fail;                          //!< whether the file is invalid
+  std::vector<std::string> m_strings;   //!< the strings read so far
+};
+
+} // namespace ns3
+
+#endif /* BINARY_TRACE_H */
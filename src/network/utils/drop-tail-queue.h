@@ -20,6 +20,7 @@
 #define DROPTAIL_H
 
 #include "ns3/queue.h"
+#include "ns3/ring-buffer.h"
 
 namespace ns3 {
 
@@ -27,6 +28,10 @@ namespace ns3 {
  * \ingroup queue
  *
  * \brief A FIFO packet queue that drops tail-end packets on overflow
+ *
+ * The items are stored in a RingBuffer, so that, once the buffer has grown
+ * to the peak occupancy of the queue, enqueuing and dequeuing items do not
+ * allocate memory.
  */
 template <typename Item>
 class DropTailQueue : public Queue<Item>
@@ -52,13 +57,12 @@ public:
   virtual Ptr<const Item> Peek (void) const;
 
 private:
-  using Queue<Item>::Head;
-  using Queue<Item>::Tail;
-  using Queue<Item>::DoEnqueue;
-  using Queue<Item>::DoDequeue;
-  using Queue<Item>::DoRemove;
-  using Queue<Item>::DoPeek;
+  using Queue<Item>::PrepareEnqueue;
+  using Queue<Item>::NotifyEnqueue;
+  using Queue<Item>::NotifyDequeue;
+  using Queue<Item>::NotifyRemove;
 
+  RingBuffer<Ptr<Item> > m_items;  //!< the items in the queue
   NS_LOG_TEMPLATE_DECLARE;     //!< redefinition of the log component
 };
 
@@ -99,7 +103,15 @@ DropTailQueue<Item>::Enqueue (Ptr<Item> item)
 {
   NS_LOG_FUNCTION (this << item);
 
-  return DoEnqueue (Tail (), item);
+  if (!PrepareEnqueue (item))
+    {
+      return false;
+    }
+
+  m_items.PushBack (item);
+  NotifyEnqueue (item);
+
+  return true;
 }
 
 template <typename Item>
@@ -108,7 +120,14 @@ DropTailQueue<Item>::Dequeue (void)
 {
   NS_LOG_FUNCTION (this);
 
-  Ptr<Item> item = DoDequeue (Head ());
+  if (m_items.IsEmpty ())
+    {
+      NS_LOG_LOGIC ("Queue empty");
+      return 0;
+    }
+
+  Ptr<Item> item = m_items.PopFront ();
+  NotifyDequeue (item);
 
   NS_LOG_LOGIC ("Popped " << item);
 
@@ -121,7 +140,14 @@ DropTailQueue<Item>::Remove (void)
 {
   NS_LOG_FUNCTION (this);
 
-  Ptr<Item> item = DoRemove (Head ());
+  if (m_items.IsEmpty ())
+    {
+      NS_LOG_LOGIC ("Queue empty");
+      return 0;
+    }
+
+  Ptr<Item> item = m_items.PopFront ();
+  NotifyRemove (item);
 
   NS_LOG_LOGIC ("Removed " << item);
 
@@ -134,7 +160,13 @@ DropTailQueue<Item>::Peek (void) const
 {
   NS_LOG_FUNCTION (this);
 
-  return DoPeek (Head ());
+  if (m_items.IsEmpty ())
+    {
+      NS_LOG_LOGIC ("Queue empty");
+      return 0;
+    }
+
+  return m_items.Front ();
 }
 
 } // namespace ns3
@@ -20,6 +20,7 @@
 #include "ns3/log.h"
 #include "ns3/fatal-impl.h"
 #include "ns3/abort.h"
+#include "binary-trace.h"
 #include <fstream>
 
 namespace ns3 {
@@ -27,7 +28,8 @@ namespace ns3 {
 NS_LOG_COMPONENT_DEFINE ("OutputStreamWrapper");
 
 OutputStreamWrapper::OutputStreamWrapper (std::string filename, std::ios::openmode filemode)
-  : m_destroyable (true)
+  : m_destroyable (true),
+    m_binaryTraceWriter (0)
 {
   NS_LOG_FUNCTION (this << filename << filemode);
   std::ofstream* os = new std::ofstream ();
@@ -39,19 +41,28 @@ OutputStreamWrapper::OutputStreamWrapper (std::string filename, std::ios::openmo
 }
 
 OutputStreamWrapper::OutputStreamWrapper (std::ostream* os)
-  : m_ostream (os), m_destroyable (false)
+  : m_ostream (os), m_destroyable (false), m_binaryTraceWriter (0)
 {
   NS_LOG_FUNCTION (this << os);
   FatalImpl::RegisterStream (m_ostream);
   NS_ABORT_MSG_UNLESS (m_ostream->good (), "Output stream is not valid for writing.");
 }
 
+OutputStreamWrapper::OutputStreamWrapper (BinaryTraceWriter* writer)
+  : m_ostream (writer->GetTextStream ()), m_destroyable (false), m_binaryTraceWriter (writer)
+{
+  NS_LOG_FUNCTION (this << writer);
+  FatalImpl::RegisterStream (m_ostream);
+}
+
 OutputStreamWrapper::~OutputStreamWrapper ()
 {
   NS_LOG_FUNCTION (this);
   FatalImpl::UnregisterStream (m_ostream);
   if (m_destroyable) delete m_ostream;
   m_ostream = 0;
+  delete m_binaryTraceWriter;
+  m_binaryTraceWriter = 0;
 }
 
 std::ostream *
@@ -61,4 +72,10 @@ OutputStreamWrapper::GetStream (void)
   return m_ostream;
 }
 
+BinaryTraceWriter *
+OutputStreamWrapper::GetBinaryTraceWriter (void)
+{
+  return m_binaryTraceWriter;
+}
+
 } // namespace ns3
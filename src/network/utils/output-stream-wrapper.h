@@ -26,6 +26,8 @@
 
 namespace ns3 {
 
+class BinaryTraceWriter;
+
 /**
  * @brief A class encapsulating an output stream.
  *
@@ -81,6 +83,12 @@ public:
    * \param os output stream
    */
   OutputStreamWrapper (std::ostream* os);
+  /**
+   * Constructor of a wrapper writing a binary trace file.  The stream of
+   * the wrapper is the text stream of the writer.
+   * \param writer binary trace writer, deleted with the wrapper
+   */
+  OutputStreamWrapper (BinaryTraceWriter* writer);
   ~OutputStreamWrapper ();
 
   /**
@@ -92,9 +100,18 @@ public:
    */
   std::ostream *GetStream (void);
 
+  /**
+   * Return the binary trace writer of the wrapper, if any.  The default
+   * ascii trace sinks write binary records through it.
+   *
+   * \returns a pointer to the binary trace writer, or 0
+   */
+  BinaryTraceWriter *GetBinaryTraceWriter (void);
+
 private:
   std::ostream *m_ostream; //!< The output stream
   bool m_destroyable; //!< Can be destroyed
+  BinaryTraceWriter *m_binaryTraceWriter; //!< The binary trace writer, if any
 };
 
 } // namespace ns3
@@ -46,12 +46,24 @@ PcapFileWrapper::GetTypeId (void)
                    BooleanValue (false),
                    MakeBooleanAccessor (&PcapFileWrapper::m_nanosecMode),
                    MakeBooleanChecker())
+    .AddAttribute ("ChunkSize",
+                   "Size in bytes of the in-memory chunks the packets are buffered in "
+                   "before being written to the file. Packets are written one by one if zero.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&PcapFileWrapper::m_chunkSize),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("BackgroundWrite",
+                   "Whether the buffered chunks are written to the file by a writer thread.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&PcapFileWrapper::m_backgroundWrite),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
 
 
 PcapFileWrapper::PcapFileWrapper ()
+  : m_ngInterface (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -66,6 +78,10 @@ bool
 PcapFileWrapper::Fail (void) const
 {
   NS_LOG_FUNCTION (this);
+  if (m_ngFile != 0)
+    {
+      return m_ngFile->Fail ();
+    }
   return m_file.Fail ();
 }
 
@@ -89,6 +105,13 @@ PcapFileWrapper::Close (void)
   m_file.Close ();
 }
 
+void
+PcapFileWrapper::Flush (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_file.Flush ();
+}
+
 void
 PcapFileWrapper::Open (std::string const &filename, std::ios::openmode mode)
 {
@@ -113,12 +136,30 @@ PcapFileWrapper::Init (uint32_t dataLinkType, uint32_t snapLen, int32_t tzCorrec
     {
       m_file.Init (dataLinkType, m_snapLen, tzCorrection, false, m_nanosecMode);
     } 
+  if (m_chunkSize > 0)
+    {
+      m_file.SetBuffering (m_chunkSize, m_backgroundWrite);
+    }
+}
+
+void
+PcapFileWrapper::Attach (Ptr<PcapNgFile> file, uint32_t ifIndex)
+{
+  NS_LOG_FUNCTION (this << file << ifIndex);
+  NS_ASSERT (ifIndex < file->GetNInterfaces ());
+  m_ngFile = file;
+  m_ngInterface = ifIndex;
 }
 
 void
 PcapFileWrapper::Write (Time t, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (this << t << p);
+  if (m_ngFile != 0)
+    {
+      m_ngFile->Write (m_ngInterface, t.GetNanoSeconds (), p);
+      return;
+    }
   if (m_file.IsNanoSecMode())
     {
       uint64_t current = t.GetNanoSeconds ();
@@ -139,6 +180,11 @@ void
 PcapFileWrapper::Write (Time t, const Header &header, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (this << t << &header << p);
+  if (m_ngFile != 0)
+    {
+      m_ngFile->Write (m_ngInterface, t.GetNanoSeconds (), header, p);
+      return;
+    }
   if (m_file.IsNanoSecMode())
     {
       uint64_t current = t.GetNanoSeconds ();
@@ -159,6 +205,11 @@ void
 PcapFileWrapper::Write (Time t, uint8_t const *buffer, uint32_t length)
 {
   NS_LOG_FUNCTION (this << t << &buffer << length);
+  if (m_ngFile != 0)
+    {
+      m_ngFile->Write (m_ngInterface, t.GetNanoSeconds (), buffer, length);
+      return;
+    }
   if (m_file.IsNanoSecMode())
     {
       uint64_t current = t.GetNanoSeconds ();
@@ -175,6 +226,18 @@ PcapFileWrapper::Write (Time t, uint8_t const *buffer, uint32_t length)
     }
 }
 
+void
+PcapFileWrapper::Write (Time t, Ptr<const Packet> p, std::string const &comment)
+{
+  NS_LOG_FUNCTION (this << t << p << comment);
+  if (m_ngFile != 0)
+    {
+      m_ngFile->Write (m_ngInterface, t.GetNanoSeconds (), p, comment);
+      return;
+    }
+  Write (t, p);
+}
+
 Ptr<Packet> 
 PcapFileWrapper::Read (Time &t)
 {
@@ -27,6 +27,7 @@
 #include "ns3/object.h"
 #include "ns3/nstime.h"
 #include "pcap-file.h"
+#include "pcapng-file.h"
 
 namespace ns3 {
 
@@ -82,6 +83,13 @@ public:
    */
   void Close (void);
 
+  /**
+   * Write the packets buffered so far to the underlying pcap file.
+   *
+   * \see PcapFile::Flush
+   */
+  void Flush (void);
+
   /**
    * Initialize the pcap file associated with this wrapper.  This file must have
    * been previously opened with write permissions.
@@ -102,6 +110,9 @@ public:
    * time zone from UTC/GMT.  For example, Pacific Standard Time in the US is
    * GMT-8, so one would enter -8 for that correction.  Defaults to 0 (UTC).
    *
+   * If the "ChunkSize" Attribute is not zero, the packets written to the
+   * file are buffered (see PcapFile::SetBuffering).
+   *
    * \warning Calling this method on an existing file will result in the loss
    * any existing data.
    */
@@ -109,6 +120,17 @@ public:
              uint32_t snapLen = std::numeric_limits<uint32_t>::max (), 
              int32_t tzCorrection = PcapFile::ZONE_DEFAULT);
 
+  /**
+   * Write the packets to an interface of a pcapng file instead of a pcap
+   * file.  The wrapper must be neither opened nor initialized, and only
+   * the Write and Fail methods can be used afterwards.
+   *
+   * \param file The pcapng file, possibly shared with other wrappers.
+   * \param ifIndex The index of the interface of the pcapng file, as
+   * returned by PcapNgFile::AddInterface.
+   */
+  void Attach (Ptr<PcapNgFile> file, uint32_t ifIndex);
+
   /**
    * \brief Write the next packet to file
    * 
@@ -142,6 +164,19 @@ public:
    */
   void Write (Time t, uint8_t const *buffer, uint32_t length);
 
+  /**
+   * \brief Write the next packet to file, along with a comment
+   *
+   * The comment, for instance the reason why the packet was dropped, is only
+   * written when the wrapper is attached to a pcapng file: pcap files have
+   * no room for it.
+   *
+   * \param t Packet timestamp as ns3::Time.
+   * \param p Packet to write to the pcap file.
+   * \param comment The packet comment.
+   */
+  void Write (Time t, Ptr<const Packet> p, std::string const &comment);
+
   /**
    * \brief Read the next packet from the file.
    * 
@@ -224,6 +259,10 @@ private:
   PcapFile m_file; //!< Pcap file
   uint32_t m_snapLen; //!< max length of saved packets
   bool     m_nanosecMode; //!< Timestamps in nanosecond mode
+  Ptr<PcapNgFile> m_ngFile; //!< pcapng file the packets are written to, if any
+  uint32_t m_ngInterface; //!< index of the interface in the pcapng file
+  uint32_t m_chunkSize; //!< size of the write buffer chunks, unbuffered if zero
+  bool     m_backgroundWrite; //!< whether the chunks are written by a writer thread
 };
 
 } // namespace ns3
@@ -20,6 +20,9 @@
 
 #include <iostream>
 #include <cstring>
+#include <deque>
+#include <vector>
+#include "ns3/core-config.h"
 #include "ns3/assert.h"
 #include "ns3/packet.h"
 #include "ns3/fatal-error.h"
@@ -29,6 +32,11 @@
 #include "pcap-file.h"
 #include "ns3/log.h"
 #include "ns3/build-profile.h"
+#ifdef HAVE_PTHREAD_H
+#include <mutex>
+#include <condition_variable>
+#include "ns3/system-thread.h"
+#endif /* HAVE_PTHREAD_H */
 //
 // This file is used as part of the ns-3 test framework, so please refrain from 
 // adding any ns-3 specific constructs such as Packet to this file.
@@ -47,10 +55,242 @@ const uint32_t NS_SWAPPED_MAGIC = 0x4d3cb2a1; /**< Looks this way if byte swappi
 const uint16_t VERSION_MAJOR = 2;             /**< Major version of supported pcap file format */
 const uint16_t VERSION_MINOR = 4;             /**< Minor version of supported pcap file format */
 
+/**
+ * \ingroup network
+ * \brief Writer of the chunks of a buffered PcapFile
+ *
+ * The records are appended to the current chunk, which is handed over when
+ * full.  With background writing, the full chunks are queued to a writer
+ * thread and the chunks it has written are recycled; otherwise, they are
+ * written right away.
+ */
+class PcapFileWriter
+{
+public:
+  /**
+   * \param file the file stream to write the chunks to
+   * \param chunkSize the size of the chunks
+   * \param background whether full chunks are written by a writer thread
+   */
+  PcapFileWriter (std::fstream *file, uint32_t chunkSize, bool background);
+  /**
+   * Write the pending chunks and stop the writer thread.
+   */
+  ~PcapFileWriter ();
+
+  /**
+   * \param size the number of bytes to append
+   * \returns a pointer to the bytes appended to the current chunk
+   */
+  uint8_t *Reserve (uint32_t size);
+  /**
+   * Write the current chunk and wait until all the chunks are written.
+   */
+  void Flush (void);
+  /**
+   * \returns true if writing a chunk failed
+   */
+  bool Fail (void);
+
+private:
+  /**
+   * Hand the current chunk over and start a new one.
+   */
+  void Submit (void);
+  /**
+   * Write a chunk to the file.
+   * \param chunk the chunk
+   */
+  void WriteChunk (const std::vector<uint8_t> &chunk);
+
+  std::fstream *m_file;             //!< the file stream
+  uint32_t m_chunkSize;             //!< the size of the chunks
+  std::vector<uint8_t> m_chunk;     //!< the current chunk
+  uint32_t m_used;                  //!< the number of bytes used in the current chunk
+  bool m_failed;                    //!< whether writing a chunk failed
+
+#ifdef HAVE_PTHREAD_H
+  /**
+   * The loop of the writer thread.
+   */
+  void Run (void);
+
+  static const uint32_t MAX_PENDING = 4;     //!< max number of full chunks queued to the writer
+
+  Ptr<SystemThread> m_thread;                //!< the writer thread, if any
+  std::mutex m_mutex;                        //!< protects the fields below
+  std::condition_variable m_ready;           //!< notified when a chunk is queued or the writer must stop
+  std::condition_variable m_written;         //!< notified when a chunk is written
+  std::deque<std::vector<uint8_t> > m_full;  //!< the chunks queued to the writer
+  std::vector<std::vector<uint8_t> > m_free; //!< the chunks written by the writer
+  bool m_busy;                               //!< whether the writer is writing a chunk
+  bool m_stop;                               //!< whether the writer must stop
+#endif /* HAVE_PTHREAD_H */
+};
+
+PcapFileWriter::PcapFileWriter (std::fstream *file, uint32_t chunkSize, bool background)
+  : m_file (file),
+    m_chunkSize (chunkSize),
+    m_chunk (chunkSize),
+    m_used (0),
+    m_failed (false)
+{
+  NS_LOG_FUNCTION (this << file << chunkSize << background);
+#ifdef HAVE_PTHREAD_H
+  m_busy = false;
+  m_stop = false;
+  if (background)
+    {
+      m_thread = Create<SystemThread> (MakeCallback (&PcapFileWriter::Run, this));
+      m_thread->Start ();
+    }
+#endif /* HAVE_PTHREAD_H */
+}
+
+PcapFileWriter::~PcapFileWriter ()
+{
+  NS_LOG_FUNCTION (this);
+  Flush ();
+#ifdef HAVE_PTHREAD_H
+  if (m_thread != 0)
+    {
+      {
+        std::lock_guard<std::mutex> lock (m_mutex);
+        m_stop = true;
+      }
+      m_ready.notify_one ();
+      m_thread->Join ();
+      m_thread = 0;
+    }
+#endif /* HAVE_PTHREAD_H */
+}
+
+uint8_t *
+PcapFileWriter::Reserve (uint32_t size)
+{
+  if (m_used + size > m_chunk.size ())
+    {
+      if (m_used > 0)
+        {
+          Submit ();
+        }
+      if (size > m_chunk.size ())
+        {
+          m_chunk.resize (size);
+        }
+    }
+  uint8_t *data = m_chunk.data () + m_used;
+  m_used += size;
+  return data;
+}
+
+void
+PcapFileWriter::Flush (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_used > 0)
+    {
+      Submit ();
+    }
+#ifdef HAVE_PTHREAD_H
+  if (m_thread != 0)
+    {
+      std::unique_lock<std::mutex> lock (m_mutex);
+      m_written.wait (lock, [this] { return m_full.empty () && !m_busy; });
+    }
+#endif /* HAVE_PTHREAD_H */
+  m_file->flush ();
+}
+
+bool
+PcapFileWriter::Fail (void)
+{
+#ifdef HAVE_PTHREAD_H
+  if (m_thread != 0)
+    {
+      std::lock_guard<std::mutex> lock (m_mutex);
+      return m_failed;
+    }
+#endif /* HAVE_PTHREAD_H */
+  return m_failed || m_file->fail ();
+}
+
+void
+PcapFileWriter::Submit (void)
+{
+  NS_LOG_FUNCTION (this << m_used);
+  m_chunk.resize (m_used);
+  m_used = 0;
+#ifdef HAVE_PTHREAD_H
+  if (m_thread != 0)
+    {
+      {
+        std::unique_lock<std::mutex> lock (m_mutex);
+        // If the writer is lagging behind, wait for it to catch up
+        m_written.wait (lock, [this] { return m_full.size () < MAX_PENDING; });
+        m_full.push_back (std::vector<uint8_t> ());
+        m_full.back ().swap (m_chunk);
+        if (!m_free.empty ())
+          {
+            m_chunk.swap (m_free.back ());
+            m_free.pop_back ();
+          }
+      }
+      m_ready.notify_one ();
+      m_chunk.resize (m_chunkSize);
+      return;
+    }
+#endif /* HAVE_PTHREAD_H */
+  WriteChunk (m_chunk);
+  m_chunk.resize (m_chunkSize);
+}
+
+void
+PcapFileWriter::WriteChunk (const std::vector<uint8_t> &chunk)
+{
+  m_file->write ((const char *)&chunk[0], chunk.size ());
+}
+
+#ifdef HAVE_PTHREAD_H
+void
+PcapFileWriter::Run (void)
+{
+  NS_LOG_FUNCTION (this);
+  std::vector<uint8_t> chunk;
+  while (true)
+    {
+      {
+        // The writer sleeps until a chunk is queued or it must stop
+        std::unique_lock<std::mutex> lock (m_mutex);
+        m_ready.wait (lock, [this] { return !m_full.empty () || m_stop; });
+        if (m_full.empty ())
+          {
+            break;
+          }
+        chunk.swap (m_full.front ());
+        m_full.pop_front ();
+        m_busy = true;
+      }
+
+      WriteChunk (chunk);
+      bool failed = m_file->fail ();
+      {
+        std::lock_guard<std::mutex> lock (m_mutex);
+        m_failed = m_failed || failed;
+        m_busy = false;
+        m_free.push_back (std::vector<uint8_t> ());
+        m_free.back ().swap (chunk);
+      }
+      m_written.notify_all ();
+    }
+}
+#endif /* HAVE_PTHREAD_H */
+
 PcapFile::PcapFile ()
   : m_file (),
     m_swapMode (false),
-    m_nanosecMode (false)
+    m_nanosecMode (false),
+    m_writer (0)
 {
   NS_LOG_FUNCTION (this);
   FatalImpl::RegisterStream (&m_file); 
@@ -68,6 +308,10 @@ bool
 PcapFile::Fail (void) const
 {
   NS_LOG_FUNCTION (this);
+  if (m_writer != 0)
+    {
+      return m_writer->Fail ();
+    }
   return m_file.fail ();
 }
 bool 
@@ -88,9 +332,33 @@ void
 PcapFile::Close (void)
 {
   NS_LOG_FUNCTION (this);
+  delete m_writer;
+  m_writer = 0;
   m_file.close ();
 }
 
+void
+PcapFile::SetBuffering (uint32_t chunkSize, bool background)
+{
+  NS_LOG_FUNCTION (this << chunkSize << background);
+  delete m_writer;
+  m_writer = 0;
+  if (chunkSize > 0)
+    {
+      m_writer = new PcapFileWriter (&m_file, chunkSize, background);
+    }
+}
+
+void
+PcapFile::Flush (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_writer != 0)
+    {
+      m_writer->Flush ();
+    }
+}
+
 uint32_t
 PcapFile::GetMagic (void)
 {
@@ -345,6 +613,7 @@ void
 PcapFile::Init (uint32_t dataLinkType, uint32_t snapLen, int32_t timeZoneCorrection, bool swapMode, bool nanosecMode)
 {
   NS_LOG_FUNCTION (this << dataLinkType << snapLen << timeZoneCorrection << swapMode);
+  NS_ASSERT_MSG (m_writer == 0, "PcapFile::Init(): Buffering must be enabled after Init");
 
   //
   // Initialize the magic number and nanosecond mode flag
@@ -422,6 +691,19 @@ PcapFile::WritePacketHeader (uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen)
   // Watch out for memory alignment differences between machines, so write
   // them all individually.
   //
+  if (m_writer != 0)
+    {
+      uint8_t *data = m_writer->Reserve (sizeof(header.m_tsSec) + sizeof(header.m_tsUsec)
+                                         + sizeof(header.m_inclLen) + sizeof(header.m_origLen));
+      std::memcpy (data, &header.m_tsSec, sizeof(header.m_tsSec));
+      data += sizeof(header.m_tsSec);
+      std::memcpy (data, &header.m_tsUsec, sizeof(header.m_tsUsec));
+      data += sizeof(header.m_tsUsec);
+      std::memcpy (data, &header.m_inclLen, sizeof(header.m_inclLen));
+      data += sizeof(header.m_inclLen);
+      std::memcpy (data, &header.m_origLen, sizeof(header.m_origLen));
+      return inclLen;
+    }
   m_file.write ((const char *)&header.m_tsSec, sizeof(header.m_tsSec));
   m_file.write ((const char *)&header.m_tsUsec, sizeof(header.m_tsUsec));
   m_file.write ((const char *)&header.m_inclLen, sizeof(header.m_inclLen));
@@ -435,6 +717,11 @@ PcapFile::Write (uint32_t tsSec, uint32_t tsUsec, uint8_t const * const data, ui
 {
   NS_LOG_FUNCTION (this << tsSec << tsUsec << &data << totalLen);
   uint32_t inclLen = WritePacketHeader (tsSec, tsUsec, totalLen);
+  if (m_writer != 0)
+    {
+      std::memcpy (m_writer->Reserve (inclLen), data, inclLen);
+      return;
+    }
   m_file.write ((const char *)data, inclLen);
   NS_BUILD_DEBUG(m_file.flush());
 }
@@ -444,6 +731,12 @@ PcapFile::Write (uint32_t tsSec, uint32_t tsUsec, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (this << tsSec << tsUsec << p);
   uint32_t inclLen = WritePacketHeader (tsSec, tsUsec, p->GetSize ());
+  if (m_writer != 0)
+    {
+      // Only the captured bytes of the packet are copied
+      p->CopyData (m_writer->Reserve (inclLen), inclLen);
+      return;
+    }
   p->CopyData (&m_file, inclLen);
   NS_BUILD_DEBUG(m_file.flush());
 }
@@ -460,6 +753,13 @@ PcapFile::Write (uint32_t tsSec, uint32_t tsUsec, const Header &header, Ptr<cons
   headerBuffer.AddAtStart (headerSize);
   header.Serialize (headerBuffer.Begin ());
   uint32_t toCopy = std::min (headerSize, inclLen);
+  if (m_writer != 0)
+    {
+      headerBuffer.CopyData (m_writer->Reserve (toCopy), toCopy);
+      inclLen -= toCopy;
+      p->CopyData (m_writer->Reserve (inclLen), inclLen);
+      return;
+    }
   headerBuffer.CopyData (&m_file, toCopy);
   inclLen -= toCopy;
   p->CopyData (&m_file, inclLen);
@@ -30,6 +30,7 @@ namespace ns3 {
 
 class Packet;
 class Header;
+class PcapFileWriter;
 
 
 /**
@@ -153,6 +154,37 @@ public:
    */
   void Write (uint32_t tsSec, uint32_t tsUsec, const Header &header, Ptr<const Packet> p);
 
+  /**
+   * \brief Buffer the packets written to the file
+   *
+   * Once buffering is enabled, the packet records are appended to in-memory
+   * chunks instead of being written one by one to the underlying iostream,
+   * and only the captured part of the packets (see the snapLen parameter of
+   * Init) is copied into the chunks.  A chunk is written to the file when it
+   * is full, when Flush is called and when the file is closed.
+   *
+   * If background writing is requested, full chunks are handed to a writer
+   * thread which writes them to the file while the simulation goes on.
+   * Background writing requires thread support; without it, full chunks
+   * are written by the calling thread.
+   *
+   * The file must have been initialized with Init.  Reading packets from
+   * a file while buffering is enabled is not supported.
+   *
+   * \param chunkSize The size of the chunks, in bytes.  Buffering is
+   * disabled, after the pending chunks are written, if zero.
+   * \param background Whether full chunks are written by a writer thread.
+   */
+  void SetBuffering (uint32_t chunkSize, bool background);
+
+  /**
+   * \brief Write the packets buffered so far to the file
+   *
+   * When buffering is enabled, wait until all the buffered packets have
+   * been written to the underlying iostream, and flush it.
+   */
+  void Flush (void);
+
 
   /**
    * \brief Read next packet from file
@@ -371,6 +403,7 @@ private:
   PcapFileHeader m_fileHeader;  //!< file header
   bool m_swapMode;              //!< swap mode
   bool m_nanosecMode;           //!< nanosecond timestamp mode
+  PcapFileWriter *m_writer;     //!< chunk writer, if buffering is enabled
 };
 
 } // namespace ns3
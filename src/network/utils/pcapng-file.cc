@@ -0,0 +1,261 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstring>
+#include <algorithm>
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include "ns3/packet.h"
+#include "ns3/header.h"
+#include "ns3/buffer.h"
+#include "ns3/fatal-impl.h"
+#include "pcapng-file.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PcapNgFile");
+
+const uint32_t SHB_TYPE = 0x0a0d0d0a;         /**< Section Header Block type */
+const uint32_t IDB_TYPE = 0x00000001;         /**< Interface Description Block type */
+const uint32_t EPB_TYPE = 0x00000006;         /**< Enhanced Packet Block type */
+const uint32_t BYTE_ORDER_MAGIC = 0x1a2b3c4d; /**< Identifies the byte order of a section */
+const uint16_t VERSION_MAJOR = 1;             /**< Major version of supported pcapng file format */
+const uint16_t VERSION_MINOR = 0;             /**< Minor version of supported pcapng file format */
+
+const uint16_t OPT_ENDOFOPT = 0;              /**< End of the options */
+const uint16_t OPT_COMMENT = 1;               /**< Comment option */
+const uint16_t SHB_USERAPPL = 4;              /**< Name of the application which wrote the section */
+const uint16_t IF_NAME = 2;                   /**< Name of the interface */
+const uint16_t IF_TSRESOL = 9;                /**< Resolution of the interface timestamps */
+
+const uint8_t TSRESOL_NS = 9;                 /**< Timestamps in nanoseconds (10^-9 s) */
+
+PcapNgFile::PcapNgFile ()
+  : m_file (),
+    m_hasOptions (false)
+{
+  NS_LOG_FUNCTION (this);
+  FatalImpl::RegisterStream (&m_file);
+}
+
+PcapNgFile::~PcapNgFile ()
+{
+  NS_LOG_FUNCTION (this);
+  FatalImpl::UnregisterStream (&m_file);
+  Close ();
+}
+
+bool
+PcapNgFile::Fail (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_file.fail ();
+}
+
+void
+PcapNgFile::Open (std::string const &filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  NS_ASSERT (!m_file.fail ());
+
+  m_filename = filename;
+  m_file.open (filename.c_str (), std::ios::out | std::ios::binary);
+  m_snapLen.clear ();
+
+  //
+  // The Section Header Block of the single section of the file.  The section
+  // length is unknown (-1) as the file is written on the fly.
+  //
+  StartBlock (SHB_TYPE);
+  AppendU32 (BYTE_ORDER_MAGIC);
+  Append (&VERSION_MAJOR, sizeof (VERSION_MAJOR));
+  Append (&VERSION_MINOR, sizeof (VERSION_MINOR));
+  int64_t sectionLength = -1;
+  Append (&sectionLength, sizeof (sectionLength));
+  std::string application = "ns-3";
+  AppendOption (SHB_USERAPPL, application.c_str (), application.size ());
+  EndBlock ();
+}
+
+void
+PcapNgFile::Close (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_file.close ();
+}
+
+uint32_t
+PcapNgFile::AddInterface (std::string const &name, uint32_t dataLinkType, uint32_t snapLen)
+{
+  NS_LOG_FUNCTION (this << name << dataLinkType << snapLen);
+  NS_ASSERT (m_file.good ());
+
+  StartBlock (IDB_TYPE);
+  uint16_t linkType = dataLinkType;
+  uint16_t reserved = 0;
+  Append (&linkType, sizeof (linkType));
+  Append (&reserved, sizeof (reserved));
+  AppendU32 (snapLen);
+  if (!name.empty ())
+    {
+      AppendOption (IF_NAME, name.c_str (), name.size ());
+    }
+  AppendOption (IF_TSRESOL, &TSRESOL_NS, sizeof (TSRESOL_NS));
+  EndBlock ();
+
+  m_snapLen.push_back (snapLen);
+  return m_snapLen.size () - 1;
+}
+
+uint32_t
+PcapNgFile::GetNInterfaces (void) const
+{
+  return m_snapLen.size ();
+}
+
+void
+PcapNgFile::StartBlock (uint32_t type)
+{
+  m_block.clear ();
+  m_hasOptions = false;
+  AppendU32 (type);
+  // The block total length, set by EndBlock
+  AppendU32 (0);
+}
+
+uint8_t *
+PcapNgFile::Append (void const *data, uint32_t size)
+{
+  uint32_t used = m_block.size ();
+  m_block.resize (used + size);
+  if (data != 0)
+    {
+      std::memcpy (m_block.data () + used, data, size);
+    }
+  return m_block.data () + used;
+}
+
+void
+PcapNgFile::AppendU32 (uint32_t value)
+{
+  Append (&value, sizeof (value));
+}
+
+void
+PcapNgFile::Pad (void)
+{
+  m_block.resize ((m_block.size () + 3) & ~3, 0);
+}
+
+void
+PcapNgFile::AppendOption (uint16_t code, void const *data, uint16_t size)
+{
+  Append (&code, sizeof (code));
+  Append (&size, sizeof (size));
+  Append (data, size);
+  Pad ();
+  m_hasOptions = true;
+}
+
+void
+PcapNgFile::EndBlock (void)
+{
+  //
+  // The options, if any, are terminated by an end-of-options option.  The
+  // block total length is repeated at the end of the block, so that the
+  // file can be read backwards.
+  //
+  if (m_hasOptions)
+    {
+      uint16_t end = 0;
+      Append (&OPT_ENDOFOPT, sizeof (OPT_ENDOFOPT));
+      Append (&end, sizeof (end));
+    }
+  uint32_t length = m_block.size () + sizeof (length);
+  std::memcpy (m_block.data () + sizeof (uint32_t), &length, sizeof (length));
+  AppendU32 (length);
+
+  m_file.write ((const char *)m_block.data (), m_block.size ());
+}
+
+uint8_t *
+PcapNgFile::StartPacket (uint32_t ifIndex, uint64_t tsNs, uint32_t totalLen)
+{
+  NS_LOG_FUNCTION (this << ifIndex << tsNs << totalLen);
+  NS_ASSERT (m_file.good ());
+  NS_ASSERT_MSG (ifIndex < m_snapLen.size (), "PcapNgFile::Write(): Unknown interface " << ifIndex);
+
+  uint32_t inclLen = std::min (totalLen, m_snapLen[ifIndex]);
+
+  StartBlock (EPB_TYPE);
+  AppendU32 (ifIndex);
+  AppendU32 (tsNs >> 32);
+  AppendU32 (tsNs & 0xffffffff);
+  AppendU32 (inclLen);
+  AppendU32 (totalLen);
+  return Append (0, inclLen);
+}
+
+void
+PcapNgFile::EndPacket (std::string const &comment)
+{
+  Pad ();
+  if (!comment.empty ())
+    {
+      AppendOption (OPT_COMMENT, comment.c_str (), comment.size ());
+    }
+  EndBlock ();
+}
+
+void
+PcapNgFile::Write (uint32_t ifIndex, uint64_t tsNs, uint8_t const * const data, uint32_t totalLen,
+                   std::string const &comment)
+{
+  NS_LOG_FUNCTION (this << ifIndex << tsNs << &data << totalLen << comment);
+  uint8_t *buffer = StartPacket (ifIndex, tsNs, totalLen);
+  std::memcpy (buffer, data, std::min (totalLen, m_snapLen[ifIndex]));
+  EndPacket (comment);
+}
+
+void
+PcapNgFile::Write (uint32_t ifIndex, uint64_t tsNs, Ptr<const Packet> p, std::string const &comment)
+{
+  NS_LOG_FUNCTION (this << ifIndex << tsNs << p << comment);
+  uint8_t *buffer = StartPacket (ifIndex, tsNs, p->GetSize ());
+  p->CopyData (buffer, std::min (p->GetSize (), m_snapLen[ifIndex]));
+  EndPacket (comment);
+}
+
+void
+PcapNgFile::Write (uint32_t ifIndex, uint64_t tsNs, const Header &header, Ptr<const Packet> p,
+                   std::string const &comment)
+{
+  NS_LOG_FUNCTION (this << ifIndex << tsNs << &header << p << comment);
+  uint32_t headerSize = header.GetSerializedSize ();
+  uint32_t totalSize = headerSize + p->GetSize ();
+  uint8_t *buffer = StartPacket (ifIndex, tsNs, totalSize);
+  uint32_t inclLen = std::min (totalSize, m_snapLen[ifIndex]);
+
+  Buffer headerBuffer;
+  headerBuffer.AddAtStart (headerSize);
+  header.Serialize (headerBuffer.Begin ());
+  uint32_t toCopy = std::min (headerSize, inclLen);
+  headerBuffer.CopyData (buffer, toCopy);
+  p->CopyData (buffer + toCopy, inclLen - toCopy);
+  EndPacket (comment);
+}
+
+} // namespace ns3
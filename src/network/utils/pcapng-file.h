@@ -0,0 +1,186 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PCAPNG_FILE_H
+#define PCAPNG_FILE_H
+
+#include <string>
+#include <fstream>
+#include <vector>
+#include <stdint.h>
+#include "ns3/ptr.h"
+#include "ns3/simple-ref-count.h"
+
+namespace ns3 {
+
+class Packet;
+class Header;
+
+/**
+ * \ingroup network
+ * \brief A class representing a pcapng file being written
+ *
+ * Unlike a pcap file, which holds the packets of a single link, a pcapng
+ * file holds the packets of any number of interfaces, each one described
+ * by an Interface Description Block (IDB) with its own data link type,
+ * snap length and name.  The packets are written in Enhanced Packet Blocks
+ * (EPB) with nanosecond timestamps and an optional comment, for instance
+ * the reason why the packet was dropped.
+ *
+ * The file is written in the byte order of the writing system, as allowed
+ * by the format.  Reading pcapng files is not supported.
+ *
+ * See https://github.com/pcapng/pcapng for the format specification.
+ */
+class PcapNgFile : public SimpleRefCount<PcapNgFile>
+{
+public:
+  static const uint32_t SNAPLEN_DEFAULT = 65535;       /**< Default value for maximum octets to save per packet */
+
+  PcapNgFile ();
+  ~PcapNgFile ();
+
+  /**
+   * \return true if the 'fail' bit is set in the underlying iostream, false otherwise.
+   */
+  bool Fail (void) const;
+
+  /**
+   * Create a new pcapng file and write its Section Header Block.
+   *
+   * \param filename String containing the name of the file.
+   */
+  void Open (std::string const &filename);
+
+  /**
+   * Close the underlying file.
+   */
+  void Close (void);
+
+  /**
+   * \brief Add an interface to the file
+   *
+   * Write the Interface Description Block of a new interface.  The packets
+   * of the interface are written with the returned interface index.
+   *
+   * \param name The name of the interface.
+   * \param dataLinkType A data link type as defined in the pcap library.
+   * \param snapLen The maximum size of the packets written to the file for
+   * the interface.  If packets exceed this length they are truncated.
+   * \returns the index of the interface in the file
+   */
+  uint32_t AddInterface (std::string const &name, uint32_t dataLinkType,
+                         uint32_t snapLen = SNAPLEN_DEFAULT);
+
+  /**
+   * \returns the number of interfaces of the file
+   */
+  uint32_t GetNInterfaces (void) const;
+
+  /**
+   * \brief Write next packet to file
+   *
+   * \param ifIndex     Interface index, as returned by AddInterface
+   * \param tsNs        Packet timestamp, nanoseconds
+   * \param data        Data buffer
+   * \param totalLen    Total packet length
+   * \param comment     Packet comment, not written if empty
+   */
+  void Write (uint32_t ifIndex, uint64_t tsNs, uint8_t const * const data, uint32_t totalLen,
+              std::string const &comment = "");
+
+  /**
+   * \brief Write next packet to file
+   *
+   * \param ifIndex     Interface index, as returned by AddInterface
+   * \param tsNs        Packet timestamp, nanoseconds
+   * \param p           Packet to write
+   * \param comment     Packet comment, not written if empty
+   */
+  void Write (uint32_t ifIndex, uint64_t tsNs, Ptr<const Packet> p,
+              std::string const &comment = "");
+
+  /**
+   * \brief Write next packet to file
+   *
+   * \param ifIndex     Interface index, as returned by AddInterface
+   * \param tsNs        Packet timestamp, nanoseconds
+   * \param header      Header to write, in front of packet
+   * \param p           Packet to write
+   * \param comment     Packet comment, not written if empty
+   */
+  void Write (uint32_t ifIndex, uint64_t tsNs, const Header &header, Ptr<const Packet> p,
+              std::string const &comment = "");
+
+private:
+  /**
+   * \brief Start a block in the block buffer
+   * \param type the block type
+   */
+  void StartBlock (uint32_t type);
+  /**
+   * \brief Append bytes to the block buffer
+   * \param data the bytes
+   * \param size the number of bytes
+   * \returns a pointer to the appended bytes, to fill them if data is null
+   */
+  uint8_t *Append (void const *data, uint32_t size);
+  /**
+   * \brief Append a 32-bit value to the block buffer
+   * \param value the value
+   */
+  void AppendU32 (uint32_t value);
+  /**
+   * \brief Append padding bytes to align the block buffer on 32 bits
+   */
+  void Pad (void);
+  /**
+   * \brief Append an option to the block buffer
+   * \param code the option code
+   * \param data the option value
+   * \param size the size of the option value
+   */
+  void AppendOption (uint16_t code, void const *data, uint16_t size);
+  /**
+   * \brief Terminate the options, if any, and the block, and write the block
+   * to the file
+   */
+  void EndBlock (void);
+  /**
+   * \brief Append the header of an Enhanced Packet Block to the block buffer
+   *
+   * \param ifIndex the interface index
+   * \param tsNs the packet timestamp, nanoseconds
+   * \param totalLen the total packet length
+   * \returns a pointer to the captured packet data, to be filled
+   */
+  uint8_t *StartPacket (uint32_t ifIndex, uint64_t tsNs, uint32_t totalLen);
+  /**
+   * \brief Terminate an Enhanced Packet Block and write it to the file
+   * \param comment the packet comment, not written if empty
+   */
+  void EndPacket (std::string const &comment);
+
+  std::string m_filename;               //!< file name
+  std::fstream m_file;                  //!< file stream
+  std::vector<uint32_t> m_snapLen;      //!< snap length of each interface
+  std::vector<uint8_t> m_block;         //!< the block being built
+  bool m_hasOptions;                    //!< whether the block being built has options
+};
+
+} // namespace ns3
+
+#endif /* PCAPNG_FILE_H */
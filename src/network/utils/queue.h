@@ -232,7 +232,14 @@ private:
  * Queue is a template class. The type of the objects stored within the queue
  * is specified by the type parameter, which can be any class providing a
  * GetSize () method (e.g., Packet, QueueDiscItem, etc.). Subclasses need to
- * implement the DoEnqueue, DoDequeue, DoRemove and DoPeek methods.
+ * implement the Enqueue, Dequeue, Remove and Peek methods.
+ *
+ * The items can be stored in the list provided by this class, through the
+ * DoEnqueue, DoDequeue, DoRemove and DoPeek methods, which allow inserting
+ * and removing items at any position. Subclasses with a simpler access
+ * pattern may instead keep the items in a storage of their own (e.g., the
+ * RingBuffer of DropTailQueue) and account for them through the
+ * PrepareEnqueue, NotifyEnqueue, NotifyDequeue and NotifyRemove methods.
  *
  * Users of the Queue template class usually hold a queue through a smart pointer,
  * hence forward declaration is recommended to avoid pulling the implementation
@@ -357,6 +364,37 @@ protected:
    */
   Ptr<const Item> DoPeek (ConstIterator pos) const;
 
+  /**
+   * Check that there is room in the queue for an item, and drop it otherwise.
+   * To be called by the subclasses managing their own storage before
+   * storing the item.
+   * \param item the item to enqueue
+   * \return true if the item can be stored, false if it has been dropped.
+   */
+  bool PrepareEnqueue (Ptr<Item> item);
+
+  /**
+   * Account for an item stored in the queue and fire the Enqueue trace.
+   * To be called by the subclasses managing their own storage.
+   * \param item the item enqueued
+   */
+  void NotifyEnqueue (Ptr<Item> item);
+
+  /**
+   * Account for an item pulled from the queue and fire the Dequeue trace.
+   * To be called by the subclasses managing their own storage.
+   * \param item the item dequeued
+   */
+  void NotifyDequeue (Ptr<Item> item);
+
+  /**
+   * Account for an item pulled from the queue to be dropped, and fire the
+   * Dequeue and DropAfterDequeue traces. To be called by the subclasses
+   * managing their own storage.
+   * \param item the item removed
+   */
+  void NotifyRemove (Ptr<Item> item);
+
   /**
    * \brief Drop a packet before enqueue
    * \param item item that was dropped
@@ -442,24 +480,13 @@ Queue<Item>::DoEnqueue (ConstIterator pos, Ptr<Item> item)
 {
   NS_LOG_FUNCTION (this << item);
 
-  if (GetCurrentSize () + item > GetMaxSize ())
+  if (!PrepareEnqueue (item))
     {
-      NS_LOG_LOGIC ("Queue full -- dropping pkt");
-      DropBeforeEnqueue (item);
       return false;
     }
 
   m_packets.insert (pos, item);
-
-  uint32_t size = item->GetSize ();
-  m_nBytes += size;
-  m_nTotalReceivedBytes += size;
-
-  m_nPackets++;
-  m_nTotalReceivedPackets++;
-
-  NS_LOG_LOGIC ("m_traceEnqueue (p)");
-  m_traceEnqueue (item);
+  NotifyEnqueue (item);
 
   return true;
 }
@@ -481,14 +508,7 @@ Queue<Item>::DoDequeue (ConstIterator pos)
 
   if (item != 0)
     {
-      NS_ASSERT (m_nBytes.Get () >= item->GetSize ());
-      NS_ASSERT (m_nPackets.Get () > 0);
-
-      m_nBytes -= item->GetSize ();
-      m_nPackets--;
-
-      NS_LOG_LOGIC ("m_traceDequeue (p)");
-      m_traceDequeue (item);
+      NotifyDequeue (item);
     }
   return item;
 }
@@ -510,17 +530,7 @@ Queue<Item>::DoRemove (ConstIterator pos)
 
   if (item != 0)
     {
-      NS_ASSERT (m_nBytes.Get () >= item->GetSize ());
-      NS_ASSERT (m_nPackets.Get () > 0);
-
-      m_nBytes -= item->GetSize ();
-      m_nPackets--;
-
-      // packets are first dequeued and then dropped
-      NS_LOG_LOGIC ("m_traceDequeue (p)");
-      m_traceDequeue (item);
-
-      DropAfterDequeue (item);
+      NotifyRemove (item);
     }
   return item;
 }
@@ -563,6 +573,65 @@ typename Queue<Item>::ConstIterator Queue<Item>::Tail (void) const
   return m_packets.cend ();
 }
 
+template <typename Item>
+bool
+Queue<Item>::PrepareEnqueue (Ptr<Item> item)
+{
+  NS_LOG_FUNCTION (this << item);
+
+  if (GetCurrentSize () + item > GetMaxSize ())
+    {
+      NS_LOG_LOGIC ("Queue full -- dropping pkt");
+      DropBeforeEnqueue (item);
+      return false;
+    }
+  return true;
+}
+
+template <typename Item>
+void
+Queue<Item>::NotifyEnqueue (Ptr<Item> item)
+{
+  NS_LOG_FUNCTION (this << item);
+
+  uint32_t size = item->GetSize ();
+  m_nBytes += size;
+  m_nTotalReceivedBytes += size;
+
+  m_nPackets++;
+  m_nTotalReceivedPackets++;
+
+  NS_LOG_LOGIC ("m_traceEnqueue (p)");
+  m_traceEnqueue (item);
+}
+
+template <typename Item>
+void
+Queue<Item>::NotifyDequeue (Ptr<Item> item)
+{
+  NS_LOG_FUNCTION (this << item);
+
+  NS_ASSERT (m_nBytes.Get () >= item->GetSize ());
+  NS_ASSERT (m_nPackets.Get () > 0);
+
+  m_nBytes -= item->GetSize ();
+  m_nPackets--;
+
+  NS_LOG_LOGIC ("m_traceDequeue (p)");
+  m_traceDequeue (item);
+}
+
+template <typename Item>
+void
+Queue<Item>::NotifyRemove (Ptr<Item> item)
+{
+  NS_LOG_FUNCTION (this << item);
+
+  // packets are first dequeued and then dropped
+  NotifyDequeue (item);
+  DropAfterDequeue (item);
+}
+
 template <typename Item>
 void
 Queue<Item>::DropBeforeEnqueue (Ptr<Item> item)
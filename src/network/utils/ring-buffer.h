@@ -0,0 +1,198 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include "ns3/assert.h"
+#include <vector>
+#include <stdint.h>
+
+namespace ns3 {
+
+/**
+ * \ingroup queue
+ * \brief A FIFO container storing its elements in a contiguous circular buffer
+ *
+ * Elements are pushed at the back and popped from the front. The storage
+ * is a power-of-two sized array, which is doubled when full and never
+ * shrunk: once the buffer has grown to the peak occupancy, pushing and
+ * popping elements does not allocate memory.
+ *
+ * A popped slot is reset to a default-constructed element, so that smart
+ * pointers release their object as soon as it leaves the buffer.
+ */
+template <typename T>
+class RingBuffer
+{
+public:
+  RingBuffer ();
+
+  /**
+   * \return the number of elements in the buffer
+   */
+  uint32_t GetSize (void) const;
+
+  /**
+   * \return true if the buffer holds no element
+   */
+  bool IsEmpty (void) const;
+
+  /**
+   * \return the number of elements the buffer can hold without growing
+   */
+  uint32_t GetCapacity (void) const;
+
+  /**
+   * \return the element at the front of the buffer, which must not be empty
+   */
+  const T & Front (void) const;
+
+  /**
+   * \param i the position of the element, from the front
+   * \return the element at position i, which must be lower than GetSize ()
+   */
+  const T & At (uint32_t i) const;
+
+  /**
+   * Append an element at the back of the buffer, growing it if needed.
+   * \param t the element
+   */
+  void PushBack (const T &t);
+
+  /**
+   * Remove the element at the front of the buffer, which must not be empty.
+   * \return the element removed
+   */
+  T PopFront (void);
+
+  /**
+   * Remove all the elements, keeping the storage.
+   */
+  void Clear (void);
+
+private:
+  /**
+   * Double the capacity of the buffer, moving the elements to the
+   * beginning of the new storage.
+   */
+  void Grow (void);
+
+  std::vector<T> m_slots;  //!< the storage, with a power-of-two size
+  uint32_t m_head;         //!< index of the front element
+  uint32_t m_size;         //!< number of elements
+};
+
+
+/**
+ * Implementation of the templates declared above.
+ */
+
+template <typename T>
+RingBuffer<T>::RingBuffer ()
+  : m_head (0),
+    m_size (0)
+{
+}
+
+template <typename T>
+uint32_t
+RingBuffer<T>::GetSize (void) const
+{
+  return m_size;
+}
+
+template <typename T>
+bool
+RingBuffer<T>::IsEmpty (void) const
+{
+  return m_size == 0;
+}
+
+template <typename T>
+uint32_t
+RingBuffer<T>::GetCapacity (void) const
+{
+  return m_slots.size ();
+}
+
+template <typename T>
+const T &
+RingBuffer<T>::Front (void) const
+{
+  NS_ASSERT (m_size > 0);
+  return m_slots[m_head];
+}
+
+template <typename T>
+const T &
+RingBuffer<T>::At (uint32_t i) const
+{
+  NS_ASSERT (i < m_size);
+  return m_slots[(m_head + i) & (m_slots.size () - 1)];
+}
+
+template <typename T>
+void
+RingBuffer<T>::PushBack (const T &t)
+{
+  if (m_size == m_slots.size ())
+    {
+      Grow ();
+    }
+  m_slots[(m_head + m_size) & (m_slots.size () - 1)] = t;
+  m_size++;
+}
+
+template <typename T>
+T
+RingBuffer<T>::PopFront (void)
+{
+  NS_ASSERT (m_size > 0);
+  T t = m_slots[m_head];
+  m_slots[m_head] = T ();
+  m_head = (m_head + 1) & (m_slots.size () - 1);
+  m_size--;
+  return t;
+}
+
+template <typename T>
+void
+RingBuffer<T>::Clear (void)
+{
+  while (m_size > 0)
+    {
+      PopFront ();
+    }
+  m_head = 0;
+}
+
+template <typename T>
+void
+RingBuffer<T>::Grow (void)
+{
+  std::vector<T> slots (m_slots.empty () ? 16 : 2 * m_slots.size ());
+  for (uint32_t i = 0; i < m_size; i++)
+    {
+      slots[i] = At (i);
+    }
+  m_slots.swap (slots);
+  m_head = 0;
+}
+
+} // namespace ns3
+
+#endif /* RING_BUFFER_H */
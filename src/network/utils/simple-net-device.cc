@@ -508,6 +508,10 @@ SimpleNetDevice::TransmitComplete ()
 
   if (m_queue->GetNPackets () == 0)
     {
+      if (!m_readyCallback.IsNull ())
+        {
+          m_readyCallback (this);
+        }
       return;
     }
 
@@ -531,6 +535,10 @@ SimpleNetDevice::TransmitComplete ()
         }
       TransmitCompleteEvent = Simulator::Schedule (txTime, &SimpleNetDevice::TransmitComplete, this);
     }
+  else if (!m_readyCallback.IsNull ())
+    {
+      m_readyCallback (this);
+    }
 
   return;
 }
@@ -573,6 +581,7 @@ SimpleNetDevice::DoDispose (void)
   m_receiveErrorModel = 0;
   m_queue->Flush ();
   m_queueInterface = 0;
+  m_readyCallback = MakeNullCallback<void, Ptr<NetDevice> > ();
   if (TransmitCompleteEvent.IsRunning ())
     {
       TransmitCompleteEvent.Cancel ();
@@ -595,4 +604,29 @@ SimpleNetDevice::SupportsSendFrom (void) const
   return true;
 }
 
+bool
+SimpleNetDevice::SupportsReadyCallback (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return true;
+}
+
+void
+SimpleNetDevice::SetReadyCallback (NetDevice::ReadyCallback cb)
+{
+  NS_LOG_FUNCTION (this);
+  m_readyCallback = cb;
+}
+
+uint32_t
+SimpleNetDevice::GetTxBudget (void) const
+{
+  NS_LOG_FUNCTION (this);
+  if (!TransmitCompleteEvent.IsRunning () && m_queue->GetNPackets () == 0)
+    {
+      return GetMtu ();
+    }
+  return 0;
+}
+
 } // namespace ns3
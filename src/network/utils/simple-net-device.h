@@ -135,6 +135,9 @@ public:
 
   virtual void SetPromiscReceiveCallback (PromiscReceiveCallback cb);
   virtual bool SupportsSendFrom (void) const;
+  virtual bool SupportsReadyCallback (void) const;
+  virtual void SetReadyCallback (NetDevice::ReadyCallback cb);
+  virtual uint32_t GetTxBudget (void) const;
 
 protected:
   virtual void DoDispose (void);
@@ -145,6 +148,7 @@ private:
   Ptr<SimpleChannel> m_channel; //!< the channel the device is connected to
   NetDevice::ReceiveCallback m_rxCallback; //!< Receive callback
   NetDevice::PromiscReceiveCallback m_promiscCallback; //!< Promiscuous receive callback
+  NetDevice::ReadyCallback m_readyCallback; //!< Ready to send callback
   Ptr<Node> m_node; //!< Node this netDevice is associated to
   Ptr<NetDeviceQueueInterface> m_queueInterface;   //!< NetDevice queue interface
   uint16_t m_mtu;   //!< MTU
@@ -251,6 +251,7 @@ PointToPointNetDevice::DoDispose ()
   m_currentPkt = 0;
   m_queue = 0;
   m_queueInterface = 0;
+  m_readyCallback = MakeNullCallback<void, Ptr<NetDevice> > ();
   NetDevice::DoDispose ();
 }
 
@@ -321,22 +322,13 @@ PointToPointNetDevice::TransmitComplete (void)
   if (p == 0)
     {
       NS_LOG_LOGIC ("No pending packets in device queue after tx complete");
-
-      //MMB2020 TMC PEP modification
-      if(!m_transmitCompleteCb.IsNull())
-      {
-        m_transmitCompleteCb(this);
-      }
-
+      if (!m_readyCallback.IsNull ())
+        {
+          m_readyCallback (this);
+        }
       return;
     }
 
-  //MMB2020 TMC PEP modification
-  if(!m_transmitCompleteCb.IsNull())
-  {
-    NS_ASSERT_MSG(false, "MMB2020 TMC: P2P NetDevice should not have packets in m_queue");
-  }
-
   //
   // Got another packet off of the queue, so start the transmit process again.
   //
@@ -596,13 +588,6 @@ PointToPointNetDevice::Send (
           bool ret = TransmitStart (packet);
           return ret;
         }
-      else //MMB2020 TMC PEP modification
-      {
-          if(!m_transmitCompleteCb.IsNull())
-          {
-              NS_ASSERT_MSG(false, "MMB2020 TMC: m_txMachineState != READY but there is a packet queued. Should not happen with TMC PEPs.");
-          }
-      }
       return true;
     }
 
@@ -661,6 +646,31 @@ PointToPointNetDevice::SupportsSendFrom (void) const
   return false;
 }
 
+bool
+PointToPointNetDevice::SupportsReadyCallback (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return true;
+}
+
+void
+PointToPointNetDevice::SetReadyCallback (NetDevice::ReadyCallback cb)
+{
+  NS_LOG_FUNCTION (this);
+  m_readyCallback = cb;
+}
+
+uint32_t
+PointToPointNetDevice::GetTxBudget (void) const
+{
+  NS_LOG_FUNCTION (this);
+  if (m_txMachineState == READY && m_queue->IsEmpty () && IsLinkUp ())
+    {
+      return GetMtu ();
+    }
+  return 0;
+}
+
 void
 PointToPointNetDevice::DoMpiReceive (Ptr<Packet> p)
 {
@@ -150,11 +150,6 @@ public:
    */
   void Receive (Ptr<Packet> p);
 
-  // MMB2020 TMC PEP modification
-  // We want a direct notification in the application as
-  // soon as the p2p NetDevice finishes transmission
-  Callback<void, Ptr<NetDevice> > m_transmitCompleteCb;
-
   // The remaining methods are documented in ns3::NetDevice*
 
   virtual void SetIfIndex (const uint32_t index);
@@ -196,6 +191,10 @@ public:
   virtual void SetPromiscReceiveCallback (PromiscReceiveCallback cb);
   virtual bool SupportsSendFrom (void) const;
 
+  virtual bool SupportsReadyCallback (void) const;
+  virtual void SetReadyCallback (NetDevice::ReadyCallback cb);
+  virtual uint32_t GetTxBudget (void) const;
+
 protected:
   /**
    * \brief Handler for MPI receive event
@@ -449,6 +448,7 @@ private:
   NetDevice::ReceiveCallback m_rxCallback;   //!< Receive callback
   NetDevice::PromiscReceiveCallback m_promiscCallback;  //!< Receive callback
                                                         //   (promisc data)
+  NetDevice::ReadyCallback m_readyCallback; //!< Ready to send callback
   uint32_t m_ifIndex; //!< Index of the interface
   bool m_linkUp;      //!< Identify if the link is up or not
   TracedCallback<> m_linkChangeCallbacks;  //!< Callback for the link change event
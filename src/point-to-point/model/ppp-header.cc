@@ -21,6 +21,7 @@
 #include "ns3/assert.h"
 #include "ns3/log.h"
 #include "ns3/header.h"
+#include "ns3/fixed-header-layout.h"
 #include "ppp-header.h"
 
 namespace ns3 {
@@ -82,13 +83,17 @@ PppHeader::GetSerializedSize (void) const
 void
 PppHeader::Serialize (Buffer::Iterator start) const
 {
-  start.WriteHtonU16 (m_protocol);
+  FixedHeaderLayout<2> layout;
+  layout.WriteHtonU16<0> (m_protocol);
+  layout.WriteTo (start);
 }
 
 uint32_t
 PppHeader::Deserialize (Buffer::Iterator start)
 {
-  m_protocol = start.ReadNtohU16 ();
+  FixedHeaderLayout<2> layout;
+  layout.ReadFrom (start);
+  m_protocol = layout.ReadNtohU16<0> ();
   return GetSerializedSize ();
 }
 
@@ -24,6 +24,13 @@
 #include "ns3/point-to-point-net-device.h"
 #include "ns3/point-to-point-channel.h"
 #include "ns3/net-device-queue-interface.h"
+#include "ns3/point-to-point-helper.h"
+#include "ns3/error-model.h"
+#include "ns3/string.h"
+#include "ns3/double.h"
+#include "ns3/pointer.h"
+#include <fstream>
+#include <cstdio>
 
 using namespace ns3;
 
@@ -101,6 +108,179 @@ PointToPointTest::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \brief Test of the ready callback and the transmit budget of the
+ * PointToPointNetDevice
+ *
+ * Three packets are sent back to back: the device has no budget left
+ * until the last one is transmitted, and then calls the ready callback
+ * exactly once.
+ */
+class PointToPointReadyTest : public TestCase
+{
+public:
+  /**
+   * \brief Create the test
+   */
+  PointToPointReadyTest ();
+
+  /**
+   * \brief Run the test
+   */
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \brief Send three packets and check that the budget is exhausted
+   *
+   * \param device NetDevice to send from
+   */
+  void SendPackets (Ptr<PointToPointNetDevice> device);
+
+  /**
+   * \brief Ready callback of the device
+   *
+   * \param device the device ready to send
+   */
+  void Ready (Ptr<NetDevice> device);
+
+  uint32_t m_ready; //!< Number of ready callback invocations
+};
+
+PointToPointReadyTest::PointToPointReadyTest ()
+  : TestCase ("PointToPoint ready callback and transmit budget"),
+    m_ready (0)
+{
+}
+
+void
+PointToPointReadyTest::SendPackets (Ptr<PointToPointNetDevice> device)
+{
+  NS_TEST_EXPECT_MSG_EQ (device->GetTxBudget (), device->GetMtu (), "Idle device without budget");
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      device->Send (Create<Packet> (100), device->GetBroadcast (), 0x800);
+      NS_TEST_EXPECT_MSG_EQ (device->GetTxBudget (), 0, "Busy device with budget");
+    }
+}
+
+void
+PointToPointReadyTest::Ready (Ptr<NetDevice> device)
+{
+  m_ready++;
+  NS_TEST_EXPECT_MSG_EQ (device->GetTxBudget (), device->GetMtu (), "Ready device without budget");
+}
+
+void
+PointToPointReadyTest::DoRun (void)
+{
+  Ptr<Node> a = CreateObject<Node> ();
+  Ptr<Node> b = CreateObject<Node> ();
+  Ptr<PointToPointNetDevice> devA = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointNetDevice> devB = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointChannel> channel = CreateObject<PointToPointChannel> ();
+
+  devA->Attach (channel);
+  devA->SetAddress (Mac48Address::Allocate ());
+  devA->SetQueue (CreateObject<DropTailQueue<Packet> > ());
+  devB->Attach (channel);
+  devB->SetAddress (Mac48Address::Allocate ());
+  devB->SetQueue (CreateObject<DropTailQueue<Packet> > ());
+
+  a->AddDevice (devA);
+  b->AddDevice (devB);
+
+  NS_TEST_ASSERT_MSG_EQ (devA->SupportsReadyCallback (), true, "Ready callback not supported");
+  devA->SetReadyCallback (MakeCallback (&PointToPointReadyTest::Ready, this));
+
+  Simulator::Schedule (Seconds (1.0), &PointToPointReadyTest::SendPackets, this, devA);
+
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_ready, 1, "Wrong number of ready callback invocations");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \brief Test of the packet drops written by PointToPointHelper::EnablePcapNg
+ *
+ * A packet is dropped by the full transmit queue of the first device and
+ * another one by the receive error model of the second device: both must
+ * be written to the pcapng file, with the trace source name as comment.
+ */
+class PointToPointPcapNgDropTest : public TestCase
+{
+public:
+  /**
+   * \brief Create the test
+   */
+  PointToPointPcapNgDropTest ();
+
+  /**
+   * \brief Run the test
+   */
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \brief Send three packets back to back
+   *
+   * \param device NetDevice to send from
+   */
+  void SendPackets (Ptr<NetDevice> device);
+};
+
+PointToPointPcapNgDropTest::PointToPointPcapNgDropTest ()
+  : TestCase ("PointToPoint pcapng capture of the dropped packets")
+{
+}
+
+void
+PointToPointPcapNgDropTest::SendPackets (Ptr<NetDevice> device)
+{
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      device->Send (Create<Packet> (100), device->GetBroadcast (), 0x800);
+    }
+}
+
+void
+PointToPointPcapNgDropTest::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("p2p-drops.pcapng");
+
+  // the devices, which keep the file open, must be released before reading it
+  {
+    NodeContainer nodes;
+    nodes.Create (2);
+
+    PointToPointHelper p2p;
+    p2p.SetQueue ("ns3::DropTailQueue", "MaxSize", StringValue ("1p"));
+    NetDeviceContainer devices = p2p.Install (nodes);
+
+    Ptr<RateErrorModel> em = CreateObject<RateErrorModel> ();
+    em->SetAttribute ("ErrorRate", DoubleValue (1.0));
+    em->SetUnit (RateErrorModel::ERROR_UNIT_PACKET);
+    devices.Get (1)->SetAttribute ("ReceiveErrorModel", PointerValue (em));
+
+    p2p.EnablePcapNg (filename, devices, false, true);
+
+    // the first packet is transmitted, the second one queued and the third one dropped
+    Simulator::Schedule (Seconds (1.0), &PointToPointPcapNgDropTest::SendPackets, this, devices.Get (0));
+
+    Simulator::Run ();
+    Simulator::Destroy ();
+  }
+
+  std::ifstream file (filename.c_str (), std::ios::in | std::ios::binary);
+  std::string data ((std::istreambuf_iterator<char> (file)), std::istreambuf_iterator<char> ());
+  NS_TEST_EXPECT_MSG_NE (data.find ("MacTxDrop"), std::string::npos, "The transmit queue drop is not captured");
+  NS_TEST_EXPECT_MSG_NE (data.find ("PhyRxDrop"), std::string::npos, "The receive error model drop is not captured");
+
+  remove (filename.c_str ());
+}
+
 /**
  * \brief TestSuite for PointToPoint module
  */
@@ -117,6 +297,8 @@ PointToPointTestSuite::PointToPointTestSuite ()
   : TestSuite ("devices-point-to-point", UNIT)
 {
   AddTestCase (new PointToPointTest, TestCase::QUICK);
+  AddTestCase (new PointToPointReadyTest, TestCase::QUICK);
+  AddTestCase (new PointToPointPcapNgDropTest, TestCase::QUICK);
 }
 
 static PointToPointTestSuite g_pointToPointTestSuite; //!< The testsuite
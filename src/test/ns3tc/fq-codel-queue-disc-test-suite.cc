@@ -33,6 +33,7 @@
 #include "ns3/udp-header.h"
 #include "ns3/string.h"
 #include "ns3/pointer.h"
+#include "ns3/uinteger.h"
 
 using namespace ns3;
 
@@ -513,6 +514,89 @@ FqCoDelQueueDiscUDPFlowsSeparation::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * This class tests that the flows becoming inactive keep their flow queue
+ * and are scheduled again as new flows
+ */
+class FqCoDelQueueDiscFlowsReuse : public TestCase
+{
+public:
+  FqCoDelQueueDiscFlowsReuse ();
+  virtual ~FqCoDelQueueDiscFlowsReuse ();
+
+private:
+  virtual void DoRun (void);
+  void AddPacket (Ptr<FqCoDelQueueDisc> queue, Ipv4Header hdr);
+};
+
+FqCoDelQueueDiscFlowsReuse::FqCoDelQueueDiscFlowsReuse ()
+  : TestCase ("Test the reuse of the flow queues of inactive flows")
+{
+}
+
+FqCoDelQueueDiscFlowsReuse::~FqCoDelQueueDiscFlowsReuse ()
+{
+}
+
+void
+FqCoDelQueueDiscFlowsReuse::AddPacket (Ptr<FqCoDelQueueDisc> queue, Ipv4Header hdr)
+{
+  Ptr<Packet> p = Create<Packet> (100);
+  Address dest;
+  Ptr<Ipv4QueueDiscItem> item = Create<Ipv4QueueDiscItem> (p, dest, 0, hdr);
+  queue->Enqueue (item);
+}
+
+void
+FqCoDelQueueDiscFlowsReuse::DoRun (void)
+{
+  Ptr<FqCoDelQueueDisc> queueDisc = CreateObjectWithAttributes<FqCoDelQueueDisc> ("Flows", UintegerValue (4096));
+
+  queueDisc->SetQuantum (1500);
+  queueDisc->Initialize ();
+
+  Ipv4Header hdr1;
+  hdr1.SetPayloadSize (100);
+  hdr1.SetSource (Ipv4Address ("10.10.1.1"));
+  hdr1.SetDestination (Ipv4Address ("10.10.1.2"));
+  hdr1.SetProtocol (7);
+  Ipv4Header hdr2 = hdr1;
+  hdr2.SetDestination (Ipv4Address ("10.10.1.10"));
+
+  // Add two packets from each flow and dequeue all of them
+  AddPacket (queueDisc, hdr1);
+  AddPacket (queueDisc, hdr1);
+  AddPacket (queueDisc, hdr2);
+  AddPacket (queueDisc, hdr2);
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetNQueueDiscClasses (), 2, "unexpected number of flow queues");
+  Ptr<FqCoDelFlow> flow1 = StaticCast<FqCoDelFlow> (queueDisc->GetQueueDiscClass (0));
+  Ptr<FqCoDelFlow> flow2 = StaticCast<FqCoDelFlow> (queueDisc->GetQueueDiscClass (1));
+  while (queueDisc->Dequeue ())
+    {
+    }
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->QueueDisc::GetNPackets (), 0, "unexpected number of packets in the queue disc");
+  NS_TEST_ASSERT_MSG_EQ (flow1->GetStatus (), FqCoDelFlow::INACTIVE, "the first flow must be inactive");
+  NS_TEST_ASSERT_MSG_EQ (flow2->GetStatus (), FqCoDelFlow::INACTIVE, "the second flow must be inactive");
+
+  // Add a packet from the second flow, then from the first flow
+  AddPacket (queueDisc, hdr2);
+  AddPacket (queueDisc, hdr1);
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetNQueueDiscClasses (), 2, "no flow queue should have been created");
+  NS_TEST_ASSERT_MSG_EQ (flow1->GetStatus (), FqCoDelFlow::NEW_FLOW, "the first flow must be in the list of new queues");
+  NS_TEST_ASSERT_MSG_EQ (flow2->GetStatus (), FqCoDelFlow::NEW_FLOW, "the second flow must be in the list of new queues");
+
+  // Dequeue a packet (from the second flow, which is at the head of the list of new queues)
+  queueDisc->Dequeue ();
+  NS_TEST_ASSERT_MSG_EQ (flow1->GetQueueDisc ()->GetNPackets (), 1, "unexpected number of packets in the first flow queue");
+  NS_TEST_ASSERT_MSG_EQ (flow2->GetQueueDisc ()->GetNPackets (), 0, "unexpected number of packets in the second flow queue");
+
+  // Dequeue a packet (from the first flow)
+  queueDisc->Dequeue ();
+  NS_TEST_ASSERT_MSG_EQ (flow1->GetQueueDisc ()->GetNPackets (), 0, "unexpected number of packets in the first flow queue");
+
+  Simulator::Destroy ();
+}
+
 class FqCoDelQueueDiscTestSuite : public TestSuite
 {
 public:
@@ -527,6 +611,7 @@ FqCoDelQueueDiscTestSuite::FqCoDelQueueDiscTestSuite ()
   AddTestCase (new FqCoDelQueueDiscDeficit, TestCase::QUICK);
   AddTestCase (new FqCoDelQueueDiscTCPFlowsSeparation, TestCase::QUICK);
   AddTestCase (new FqCoDelQueueDiscUDPFlowsSeparation, TestCase::QUICK);
+  AddTestCase (new FqCoDelQueueDiscFlowsReuse, TestCase::QUICK);
 }
 
 static FqCoDelQueueDiscTestSuite fqCoDelQueueDiscTestSuite;
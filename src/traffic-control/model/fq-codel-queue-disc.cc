@@ -92,6 +92,8 @@ FqCoDelFlow::GetStatus (void) const
 
 NS_OBJECT_ENSURE_REGISTERED (FqCoDelQueueDisc);
 
+const uint32_t FqCoDelQueueDisc::NO_SLOT;
+
 TypeId FqCoDelQueueDisc::GetTypeId (void)
 {
   static TypeId tid = TypeId ("ns3::FqCoDelQueueDisc")
@@ -138,6 +140,8 @@ FqCoDelQueueDisc::FqCoDelQueueDisc ()
     m_quantum (0)
 {
   NS_LOG_FUNCTION (this);
+  m_newFlows.head = m_newFlows.tail = NO_SLOT;
+  m_oldFlows.head = m_oldFlows.tail = NO_SLOT;
 }
 
 FqCoDelQueueDisc::~FqCoDelQueueDisc ()
@@ -145,6 +149,16 @@ FqCoDelQueueDisc::~FqCoDelQueueDisc ()
   NS_LOG_FUNCTION (this);
 }
 
+void
+FqCoDelQueueDisc::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_slots.clear ();
+  m_newFlows.head = m_newFlows.tail = NO_SLOT;
+  m_oldFlows.head = m_oldFlows.tail = NO_SLOT;
+  QueueDisc::DoDispose ();
+}
+
 void
 FqCoDelQueueDisc::SetQuantum (uint32_t quantum)
 {
@@ -185,33 +199,37 @@ FqCoDelQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
         }
     }
 
-  Ptr<FqCoDelFlow> flow;
-  if (m_flowsIndices.find (h) == m_flowsIndices.end ())
+  uint32_t slot = m_flowsIndices[h];
+  if (slot == NO_SLOT)
     {
       NS_LOG_DEBUG ("Creating a new flow queue with index " << h);
-      flow = m_flowFactory.Create<FqCoDelFlow> ();
+      Ptr<FqCoDelFlow> flow = m_flowFactory.Create<FqCoDelFlow> ();
       Ptr<QueueDisc> qd = m_queueDiscFactory.Create<QueueDisc> ();
       qd->Initialize ();
       flow->SetQueueDisc (qd);
       AddQueueDiscClass (flow);
 
-      m_flowsIndices[h] = GetNQueueDiscClasses () - 1;
-    }
-  else
-    {
-      flow = StaticCast<FqCoDelFlow> (GetQueueDiscClass (m_flowsIndices[h]));
+      slot = GetNQueueDiscClasses () - 1;
+      NS_ASSERT (slot == m_slots.size ());
+      FlowSlot newSlot;
+      newSlot.flow = flow;
+      newSlot.next = NO_SLOT;
+      m_slots.push_back (newSlot);
+      m_flowsIndices[h] = slot;
     }
 
+  FqCoDelFlow *flow = PeekPointer (m_slots[slot].flow);
+
   if (flow->GetStatus () == FqCoDelFlow::INACTIVE)
     {
       flow->SetStatus (FqCoDelFlow::NEW_FLOW);
       flow->SetDeficit (m_quantum);
-      m_newFlows.push_back (flow);
+      PushBack (m_newFlows, slot);
     }
 
   flow->GetQueueDisc ()->Enqueue (item);
 
-  NS_LOG_DEBUG ("Packet enqueued into flow " << h << "; flow index " << m_flowsIndices[h]);
+  NS_LOG_DEBUG ("Packet enqueued into flow " << h << "; flow index " << slot);
 
   if (GetCurrentSize () > GetMaxSize ())
     {
@@ -226,23 +244,25 @@ FqCoDelQueueDisc::DoDequeue (void)
 {
   NS_LOG_FUNCTION (this);
 
-  Ptr<FqCoDelFlow> flow;
+  FqCoDelFlow *flow = 0;
   Ptr<QueueDiscItem> item;
 
   do
     {
       bool found = false;
+      uint32_t slot;
 
-      while (!found && !m_newFlows.empty ())
+      while (!found && m_newFlows.head != NO_SLOT)
         {
-          flow = m_newFlows.front ();
+          slot = m_newFlows.head;
+          flow = PeekPointer (m_slots[slot].flow);
 
           if (flow->GetDeficit () <= 0)
             {
               flow->IncreaseDeficit (m_quantum);
               flow->SetStatus (FqCoDelFlow::OLD_FLOW);
-              m_oldFlows.push_back (flow);
-              m_newFlows.pop_front ();
+              PopFront (m_newFlows);
+              PushBack (m_oldFlows, slot);
             }
           else
             {
@@ -251,15 +271,16 @@ FqCoDelQueueDisc::DoDequeue (void)
             }
         }
 
-      while (!found && !m_oldFlows.empty ())
+      while (!found && m_oldFlows.head != NO_SLOT)
         {
-          flow = m_oldFlows.front ();
+          slot = m_oldFlows.head;
+          flow = PeekPointer (m_slots[slot].flow);
 
           if (flow->GetDeficit () <= 0)
             {
               flow->IncreaseDeficit (m_quantum);
-              m_oldFlows.push_back (flow);
-              m_oldFlows.pop_front ();
+              PopFront (m_oldFlows);
+              PushBack (m_oldFlows, slot);
             }
           else
             {
@@ -279,16 +300,16 @@ FqCoDelQueueDisc::DoDequeue (void)
       if (!item)
         {
           NS_LOG_DEBUG ("Could not get a packet from the selected flow queue");
-          if (!m_newFlows.empty ())
+          if (m_newFlows.head != NO_SLOT)
             {
               flow->SetStatus (FqCoDelFlow::OLD_FLOW);
-              m_oldFlows.push_back (flow);
-              m_newFlows.pop_front ();
+              PopFront (m_newFlows);
+              PushBack (m_oldFlows, slot);
             }
           else
             {
               flow->SetStatus (FqCoDelFlow::INACTIVE);
-              m_oldFlows.pop_front ();
+              PopFront (m_oldFlows);
             }
         }
       else
@@ -342,6 +363,8 @@ FqCoDelQueueDisc::InitializeParams (void)
   m_queueDiscFactory.Set ("MaxSize", QueueSizeValue (GetMaxSize ()));
   m_queueDiscFactory.Set ("Interval", StringValue (m_interval));
   m_queueDiscFactory.Set ("Target", StringValue (m_target));
+
+  m_flowsIndices.assign (m_flows, NO_SLOT);
 }
 
 uint32_t
@@ -353,9 +376,9 @@ FqCoDelQueueDisc::FqCoDelDrop (void)
   Ptr<QueueDisc> qd;
 
   /* Queue is full! Find the fat flow and drop packet(s) from it */
-  for (uint32_t i = 0; i < GetNQueueDiscClasses (); i++)
+  for (uint32_t i = 0; i < m_slots.size (); i++)
     {
-      qd = GetQueueDiscClass (i)->GetQueueDisc ();
+      qd = m_slots[i].flow->GetQueueDisc ();
       uint32_t bytes = qd->GetNBytes ();
       if (bytes > maxBacklog)
         {
@@ -366,7 +389,7 @@ FqCoDelQueueDisc::FqCoDelDrop (void)
 
   /* Our goal is to drop half of this fat flow backlog */
   uint32_t len = 0, count = 0, threshold = maxBacklog >> 1;
-  qd = GetQueueDiscClass (index)->GetQueueDisc ();
+  qd = m_slots[index].flow->GetQueueDisc ();
   Ptr<QueueDiscItem> item;
 
   do
@@ -379,4 +402,34 @@ FqCoDelQueueDisc::FqCoDelDrop (void)
   return index;
 }
 
+void
+FqCoDelQueueDisc::PushBack (FlowList &list, uint32_t slot)
+{
+  NS_LOG_FUNCTION (this << slot);
+  m_slots[slot].next = NO_SLOT;
+  if (list.tail == NO_SLOT)
+    {
+      list.head = slot;
+    }
+  else
+    {
+      m_slots[list.tail].next = slot;
+    }
+  list.tail = slot;
+}
+
+void
+FqCoDelQueueDisc::PopFront (FlowList &list)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (list.head != NO_SLOT);
+  uint32_t slot = list.head;
+  list.head = m_slots[slot].next;
+  if (list.head == NO_SLOT)
+    {
+      list.tail = NO_SLOT;
+    }
+  m_slots[slot].next = NO_SLOT;
+}
+
 } // namespace ns3
@@ -24,8 +24,7 @@
 
 #include "ns3/queue-disc.h"
 #include "ns3/object-factory.h"
-#include <list>
-#include <map>
+#include <vector>
 
 namespace ns3 {
 
@@ -96,6 +95,12 @@ private:
  * \ingroup traffic-control
  *
  * \brief A FqCoDel packet queue disc
+ *
+ * The flows are kept in a table of slots, created the first time a packet
+ * is classified into the corresponding bucket and indexed directly by the
+ * bucket number. The lists of new and old flows are linked through the
+ * slots, so that enqueuing and dequeuing packets involve no map lookup and
+ * no allocation once the flows are created.
  */
 
 class FqCoDelQueueDisc : public QueueDisc {
@@ -130,6 +135,12 @@ public:
   static constexpr const char* UNCLASSIFIED_DROP = "Unclassified drop";  //!< No packet filter able to classify packet
   static constexpr const char* OVERLIMIT_DROP = "Overlimit drop";        //!< Overlimit dropped packets
 
+protected:
+  /**
+   * \brief Dispose of the object
+   */
+  virtual void DoDispose (void);
+
 private:
   virtual bool DoEnqueue (Ptr<QueueDiscItem> item);
   virtual Ptr<QueueDiscItem> DoDequeue (void);
@@ -142,6 +153,35 @@ private:
    */
   uint32_t FqCoDelDrop (void);
 
+  /// A slot of the flow table
+  struct FlowSlot
+  {
+    Ptr<FqCoDelFlow> flow;  //!< the flow
+    uint32_t next;          //!< the slot following this one in the list of new or old flows
+  };
+
+  /// A list of new or old flows, linked through the slots of the flow table
+  struct FlowList
+  {
+    uint32_t head;   //!< the first slot of the list, or NO_SLOT
+    uint32_t tail;   //!< the last slot of the list, or NO_SLOT
+  };
+
+  /**
+   * \brief Append a flow to a list of flows
+   * \param list the list
+   * \param slot the slot of the flow
+   */
+  void PushBack (FlowList &list, uint32_t slot);
+
+  /**
+   * \brief Remove the first flow of a list of flows, which must not be empty
+   * \param list the list
+   */
+  void PopFront (FlowList &list);
+
+  static const uint32_t NO_SLOT = 0xffffffff;   //!< Index of no slot
+
   std::string m_interval;    //!< CoDel interval attribute
   std::string m_target;      //!< CoDel target attribute
   uint32_t m_quantum;        //!< Deficit assigned to flows at each round
@@ -149,10 +189,11 @@ private:
   uint32_t m_dropBatchSize;  //!< Max number of packets dropped from the fat flow
   uint32_t m_perturbation;   //!< hash perturbation value
 
-  std::list<Ptr<FqCoDelFlow> > m_newFlows;    //!< The list of new flows
-  std::list<Ptr<FqCoDelFlow> > m_oldFlows;    //!< The list of old flows
+  std::vector<FlowSlot> m_slots;          //!< The flow table, in the order of the classes
+  FlowList m_newFlows;                    //!< The list of new flows
+  FlowList m_oldFlows;                    //!< The list of old flows
 
-  std::map<uint32_t, uint32_t> m_flowsIndices;    //!< Map with the index of class for each flow
+  std::vector<uint32_t> m_flowsIndices;   //!< The slot of each bucket, or NO_SLOT
 
   ObjectFactory m_flowFactory;         //!< Factory to create a new flow
   ObjectFactory m_queueDiscFactory;    //!< Factory to create a new queue
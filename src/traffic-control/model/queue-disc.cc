@@ -29,6 +29,8 @@
 #include "queue-disc.h"
 #include <ns3/drop-tail-queue.h>
 #include "ns3/net-device-queue-interface.h"
+#include "ns3/queue-limits.h"
+#include <algorithm>
 
 namespace ns3 {
 
@@ -355,13 +357,11 @@ QueueDisc::QueueDisc (QueueDiscSizePolicy policy)
   // the packet is dropped.
   m_childQueueDiscDbeFunctor = [this] (Ptr<const QueueDiscItem> item, const char* r)
     {
-      return DropBeforeEnqueue (item,
-                                m_childQueueDiscDropMsg.assign (CHILD_QUEUE_DISC_DROP).append (r).data ());
+      return DropBeforeEnqueue (item, GetChildQueueDiscDropMsg (r));
     };
   m_childQueueDiscDadFunctor = [this] (Ptr<const QueueDiscItem> item, const char* r)
     {
-      return DropAfterDequeue (item,
-                               m_childQueueDiscDropMsg.assign (CHILD_QUEUE_DISC_DROP).append (r).data ());
+      return DropAfterDequeue (item, GetChildQueueDiscDropMsg (r));
     };
 }
 
@@ -386,7 +386,8 @@ QueueDisc::DoDispose (void)
   m_classes.clear ();
   m_device = 0;
   m_devQueueIface = 0;
-  m_requeued = 0;
+  m_requeued.clear ();
+  m_batch.clear ();
   Object::DoDispose ();
 }
 
@@ -428,11 +429,42 @@ QueueDisc::GetStats (void)
   // the total number of sent packets is only updated here to avoid to increase it
   // after a dequeue and then having to decrease it if the packet is dropped after
   // dequeue or requeued
-  m_stats.nTotalSentPackets = m_stats.nTotalDequeuedPackets - (m_requeued ? 1 : 0)
+  uint64_t requeuedBytes = 0;
+  for (std::deque<Ptr<QueueDiscItem> >::const_iterator it = m_requeued.begin (); it != m_requeued.end (); it++)
+    {
+      requeuedBytes += (*it)->GetSize ();
+    }
+  m_stats.nTotalSentPackets = m_stats.nTotalDequeuedPackets - m_requeued.size ()
                               - m_stats.nTotalDroppedPacketsAfterDequeue;
-  m_stats.nTotalSentBytes = m_stats.nTotalDequeuedBytes - (m_requeued ? m_requeued->GetSize () : 0)
+  m_stats.nTotalSentBytes = m_stats.nTotalDequeuedBytes - requeuedBytes
                             - m_stats.nTotalDroppedBytesAfterDequeue;
 
+  // the per-reason counters are only converted to string-keyed maps here
+  m_stats.nDroppedPacketsBeforeEnqueue.clear ();
+  m_stats.nDroppedBytesBeforeEnqueue.clear ();
+  m_stats.nDroppedPacketsAfterDequeue.clear ();
+  m_stats.nDroppedBytesAfterDequeue.clear ();
+  m_stats.nMarkedPackets.clear ();
+  m_stats.nMarkedBytes.clear ();
+  for (std::vector<ReasonStats>::const_iterator it = m_reasons.begin (); it != m_reasons.end (); it++)
+    {
+      if (it->nPackets[DROP_BEFORE_ENQUEUE] > 0)
+        {
+          m_stats.nDroppedPacketsBeforeEnqueue[it->reason] = it->nPackets[DROP_BEFORE_ENQUEUE];
+          m_stats.nDroppedBytesBeforeEnqueue[it->reason] = it->nBytes[DROP_BEFORE_ENQUEUE];
+        }
+      if (it->nPackets[DROP_AFTER_DEQUEUE] > 0)
+        {
+          m_stats.nDroppedPacketsAfterDequeue[it->reason] = it->nPackets[DROP_AFTER_DEQUEUE];
+          m_stats.nDroppedBytesAfterDequeue[it->reason] = it->nBytes[DROP_AFTER_DEQUEUE];
+        }
+      if (it->nPackets[MARK] > 0)
+        {
+          m_stats.nMarkedPackets[it->reason] = it->nPackets[MARK];
+          m_stats.nMarkedBytes[it->reason] = it->nBytes[MARK];
+        }
+    }
+
   return m_stats;
 }
 
@@ -718,26 +750,8 @@ QueueDisc::DropBeforeEnqueue (Ptr<const QueueDiscItem> item, const char* reason)
   m_stats.nTotalDroppedPacketsBeforeEnqueue++;
   m_stats.nTotalDroppedBytesBeforeEnqueue += item->GetSize ();
 
-  // update the number of packets dropped for the given reason
-  std::map<std::string, uint32_t>::iterator itp = m_stats.nDroppedPacketsBeforeEnqueue.find (reason);
-  if (itp != m_stats.nDroppedPacketsBeforeEnqueue.end ())
-    {
-      itp->second++;
-    }
-  else
-    {
-      m_stats.nDroppedPacketsBeforeEnqueue[reason] = 1;
-    }
-  // update the amount of bytes dropped for the given reason
-  std::map<std::string, uint64_t>::iterator itb = m_stats.nDroppedBytesBeforeEnqueue.find (reason);
-  if (itb != m_stats.nDroppedBytesBeforeEnqueue.end ())
-    {
-      itb->second += item->GetSize ();
-    }
-  else
-    {
-      m_stats.nDroppedBytesBeforeEnqueue[reason] = item->GetSize ();
-    }
+  // update the number of packets and bytes dropped for the given reason
+  CountReason (DROP_BEFORE_ENQUEUE, item, reason);
 
   NS_LOG_DEBUG ("Total packets/bytes dropped before enqueue: "
                 << m_stats.nTotalDroppedPacketsBeforeEnqueue << " / "
@@ -757,26 +771,8 @@ QueueDisc::DropAfterDequeue (Ptr<const QueueDiscItem> item, const char* reason)
   m_stats.nTotalDroppedPacketsAfterDequeue++;
   m_stats.nTotalDroppedBytesAfterDequeue += item->GetSize ();
 
-  // update the number of packets dropped for the given reason
-  std::map<std::string, uint32_t>::iterator itp = m_stats.nDroppedPacketsAfterDequeue.find (reason);
-  if (itp != m_stats.nDroppedPacketsAfterDequeue.end ())
-    {
-      itp->second++;
-    }
-  else
-    {
-      m_stats.nDroppedPacketsAfterDequeue[reason] = 1;
-    }
-  // update the amount of bytes dropped for the given reason
-  std::map<std::string, uint64_t>::iterator itb = m_stats.nDroppedBytesAfterDequeue.find (reason);
-  if (itb != m_stats.nDroppedBytesAfterDequeue.end ())
-    {
-      itb->second += item->GetSize ();
-    }
-  else
-    {
-      m_stats.nDroppedBytesAfterDequeue[reason] = item->GetSize ();
-    }
+  // update the number of packets and bytes dropped for the given reason
+  CountReason (DROP_AFTER_DEQUEUE, item, reason);
 
   // if in the context of a peek request a dequeued packet is dropped, we need
   // to update the statistics and fire the dequeue trace before firing the drop
@@ -797,6 +793,59 @@ QueueDisc::DropAfterDequeue (Ptr<const QueueDiscItem> item, const char* reason)
   m_traceDropAfterDequeue (item, reason);
 }
 
+QueueDisc::ReasonStats&
+QueueDisc::GetReasonStats (const char* reason)
+{
+  for (std::vector<ReasonStats>::iterator it = m_reasons.begin (); it != m_reasons.end (); it++)
+    {
+      if (it->key == reason && it->reason.compare (reason) == 0)
+        {
+          return *it;
+        }
+    }
+  for (std::vector<ReasonStats>::iterator it = m_reasons.begin (); it != m_reasons.end (); it++)
+    {
+      if (it->reason.compare (reason) == 0)
+        {
+          return *it;
+        }
+    }
+
+  NS_LOG_DEBUG ("New reason: " << reason);
+  ReasonStats stats;
+  stats.key = reason;
+  stats.reason = reason;
+  std::fill (stats.nPackets, stats.nPackets + N_REASON_COUNTERS, 0);
+  std::fill (stats.nBytes, stats.nBytes + N_REASON_COUNTERS, 0);
+  m_reasons.push_back (stats);
+  return m_reasons.back ();
+}
+
+const char*
+QueueDisc::GetChildQueueDiscDropMsg (const char* reason)
+{
+  static const std::string::size_type prefixLength = std::string (CHILD_QUEUE_DISC_DROP).size ();
+  std::map<const char*, std::string>::iterator it = m_childQueueDiscDropMsgs.find (reason);
+  if (it == m_childQueueDiscDropMsgs.end ())
+    {
+      it = m_childQueueDiscDropMsgs.insert (std::make_pair (reason, std::string (CHILD_QUEUE_DISC_DROP) + reason)).first;
+    }
+  else if (it->second.compare (prefixLength, std::string::npos, reason) != 0)
+    {
+      // the child reused the buffer of the reason for another reason
+      it->second.assign (CHILD_QUEUE_DISC_DROP).append (reason);
+    }
+  return it->second.c_str ();
+}
+
+void
+QueueDisc::CountReason (ReasonCounter counter, Ptr<const QueueDiscItem> item, const char* reason)
+{
+  ReasonStats& stats = GetReasonStats (reason);
+  stats.nPackets[counter]++;
+  stats.nBytes[counter] += item->GetSize ();
+}
+
 bool
 QueueDisc::Mark (Ptr<QueueDiscItem> item, const char* reason)
 {
@@ -812,26 +861,8 @@ QueueDisc::Mark (Ptr<QueueDiscItem> item, const char* reason)
   m_stats.nTotalMarkedPackets++;
   m_stats.nTotalMarkedBytes += item->GetSize ();
 
-  // update the number of packets marked for the given reason
-  std::map<std::string, uint32_t>::iterator itp = m_stats.nMarkedPackets.find (reason);
-  if (itp != m_stats.nMarkedPackets.end ())
-    {
-      itp->second++;
-    }
-  else
-    {
-      m_stats.nMarkedPackets[reason] = 1;
-    }
-  // update the amount of bytes marked for the given reason
-  std::map<std::string, uint64_t>::iterator itb = m_stats.nMarkedBytes.find (reason);
-  if (itb != m_stats.nMarkedBytes.end ())
-    {
-      itb->second += item->GetSize ();
-    }
-  else
-    {
-      m_stats.nMarkedBytes[reason] = item->GetSize ();
-    }
+  // update the number of packets and bytes marked for the given reason
+  CountReason (MARK, item, reason);
 
   NS_LOG_DEBUG ("Total packets/bytes marked: "
                 << m_stats.nTotalMarkedPackets << " / "
@@ -883,11 +914,12 @@ QueueDisc::Dequeue (void)
   // The QueueDisc::DoPeek method dequeues a packet and keeps it as a requeued
   // packet. Thus, first check whether a peeked packet exists. Otherwise, call
   // the private DoDequeue method.
-  Ptr<QueueDiscItem> item = m_requeued;
+  Ptr<QueueDiscItem> item;
 
-  if (item)
+  if (!m_requeued.empty ())
     {
-      m_requeued = 0;
+      item = m_requeued.front ();
+      m_requeued.pop_front ();
       if (m_peeked)
         {
           // If the packet was requeued because a peek operation was requested
@@ -921,17 +953,19 @@ QueueDisc::DoPeek (void)
 {
   NS_LOG_FUNCTION (this);
 
-  if (!m_requeued)
+  if (m_requeued.empty ())
     {
       m_peeked = true;
-      m_requeued = Dequeue ();
+      Ptr<QueueDiscItem> item = Dequeue ();
       // if no packet is returned, reset the m_peeked flag
-      if (!m_requeued)
+      if (!item)
         {
           m_peeked = false;
+          return 0;
         }
+      m_requeued.push_back (item);
     }
-  return m_requeued;
+  return m_requeued.front ();
 }
 
 void
@@ -942,10 +976,9 @@ QueueDisc::Run (void)
   if (RunBegin ())
     {
       uint32_t quota = m_quota;
-      while (Restart ())
+      while (Restart (quota))
         {
-          quota -= 1;
-          if (quota <= 0)
+          if (quota == 0)
             {
               /// \todo netif_schedule (q);
               break;
@@ -976,36 +1009,43 @@ QueueDisc::RunEnd (void)
 }
 
 bool
-QueueDisc::Restart (void)
+QueueDisc::Restart (uint32_t &quota)
 {
-  NS_LOG_FUNCTION (this);
-  Ptr<QueueDiscItem> item = DequeuePacket();
+  NS_LOG_FUNCTION (this << quota);
+  Ptr<QueueDiscItem> item = DequeuePacket (quota);
   if (item == 0)
     {
       NS_LOG_LOGIC ("No packet to send");
       return false;
     }
 
+  quota -= 1 + m_batch.size ();
+
+  if (!m_batch.empty ())
+    {
+      return TransmitBatch (item);
+    }
   return Transmit (item);
 }
 
 Ptr<QueueDiscItem>
-QueueDisc::DequeuePacket ()
+QueueDisc::DequeuePacket (uint32_t quota)
 {
-  NS_LOG_FUNCTION (this);
+  NS_LOG_FUNCTION (this << quota);
   NS_ASSERT (m_devQueueIface);
+  NS_ASSERT (m_batch.empty ());
   Ptr<QueueDiscItem> item;
 
   // First check if there is a requeued packet
-  if (m_requeued != 0)
+  if (!m_requeued.empty ())
     {
         // If the queue where the requeued packet is destined to is not stopped, return
         // the requeued packet; otherwise, return an empty packet.
         // If the device does not support flow control, the device queue is never stopped
-        if (!m_devQueueIface->GetTxQueue (m_requeued->GetTxQueueIndex ())->IsStopped ())
+        if (!m_devQueueIface->GetTxQueue (m_requeued.front ()->GetTxQueueIndex ())->IsStopped ())
           {
-            item = m_requeued;
-            m_requeued = 0;
+            item = m_requeued.front ();
+            m_requeued.pop_front ();
             if (m_peeked)
               {
                 // If the packet was requeued because a peek operation was requested
@@ -1031,7 +1071,26 @@ QueueDisc::DequeuePacket ()
             {
               item->AddHeader ();
             }
-          // Here, Linux tries bulk dequeues
+          // Here, Linux tries bulk dequeues, if the device has a single queue
+          // whose queue limits bound the number of bytes that can be dequeued
+          Ptr<QueueLimits> ql;
+          if (item != 0 && m_devQueueIface->GetNTxQueues () == 1
+              && (ql = m_devQueueIface->GetTxQueue (0)->GetQueueLimits ()) != 0)
+            {
+              int64_t bytelimit = ql->Available () - item->GetSize ();
+              while (bytelimit > 0 && 1 + m_batch.size () < quota)
+                {
+                  Ptr<QueueDiscItem> next = Dequeue ();
+                  if (next == 0)
+                    {
+                      break;
+                    }
+                  next->AddHeader ();
+                  bytelimit -= next->GetSize ();
+                  m_batch.push_back (next);
+                }
+              NS_LOG_LOGIC ("Bulk dequeued " << m_batch.size () << " packets after the first one");
+            }
         }
     }
   return item;
@@ -1041,7 +1100,7 @@ void
 QueueDisc::Requeue (Ptr<QueueDiscItem> item)
 {
   NS_LOG_FUNCTION (this << item);
-  m_requeued = item;
+  m_requeued.push_back (item);
   /// \todo netif_schedule (q);
 
   m_stats.nTotalRequeuedPackets++;
@@ -1066,13 +1125,7 @@ QueueDisc::Transmit (Ptr<QueueDiscItem> item)
       return false;
     }
 
-  // a single queue device makes no use of the priority tag
-  if (m_devQueueIface->GetNTxQueues () == 1)
-    {
-      SocketPriorityTag priorityTag;
-      item->GetPacket ()->RemovePacketTag (priorityTag);
-    }
-  m_device->Send (item->GetPacket (), item->GetAddress (), item->GetProtocol ());
+  SendToDevice (item);
 
   // the behavior here slightly diverges from Linux. In Linux, it is advised that
   // the function called when a packet needs to be transmitted (ndo_start_xmit)
@@ -1088,9 +1141,11 @@ QueueDisc::Transmit (Ptr<QueueDiscItem> item)
   // of the value returned by NetDevice::Send does not match that of the value
   // returned by ndo_start_xmit.
 
-  // if the queue disc is empty or the device queue is now stopped, return false so
-  // that the Run method does not attempt to dequeue other packets and exits
-  if (GetNPackets () == 0 || m_devQueueIface->GetTxQueue (item->GetTxQueueIndex ())->IsStopped ())
+  // if the queue disc is empty (requeued packets included) or the device queue
+  // is now stopped, return false so that the Run method does not attempt to
+  // dequeue other packets and exits
+  if ((GetNPackets () == 0 && m_requeued.empty ())
+      || m_devQueueIface->GetTxQueue (item->GetTxQueueIndex ())->IsStopped ())
     {
       return false;
     }
@@ -1098,4 +1153,55 @@ QueueDisc::Transmit (Ptr<QueueDiscItem> item)
   return true;
 }
 
+bool
+QueueDisc::TransmitBatch (Ptr<QueueDiscItem> item)
+{
+  NS_LOG_FUNCTION (this << item << m_batch.size ());
+  NS_ASSERT (m_devQueueIface && m_devQueueIface->GetNTxQueues () == 1);
+
+  Ptr<NetDeviceQueue> txq = m_devQueueIface->GetTxQueue (0);
+  uint32_t i = 0;
+  while (!txq->IsStopped ())
+    {
+      SendToDevice (item);
+      if (i == m_batch.size ())
+        {
+          item = 0;
+          break;
+        }
+      item = m_batch[i++];
+    }
+
+  // the device queue has been stopped: requeue the packets that were not sent,
+  // in order (Linux requeues the rest of the skb list)
+  if (item != 0)
+    {
+      Requeue (item);
+      while (i < m_batch.size ())
+        {
+          Requeue (m_batch[i++]);
+        }
+    }
+  m_batch.clear ();
+
+  // if the queue disc is empty (requeued packets included) or the device queue
+  // is now stopped, return false so that the Run method does not attempt to
+  // dequeue other packets and exits
+  return (GetNPackets () != 0 || !m_requeued.empty ()) && !txq->IsStopped ();
+}
+
+void
+QueueDisc::SendToDevice (Ptr<QueueDiscItem> item)
+{
+  NS_LOG_FUNCTION (this << item);
+
+  // a single queue device makes no use of the priority tag
+  if (m_devQueueIface->GetNTxQueues () == 1)
+    {
+      SocketPriorityTag priorityTag;
+      item->GetPacket ()->RemovePacketTag (priorityTag);
+    }
+  m_device->Send (item->GetPacket (), item->GetAddress (), item->GetProtocol ());
+}
+
 } // namespace ns3
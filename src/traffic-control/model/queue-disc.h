@@ -27,6 +27,7 @@
 #include "ns3/queue-item.h"
 #include "ns3/queue-size.h"
 #include <vector>
+#include <deque>
 #include <map>
 #include <functional>
 #include <string>
@@ -182,7 +183,11 @@ enum QueueDiscSizePolicy
 class QueueDisc : public Object {
 public:
 
-  /// \brief Structure that keeps the queue disc statistics
+  /**
+   * \brief Structure that keeps the queue disc statistics
+   *
+   * The counters for each reason are only filled by QueueDisc::GetStats.
+   */
   struct Stats
   {
     /// Total received packets
@@ -617,20 +622,31 @@ private:
 
   /**
    * Modelled after the Linux function qdisc_restart (net/sched/sch_generic.c)
-   * Dequeue a packet (by calling DequeuePacket) and send it to the device (by calling Transmit).
-   * \return true if a packet is successfully sent to the device.
+   * Dequeue a packet, or a batch of packets (by calling DequeuePacket), and send
+   * them to the device (by calling Transmit or TransmitBatch).
+   * \param quota the number of packets that can still be dequeued in this run,
+   *        decreased by the number of packets dequeued
+   * \return true if the packets are successfully sent to the device.
    */
-  bool Restart (void);
+  bool Restart (uint32_t &quota);
 
   /**
    * Modelled after the Linux function dequeue_skb (net/sched/sch_generic.c)
+   *
+   * If the device has a single transmission queue with queue limits (BQL),
+   * the packets dequeued after the first one, up to the bytes available in
+   * the device queue and to the given quota, are appended to m_batch, as in
+   * the Linux function try_bulk_dequeue_skb.
+   *
+   * \param quota the number of packets that can be dequeued
    * \return the requeued packet, if any, or the packet dequeued by the queue disc, otherwise.
    */
-  Ptr<QueueDiscItem> DequeuePacket (void);
+  Ptr<QueueDiscItem> DequeuePacket (uint32_t quota);
 
   /**
    * Modelled after the Linux function dev_requeue_skb (net/sched/sch_generic.c)
-   * Requeues a packet whose transmission failed.
+   * Requeues a packet whose transmission failed. The requeued packets are
+   * sent in the order they are requeued.
    * \param item the packet to requeue
    */
   void Requeue (Ptr<QueueDiscItem> item);
@@ -644,6 +660,21 @@ private:
    */
   bool Transmit (Ptr<QueueDiscItem> item);
 
+  /**
+   * Modelled after the Linux function dev_hard_start_xmit (net/core/dev.c)
+   * Sends the packets of m_batch, which follow the given packet, to the device
+   * (single queue) until the device queue is stopped, and requeues the others.
+   * \param item the first packet of the batch
+   * \return true if the device queue is not stopped and the queue disc is not empty
+   */
+  bool TransmitBatch (Ptr<QueueDiscItem> item);
+
+  /**
+   * Send a packet to the device, with no check on the device queue.
+   * \param item the packet to send
+   */
+  void SendToDevice (Ptr<QueueDiscItem> item);
+
   /**
    *  \brief Perform the actions required when the queue disc is notified of
    *         a packet enqueue
@@ -669,14 +700,70 @@ private:
   TracedCallback<Time> m_sojourn;   //!< Sojourn time of the latest dequeued packet
   QueueSize m_maxSize;              //!< max queue size
 
+  /// Kinds of per-reason counters
+  enum ReasonCounter
+  {
+    DROP_BEFORE_ENQUEUE = 0,
+    DROP_AFTER_DEQUEUE,
+    MARK,
+    N_REASON_COUNTERS
+  };
+
+  /// Counters of the packets dropped or marked for a given reason
+  struct ReasonStats
+  {
+    const char* key;                         //!< Address of the string the reason was interned from
+    std::string reason;                      //!< The reason
+    uint32_t nPackets[N_REASON_COUNTERS];    //!< Packets, for each kind of counter
+    uint64_t nBytes[N_REASON_COUNTERS];      //!< Bytes, for each kind of counter
+  };
+
+  /**
+   * \brief Get the counters of the given reason, creating them if needed
+   *
+   * The reasons are looked up by the address of their string first, which
+   * is stable for the constants defined by the queue discs and for the
+   * reasons interned by GetChildQueueDiscDropMsg, so that a string is only
+   * allocated the first time a reason is seen.  The content of the string
+   * is still compared, since the caller may reuse a buffer for several
+   * reasons.
+   *
+   * \param reason the reason
+   * \return the counters of the reason
+   */
+  ReasonStats& GetReasonStats (const char* reason);
+
+  /**
+   * \brief Update the counters of the given reason
+   * \param counter the kind of counter to update
+   * \param item the item dropped or marked
+   * \param reason the reason
+   */
+  void CountReason (ReasonCounter counter, Ptr<const QueueDiscItem> item, const char* reason);
+
+  /**
+   * \brief Get the reason why a packet was dropped by a child queue disc
+   *
+   * The reason is the concatenation of CHILD_QUEUE_DISC_DROP and the reason
+   * given by the child queue disc, interned by the address of the latter so
+   * that its address is usually stable.  The interned reason is rebuilt if
+   * the child queue disc gives another reason at the same address.
+   *
+   * \param reason the reason given by the child queue disc
+   * \return the reason
+   */
+  const char* GetChildQueueDiscDropMsg (const char* reason);
+
   Stats m_stats;                    //!< The collected statistics
+  std::vector<ReasonStats> m_reasons;   //!< Counters for each reason
   uint32_t m_quota;                 //!< Maximum number of packets dequeued in a qdisc run
   Ptr<NetDevice> m_device;          //!< The NetDevice on which this queue discipline is installed
   Ptr<NetDeviceQueueInterface> m_devQueueIface;   //!< NetDevice queue interface
   bool m_running;                   //!< The queue disc is performing multiple dequeue operations
-  Ptr<QueueDiscItem> m_requeued;    //!< The last packet that failed to be transmitted
+  std::deque<Ptr<QueueDiscItem> > m_requeued;  //!< The packets that failed to be transmitted
+  std::vector<Ptr<QueueDiscItem> > m_batch;     //!< The packets bulk dequeued after the first one
   bool m_peeked;                    //!< A packet was dequeued because Peek was called
-  std::string m_childQueueDiscDropMsg;  //!< Reason why a packet was dropped by a child queue disc
+  std::map<const char*, std::string> m_childQueueDiscDropMsgs;  //!< Reasons why a packet was dropped by a child queue disc
   QueueDiscSizePolicy m_sizePolicy;     //!< The queue disc size policy
   bool m_prohibitChangeMode;            //!< True if changing mode is prohibited
 
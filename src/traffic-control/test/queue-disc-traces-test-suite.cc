@@ -555,6 +555,22 @@ QueueDiscTracesTestCase::DoRun (void)
   CheckDroppedBeforeEnqueue (child, 1, pktSizeUnit * 5);
   CheckDroppedAfterDequeue (child, 2, pktSizeUnit * 3);
 
+  // The drops are counted for each reason, those of the child queue disc being
+  // reported by the root queue disc with the CHILD_QUEUE_DISC_DROP prefix.
+  std::string childDrop = QueueDisc::CHILD_QUEUE_DISC_DROP;
+  QueueDisc::Stats stats = child->GetStats ();
+  NS_TEST_EXPECT_MSG_EQ (stats.GetNDroppedPackets (TestChildQueueDisc::BEFORE_ENQUEUE), 1,
+                         "Verify that the packets dropped before enqueue are counted for their reason");
+  NS_TEST_EXPECT_MSG_EQ (stats.GetNDroppedBytes (TestChildQueueDisc::AFTER_DEQUEUE), pktSizeUnit * 3,
+                         "Verify that the bytes dropped after dequeue are counted for their reason");
+  stats = root->GetStats ();
+  NS_TEST_EXPECT_MSG_EQ (stats.nDroppedPacketsBeforeEnqueue.size (), 1,
+                         "Verify that one reason of drop before enqueue is reported");
+  NS_TEST_EXPECT_MSG_EQ (stats.GetNDroppedPackets (childDrop + TestChildQueueDisc::BEFORE_ENQUEUE), 1,
+                         "Verify that the drops of the child queue disc are counted for their reason");
+  NS_TEST_EXPECT_MSG_EQ (stats.GetNDroppedPackets (childDrop + TestChildQueueDisc::AFTER_DEQUEUE), 2,
+                         "Verify that the drops of the child queue disc are counted for their reason");
+
   Simulator::Destroy ();
 }
 
@@ -33,6 +33,7 @@
 #include "ns3/simple-channel.h"
 #include "ns3/drop-tail-queue.h"
 #include "ns3/net-device-queue-interface.h"
+#include "ns3/queue-limits.h"
 #include "ns3/config.h"
 
 using namespace ns3;
@@ -374,6 +375,284 @@ TcFlowControlTestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Traffic Control Bulk Dequeue Test Case
+ *
+ * With queue limits (BQL) on the device queue, the queue disc dequeues
+ * several packets, up to the bytes available in the device queue, before
+ * handing them to the device. All the packets must be transmitted and none
+ * must be dropped, even if the device queue is stopped within a batch.
+ */
+class TcBulkDequeueTestCase : public TestCase
+{
+public:
+  TcBulkDequeueTestCase ();
+private:
+  virtual void DoRun (void);
+  /**
+   * Record a packet dequeued from the queue disc
+   * \param item the packet
+   */
+  void QueueDiscDequeue (Ptr<const QueueDiscItem> item);
+  /**
+   * Record a packet enqueued in the device queue
+   * \param p the packet
+   */
+  void DeviceEnqueue (Ptr<const Packet> p);
+  std::string m_events; //!< 'D' for each queue disc dequeue, 'E' for each device enqueue
+};
+
+TcBulkDequeueTestCase::TcBulkDequeueTestCase ()
+  : TestCase ("Test the bulk dequeue of the queue discs")
+{
+}
+
+void
+TcBulkDequeueTestCase::QueueDiscDequeue (Ptr<const QueueDiscItem> item)
+{
+  m_events += 'D';
+}
+
+void
+TcBulkDequeueTestCase::DeviceEnqueue (Ptr<const Packet> p)
+{
+  m_events += 'E';
+}
+
+void
+TcBulkDequeueTestCase::DoRun (void)
+{
+  NodeContainer n;
+  n.Create (2);
+
+  n.Get (0)->AggregateObject (CreateObject<TrafficControlLayer> ());
+  n.Get (1)->AggregateObject (CreateObject<TrafficControlLayer> ());
+
+  Ptr<Queue<Packet> > queue = CreateObjectWithAttributes<DropTailQueue<Packet> > ("MaxSize", StringValue ("5p"));
+  queue->TraceConnectWithoutContext ("Enqueue", MakeCallback (&TcBulkDequeueTestCase::DeviceEnqueue, this));
+
+  Ptr<SimpleNetDevice> txDev, rxDev;
+  txDev = CreateObjectWithAttributes<SimpleNetDevice> ("TxQueue", PointerValue (queue),
+                                                       "DataRate", DataRateValue (DataRate ("1Mb/s")));
+  rxDev = CreateObject<SimpleNetDevice> ();
+  n.Get (0)->AddDevice (txDev);
+  n.Get (1)->AddDevice (rxDev);
+  Ptr<SimpleChannel> channel1 = CreateObject<SimpleChannel> ();
+  txDev->SetChannel (channel1);
+  rxDev->SetChannel (channel1);
+
+  txDev->SetMtu (2500);
+
+  TrafficControlHelper tch = TrafficControlHelper::Default ();
+  tch.SetQueueLimits ("ns3::DynamicQueueLimits", "MinLimit", UintegerValue (3000));
+  tch.Install (txDev);
+
+  Ptr<QueueDisc> qdisc = n.Get (0)->GetObject<TrafficControlLayer> ()->GetRootQueueDiscOnDevice (txDev);
+  qdisc->TraceConnectWithoutContext ("Dequeue", MakeCallback (&TcBulkDequeueTestCase::QueueDiscDequeue, this));
+
+  // transmit 10 packets at time 0: the queue disc builds up a backlog once
+  // the queue limits stop the device queue, and then dequeues in batches
+  Ptr<TrafficControlLayer> tc = n.Get (0)->GetObject<TrafficControlLayer> ();
+  for (uint16_t i = 0; i < 10; i++)
+    {
+      Simulator::Schedule (Seconds (0), &TrafficControlLayer::Send, tc, txDev,
+                           Create<QueueDiscTestItem> (Create<Packet> (1000)));
+    }
+
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_NE (m_events.find ("DDD"), std::string::npos,
+                         "No batch of packets dequeued from the queue disc: " << m_events);
+  NS_TEST_EXPECT_MSG_EQ (qdisc->GetNPackets (), 0, "The queue disc must be empty");
+  QueueDisc::Stats stats = qdisc->GetStats ();
+  NS_TEST_EXPECT_MSG_EQ (stats.nTotalSentPackets, 10, "All the packets must be sent to the device");
+  NS_TEST_EXPECT_MSG_EQ (stats.nTotalDroppedPackets, 0, "No packet must be dropped by the queue disc");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetTotalReceivedPackets (), 10, "All the packets must reach the device queue");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetTotalDroppedPackets (), 0, "No packet must be dropped by the device queue");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Queue limits whose limit is set by the test upon completions
+ *
+ * As DynamicQueueLimits may do, the limit changes when bytes are completed,
+ * taking in turn the values given to the constructor.
+ */
+class TcTestQueueLimits : public QueueLimits
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  /**
+   * \param limits the initial limit, then the limits set upon each completion
+   */
+  TcTestQueueLimits (std::vector<int32_t> limits);
+  virtual void Reset ();
+  virtual void Completed (uint32_t count);
+  virtual int32_t Available () const;
+  virtual void Queued (uint32_t count);
+private:
+  std::vector<int32_t> m_limits;  //!< the limits to set
+  uint32_t m_next;                //!< index of the current limit
+  int32_t m_queued;               //!< the bytes queued and not completed
+};
+
+TypeId
+TcTestQueueLimits::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TcTestQueueLimits")
+    .SetParent<QueueLimits> ()
+    .SetGroupName ("TrafficControl")
+  ;
+  return tid;
+}
+
+TcTestQueueLimits::TcTestQueueLimits (std::vector<int32_t> limits)
+  : m_limits (limits),
+    m_next (0),
+    m_queued (0)
+{
+}
+
+void
+TcTestQueueLimits::Reset ()
+{
+  m_queued = 0;
+}
+
+void
+TcTestQueueLimits::Completed (uint32_t count)
+{
+  m_queued -= count;
+  if (m_next + 1 < m_limits.size ())
+    {
+      m_next++;
+    }
+}
+
+int32_t
+TcTestQueueLimits::Available () const
+{
+  return m_limits[m_next] - m_queued;
+}
+
+void
+TcTestQueueLimits::Queued (uint32_t count)
+{
+  m_queued += count;
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Traffic Control Requeued Batch Test Case
+ *
+ * The queue limits stop the device queue in the middle of a batch, when the
+ * queue disc holds no other packet.  When the device queue is woken, all the
+ * requeued packets must be sent to the device, not just the first one.
+ */
+class TcRequeuedBatchTestCase : public TestCase
+{
+public:
+  TcRequeuedBatchTestCase ();
+private:
+  virtual void DoRun (void);
+  /**
+   * Check the number of packets sent by the queue disc
+   * \param qdisc the queue disc
+   * \param nPackets the expected number of packets
+   * \param msg the message to print if a different number of packets is found
+   */
+  void CheckSentPackets (Ptr<QueueDisc> qdisc, uint32_t nPackets, const char* msg);
+  /**
+   * Enqueue packets in the queue disc, then run it, so that it dequeues
+   * them in a single batch
+   * \param qdisc the queue disc
+   * \param nPackets the number of packets
+   */
+  void EnqueueAndRun (Ptr<QueueDisc> qdisc, uint32_t nPackets);
+};
+
+TcRequeuedBatchTestCase::TcRequeuedBatchTestCase ()
+  : TestCase ("Test that the requeued packets of a batch leave after one wake")
+{
+}
+
+void
+TcRequeuedBatchTestCase::CheckSentPackets (Ptr<QueueDisc> qdisc, uint32_t nPackets, const char* msg)
+{
+  NS_TEST_EXPECT_MSG_EQ (qdisc->GetStats ().nTotalSentPackets, nPackets, msg);
+}
+
+void
+TcRequeuedBatchTestCase::EnqueueAndRun (Ptr<QueueDisc> qdisc, uint32_t nPackets)
+{
+  for (uint32_t i = 0; i < nPackets; i++)
+    {
+      qdisc->Enqueue (Create<QueueDiscTestItem> (Create<Packet> (1000)));
+    }
+  qdisc->Run ();
+}
+
+void
+TcRequeuedBatchTestCase::DoRun (void)
+{
+  NodeContainer n;
+  n.Create (2);
+
+  n.Get (0)->AggregateObject (CreateObject<TrafficControlLayer> ());
+  n.Get (1)->AggregateObject (CreateObject<TrafficControlLayer> ());
+
+  Ptr<Queue<Packet> > queue = CreateObjectWithAttributes<DropTailQueue<Packet> > ("MaxSize", StringValue ("100p"));
+
+  Ptr<SimpleNetDevice> txDev, rxDev;
+  txDev = CreateObjectWithAttributes<SimpleNetDevice> ("TxQueue", PointerValue (queue),
+                                                       "DataRate", DataRateValue (DataRate ("1Mb/s")));
+  rxDev = CreateObject<SimpleNetDevice> ();
+  n.Get (0)->AddDevice (txDev);
+  n.Get (1)->AddDevice (rxDev);
+  Ptr<SimpleChannel> channel1 = CreateObject<SimpleChannel> ();
+  txDev->SetChannel (channel1);
+  rxDev->SetChannel (channel1);
+
+  TrafficControlHelper tch = TrafficControlHelper::Default ();
+  tch.Install (txDev);
+
+  // The first packet, sent to the idle device, is completed at once and
+  // shrinks the limit to 3500 bytes: the device queue is stopped by the
+  // queue limits after the fifth packet of the batch, and the last three are
+  // requeued.  The completion of the second packet (at 8 ms) raises the limit
+  // to 10000 bytes and wakes the device queue.
+  Ptr<TcTestQueueLimits> ql = CreateObject<TcTestQueueLimits> (std::vector<int32_t> {7500, 3500, 10000});
+  txDev->GetObject<NetDeviceQueueInterface> ()->GetTxQueue (0)->SetQueueLimits (ql);
+
+  Ptr<QueueDisc> qdisc = n.Get (0)->GetObject<TrafficControlLayer> ()->GetRootQueueDiscOnDevice (txDev);
+  Simulator::Schedule (Seconds (0), &TcRequeuedBatchTestCase::EnqueueAndRun, this, qdisc, 8);
+
+  Simulator::Schedule (MilliSeconds (1), &TcRequeuedBatchTestCase::CheckSentPackets, this, qdisc, 5,
+                       "The device queue must be stopped after the fifth packet");
+  Simulator::Schedule (MilliSeconds (9), &TcRequeuedBatchTestCase::CheckSentPackets, this, qdisc, 8,
+                       "All the requeued packets must be sent after the device queue is woken");
+  Simulator::Run ();
+
+  QueueDisc::Stats stats = qdisc->GetStats ();
+  NS_TEST_EXPECT_MSG_EQ (stats.nTotalRequeuedPackets, 3, "Three packets must be requeued");
+  NS_TEST_EXPECT_MSG_EQ (stats.nTotalSentPackets, 8, "All the packets must be sent to the device");
+
+  Simulator::Destroy ();
+}
+
 /**
  * \ingroup traffic-control-test
  * \ingroup tests
@@ -388,5 +667,7 @@ public:
   {
     AddTestCase (new TcFlowControlTestCase (QueueSizeUnit::PACKETS), TestCase::QUICK);
     AddTestCase (new TcFlowControlTestCase (QueueSizeUnit::BYTES), TestCase::QUICK);
+    AddTestCase (new TcBulkDequeueTestCase (), TestCase::QUICK);
+    AddTestCase (new TcRequeuedBatchTestCase (), TestCase::QUICK);
   }
 } g_tcFlowControlTestSuite; ///< the test suite
@@ -510,6 +510,24 @@ WifiPhyHelper::EnablePcapInternal (std::string prefix, Ptr<NetDevice> nd, bool p
   phy->TraceConnectWithoutContext ("MonitorSnifferRx", MakeBoundCallback (&WifiPhyHelper::PcapSniffRxEvent, file));
 }
 
+void
+WifiPhyHelper::EnablePcapDropsInternal (Ptr<NetDevice> nd, Ptr<PcapFileWrapper> file)
+{
+  NS_LOG_FUNCTION (this << nd << file);
+  Ptr<WifiNetDevice> device = nd->GetObject<WifiNetDevice> ();
+  if (device == 0)
+    {
+      NS_LOG_INFO ("WifiHelper::EnablePcapDropsInternal(): Device " << &device << " not of type ns3::WifiNetDevice");
+      return;
+    }
+
+  PcapHelper pcapHelper;
+  bool result = pcapHelper.HookDropSink<WifiMac> (device->GetMac (), "MacTxDrop", file);
+  NS_ASSERT_MSG (result, "WifiPhyHelper::EnablePcapDropsInternal(): Unable to hook \"MacTxDrop\"");
+  result = pcapHelper.HookDropSink<WifiPhy> (device->GetPhy (), "PhyRxDrop", file);
+  NS_ASSERT_MSG (result, "WifiPhyHelper::EnablePcapDropsInternal(): Unable to hook \"PhyRxDrop\"");
+}
+
 void
 WifiPhyHelper::EnableAsciiInternal (
   Ptr<OutputStreamWrapper> stream,
@@ -200,6 +200,18 @@ private:
                                    bool promiscuous,
                                    bool explicitFilename);
 
+  /**
+   * \brief Write the packets dropped by the indicated net device to the
+   * given pcap file.
+   *
+   * The drops are reported by the MacTxDrop trace source of the MAC and
+   * the PhyRxDrop trace source of the PHY.
+   *
+   * \param nd Net device for which you want to capture the drops.
+   * \param file the pcap file, attached to a pcapng file
+   */
+  virtual void EnablePcapDropsInternal (Ptr<NetDevice> nd, Ptr<PcapFileWrapper> file);
+
   /**
    * \brief Enable ascii trace output on the indicated net device.
    *
@@ -24,6 +24,7 @@
 #include "ns3/pointer.h"
 #include "ns3/log.h"
 #include "ns3/node.h"
+#include "ns3/simulator.h"
 #include "ns3/net-device-queue-interface.h"
 #include "wifi-net-device.h"
 #include "wifi-phy.h"
@@ -72,7 +73,8 @@ WifiNetDevice::GetTypeId (void)
 }
 
 WifiNetDevice::WifiNetDevice ()
-  : m_configComplete (false)
+  : m_readyTracesConnected (false),
+    m_configComplete (false)
 {
   NS_LOG_FUNCTION_NOARGS ();
 }
@@ -94,6 +96,8 @@ WifiNetDevice::DoDispose (void)
   m_phy = 0;
   m_stationManager = 0;
   m_queueInterface = 0;
+  m_txQueues.clear ();
+  m_readyCallback = MakeNullCallback<void, Ptr<NetDevice> > ();
   NetDevice::DoDispose ();
 }
 
@@ -157,52 +161,61 @@ WifiNetDevice::FlowControlConfig (void)
       return;
     }
 
-  Ptr<RegularWifiMac> mac = DynamicCast<RegularWifiMac> (m_mac);
-  if (mac == 0)
+  if (m_txQueues.empty ())
     {
       NS_LOG_WARN ("Flow control is only supported by RegularWifiMac");
       return;
     }
 
+  if (m_txQueues.size () > 1)
+    {
+      m_queueInterface->SetTxQueuesN (m_txQueues.size ());
+    }
+  m_queueInterface->CreateTxQueues ();
+
+  for (uint8_t i = 0; i < m_txQueues.size (); i++)
+    {
+      m_queueInterface->ConnectQueueTraces<WifiMacQueueItem> (m_txQueues[i], i);
+    }
+}
+
+std::vector<Ptr<WifiMacQueue> >
+WifiNetDevice::GetTxQueues (void) const
+{
+  std::vector<Ptr<WifiMacQueue> > queues;
+  Ptr<RegularWifiMac> mac = DynamicCast<RegularWifiMac> (m_mac);
+  if (mac == 0)
+    {
+      return queues;
+    }
+
   BooleanValue qosSupported;
   mac->GetAttributeFailSafe ("QosSupported", qosSupported);
   PointerValue ptr;
-  Ptr<WifiMacQueue> wmq;
   if (qosSupported.Get ())
     {
-      m_queueInterface->SetTxQueuesN (4);
-      m_queueInterface->CreateTxQueues ();
-
       mac->GetAttributeFailSafe ("BE_Txop", ptr);
-      wmq = ptr.Get<QosTxop> ()->GetWifiMacQueue ();
-      m_queueInterface->ConnectQueueTraces<WifiMacQueueItem> (wmq, 0);
-
+      queues.push_back (ptr.Get<QosTxop> ()->GetWifiMacQueue ());
       mac->GetAttributeFailSafe ("BK_Txop", ptr);
-      wmq = ptr.Get<QosTxop> ()->GetWifiMacQueue ();
-      m_queueInterface->ConnectQueueTraces<WifiMacQueueItem> (wmq, 1);
-
+      queues.push_back (ptr.Get<QosTxop> ()->GetWifiMacQueue ());
       mac->GetAttributeFailSafe ("VI_Txop", ptr);
-      wmq = ptr.Get<QosTxop> ()->GetWifiMacQueue ();
-      m_queueInterface->ConnectQueueTraces<WifiMacQueueItem> (wmq, 2);
-
+      queues.push_back (ptr.Get<QosTxop> ()->GetWifiMacQueue ());
       mac->GetAttributeFailSafe ("VO_Txop", ptr);
-      wmq = ptr.Get<QosTxop> ()->GetWifiMacQueue ();
-      m_queueInterface->ConnectQueueTraces<WifiMacQueueItem> (wmq, 3);
+      queues.push_back (ptr.Get<QosTxop> ()->GetWifiMacQueue ());
     }
   else
     {
-      m_queueInterface->CreateTxQueues ();
-
       mac->GetAttributeFailSafe ("Txop", ptr);
-      wmq = ptr.Get<Txop> ()->GetWifiMacQueue ();
-      m_queueInterface->ConnectQueueTraces<WifiMacQueueItem> (wmq, 0);
+      queues.push_back (ptr.Get<Txop> ()->GetWifiMacQueue ());
     }
+  return queues;
 }
 
 void
 WifiNetDevice::SetMac (const Ptr<WifiMac> mac)
 {
   m_mac = mac;
+  m_txQueues = GetTxQueues ();
   CompleteConfig ();
   FlowControlConfig ();
 }
@@ -501,4 +514,64 @@ WifiNetDevice::SelectQueue (Ptr<QueueItem> item) const
   return static_cast<uint8_t> (QosUtilsMapTidToAc (priority));
 }
 
+bool
+WifiNetDevice::SupportsReadyCallback (void) const
+{
+  return DynamicCast<RegularWifiMac> (m_mac) != 0;
+}
+
+void
+WifiNetDevice::SetReadyCallback (NetDevice::ReadyCallback cb)
+{
+  NS_LOG_FUNCTION (this);
+  if (!SupportsReadyCallback ())
+    {
+      NS_FATAL_ERROR ("The ready callback requires a RegularWifiMac");
+    }
+  m_readyCallback = cb;
+  if (!m_readyTracesConnected)
+    {
+      for (std::vector<Ptr<WifiMacQueue> >::iterator it = m_txQueues.begin (); it != m_txQueues.end (); it++)
+        {
+          (*it)->TraceConnectWithoutContext ("Dequeue", MakeCallback (&WifiNetDevice::TxQueueDequeued, this));
+          (*it)->TraceConnectWithoutContext ("DropAfterDequeue", MakeCallback (&WifiNetDevice::TxQueueDequeued, this));
+        }
+      m_readyTracesConnected = true;
+    }
+}
+
+uint32_t
+WifiNetDevice::GetTxBudget (void) const
+{
+  for (std::vector<Ptr<WifiMacQueue> >::const_iterator it = m_txQueues.begin (); it != m_txQueues.end (); it++)
+    {
+      if (!(*it)->IsEmpty ())
+        {
+          return 0;
+        }
+    }
+  return IsLinkUp () || m_txQueues.empty () ? GetMtu () : 0;
+}
+
+void
+WifiNetDevice::TxQueueDequeued (Ptr<const WifiMacQueueItem> item)
+{
+  NS_LOG_FUNCTION (this << item);
+  if (!m_readyCallback.IsNull ())
+    {
+      // the queue size is only updated once the trace returns
+      Simulator::ScheduleNow (&WifiNetDevice::NotifyReady, this);
+    }
+}
+
+void
+WifiNetDevice::NotifyReady (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (!m_readyCallback.IsNull () && GetTxBudget () > 0)
+    {
+      m_readyCallback (this);
+    }
+}
+
 } //namespace ns3
@@ -31,6 +31,8 @@ class WifiPhy;
 class WifiMac;
 class NetDeviceQueueInterface;
 class QueueItem;
+class WifiMacQueue;
+class WifiMacQueueItem;
 
 /// This value conforms to the 802.11 specification
 static const uint16_t MAX_MSDU_SIZE = 2304;
@@ -112,6 +114,21 @@ public:
   bool SendFrom (Ptr<Packet> packet, const Address& source, const Address& dest, uint16_t protocolNumber);
   void SetPromiscReceiveCallback (PromiscReceiveCallback cb);
   bool SupportsSendFrom (void) const;
+  /**
+   * \return true if the MAC is a RegularWifiMac, whose queues the device can watch
+   */
+  bool SupportsReadyCallback (void) const;
+  /**
+   * \param cb callback to invoke whenever the MAC queues become empty.
+   *
+   * The device is then ready to send, although the channel access for the
+   * frame taken from the queues may still be in progress.
+   */
+  void SetReadyCallback (NetDevice::ReadyCallback cb);
+  /**
+   * \return the MTU if the MAC queues are empty, zero otherwise
+   */
+  uint32_t GetTxBudget (void) const;
 
 
 protected:
@@ -210,13 +227,35 @@ private:
    */
   uint8_t SelectQueue (Ptr<QueueItem> item) const;
 
+  /**
+   * \return the queues of the MAC for the data frames, in the order of the
+   *         device transmission queues, or an empty vector if the MAC is not
+   *         a RegularWifiMac
+   */
+  std::vector<Ptr<WifiMacQueue> > GetTxQueues (void) const;
+
+  /**
+   * Invoked when a frame leaves one of the MAC queues.
+   *
+   * \param item the frame
+   */
+  void TxQueueDequeued (Ptr<const WifiMacQueueItem> item);
+
+  /**
+   * Invoke the ready callback, if the device is still ready to send.
+   */
+  void NotifyReady (void);
+
   Ptr<Node> m_node; //!< the node
   Ptr<WifiPhy> m_phy; //!< the phy
   Ptr<WifiMac> m_mac; //!< the MAC
   Ptr<WifiRemoteStationManager> m_stationManager; //!< the station manager
   Ptr<NetDeviceQueueInterface> m_queueInterface;   //!< NetDevice queue interface
+  std::vector<Ptr<WifiMacQueue> > m_txQueues; //!< the MAC queues for the data frames, set along with the MAC
   NetDevice::ReceiveCallback m_forwardUp; //!< forward up callback
   NetDevice::PromiscReceiveCallback m_promiscRx; //!< promiscious receive callback
+  NetDevice::ReadyCallback m_readyCallback; //!< ready to send callback
+  bool m_readyTracesConnected; //!< true if the MAC queue traces are connected to TxQueueDequeued
 
   TracedCallback<Ptr<const Packet>, Mac48Address> m_rxLogger; //!< receive trace callback
   TracedCallback<Ptr<const Packet>, Mac48Address> m_txLogger; //!< transmit trace callback
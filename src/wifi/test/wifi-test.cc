@@ -1690,6 +1690,110 @@ StaWifiMacScanningTestCase::DoRun (void)
   }
 }
 
+//-----------------------------------------------------------------------------
+/**
+ * Make sure that the WifiNetDevice has no transmit budget while frames are
+ * waiting in the MAC queues, and that it calls the ready callback exactly
+ * once, when the last frame leaves the MAC queues.
+ */
+class WifiReadyCallbackTestCase : public TestCase
+{
+public:
+  WifiReadyCallbackTestCase ();
+  virtual ~WifiReadyCallbackTestCase ();
+
+  virtual void DoRun (void);
+
+
+private:
+  /**
+   * Send three frames back to back and check that the budget is exhausted
+   * while frames are queued
+   * \param device the device to send from
+   */
+  void SendPackets (Ptr<WifiNetDevice> device);
+  /**
+   * Ready callback of the device
+   * \param device the device ready to send
+   */
+  void Ready (Ptr<NetDevice> device);
+
+  uint32_t m_ready; ///< number of ready callback invocations
+};
+
+WifiReadyCallbackTestCase::WifiReadyCallbackTestCase ()
+  : TestCase ("Test case for the WifiNetDevice ready callback and transmit budget"),
+    m_ready (0)
+{
+}
+
+WifiReadyCallbackTestCase::~WifiReadyCallbackTestCase ()
+{
+}
+
+void
+WifiReadyCallbackTestCase::SendPackets (Ptr<WifiNetDevice> device)
+{
+  NS_TEST_EXPECT_MSG_EQ (device->GetTxBudget (), device->GetMtu (), "idle device without budget");
+  // the medium is idle, hence the first frame is dequeued immediately
+  device->Send (Create<Packet> (1000), device->GetBroadcast (), 1);
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      device->Send (Create<Packet> (1000), device->GetBroadcast (), 1);
+      NS_TEST_EXPECT_MSG_EQ (device->GetTxBudget (), 0, "device with queued frames has a budget");
+    }
+}
+
+void
+WifiReadyCallbackTestCase::Ready (Ptr<NetDevice> device)
+{
+  m_ready++;
+  NS_TEST_EXPECT_MSG_EQ (device->GetTxBudget (), device->GetMtu (), "ready device without budget");
+}
+
+void
+WifiReadyCallbackTestCase::DoRun (void)
+{
+  NodeContainer wifiNodes;
+  wifiNodes.Create (2);
+
+  YansWifiChannelHelper channel = YansWifiChannelHelper::Default ();
+  YansWifiPhyHelper phy = YansWifiPhyHelper::Default ();
+  phy.SetChannel (channel.Create ());
+
+  WifiHelper wifi;
+  wifi.SetRemoteStationManager ("ns3::ConstantRateWifiManager",
+                                "DataMode", StringValue ("OfdmRate54Mbps"),
+                                "ControlMode", StringValue ("OfdmRate24Mbps"));
+  WifiMacHelper mac;
+  mac.SetType ("ns3::AdhocWifiMac",
+               "QosSupported", BooleanValue (true));
+
+  NetDeviceContainer wifiDevices = wifi.Install (phy, mac, wifiNodes);
+
+  MobilityHelper mobility;
+  Ptr<ListPositionAllocator> positionAlloc = CreateObject<ListPositionAllocator> ();
+  positionAlloc->Add (Vector (0.0, 0.0, 0.0));
+  positionAlloc->Add (Vector (10.0, 0.0, 0.0));
+  mobility.SetPositionAllocator (positionAlloc);
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (wifiNodes);
+
+  Ptr<WifiNetDevice> device = DynamicCast<WifiNetDevice> (wifiDevices.Get (0));
+  NS_TEST_ASSERT_MSG_EQ (device->SupportsReadyCallback (), true, "ready callback not supported");
+  device->SetReadyCallback (MakeCallback (&WifiReadyCallbackTestCase::Ready, this));
+
+  Simulator::Schedule (Seconds (1.0), &WifiReadyCallbackTestCase::SendPackets, this, device);
+
+  Simulator::Stop (Seconds (2.0));
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_ready, 1, "unexpected number of ready callback invocations");
+  NS_TEST_EXPECT_MSG_EQ (device->GetTxBudget (), device->GetMtu (), "idle device without budget");
+
+  Simulator::Destroy ();
+}
+
 /**
  * \ingroup wifi-test
  * \ingroup tests
@@ -1715,6 +1819,7 @@ WifiTestSuite::WifiTestSuite ()
   AddTestCase (new Bug2483TestCase, TestCase::QUICK); //Bug 2483
   AddTestCase (new Bug2831TestCase, TestCase::QUICK); //Bug 2831
   AddTestCase (new StaWifiMacScanningTestCase, TestCase::QUICK); //Bug 2399
+  AddTestCase (new WifiReadyCallbackTestCase, TestCase::QUICK);
 }
 
 static WifiTestSuite g_wifiTestSuite; ///< the test suite
@@ -0,0 +1,65 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program decodes a binary trace file, written through
+// AsciiTraceHelper::CreateBinaryFileStream, into the ascii trace format.
+// Sample usage:  ./waf --run 'decode-binary-trace --input=trace.bin --output=trace.tr'
+//
+// The program is linked with all the enabled modules, so that the headers
+// of the packets stored in the trace file can be printed.
+
+#include "ns3/command-line.h"
+#include "ns3/abort.h"
+#include "ns3/packet.h"
+#include "ns3/binary-trace.h"
+#include <iostream>
+#include <fstream>
+#include <string>
+
+using namespace ns3;
+
+int main (int argc, char *argv[])
+{
+  std::string input;
+  std::string output;
+
+  CommandLine cmd;
+  cmd.Usage ("Decode a binary trace file into the ascii trace format.");
+  cmd.AddValue ("input", "the binary trace file", input);
+  cmd.AddValue ("output", "the ascii trace file, the standard output if empty", output);
+  cmd.Parse (argc, argv);
+
+  NS_ABORT_MSG_IF (input.empty (), "No binary trace file given, see --PrintHelp");
+
+  // The packets stored in the trace file carry their metadata
+  Packet::EnablePrinting ();
+
+  std::ofstream file;
+  std::ostream *os = &std::cout;
+  if (!output.empty ())
+    {
+      file.open (output.c_str ());
+      NS_ABORT_MSG_UNLESS (file.is_open (), "Unable to open " << output);
+      os = &file;
+    }
+
+  if (!BinaryTraceReader::Decode (input, *os))
+    {
+      std::cerr << input << " is not a valid binary trace file" << std::endl;
+      return 1;
+    }
+  return 0;
+}